@@ -0,0 +1,68 @@
+/// \file bench_crc.cpp
+/// \brief Benchmarks for checksumming frames and bulk data, with the selected CRC-32C method and with tables
+
+#include "harness.hpp"
+
+#include "crc.hpp"
+
+namespace {
+
+  uint8_t data[64 * 1024];
+
+  const uint8_t* input()
+  {
+    static bool filled = false;
+    if (!filled)
+    {
+      uint32_t x = 1;
+      for (auto& b : data) b = static_cast<uint8_t>((x = x * 1103515245u + 12345u) >> 16);
+      filled = true;
+    }
+    return data;
+  }
+
+  /// \brief CRC-32C of a buffer of the size given as argument, with the fastest method of this processor
+  void crc32c(bench::State& state)
+  {
+    estd::span<const uint8_t> in(input(), state.arg);
+    uint32_t                  crc = 0;
+    for (uint64_t i = 0; i < state.iterations; ++i) bench::do_not_optimize(crc = estd::crc32c(in, crc));
+    state.bytes_processed = state.iterations * state.arg;
+  }
+  BENCHMARK_ARGS(crc32c, 16, 256, 4096, 65536);
+
+  /// \brief CRC-32C using tables, as on processors without CRC instructions
+  void crc32c_table(bench::State& state)
+  {
+    const uint8_t* in  = input();
+    uint32_t       crc = 0;
+    for (uint64_t i = 0; i < state.iterations; ++i)
+      bench::do_not_optimize(crc = estd::detail::crc32c_update_table(crc, in, state.arg));
+    state.bytes_processed = state.iterations * state.arg;
+  }
+  BENCHMARK_ARGS(crc32c_table, 16, 256, 4096, 65536);
+
+  /// \brief CRC-32C a byte at a time, as a bytewise implementation would
+  void crc32c_bytewise(bench::State& state)
+  {
+    const uint8_t* in  = input();
+    uint32_t       crc = 0;
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      uint32_t c = ~crc;
+      for (uint32_t j = 0; j < state.arg; ++j) c = (c >> 8) ^ estd::detail::crc32c_tables.table[0][(c ^ in[j]) & 0xFF];
+      bench::do_not_optimize(crc = ~c);
+    }
+    state.bytes_processed = state.iterations * state.arg;
+  }
+  BENCHMARK_ARGS(crc32c_bytewise, 4096);
+
+  void crc16_ccitt(bench::State& state)
+  {
+    estd::span<const uint8_t> in(input(), state.arg);
+    uint16_t                  crc = 0xFFFF;
+    for (uint64_t i = 0; i < state.iterations; ++i) bench::do_not_optimize(crc = estd::crc16_ccitt(in, crc));
+    state.bytes_processed = state.iterations * state.arg;
+  }
+  BENCHMARK_ARGS(crc16_ccitt, 16, 256, 4096, 65536);
+}
@@ -0,0 +1,192 @@
+/// \file bench_ecbor.cpp
+/// \brief Benchmarks for exporting a dictionary as CBOR compared with a text dump, and for importing it again
+
+#include "harness.hpp"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+#include "ecbor.hpp"
+#include "eio_memory.hpp"
+
+using eobject::DataType;
+using eobject::Dictionary;
+using eobject::Object;
+using eobject::Record;
+using eobject::Variable;
+
+namespace {
+
+  typedef eio::memory_driver<1024, 128> Driver;
+
+  struct Motor
+  {
+    uint32_t current;
+    int16_t  speed;
+    uint16_t limit;
+  };
+
+  Motor    motor = { 1500, -1200, 4000 };
+  uint32_t counters[64];
+  char     label[16] = "bench";
+
+  constexpr auto motor_info = Record::make_info(
+    Object::Permissions::UserConfig,
+    Record::fields()
+      .field<Motor, uint32_t, &Motor::current, offsetof(Motor, current), 0, 10000>(Object::Permissions::UserConfig,
+                                                                                  "current")
+      .field<Motor, int16_t, &Motor::speed, offsetof(Motor, speed), -3000, 3000>(Object::Permissions::UserConfig,
+                                                                                "speed")
+      .field<Motor, uint16_t, &Motor::limit, offsetof(Motor, limit), 0, 0>(Object::Permissions::UserConfig, "limit"));
+
+  constexpr auto counter_info = Variable::make_info<uint32_t>(Object::Permissions::UserConfig);
+  constexpr auto label_info   = Variable::make_string_info<16>(Object::Permissions::UserConfig);
+
+  /// \brief Dictionary with one record, one string and 64 counters spread over the range of encoded sizes
+  struct Objects
+  {
+    char              names[64][16];
+    const Dictionary* dictionary;
+
+    Objects()
+    {
+      estd::array<Dictionary::Item, 66> items;
+      items[0] = Dictionary::Item{ 0x2000, 0, Object("motor", &motor_info, &motor) };
+      items[1] = Dictionary::Item{ 0x2001, 0, Object("label", &label_info, &label) };
+      for (uint16_t i = 0; i < 64; ++i)
+      {
+        int n        = snprintf(names[i], sizeof(names[i]), "counter_%02u", static_cast<unsigned>(i));
+        counters[i]  = 1u << (i / 2);
+        items[i + 2] = Dictionary::Item{ static_cast<uint16_t>(0x1000 + i), 0,
+                                         Object(estd::string_view(names[i], n), &counter_info, &counters[i]) };
+      }
+      dictionary = new eobject::TDictionary<66>(std::move(items));
+    }
+  };
+
+  const Dictionary& dictionary()
+  {
+    static Objects o;
+    return *o.dictionary;
+  }
+
+  /// \brief Format value of one native type as text
+  void format_value(eio::buffer& buf, DataType type, const void* data, size_t size)
+  {
+    switch (type)
+    {
+      case DataType::U16: eformat::format_to(buf, "{}", *static_cast<const uint16_t*>(data)); break;
+      case DataType::U32: eformat::format_to(buf, "{}", *static_cast<const uint32_t*>(data)); break;
+      case DataType::I16: eformat::format_to(buf, "{}", *static_cast<const int16_t*>(data)); break;
+      case DataType::String:
+        eformat::format_to(buf, "\"{}\"", estd::string_view(static_cast<const char*>(data),
+                                                            strnlen(static_cast<const char*>(data), size)));
+        break;
+      default: break;
+    }
+  }
+
+  /// \brief Text export as "name=value" lines, with "name.field=value" for record fields
+  void export_text(eio::buffer& buf, const Dictionary& dict)
+  {
+    for (auto& item : dict)
+    {
+      auto& object = item.object;
+      if (object.otype() == Object::ClassId::Record)
+      {
+        auto& record = static_cast<const Record::Info&>(object.info());
+        for (auto& field : record)
+        {
+          auto& descriptor = record.descriptor(field);
+          eformat::format_to(buf, "{}.{}=", object.name(), field.name);
+          format_value(buf, descriptor.type, object.data(field.data_offset), descriptor.data_size);
+          buf.sputc('\n');
+        }
+      }
+      else
+      {
+        eformat::format_to(buf, "{}=", object.name());
+        format_value(buf, object.type(), object.data(), object.size());
+        buf.sputc('\n');
+      }
+    }
+  }
+
+  void export_dictionary_text(bench::State& state)
+  {
+    auto&  dict = dictionary();
+    Driver driver;
+    auto&  buf = driver.getbuf();
+    for (uint64_t i = 0; i < state.iterations; ++i) export_text(buf, dict);
+    buf.flush();
+    state.bytes_processed = driver.written();
+    state.items_processed = state.iterations * dict.count;
+  }
+  BENCHMARK(export_dictionary_text);
+
+  void export_dictionary_cbor(bench::State& state)
+  {
+    auto&  dict = dictionary();
+    Driver driver;
+    auto&  buf = driver.getbuf();
+    for (uint64_t i = 0; i < state.iterations; ++i) ecbor::encode(buf, dict);
+    buf.flush();
+    state.bytes_processed = driver.written();
+    state.items_processed = state.iterations * dict.count;
+  }
+  BENCHMARK(export_dictionary_cbor);
+
+  void export_dictionary_cbor_indices(bench::State& state)
+  {
+    auto&  dict = dictionary();
+    Driver driver;
+    auto&  buf = driver.getbuf();
+    for (uint64_t i = 0; i < state.iterations; ++i) ecbor::encode(buf, dict, ecbor::Keys::Indices);
+    buf.flush();
+    state.bytes_processed = driver.written();
+    state.items_processed = state.iterations * dict.count;
+  }
+  BENCHMARK(export_dictionary_cbor_indices);
+
+  /// \brief Driver which keeps all written data, so an export can be decoded again
+  struct CaptureDriver final : public eio::IODevice::Driver
+  {
+    char      data[2048];
+    uint16_t  size = 0;
+    eio::iobuffer<CaptureDriver, 256, 16> buffer_{ *this };
+
+    int write(const void* in, uint16_t count) NOEXCEPT
+    {
+      if (count > sizeof(data) - size) return EOF;
+      memcpy(data + size, in, count);
+      size += count;
+      return count;
+    }
+    int read(void*, uint16_t) NOEXCEPT { return 0; }
+    int sync(int timeout) NOEXCEPT { return timeout; }
+    eio::buffer& getbuf() NOEXCEPT { return buffer_; }
+  };
+
+  void import_dictionary_cbor(bench::State& state, ecbor::Keys keys)
+  {
+    auto&         dict = dictionary();
+    CaptureDriver capture;
+    ecbor::encode(capture.getbuf(), dict, keys);
+    capture.getbuf().sync(0);
+
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      estd::string_view in(capture.data, capture.size);
+      bench::do_not_optimize(ecbor::decode(in, dict));
+    }
+    state.bytes_processed = state.iterations * capture.size;
+    state.items_processed = state.iterations * dict.count;
+  }
+
+  void import_dictionary_cbor(bench::State& state) { import_dictionary_cbor(state, ecbor::Keys::Names); }
+  BENCHMARK(import_dictionary_cbor);
+
+  void import_dictionary_cbor_indices(bench::State& state) { import_dictionary_cbor(state, ecbor::Keys::Indices); }
+  BENCHMARK(import_dictionary_cbor_indices);
+}
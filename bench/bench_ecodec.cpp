@@ -0,0 +1,112 @@
+/// \file bench_ecodec.cpp
+/// \brief Benchmarks for encoding captured columns, and for decoding them again as host tools do
+
+#include "harness.hpp"
+
+#include <cmath>
+#include <cstring>
+
+#include "ecodec.hpp"
+#include "eio_memory.hpp"
+
+using ecodec::Codec;
+
+namespace {
+
+  typedef eio::memory_driver<1024, 16> Driver;
+
+  static const size_t column_size = 4096;
+
+  /// \brief Columns like those of a capture: a noisy slowly changing signal, a counter and a held setpoint
+  struct Columns
+  {
+    int16_t  wave[column_size];
+    uint32_t ramp[column_size];
+    uint8_t  steps[column_size];
+
+    Columns()
+    {
+      uint32_t noise = 1;
+      for (size_t i = 0; i < column_size; ++i)
+      {
+        noise    = noise * 1103515245u + 12345u;
+        wave[i]  = static_cast<int16_t>(2000.0 * sin(i / 200.0) + ((noise >> 16) & 7));
+        ramp[i]  = static_cast<uint32_t>(1000000 + i * 250);
+        steps[i] = static_cast<uint8_t>((i / 500) * 10);
+      }
+    }
+  };
+
+  const Columns& columns()
+  {
+    static Columns c;
+    return c;
+  }
+
+  /// \brief Encode a column repeatedly, with the codec given as argument
+  template<class T>
+  void encode(bench::State& state, const T (&column)[column_size])
+  {
+    auto   codec = static_cast<Codec>(state.arg);
+    Driver driver;
+    auto&  buf = driver.getbuf();
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      ecodec::encode(buf, estd::span<const T>(column, column_size), codec);
+      bench::clobber_memory();
+    }
+    buf.flush();
+    state.bytes_processed = state.iterations * sizeof(column);
+    state.items_processed = state.iterations * column_size;
+  }
+
+  void encode_wave(bench::State& state) { encode(state, columns().wave); }
+  BENCHMARK_ARGS(encode_wave, 0, 1, 2, 3);
+
+  /// \brief Encode a counter, which delta-of-delta reduces to zeros
+  void encode_ramp(bench::State& state) { encode(state, columns().ramp); }
+  BENCHMARK_ARGS(encode_ramp, 1, 2);
+
+  /// \brief Encode a value held for long runs
+  void encode_steps(bench::State& state) { encode(state, columns().steps); }
+  BENCHMARK_ARGS(encode_steps, 1, 3);
+
+  /// \brief Driver which keeps all written data, so an encoded column can be decoded again
+  struct CaptureDriver final : public eio::IODevice::Driver
+  {
+    char      data[4 * column_size * sizeof(uint32_t)];
+    uint32_t  size = 0;
+    eio::iobuffer<CaptureDriver, 256, 16> buffer_{ *this };
+
+    int write(const void* in, uint16_t count) NOEXCEPT
+    {
+      if (count > sizeof(data) - size) return EOF;
+      memcpy(data + size, in, count);
+      size += count;
+      return count;
+    }
+    int read(void*, uint16_t) NOEXCEPT { return 0; }
+    int sync(int timeout) NOEXCEPT { return timeout; }
+    eio::buffer& getbuf() NOEXCEPT { return buffer_; }
+  };
+
+  /// \brief Decode a column of 16 bit values, with the codec given as argument
+  void decode_wave(bench::State& state)
+  {
+    auto          codec = static_cast<Codec>(state.arg);
+    CaptureDriver capture;
+    ecodec::encode(capture.getbuf(), estd::span<const int16_t>(columns().wave, column_size), codec);
+    capture.getbuf().sync(0);
+
+    int16_t values[column_size];
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      estd::string_view in(capture.data, capture.size);
+      bench::do_not_optimize(ecodec::decode(in, estd::span<int16_t>(values, column_size), codec));
+      bench::do_not_optimize(values);
+    }
+    state.bytes_processed = state.iterations * sizeof(values);
+    state.items_processed = state.iterations * column_size;
+  }
+  BENCHMARK_ARGS(decode_wave, 0, 1, 2, 3);
+}
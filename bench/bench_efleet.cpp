@@ -0,0 +1,119 @@
+/// \file bench_efleet.cpp
+/// \brief Benchmarks for validating, comparing and snapshotting a fleet of devices, by one thread and by pools of the
+/// number of threads given as argument
+
+#include "harness.hpp"
+
+#include <memory>
+
+#include "efleet.hpp"
+
+using eobject::Dictionary;
+using eobject::Object;
+using eobject::TDictionary;
+using eobject::Variable;
+
+namespace {
+
+  static const uint16_t objects_per_device = 256;
+  static const uint32_t devices            = 64;
+
+  /// \brief Values of a device, and its dictionary
+  struct Device
+  {
+    static constexpr Variable::Info info =
+      Variable::make_info<int32_t, -1000, 1000>(Object::Permissions::UserConfig);
+
+    int32_t                                          data[objects_per_device];
+    std::unique_ptr<TDictionary<objects_per_device>> dictionary;
+
+    explicit Device(uint32_t seed)
+    {
+      estd::array<Dictionary::Item, objects_per_device> items;
+      for (uint16_t i = 0; i < objects_per_device; ++i)
+      {
+        seed     = seed * 1664525u + 1013904223u;
+        data[i]  = static_cast<int32_t>(seed >> 8) % 1100;
+        items[i] = Dictionary::Item{ static_cast<uint16_t>(0x2000 + i), 0, Object("value", &info, &data[i]) };
+      }
+      dictionary.reset(new TDictionary<objects_per_device>(std::move(items)));
+    }
+  };
+
+  /// \brief Devices with values in a pseudo-random order, a few of them out of range
+  struct Fleet
+  {
+    std::vector<std::unique_ptr<Device>> device;
+    std::vector<const Dictionary*>        dictionaries;
+
+    explicit Fleet(uint32_t seed)
+    {
+      for (uint32_t d = 0; d < devices; ++d)
+      {
+        device.emplace_back(new Device(seed + d));
+        dictionaries.push_back(device.back()->dictionary.get());
+      }
+    }
+
+    estd::span<const Dictionary* const> span() const
+    {
+      return { dictionaries.data(), static_cast<uint32_t>(dictionaries.size()) };
+    }
+  };
+
+  const Fleet& fleet()
+  {
+    static const Fleet f(1);
+    return f;
+  }
+
+  /// \brief Fleet differing from the first in most values
+  const Fleet& other_fleet()
+  {
+    static const Fleet f(2);
+    return f;
+  }
+
+  void fleet_validate_serial(bench::State& state)
+  {
+    auto&                      f = fleet();
+    std::vector<efleet::Issue> issues;
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      issues.clear();
+      for (uint32_t d = 0; d < devices; ++d) efleet::validate(*f.dictionaries[d], d, issues);
+      bench::do_not_optimize(issues.data());
+    }
+    state.items_processed = state.iterations * devices * objects_per_device;
+  }
+  BENCHMARK(fleet_validate_serial);
+
+  void fleet_validate(bench::State& state)
+  {
+    efleet::Pool pool(state.arg);
+    auto&        f = fleet();
+    for (uint64_t i = 0; i < state.iterations; ++i) bench::do_not_optimize(efleet::validate(pool, f.span()).size());
+    state.items_processed = state.iterations * devices * objects_per_device;
+  }
+  BENCHMARK_ARGS(fleet_validate, 1, 2, 4);
+
+  void fleet_diff(bench::State& state)
+  {
+    efleet::Pool pool(state.arg);
+    auto&        f = fleet();
+    auto&        o = other_fleet();
+    for (uint64_t i = 0; i < state.iterations; ++i)
+      bench::do_not_optimize(efleet::diff(pool, f.span(), o.span()).size());
+    state.items_processed = state.iterations * devices * objects_per_device;
+  }
+  BENCHMARK_ARGS(fleet_diff, 1, 2, 4);
+
+  void fleet_snapshot(bench::State& state)
+  {
+    efleet::Pool pool(state.arg);
+    auto&        f = fleet();
+    for (uint64_t i = 0; i < state.iterations; ++i) bench::do_not_optimize(efleet::snapshot(pool, f.span()).size());
+    state.items_processed = state.iterations * devices * objects_per_device;
+  }
+  BENCHMARK_ARGS(fleet_snapshot, 1, 2, 4);
+}
@@ -0,0 +1,308 @@
+/// \file bench_eformat.cpp
+/// \brief Benchmarks for formatting and parsing functions
+
+#include "harness.hpp"
+
+#include "eformat.hpp"
+#include "eio_memory.hpp"
+
+namespace {
+
+  /// \brief Values with an even spread of digit counts, so formatting costs are not dominated by one length
+  struct Values
+  {
+    uint32_t u32[256];
+    int32_t  i32[256];
+
+    Values()
+    {
+      uint32_t seed = 0x12345678u;
+      for (int i = 0; i < 256; ++i)
+      {
+        seed = seed * 1664525u + 1013904223u;
+        uint32_t digits = 1 + (i % 10);
+        uint32_t limit  = 1;
+        for (uint32_t d = 0; d < digits && limit < 1000000000u; ++d) limit *= 10;
+        u32[i] = seed % limit;
+        i32[i] = (i & 1) ? -static_cast<int32_t>(u32[i] >> 1) : static_cast<int32_t>(u32[i] >> 1);
+      }
+    }
+  };
+
+  const Values values;
+
+  /// \brief Decimal strings matching the values table, for the parsing benchmarks
+  struct Strings
+  {
+    char text[256][16];
+    estd::string_view u32[256];
+    estd::string_view i32[256];
+    char itext[256][16];
+
+    Strings()
+    {
+      for (int i = 0; i < 256; ++i)
+      {
+        int n  = snprintf(text[i], sizeof(text[i]), "%lu ", static_cast<unsigned long>(values.u32[i]));
+        u32[i] = estd::string_view(text[i], n);
+        n      = snprintf(itext[i], sizeof(itext[i]), "%ld ", static_cast<long>(values.i32[i]));
+        i32[i] = estd::string_view(itext[i], n);
+      }
+    }
+  };
+
+  const Strings strings;
+
+  typedef eio::memory_driver<1024, 16> Driver;
+
+  void format_decimal_u32(bench::State& state)
+  {
+    char     out[16];
+    uint64_t bytes = 0;
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      bytes += eformat::format_decimal(out, sizeof(out), values.u32[i & 255]);
+      bench::do_not_optimize(out);
+    }
+    state.bytes_processed = bytes;
+  }
+  BENCHMARK(format_decimal_u32);
+
+  void format_decimal_i32(bench::State& state)
+  {
+    char     out[16];
+    uint64_t bytes = 0;
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      bytes += eformat::format_decimal(out, sizeof(out), values.i32[i & 255]);
+      bench::do_not_optimize(out);
+    }
+    state.bytes_processed = bytes;
+  }
+  BENCHMARK(format_decimal_i32);
+
+  void format_hex_u32(bench::State& state)
+  {
+    char     out[16];
+    uint64_t bytes = 0;
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      bytes += eformat::format_hex(out, sizeof(out), values.u32[i & 255]);
+      bench::do_not_optimize(out);
+    }
+    state.bytes_processed = bytes;
+  }
+  BENCHMARK(format_hex_u32);
+
+  void format_fixed_i32(bench::State& state)
+  {
+    char     out[16];
+    uint64_t bytes = 0;
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      bytes += eformat::format_fixed(out, sizeof(out), values.i32[i & 255], 2);
+      bench::do_not_optimize(out);
+    }
+    state.bytes_processed = bytes;
+  }
+  BENCHMARK(format_fixed_i32);
+
+  /// \brief Bytes of a binary blob, and the blob as hex digits, for the byte string benchmarks
+  struct Blob
+  {
+    uint8_t bytes[4096];
+    char    hex[8192];
+
+    Blob()
+    {
+      uint32_t seed = 0x9E3779B9u;
+      for (size_t i = 0; i < sizeof(bytes); ++i)
+      {
+        seed     = seed * 1664525u + 1013904223u;
+        bytes[i] = static_cast<uint8_t>(seed >> 24);
+      }
+      eformat::format_hex(hex, sizeof(hex), estd::span<const uint8_t>(bytes, static_cast<uint32_t>(sizeof(bytes))));
+    }
+  };
+
+  const Blob blob;
+
+  /// \brief Encode the first arg bytes of the blob as hex
+  void format_hex_bytes(bench::State& state)
+  {
+    char out[sizeof(blob.hex)];
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      eformat::format_hex(out, sizeof(out), estd::span<const uint8_t>(blob.bytes, state.arg));
+      bench::do_not_optimize(out);
+    }
+    state.bytes_processed = state.iterations * state.arg;
+  }
+  BENCHMARK_ARGS(format_hex_bytes, 16, 256, 4096);
+
+  void parse_hex_bytes(bench::State& state)
+  {
+    uint8_t out[sizeof(blob.bytes)];
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      estd::string_view   in(blob.hex, state.arg * 2);
+      estd::span<uint8_t> value(out, static_cast<uint32_t>(sizeof(out)));
+      eformat::parse(in, value);
+      bench::do_not_optimize(out);
+    }
+    state.bytes_processed = state.iterations * state.arg;
+  }
+  BENCHMARK_ARGS(parse_hex_bytes, 16, 256, 4096);
+
+  void format_hexdump(bench::State& state)
+  {
+    Driver driver;
+    auto&  buf = driver.getbuf();
+    for (uint64_t i = 0; i < state.iterations; ++i)
+      eformat::format_hexdump(buf, estd::span<const uint8_t>(blob.bytes, 256));
+    buf.flush();
+    state.bytes_processed = state.iterations * 256;
+  }
+  BENCHMARK(format_hexdump);
+
+  void format_to_u32(bench::State& state)
+  {
+    Driver driver;
+    auto&  buf = driver.getbuf();
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      eformat::format_to(buf, "value={}\n", values.u32[i & 255]);
+    }
+    buf.flush();
+    state.bytes_processed = driver.written();
+    state.items_processed = state.iterations;
+  }
+  BENCHMARK(format_to_u32);
+
+  void format_to_mixed(bench::State& state)
+  {
+    Driver            driver;
+    auto&             buf  = driver.getbuf();
+    estd::string_view name = "motor.current";
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      eformat::format_to(buf, "{<16}: {} ({x}) {>8}\n", name, values.i32[i & 255], values.u32[i & 255],
+                         values.u32[(i + 7) & 255]);
+    }
+    buf.flush();
+    state.bytes_processed = driver.written();
+    state.items_processed = state.iterations;
+  }
+  BENCHMARK(format_to_mixed);
+
+  void stream_u32(bench::State& state)
+  {
+    Driver          driver;
+    eio::IODevice   device(&driver);
+    eformat::stream so(device);
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      so << values.u32[i & 255] << '\n';
+    }
+    so.flush();
+    state.bytes_processed = driver.written();
+    state.items_processed = state.iterations;
+  }
+  BENCHMARK(stream_u32);
+
+  void parse_u32(bench::State& state)
+  {
+    uint64_t bytes = 0;
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      estd::string_view in = strings.u32[i & 255];
+      uint32_t          value;
+      bytes += in.size();
+      eformat::parse(in, value);
+      bench::do_not_optimize(value);
+    }
+    state.bytes_processed = bytes;
+    state.items_processed = state.iterations;
+  }
+  BENCHMARK(parse_u32);
+
+  void parse_i32(bench::State& state)
+  {
+    uint64_t bytes = 0;
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      estd::string_view in = strings.i32[i & 255];
+      int32_t           value;
+      bytes += in.size();
+      eformat::parse(in, value);
+      bench::do_not_optimize(value);
+    }
+    state.bytes_processed = bytes;
+    state.items_processed = state.iterations;
+  }
+  BENCHMARK(parse_i32);
+
+  /// \brief Values of the table as fixed-point strings with 2 decimals, for parse_fixed
+  struct FixedStrings
+  {
+    char              text[256][16];
+    estd::string_view i32[256];
+
+    FixedStrings()
+    {
+      for (int i = 0; i < 256; ++i)
+      {
+        // Positive values are formatted with a space in place of the sign, which parsing does not skip
+        int n  = eformat::format_fixed(text[i], sizeof(text[i]), values.i32[i] / 100, 2);
+        int s  = text[i][0] == ' ' ? 1 : 0;
+        i32[i] = estd::string_view(text[i] + s, n - s);
+      }
+    }
+  };
+
+  const FixedStrings fixed_strings;
+
+  void parse_fixed_i32(bench::State& state)
+  {
+    uint64_t bytes = 0;
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      estd::string_view in = fixed_strings.i32[i & 255];
+      int32_t           value;
+      bytes += in.size();
+      eformat::parse_fixed(in, value, 2);
+      bench::do_not_optimize(value);
+    }
+    state.bytes_processed = bytes;
+    state.items_processed = state.iterations;
+  }
+  BENCHMARK(parse_fixed_i32);
+
+  void parse_u8(bench::State& state)
+  {
+    static const estd::string_view inputs[] = { "7 ", "42 ", "255 ", "0 " };
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      estd::string_view in = inputs[i & 3];
+      uint8_t           value;
+      eformat::parse(in, value);
+      bench::do_not_optimize(value);
+    }
+    state.items_processed = state.iterations;
+  }
+  BENCHMARK(parse_u8);
+
+  void parse_bool(bench::State& state)
+  {
+    static const estd::string_view inputs[] = { "true ", "false ", "true", "false" };
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      estd::string_view in = inputs[i & 3];
+      bool              value;
+      eformat::parse(in, value);
+      bench::do_not_optimize(value);
+    }
+    state.items_processed = state.iterations;
+  }
+  BENCHMARK(parse_bool);
+}
@@ -0,0 +1,180 @@
+/// \file bench_eio.cpp
+/// \brief Benchmarks for IO buffer flush patterns and console command latency
+
+#include "harness.hpp"
+
+#include <cstddef>
+
+#include "console.hpp"
+#include "eio_memory.hpp"
+
+using eobject::Dictionary;
+using eobject::Object;
+using eobject::Record;
+using eobject::Variable;
+
+namespace {
+
+  static const char line[] = "motor.current: 1234 (0x4D2)      ok\n";
+
+  typedef eio::memory_driver<1024, 128> Driver;
+
+  void iobuffer_sputc(bench::State& state)
+  {
+    Driver driver;
+    auto&  buf = driver.getbuf();
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      for (char c : line) buf.sputc(c);
+    }
+    buf.flush();
+    state.bytes_processed = driver.written();
+  }
+  BENCHMARK(iobuffer_sputc);
+
+  void iobuffer_line_flush(bench::State& state)
+  {
+    Driver driver;
+    auto&  buf = driver.getbuf();
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      buf.sputn(line, sizeof(line) - 1);
+      buf.flush();
+    }
+    state.bytes_processed = driver.written();
+  }
+  BENCHMARK(iobuffer_line_flush);
+
+  void iobuffer_line_sync(bench::State& state)
+  {
+    Driver driver;
+    auto&  buf = driver.getbuf();
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      buf.sputn(line, sizeof(line) - 1);
+      buf.sync();
+    }
+    state.bytes_processed = driver.written();
+  }
+  BENCHMARK(iobuffer_line_sync);
+
+  /// \brief Writes larger than the output buffer, which are flushed through overflow()
+  void iobuffer_bulk(bench::State& state)
+  {
+    static char block[4096];
+    Driver      driver;
+    auto&       buf = driver.getbuf();
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      buf.sputn(block, state.arg);
+    }
+    buf.flush();
+    state.bytes_processed = driver.written();
+  }
+  BENCHMARK_ARGS(iobuffer_bulk, 64, 512, 4096);
+
+  void iobuffer_getline(bench::State& state)
+  {
+    static const char input[] = "get motor_0001\nset motor_0002=42\nls\n";
+    Driver            driver;
+    auto&             buf   = driver.getbuf();
+    uint64_t          lines = 0;
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      if (driver.pending().empty()) driver.feed(input);
+      auto l = buf.getline();
+      if (false == l.empty()) ++lines;
+      bench::do_not_optimize(l);
+    }
+    state.items_processed = lines;
+  }
+  BENCHMARK(iobuffer_getline);
+
+  struct Motor
+  {
+    uint32_t current;
+    int16_t  speed;
+    uint16_t limit;
+  };
+
+  Motor    motor;
+  uint32_t counters[64];
+
+  constexpr auto motor_info = Record::make_info(
+    Object::Permissions::UserConfig,
+    Record::fields()
+      .field<Motor, uint32_t, &Motor::current, offsetof(Motor, current), 0, 10000>(Object::Permissions::UserConfig,
+                                                                                  "current")
+      .field<Motor, int16_t, &Motor::speed, offsetof(Motor, speed), -3000, 3000>(Object::Permissions::UserConfig,
+                                                                                "speed")
+      .field<Motor, uint16_t, &Motor::limit, offsetof(Motor, limit), 0, 0>(Object::Permissions::UserConfig, "limit"));
+
+  constexpr auto counter_info = Variable::make_info<uint32_t>(Object::Permissions::UserConfig);
+
+  /// \brief Console session over an in-memory device, with a small dictionary of variables and one record
+  struct Session
+  {
+    char              names[64][16];
+    const Dictionary* dictionary;
+    Driver            driver;
+    eio::IODevice     device{ &driver };
+    console::Console* console;
+
+    Session()
+    {
+      estd::array<Dictionary::Item, 65> items;
+      items[0] = Dictionary::Item{ 0x2000, 0, Object("motor", &motor_info, &motor) };
+      for (uint16_t i = 0; i < 64; ++i)
+      {
+        int n        = snprintf(names[i], sizeof(names[i]), "counter_%02u", static_cast<unsigned>(i));
+        items[i + 1] = Dictionary::Item{ static_cast<uint16_t>(0x1000 + i), 0,
+                                         Object(estd::string_view(names[i], n), &counter_info, &counters[i]) };
+      }
+      dictionary = new eobject::TDictionary<65>(std::move(items));
+      console    = new console::Console(eformat::stream(device), *dictionary);
+    }
+
+    /// \brief Run one command line, polling until the console prints its next prompt
+    void run(estd::string_view command)
+    {
+      driver.feed(command);
+      for (int retry = 0; retry < 16; ++retry)
+      {
+        console->poll();
+        auto out = driver.last_write();
+        if (driver.pending().empty() && out.size() >= 2 && out[out.size() - 2] == '>' && out[out.size() - 1] == '>')
+          return;
+      }
+    }
+  };
+
+  Session& session()
+  {
+    static Session s;
+    return s;
+  }
+
+  void console_command(bench::State& state, estd::string_view command)
+  {
+    auto& s = session();
+    auto  start = s.driver.written();
+    for (uint64_t i = 0; i < state.iterations; ++i) s.run(command);
+    state.bytes_processed = s.driver.written() - start;
+    state.items_processed = state.iterations;
+  }
+
+  void console_get_variable(bench::State& state) { console_command(state, "get counter_42\n"); }
+  BENCHMARK(console_get_variable);
+
+  void console_get_field(bench::State& state) { console_command(state, "get motor.speed\n"); }
+  BENCHMARK(console_get_field);
+
+  void console_get_record(bench::State& state) { console_command(state, "get motor\n"); }
+  BENCHMARK(console_get_record);
+
+  void console_set_variable(bench::State& state) { console_command(state, "set counter_17 = 1234\n"); }
+  BENCHMARK(console_set_variable);
+
+  void console_list(bench::State& state) { console_command(state, "ls\n"); }
+  BENCHMARK(console_list);
+}
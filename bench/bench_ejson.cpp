@@ -0,0 +1,155 @@
+/// \file bench_ejson.cpp
+/// \brief Benchmarks for writing a dictionary as JSON, and for reading it back incrementally through an IO buffer
+
+#include "harness.hpp"
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+#include "ejson.hpp"
+#include "eio_memory.hpp"
+
+using eobject::Dictionary;
+using eobject::Object;
+using eobject::Record;
+using eobject::Variable;
+
+namespace {
+
+  struct Motor
+  {
+    uint32_t current;
+    int16_t  speed;
+    uint16_t limit;
+  };
+
+  Motor    motor = { 1500, -1200, 4000 };
+  uint32_t counters[64];
+  char     label[64] = "benchmark label with \"quotes\" and a\ttab";
+
+  constexpr auto motor_info = Record::make_info(
+    Object::Permissions::UserConfig,
+    Record::fields()
+      .field<Motor, uint32_t, &Motor::current, offsetof(Motor, current), 0, 10000>(Object::Permissions::UserConfig,
+                                                                                  "current")
+      .field<Motor, int16_t, &Motor::speed, offsetof(Motor, speed), -3000, 3000>(Object::Permissions::UserConfig,
+                                                                                "speed")
+      .field<Motor, uint16_t, &Motor::limit, offsetof(Motor, limit), 0, 0>(Object::Permissions::UserConfig, "limit"));
+
+  constexpr auto counter_info = Variable::make_info<uint32_t>(Object::Permissions::UserConfig);
+  constexpr auto label_info   = Variable::make_string_info<64>(Object::Permissions::UserConfig);
+
+  /// \brief Dictionary with one record, one string and 64 counters
+  struct Objects
+  {
+    char              names[64][16];
+    const Dictionary* dictionary;
+
+    Objects()
+    {
+      estd::array<Dictionary::Item, 66> items;
+      items[0] = Dictionary::Item{ 0x2000, 0, Object("motor", &motor_info, &motor) };
+      items[1] = Dictionary::Item{ 0x2001, 0, Object("label", &label_info, &label) };
+      for (uint16_t i = 0; i < 64; ++i)
+      {
+        int n        = snprintf(names[i], sizeof(names[i]), "counter_%02u", static_cast<unsigned>(i));
+        counters[i]  = 1u << (i / 2);
+        items[i + 2] = Dictionary::Item{ static_cast<uint16_t>(0x1000 + i), 0,
+                                         Object(estd::string_view(names[i], n), &counter_info, &counters[i]) };
+      }
+      dictionary = new eobject::TDictionary<66>(std::move(items));
+    }
+  };
+
+  const Dictionary& dictionary()
+  {
+    static Objects o;
+    return *o.dictionary;
+  }
+
+  /// \brief Driver which appends written data to a string
+  struct StringDriver final : public eio::IODevice::Driver
+  {
+    std::string                        output;
+    eio::iobuffer<StringDriver, 256, 16> buffer_{ *this };
+
+    int write(const void* data, uint16_t count) NOEXCEPT
+    {
+      output.append(static_cast<const char*>(data), count);
+      return count;
+    }
+    int          read(void*, uint16_t) NOEXCEPT { return 0; }
+    int          sync(int timeout) NOEXCEPT { return timeout; }
+    eio::buffer& getbuf() NOEXCEPT { return buffer_; }
+  };
+
+  const std::string& document()
+  {
+    static std::string doc;
+    if (doc.empty())
+    {
+      StringDriver    driver;
+      eio::IODevice   device(&driver);
+      eformat::stream so(device);
+      ejson::write(so, dictionary());
+      so.sync();
+      doc = driver.output;
+    }
+    return doc;
+  }
+
+  void export_dictionary_json(bench::State& state)
+  {
+    auto&                         dict = dictionary();
+    eio::memory_driver<1024, 128> driver;
+    eio::IODevice                 device(&driver);
+    eformat::stream               so(device);
+    for (uint64_t i = 0; i < state.iterations; ++i) ejson::write(so, dict);
+    so.flush();
+    state.bytes_processed = driver.written();
+    state.items_processed = state.iterations * dict.count;
+  }
+  BENCHMARK(export_dictionary_json);
+
+  /// \brief Read the document through an input buffer of the given size, as it would arrive from a device
+  template<eio::size_type InbufSize>
+  void import_dictionary_json(bench::State& state)
+  {
+    auto&                                  dict = dictionary();
+    auto&                                  doc  = document();
+    eio::memory_driver<128, InbufSize>     driver;
+    auto&                                  buf = driver.getbuf();
+    ejson::reader                          reader(dict);
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      driver.feed(estd::string_view(doc.data(), doc.size()));
+      reader.reset();
+      while (reader.poll(buf) == eformat::ParseStatus::Incomplete) {}
+    }
+    bench::do_not_optimize(reader.count());
+    state.bytes_processed = state.iterations * doc.size();
+    state.items_processed = state.iterations * dict.count;
+  }
+
+  void import_dictionary_json_64(bench::State& state) { import_dictionary_json<64>(state); }
+  BENCHMARK(import_dictionary_json_64);
+
+  void import_dictionary_json_512(bench::State& state) { import_dictionary_json<512>(state); }
+  BENCHMARK(import_dictionary_json_512);
+
+  /// \brief Parse a document holding one long string, which is mostly scanning for its closing quote
+  void json_scan_string(bench::State& state)
+  {
+    std::string doc = "{\"unknown\":\"" + std::string(state.arg, 'x') + "\"}";
+    ejson::reader reader(dictionary());
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      estd::string_view in(doc.data(), doc.size());
+      reader.reset();
+      bench::do_not_optimize(reader.parse(in));
+    }
+    state.bytes_processed = state.iterations * doc.size();
+  }
+  BENCHMARK_ARGS(json_scan_string, 64, 1024, 16384);
+}
@@ -0,0 +1,404 @@
+/// \file bench_eobject.cpp
+/// \brief Benchmarks for index and dictionary lookups at varying sizes
+
+#include "harness.hpp"
+
+#include <cstdio>
+
+#include "eobject.hpp"
+#include "etrace.hpp"
+#include "index.hpp"
+
+using eobject::Dictionary;
+using eobject::Object;
+using eobject::TDictionary;
+using eobject::Variable;
+
+namespace {
+
+  static const uint16_t max_objects = 1024;
+
+  /// \brief Storage for generated object names, which must outlive the indexes that refer to them
+  struct Names
+  {
+    char              text[max_objects][16];
+    estd::string_view view[max_objects];
+
+    Names()
+    {
+      static const char* const prefixes[] = { "motor_", "drive_", "limit_", "sensor_" };
+      for (uint16_t i = 0; i < max_objects; ++i)
+      {
+        int n   = snprintf(text[i], sizeof(text[i]), "%s%04u", prefixes[i & 3], static_cast<unsigned>(i));
+        view[i] = estd::string_view(text[i], n);
+      }
+    }
+  };
+
+  const Names names;
+
+  /// \brief Spread addresses over the 16-bit range in a scrambled order, so the dictionary has to sort them
+  constexpr uint16_t address_of(uint16_t i) { return static_cast<uint16_t>(i * 7919u); }
+
+  /// \brief Sequence of pseudo-random indices in [0, N), shared by all lookups
+  template<uint16_t N>
+  struct Order
+  {
+    uint16_t index[256];
+
+    Order()
+    {
+      uint32_t seed = 0xBEEFu;
+      for (auto& i : index)
+      {
+        seed = seed * 1664525u + 1013904223u;
+        i    = (seed >> 8) % N;
+      }
+    }
+  };
+
+  template<uint16_t N>
+  struct Indexes
+  {
+    typedef eindex::named_value<uint16_t> value_type;
+
+    static estd::array<value_type, N> values()
+    {
+      estd::array<value_type, N> v;
+      for (uint16_t i = 0; i < N; ++i) v[i] = value_type{ address_of(i), names.view[i] };
+      return v;
+    }
+
+    eindex::name_index<uint16_t, N>  by_name{ values() };
+    eindex::value_index<uint16_t, N> by_value{ values() };
+    Order<N>                        order;
+  };
+
+  template<uint16_t N>
+  const Indexes<N>& indexes()
+  {
+    static const Indexes<N> i;
+    return i;
+  }
+
+  template<uint16_t N>
+  struct Objects
+  {
+    static constexpr Variable::Info info        = Variable::make_info<uint32_t>(Object::Permissions::UserConfig);
+    static constexpr Variable::Info status_info = Variable::make_info<uint32_t>(Object::Permissions::Status);
+
+    uint32_t                  data[N] = {};
+    const Dictionary*         dictionary;
+    const eobject::NameIndex* name_index;
+    Order<N>                  order;
+
+    // Tables of the same objects as a compact dictionary
+    uint16_t                          addresses[N];
+    const Object::Info*               infos[N];
+    uint16_t                          offsets[N];
+    char                              pool[N * 16];
+    uint16_t                          name_offsets[N + 1];
+    const eobject::CompactDictionary* compact;
+
+    Objects()
+    {
+      auto items = new estd::array<Dictionary::Item, N>;
+      for (uint16_t i = 0; i < N; ++i)
+      {
+        // Every eighth object is a status value, for scans of the objects which change while running
+        const Variable::Info* perm_info = i % 8 == 7 ? &status_info : &info;
+        (*items)[i] = Dictionary::Item{ address_of(i), 0, Object(names.view[i], perm_info, &data[i]) };
+      }
+      dictionary = new TDictionary<N>(std::move(*items));
+      name_index = new eobject::TNameIndex<N, N, 0>(*dictionary);
+      delete items;
+
+      uint16_t i = 0, end = 0;
+      for (auto& item : *dictionary)
+      {
+        addresses[i]    = item.address;
+        infos[i]        = &item.object.info();
+        offsets[i]      = static_cast<uint16_t>(static_cast<const uint8_t*>(item.object.data()) -
+                                                reinterpret_cast<const uint8_t*>(data));
+        name_offsets[i] = end;
+        for (char c : item.object.name()) pool[end++] = c;
+        ++i;
+      }
+      name_offsets[N] = end;
+      compact = new eobject::CompactDictionary(N, addresses, infos, offsets, data, name_offsets, pool);
+    }
+  };
+
+  template<uint16_t N>
+  Objects<N>& objects()
+  {
+    static Objects<N> o;
+    return o;
+  }
+
+  template<uint16_t N>
+  void name_index_find(bench::State& state)
+  {
+    auto& idx = indexes<N>();
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      bench::do_not_optimize(idx.by_name.find(names.view[idx.order.index[i & 255]]));
+    }
+    state.items_processed = state.iterations;
+  }
+
+  template<uint16_t N>
+  void value_index_find(bench::State& state)
+  {
+    auto& idx = indexes<N>();
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      bench::do_not_optimize(idx.by_value.find(address_of(idx.order.index[i & 255])));
+    }
+    state.items_processed = state.iterations;
+  }
+
+  template<uint16_t N>
+  void dictionary_get(bench::State& state)
+  {
+    auto& o = objects<N>();
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      bench::do_not_optimize(o.dictionary->get(address_of(o.order.index[i & 255])));
+    }
+    state.items_processed = state.iterations;
+  }
+
+  /// \brief Get by address from the compact dictionary, whose search reads only the table of addresses
+  template<uint16_t N>
+  void compact_get(bench::State& state)
+  {
+    auto& o = objects<N>();
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      bench::do_not_optimize(o.compact->get(address_of(o.order.index[i & 255])).value.data());
+    }
+    state.items_processed = state.iterations;
+  }
+
+  template<uint16_t N>
+  void dictionary_find(bench::State& state)
+  {
+    auto& o = objects<N>();
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      bench::do_not_optimize(o.dictionary->find(names.view[o.order.index[i & 255]]));
+    }
+    state.items_processed = state.iterations;
+  }
+
+  template<uint16_t N>
+  void dictionary_query(bench::State& state)
+  {
+    auto& o = objects<N>();
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      estd::string_view  line = names.view[o.order.index[i & 255]];
+      Dictionary::Query  q{ line };
+      bench::do_not_optimize(o.dictionary->query(q));
+    }
+    state.items_processed = state.iterations;
+  }
+
+  /// \brief Queries through a name index, which interns the name and then compares atoms
+  template<uint16_t N>
+  void dictionary_query_atoms(bench::State& state)
+  {
+    auto& o = objects<N>();
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      estd::string_view  line = names.view[o.order.index[i & 255]];
+      Dictionary::Query  q{ line };
+      bench::do_not_optimize(o.name_index->query(q));
+    }
+    state.items_processed = state.iterations;
+  }
+
+  template<uint16_t N>
+  void dictionary_read(bench::State& state)
+  {
+    auto&    o = objects<N>();
+    uint32_t value;
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      bench::do_not_optimize(o.dictionary->read(address_of(o.order.index[i & 255]), 0, &value, sizeof(value)));
+    }
+    state.items_processed = state.iterations;
+  }
+
+  template<uint16_t N>
+  void compact_read(bench::State& state)
+  {
+    auto&    o = objects<N>();
+    uint32_t value;
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      bench::do_not_optimize(o.compact->read(address_of(o.order.index[i & 255]), 0, &value, sizeof(value)));
+    }
+    state.items_processed = state.iterations;
+  }
+
+  template<uint16_t N>
+  void dictionary_write(bench::State& state)
+  {
+    auto& o = objects<N>();
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      uint32_t value = static_cast<uint32_t>(i);
+      bench::do_not_optimize(o.dictionary->write(address_of(o.order.index[i & 255]), 0, &value, sizeof(value)));
+    }
+    state.items_processed = state.iterations;
+  }
+
+  /// \brief Writes while every write is traced, without a clock so only the cost of recording is measured
+  template<uint16_t N>
+  void dictionary_write_traced(bench::State& state)
+  {
+    auto&                          o = objects<N>();
+    static etrace::TRecorder<1024> recorder(*o.dictionary, nullptr);
+    recorder.start();
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      uint32_t value = static_cast<uint32_t>(i);
+      bench::do_not_optimize(o.dictionary->write(address_of(o.order.index[i & 255]), 0, &value, sizeof(value)));
+    }
+    recorder.stop();
+    state.items_processed = state.iterations;
+  }
+
+  /// \brief Visit the live objects by scanning the dictionary and testing the permissions of every object
+  template<uint16_t N>
+  void dictionary_scan_live(bench::State& state)
+  {
+    auto&    o   = objects<N>();
+    uint32_t sum = 0;
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      for (auto& item : *o.dictionary)
+      {
+        if ((eobject::permission_mask(item.object.info().perm) & eobject::View::Live) != 0) sum += item.address;
+      }
+      bench::do_not_optimize(sum);
+    }
+    state.items_processed = state.iterations * N;
+  }
+
+  /// \brief Visit the live objects through a view
+  template<uint16_t N>
+  void view_scan_live(bench::State& state)
+  {
+    auto&                          o = objects<N>();
+    static const eobject::TView<N> view(*o.dictionary, eobject::View::Live);
+    uint32_t                       sum = 0;
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      for (auto& item : view) sum += item.address;
+      bench::do_not_optimize(sum);
+    }
+    state.items_processed = state.iterations * N;
+  }
+
+  /// \brief Configuration objects with defaults, whose data and defaults are laid out in address order
+  template<uint16_t N>
+  struct Configuration
+  {
+    uint32_t          data[N];
+    uint32_t          defaults[N];
+    const void*       item_defaults[N];
+    Variable::Info    info[N];
+    const Dictionary* dictionary;
+
+    Configuration()
+    {
+      auto items = new estd::array<Dictionary::Item, N>;
+      for (uint16_t i = 0; i < N; ++i)
+      {
+        defaults[i]      = i;
+        item_defaults[i] = &defaults[i];
+        info[i]          = Variable::make_info<uint32_t>(Object::Permissions::UserConfig);
+        (*items)[i]      = Dictionary::Item{ static_cast<uint16_t>(0x2000 + i), 0, Object(names.view[i], &info[i], &data[i]) };
+      }
+      dictionary = new TDictionary<N>(std::move(*items), nullptr, item_defaults);
+      delete items;
+    }
+  };
+
+  template<uint16_t N>
+  Configuration<N>& configuration()
+  {
+    static Configuration<N> c;
+    return c;
+  }
+
+  /// \brief Restore defaults by setting every object from a table of defaults
+  template<uint16_t N>
+  void factory_reset_set(bench::State& state)
+  {
+    auto& c = configuration<N>();
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      const uint32_t* value = c.defaults;
+      for (auto& item : *c.dictionary) item.object.set(0, value++, sizeof(uint32_t));
+      bench::do_not_optimize(c.data);
+    }
+    state.items_processed = state.iterations * N;
+  }
+
+  /// \brief Restore defaults from the metadata, which copies contiguous objects together
+  template<uint16_t N>
+  void factory_reset(bench::State& state)
+  {
+    auto& c = configuration<N>();
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      bench::do_not_optimize(c.dictionary->reset(eobject::View::Persisted));
+      bench::do_not_optimize(c.data);
+    }
+    state.items_processed = state.iterations * N;
+  }
+
+  template<uint16_t N>
+  bool register_sized()
+  {
+    char name[48];
+    snprintf(name, sizeof(name), "name_index_find/%u", N);
+    bench::add(name, name_index_find<N>);
+    snprintf(name, sizeof(name), "value_index_find/%u", N);
+    bench::add(name, value_index_find<N>);
+    snprintf(name, sizeof(name), "dictionary_get/%u", N);
+    bench::add(name, dictionary_get<N>);
+    snprintf(name, sizeof(name), "compact_get/%u", N);
+    bench::add(name, compact_get<N>);
+    snprintf(name, sizeof(name), "dictionary_find/%u", N);
+    bench::add(name, dictionary_find<N>);
+    snprintf(name, sizeof(name), "dictionary_query/%u", N);
+    bench::add(name, dictionary_query<N>);
+    snprintf(name, sizeof(name), "dictionary_query_atoms/%u", N);
+    bench::add(name, dictionary_query_atoms<N>);
+    snprintf(name, sizeof(name), "dictionary_read/%u", N);
+    bench::add(name, dictionary_read<N>);
+    snprintf(name, sizeof(name), "compact_read/%u", N);
+    bench::add(name, compact_read<N>);
+    snprintf(name, sizeof(name), "dictionary_write/%u", N);
+    bench::add(name, dictionary_write<N>);
+    snprintf(name, sizeof(name), "dictionary_write_traced/%u", N);
+    bench::add(name, dictionary_write_traced<N>);
+    snprintf(name, sizeof(name), "dictionary_scan_live/%u", N);
+    bench::add(name, dictionary_scan_live<N>);
+    snprintf(name, sizeof(name), "view_scan_live/%u", N);
+    bench::add(name, view_scan_live<N>);
+    snprintf(name, sizeof(name), "factory_reset_set/%u", N);
+    bench::add(name, factory_reset_set<N>);
+    snprintf(name, sizeof(name), "factory_reset/%u", N);
+    bench::add(name, factory_reset<N>);
+    return true;
+  }
+
+  const bool registered = register_sized<8>() && register_sized<64>() && register_sized<512>()
+                          && register_sized<max_objects>();
+}
@@ -0,0 +1,100 @@
+/// \file bench_epatch.cpp
+/// \brief Benchmarks for comparing dictionaries of 1024 objects which differ in the number of values given as
+/// argument, and for applying the resulting patch
+
+#include "harness.hpp"
+
+#include <cstring>
+#include <string>
+
+#include "eio_buffer.hpp"
+#include "epatch.hpp"
+
+using eobject::Dictionary;
+using eobject::Object;
+using eobject::TDictionary;
+using eobject::Variable;
+
+namespace {
+
+  static const uint16_t object_count = 1024;
+
+  /// \brief Driver discarding output, or collecting it when asked
+  struct Sink final : eio::IODevice::Driver
+  {
+    std::string                  output;
+    bool                         collect = false;
+    eio::iobuffer<Sink, 256, 16> buffer{ *this };
+
+    int write(const void* data, uint16_t count) NOEXCEPT override
+    {
+      if (collect) output.append(static_cast<const char*>(data), count);
+      return count;
+    }
+    int          read(void*, uint16_t) NOEXCEPT override { return 0; }
+    int          sync(int timeout) NOEXCEPT override { return timeout; }
+    eio::buffer& getbuf() NOEXCEPT override { return buffer; }
+  };
+
+  struct Device
+  {
+    static constexpr Variable::Info info = Variable::make_info<uint32_t>(Object::Permissions::UserConfig);
+
+    uint32_t                   data[object_count] = {};
+    TDictionary<object_count>* dictionary;
+
+    Device()
+    {
+      auto items = new estd::array<Dictionary::Item, object_count>;
+      for (uint16_t i = 0; i < object_count; ++i)
+        (*items)[i] = Dictionary::Item{ static_cast<uint16_t>(0x2000 + i), 0, Object("value", &info, &data[i]) };
+      dictionary = new TDictionary<object_count>(std::move(*items));
+      delete items;
+    }
+  };
+
+  /// \brief Device with every value zero
+  Device& device()
+  {
+    static Device d;
+    memset(d.data, 0, sizeof(d.data));
+    return d;
+  }
+
+  /// \brief Reference with the given number of values changed, spread over the dictionary
+  Device& reference(uint32_t differences)
+  {
+    static Device d;
+    memset(d.data, 0, sizeof(d.data));
+    for (uint32_t i = 0; i < differences; ++i) d.data[i * object_count / differences] = i + 1;
+    return d;
+  }
+
+  void patch_diff(bench::State& state)
+  {
+    auto& a = device();
+    auto& b = reference(state.arg);
+    Sink  sink;
+    for (uint64_t i = 0; i < state.iterations; ++i)
+      bench::do_not_optimize(epatch::diff(sink.getbuf(), *a.dictionary, *b.dictionary));
+    state.items_processed = state.iterations * object_count;
+  }
+  BENCHMARK_ARGS(patch_diff, 0, 8, 64, 1024);
+
+  void patch_apply(bench::State& state)
+  {
+    auto& a = device();
+    auto& b = reference(state.arg);
+    Sink  sink;
+    sink.collect = true;
+    epatch::diff(sink.getbuf(), *a.dictionary, *b.dictionary);
+    sink.getbuf().sync(0);
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      estd::string_view in(sink.output.data(), static_cast<uint32_t>(sink.output.size()));
+      bench::do_not_optimize(epatch::apply(in, *a.dictionary));
+    }
+    state.items_processed = state.iterations * state.arg;
+  }
+  BENCHMARK_ARGS(patch_apply, 8, 64, 1024);
+}
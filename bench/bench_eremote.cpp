@@ -0,0 +1,85 @@
+/// \file bench_eremote.cpp
+/// \brief Benchmarks for reading a remote dictionary over a link of 1 MB/s with the one-way latency in microseconds
+/// given as argument, one value per round trip and with requests pipelined and coalesced. Throughput is of bytes
+/// received by the host, so it shows how much of the link is used
+
+#include "harness.hpp"
+
+#include <memory>
+
+#include "eremote_host.hpp"
+
+using eobject::Dictionary;
+using eobject::Object;
+using eobject::TDictionary;
+using eobject::Variable;
+
+namespace {
+
+  static const uint16_t objects               = 64;
+  static const uint32_t link_bytes_per_second = 1000000;
+
+  /// \brief Device with a dictionary of counters
+  struct Device
+  {
+    static constexpr Variable::Info info = Variable::make_info<uint32_t>(Object::Permissions::Dynamic);
+
+    uint32_t                              data[objects];
+    std::unique_ptr<TDictionary<objects>> dictionary;
+
+    Device()
+    {
+      estd::array<Dictionary::Item, objects> items;
+      for (uint16_t i = 0; i < objects; ++i)
+      {
+        data[i]  = i;
+        items[i] = Dictionary::Item{ static_cast<uint16_t>(0x2000 + i), 0, Object("counter", &info, &data[i]) };
+      }
+      dictionary.reset(new TDictionary<objects>(std::move(items)));
+    }
+  };
+
+  const Device& device()
+  {
+    static const Device d;
+    return d;
+  }
+
+  void remote_read_sequential(bench::State& state)
+  {
+    eremote::Loopback         link(*device().dictionary, std::chrono::microseconds(state.arg), link_bytes_per_second);
+    eremote::RemoteDictionary remote(link.device());
+    uint32_t                  values[objects];
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      for (uint16_t o = 0; o < objects; ++o) remote.read(0x2000 + o, 0, &values[o], sizeof(values[o]));
+      bench::do_not_optimize(values);
+    }
+    state.items_processed = state.iterations * objects;
+    state.bytes_processed = remote.stats().bytes_received;
+  }
+  BENCHMARK_ARGS(remote_read_sequential, 0, 1000);
+
+  /// \brief Read every value several times per flush, so the time to fill the link is a small part of the whole
+  void remote_read_pipelined(bench::State& state)
+  {
+    static const uint16_t passes = 16;
+
+    eremote::Loopback         link(*device().dictionary, std::chrono::microseconds(state.arg), link_bytes_per_second);
+    eremote::RemoteDictionary remote(link.device());
+    uint32_t                  values[passes][objects];
+    int32_t                   results[passes][objects];
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      for (uint16_t p = 0; p < passes; ++p)
+        for (uint16_t o = 0; o < objects; ++o)
+          remote.queue_read(0x2000 + o, 0, &values[p][o], sizeof(values[p][o]), &results[p][o]);
+      remote.flush();
+      bench::do_not_optimize(values);
+    }
+    state.items_processed = state.iterations * passes * objects;
+    state.bytes_processed = remote.stats().bytes_received;
+  }
+  BENCHMARK_ARGS(remote_read_pipelined, 0, 1000);
+
+}
@@ -0,0 +1,118 @@
+/// \file bench_esample.cpp
+/// \brief Benchmarks for sampling dictionary values each tick, and for reading captures out in bulk
+
+#include "harness.hpp"
+
+#include <cstdio>
+
+#include "esample.hpp"
+
+using eobject::Dictionary;
+using eobject::Object;
+using eobject::Variable;
+
+namespace {
+
+  static const uint16_t signal_count = 32;
+
+  uint8_t  values_u8[signal_count];
+  int16_t  values_i16[signal_count];
+  uint32_t values_u32[signal_count];
+
+  constexpr auto u8_info  = Variable::make_info<uint8_t>(Object::Permissions::Dynamic);
+  constexpr auto i16_info = Variable::make_info<int16_t>(Object::Permissions::Dynamic);
+  constexpr auto u32_info = Variable::make_info<uint32_t>(Object::Permissions::Dynamic);
+
+  /// \brief Dictionary of signals cycling through 1, 2 and 4 byte types
+  struct Objects
+  {
+    char              names[signal_count][16];
+    const Dictionary* dictionary;
+
+    Objects()
+    {
+      estd::array<Dictionary::Item, signal_count> items;
+      for (uint16_t i = 0; i < signal_count; ++i)
+      {
+        int n = snprintf(names[i], sizeof(names[i]), "signal_%02u", static_cast<unsigned>(i));
+        estd::string_view name(names[i], n);
+        switch (i % 3)
+        {
+          case 0: items[i] = Dictionary::Item{ i, 0, Object(name, &u8_info, &values_u8[i]) }; break;
+          case 1: items[i] = Dictionary::Item{ i, 0, Object(name, &i16_info, &values_i16[i]) }; break;
+          default: items[i] = Dictionary::Item{ i, 0, Object(name, &u32_info, &values_u32[i]) }; break;
+        }
+      }
+      dictionary = new eobject::TDictionary<signal_count>(items);
+    }
+  };
+
+  const Dictionary& dictionary()
+  {
+    static Objects o;
+    return *o.dictionary;
+  }
+
+  uint8_t storage[64 * 1024];
+
+  /// \brief Sampler with the first count signals, running continuously
+  esample::Sampler& sampler(uint32_t count, esample::Condition condition)
+  {
+    static esample::Sampler s(storage, sizeof(storage), dictionary());
+    s.clear();
+    for (uint16_t i = 0; i < count; ++i) s.add(i, 0);
+    s.trigger(0, condition, 1000);
+    s.start(0, 1, 1000);
+    return s;
+  }
+
+  void sampler_tick(bench::State& state)
+  {
+    auto& s = sampler(state.arg, esample::Condition::Never);
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      values_i16[1] = static_cast<int16_t>(i);
+      s.tick();
+      bench::clobber_memory();
+    }
+    state.items_processed = state.iterations;
+  }
+  BENCHMARK_ARGS(sampler_tick, 1, 8, 32);
+
+  /// \brief Ticks while armed, testing a trigger condition which is never met
+  void sampler_tick_armed(bench::State& state)
+  {
+    auto& s = sampler(state.arg, esample::Condition::Rising);
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      values_u8[0] = static_cast<uint8_t>(i & 0x7F);
+      s.tick();
+      bench::clobber_memory();
+    }
+    state.items_processed = state.iterations;
+  }
+  BENCHMARK_ARGS(sampler_tick_armed, 32);
+
+  /// \brief Read a full capture of 32 signals in 256 byte pieces, as it would be streamed out
+  void sampler_read(bench::State& state)
+  {
+    auto& s = sampler(signal_count, esample::Condition::Never);
+    for (uint32_t i = 0; i < s.depth(); ++i) s.tick();
+    s.stop();
+
+    uint8_t  out[256];
+    uint64_t bytes = 0;
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      size_t offset = 0;
+      while (size_t n = s.read(offset, out, sizeof(out)))
+      {
+        bench::do_not_optimize(out);
+        offset += n;
+      }
+      bytes += offset;
+    }
+    state.bytes_processed = bytes;
+  }
+  BENCHMARK(sampler_read);
+}
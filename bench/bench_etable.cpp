@@ -0,0 +1,82 @@
+/// \file bench_etable.cpp
+/// \brief Benchmarks for interpolated lookup in calibration maps, as done once per control loop cycle
+
+#include "harness.hpp"
+
+#include "etable.hpp"
+
+namespace {
+
+  int16_t speed_axis[16];
+  int16_t map2[16][16];
+  int32_t map3[8][8][8];
+
+  /// \brief Fill axis and maps once, with an uneven speed axis as calibration maps usually have
+  void fill()
+  {
+    static bool filled = false;
+    if (filled) return;
+    for (int i = 0; i < 16; ++i) speed_axis[i] = static_cast<int16_t>(i * i * 40);
+    uint32_t x = 1;
+    for (auto& row : map2)
+      for (auto& v : row) v = static_cast<int16_t>((x = x * 1103515245u + 12345u) >> 20);
+    for (auto& plane : map3)
+      for (auto& row : plane)
+        for (auto& v : row) v = static_cast<int32_t>((x = x * 1103515245u + 12345u) >> 12);
+    filled = true;
+  }
+
+  /// \brief Input sweeping over the axis, so lookups do not all take the same branches
+  int16_t input(uint64_t i) { return static_cast<int16_t>((i * 2654435761u) % 9600); }
+
+  /// \brief Locate a value on an axis of 16 uneven breakpoints by binary search
+  void locate(bench::State& state)
+  {
+    fill();
+    for (uint64_t i = 0; i < state.iterations; ++i)
+      bench::do_not_optimize(etable::locate<int16_t>(speed_axis, 16, input(i)));
+    state.items_processed = state.iterations;
+  }
+  BENCHMARK(locate);
+
+  /// \brief Locate a value on an axis of 16 evenly spaced breakpoints, by division
+  void locate_uniform(bench::State& state)
+  {
+    for (uint64_t i = 0; i < state.iterations; ++i)
+      bench::do_not_optimize(etable::locate_uniform(0, 640, 16, input(i)));
+    state.items_processed = state.iterations;
+  }
+  BENCHMARK(locate_uniform);
+
+  /// \brief Bilinear lookup in a 16x16 map, with both axes located
+  void interpolate_2d(bench::State& state)
+  {
+    fill();
+    estd::mdspan<const int16_t, 2> table(map2);
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      auto x = etable::locate<int16_t>(speed_axis, 16, input(i));
+      auto y = etable::locate_uniform(0, 640, 16, input(i + 7));
+      bench::do_not_optimize(etable::interpolate(table, x, y));
+    }
+    state.items_processed = state.iterations;
+  }
+  BENCHMARK(interpolate_2d);
+
+  /// \brief Trilinear lookup in an 8x8x8 map, with all axes located
+  void interpolate_3d(bench::State& state)
+  {
+    fill();
+    estd::mdspan<const int32_t, 3> table(map3);
+    for (uint64_t i = 0; i < state.iterations; ++i)
+    {
+      auto x = etable::locate_uniform(0, 1300, 8, input(i));
+      auto y = etable::locate_uniform(0, 1300, 8, input(i + 7));
+      auto z = etable::locate_uniform(0, 1300, 8, input(i + 13));
+      bench::do_not_optimize(etable::interpolate(table, x, y, z));
+    }
+    state.items_processed = state.iterations;
+  }
+  BENCHMARK(interpolate_3d);
+
+}
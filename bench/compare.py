@@ -0,0 +1,51 @@
+#!/usr/bin/env python3
+"""Compare two estd_bench JSON results, e.g. from a baseline commit and a candidate commit.
+
+Usage: compare.py <baseline.json> <candidate.json> [--threshold=<percent>]
+
+Prints the change in real time per iteration for every benchmark present in both files. Exits with status 1 if any
+benchmark is slower than the threshold (default 5%), so it can be used as a regression gate.
+"""
+
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        data = json.load(f)
+    return {b["name"]: b for b in data["benchmarks"] if b.get("run_type", "iteration") == "iteration"}
+
+
+def main(argv):
+    threshold = 5.0
+    paths = []
+    for arg in argv[1:]:
+        if arg.startswith("--threshold="):
+            threshold = float(arg.split("=", 1)[1])
+        else:
+            paths.append(arg)
+    if len(paths) != 2:
+        print(__doc__, file=sys.stderr)
+        return 2
+
+    baseline, candidate = load(paths[0]), load(paths[1])
+    regressions = 0
+    print("%-40s %12s %12s %9s" % ("benchmark", "baseline ns", "candidate ns", "change"))
+    for name, base in baseline.items():
+        if name not in candidate:
+            continue
+        old, new = base["real_time"], candidate[name]["real_time"]
+        change = 100.0 * (new - old) / old if old > 0 else 0.0
+        flag = ""
+        if change > threshold:
+            flag = "  slower"
+            regressions += 1
+        elif change < -threshold:
+            flag = "  faster"
+        print("%-40s %12.2f %12.2f %+8.1f%%%s" % (name, old, new, change, flag))
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
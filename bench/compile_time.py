@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+"""Measure the time and memory taken to compile object dictionaries of increasing size.
+
+Usage: compile_time.py --compiler=<c++> [--flags=<flags>] [--counts=10,100,...] [--filter=<substring>]
+                       [--format=json|console] [--out=<file>]
+
+Each benchmark generates a translation unit with the given number of objects and compiles it once:
+
+  dictionary/<n>  TDictionary of n variables, listed in scrambled address order so the constructor has to sort them
+  fieldlist/<n>   n record fields, in records of up to 100 fields built with Record::fields() chains
+  schema/<n>      the same records, written as flat tables by tools/eobject_gen.py
+
+JSON output has the layout of estd_bench, with the compile time as real_time, so compare.py can compare two runs.
+"""
+
+import json
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+RECORD_FIELDS = 100
+
+
+def address_of(i):
+    """Spread addresses over the 16-bit range in a scrambled order, as bench_eobject.cpp does"""
+    return (i * 7919) & 0xFFFF
+
+
+def dictionary_source(n):
+    lines = ['#include "eobject.hpp"', "",
+             "using eobject::Dictionary;", "using eobject::Object;", "using eobject::Variable;", "",
+             "uint32_t values[%d];" % n,
+             "constexpr auto info = Variable::make_info<uint32_t, 0, 1000>(Object::Permissions::UserConfig);", "",
+             "extern const eobject::TDictionary<%d> dictionary;" % n,
+             "constexpr eobject::TDictionary<%d> dictionary(estd::array<Dictionary::Item, %d>{" % (n, n)]
+    lines += ['  Dictionary::Item{ 0x%04X, 0, Object("object_%04d", &info, &values[%d]) },' % (address_of(i), i, i)
+              for i in range(n)]
+    lines += ["});"]
+    return "\n".join(lines) + "\n"
+
+
+def records(n):
+    """Split n fields into records of up to RECORD_FIELDS fields"""
+    return [min(RECORD_FIELDS, n - start) for start in range(0, n, RECORD_FIELDS)]
+
+
+def fieldlist_source(n):
+    lines = ["#include <cstddef>", '#include "eobject.hpp"', "",
+             "using eobject::Object;", "using eobject::Record;"]
+    for r, count in enumerate(records(n)):
+        lines += ["", "struct Record%d" % r, "{"]
+        lines += ["  uint32_t f%d;" % i for i in range(count)]
+        lines += ["};", "Record%d record%d;" % (r, r),
+                  "constexpr auto record%d_info = Record::make_info(" % r,
+                  "  Object::Permissions::UserConfig,", "  Record::fields()"]
+        lines += ['    .field<Record{0}, uint32_t, &Record{0}::f{1}, offsetof(Record{0}, f{1}), 0, {2}>('
+                  'Object::Permissions::UserConfig, "f{1}")'.format(r, i, 1000 + i) for i in range(count)]
+        lines += [");", 'const Object object%d("record%d", &record%d_info, &record%d);' % (r, r, r, r)]
+    return "\n".join(lines) + "\n"
+
+
+def schema(n):
+    objects = []
+    for r, count in enumerate(records(n)):
+        fields = [{"name": "f%d" % i, "type": "u32", "min": 0, "max": 1000 + i} for i in range(count)]
+        objects.append({"name": "record%d" % r, "address": r + 1, "record": "Record%d" % r, "fields": fields})
+    return {"namespace": "bench", "objects": objects}
+
+
+def compile_once(compiler, flags, source, includes):
+    """Compile source, returning wall time in seconds and peak memory of the compiler in bytes"""
+    command = [compiler] + flags + ["-I" + i for i in includes] + ["-c", source, "-o", os.devnull]
+    start = time.perf_counter()
+    process = subprocess.Popen(command)
+    _, status, usage = os.wait4(process.pid, 0)
+    elapsed = time.perf_counter() - start
+    process.returncode = os.waitstatus_to_exitcode(status)
+    if process.returncode != 0:
+        raise RuntimeError("compiling %s failed" % source)
+    # ru_maxrss is in kilobytes on Linux, and bytes on macOS
+    return elapsed, usage.ru_maxrss * (1 if sys.platform == "darwin" else 1024)
+
+
+def run(name, n, compiler, flags, work):
+    kind = name.split("/")[0]
+    path = os.path.join(work, "%s_%d.cpp" % (kind, n))
+    includes = [ROOT]
+    if kind == "dictionary":
+        text = dictionary_source(n)
+    elif kind == "fieldlist":
+        text = fieldlist_source(n)
+    else:
+        stem = os.path.join(work, "schema_%d" % n)
+        with open(stem + ".json", "w") as f:
+            json.dump(schema(n), f)
+        subprocess.check_call([sys.executable, os.path.join(ROOT, "tools", "eobject_gen.py"), stem + ".json", stem])
+        path = stem + ".cpp"
+        includes.append(work)
+        text = None
+    if text is not None:
+        with open(path, "w") as f:
+            f.write(text)
+    return compile_once(compiler, flags, path, includes)
+
+
+def main(argv):
+    compiler, flags, counts = None, ["-std=c++17", "-O2", "-fno-exceptions", "-fno-rtti"], [10, 100, 1000, 5000]
+    name_filter, output_format, out_path = "", "json", None
+    for arg in argv[1:]:
+        key, _, value = arg.partition("=")
+        if key == "--compiler":
+            compiler = value
+        elif key == "--flags":
+            flags = value.split()
+        elif key == "--counts":
+            counts = [int(c) for c in value.split(",")]
+        elif key == "--filter":
+            name_filter = value
+        elif key == "--format" and value in ("json", "console"):
+            output_format = value
+        elif key == "--out":
+            out_path = value
+        else:
+            print(__doc__, file=sys.stderr)
+            return 2
+    if compiler is None:
+        print(__doc__, file=sys.stderr)
+        return 2
+
+    results = []
+    with tempfile.TemporaryDirectory() as work:
+        for kind in ("dictionary", "fieldlist", "schema"):
+            for n in counts:
+                name = "%s/%d" % (kind, n)
+                if name_filter not in name:
+                    continue
+                seconds, memory = run(name, n, compiler, flags, work)
+                results.append({"name": name, "run_name": name, "run_type": "iteration", "iterations": 1,
+                                "real_time": seconds * 1e9, "cpu_time": seconds * 1e9, "time_unit": "ns",
+                                "items_per_second": n / seconds, "peak_memory_bytes": memory})
+                if output_format == "console":
+                    print("%-40s %10.2f s %10.1f MB %12.0f objects/s" % (name, seconds, memory / 1e6, n / seconds),
+                          flush=True)
+
+    if output_format == "json":
+        text = json.dumps({"context": {"date": time.strftime("%Y-%m-%dT%H:%M:%S"), "compiler": compiler,
+                                       "flags": " ".join(flags)},
+                           "benchmarks": results}, indent=2) + "\n"
+        if out_path:
+            with open(out_path, "w") as f:
+                f.write(text)
+        else:
+            sys.stdout.write(text)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
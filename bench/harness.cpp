@@ -0,0 +1,225 @@
+/// \file harness.cpp
+/// \brief Benchmark runner, timing and result output
+
+#include "harness.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#ifndef ESTD_BENCH_REVISION
+#define ESTD_BENCH_REVISION "unknown"
+#endif
+
+#ifndef ESTD_BENCH_BUILD_TYPE
+#define ESTD_BENCH_BUILD_TYPE "unknown"
+#endif
+
+namespace {
+
+  struct Entry
+  {
+    std::string     name;
+    bench::Function function;
+    uint32_t        arg;
+  };
+
+  struct Result
+  {
+    std::string name;
+    uint64_t    iterations;
+    double      real_time; ///< Nanoseconds per iteration
+    double      cpu_time;  ///< Nanoseconds per iteration
+    double      bytes_per_second;
+    double      items_per_second;
+  };
+
+  enum class Format { Json, Csv, Console };
+
+  struct Config
+  {
+    const char* filter      = nullptr;
+    const char* out         = nullptr;
+    double      min_time    = 0.1;
+    unsigned    repetitions = 3;
+    Format      format      = Format::Json;
+  };
+
+  std::vector<Entry>& registry()
+  {
+    static std::vector<Entry> entries;
+    return entries;
+  }
+
+  typedef std::chrono::steady_clock clock_type;
+
+  struct Sample
+  {
+    double real_ns;
+    double cpu_ns;
+  };
+
+  Sample run_once(const Entry& entry, bench::State& state)
+  {
+    state.bytes_processed = 0;
+    state.items_processed = 0;
+    std::clock_t cpu_start  = std::clock();
+    auto         real_start = clock_type::now();
+    entry.function(state);
+    auto         real_end = clock_type::now();
+    std::clock_t cpu_end  = std::clock();
+
+    Sample s;
+    s.real_ns = std::chrono::duration<double, std::nano>(real_end - real_start).count();
+    s.cpu_ns  = 1e9 * double(cpu_end - cpu_start) / CLOCKS_PER_SEC;
+    return s;
+  }
+
+  /// \brief Run a benchmark, scaling up iterations until it runs for at least min_time, and report the median
+  Result run(const Entry& entry, const Config& config)
+  {
+    bench::State state = { 1, 0, 0, entry.arg };
+    double const min_ns = config.min_time * 1e9;
+
+    Sample s = run_once(entry, state);
+    while (s.real_ns < min_ns && state.iterations < (uint64_t(1) << 40))
+    {
+      // Aim slightly past the target, but never grow by more than 10x per step
+      double   scale = s.real_ns > 0 ? 1.4 * min_ns / s.real_ns : 10.0;
+      uint64_t next  = uint64_t(double(state.iterations) * std::min(10.0, std::max(scale, 2.0)));
+      state.iterations = next;
+      s = run_once(entry, state);
+    }
+
+    std::vector<Sample> samples{ s };
+    for (unsigned i = 1; i < config.repetitions; ++i) samples.push_back(run_once(entry, state));
+
+    std::sort(samples.begin(), samples.end(), [](const Sample& l, const Sample& r) { return l.real_ns < r.real_ns; });
+    const Sample& median = samples[samples.size() / 2];
+
+    Result r;
+    r.name             = entry.name;
+    r.iterations       = state.iterations;
+    r.real_time        = median.real_ns / double(state.iterations);
+    r.cpu_time         = median.cpu_ns / double(state.iterations);
+    r.bytes_per_second = state.bytes_processed * 1e9 / median.real_ns;
+    r.items_per_second = state.items_processed * 1e9 / median.real_ns;
+    return r;
+  }
+
+  void print_json(FILE* out, const std::vector<Result>& results)
+  {
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    std::fprintf(out, "{\n  \"context\": {\n");
+    std::fprintf(out, "    \"date\": \"%s\",\n", date);
+    std::fprintf(out, "    \"library_revision\": \"%s\",\n", ESTD_BENCH_REVISION);
+    std::fprintf(out, "    \"library_build_type\": \"%s\"\n", ESTD_BENCH_BUILD_TYPE);
+    std::fprintf(out, "  },\n  \"benchmarks\": [");
+    const char* sep = "\n";
+    for (const auto& r : results)
+    {
+      std::fprintf(out, "%s    {\n", sep);
+      std::fprintf(out, "      \"name\": \"%s\",\n      \"run_name\": \"%s\",\n      \"run_type\": \"iteration\",\n",
+                   r.name.c_str(), r.name.c_str());
+      std::fprintf(out, "      \"iterations\": %llu,\n", static_cast<unsigned long long>(r.iterations));
+      std::fprintf(out, "      \"real_time\": %.4f,\n      \"cpu_time\": %.4f,\n      \"time_unit\": \"ns\"",
+                   r.real_time, r.cpu_time);
+      if (r.bytes_per_second > 0) std::fprintf(out, ",\n      \"bytes_per_second\": %.1f", r.bytes_per_second);
+      if (r.items_per_second > 0) std::fprintf(out, ",\n      \"items_per_second\": %.1f", r.items_per_second);
+      std::fprintf(out, "\n    }");
+      sep = ",\n";
+    }
+    std::fprintf(out, "\n  ]\n}\n");
+  }
+
+  void print_csv(FILE* out, const std::vector<Result>& results)
+  {
+    std::fprintf(out, "name,iterations,real_time,cpu_time,time_unit,bytes_per_second,items_per_second\n");
+    for (const auto& r : results)
+    {
+      std::fprintf(out, "\"%s\",%llu,%.4f,%.4f,ns,%.1f,%.1f\n", r.name.c_str(),
+                   static_cast<unsigned long long>(r.iterations), r.real_time, r.cpu_time, r.bytes_per_second,
+                   r.items_per_second);
+    }
+  }
+
+  void print_console(FILE* out, const Result& r)
+  {
+    std::fprintf(out, "%-40s %12.2f ns %12llu", r.name.c_str(), r.real_time,
+                 static_cast<unsigned long long>(r.iterations));
+    if (r.bytes_per_second > 0) std::fprintf(out, "  %10.2f MB/s", r.bytes_per_second / 1e6);
+    if (r.items_per_second > 0) std::fprintf(out, "  %10.2f M/s", r.items_per_second / 1e6);
+    std::fprintf(out, "\n");
+  }
+
+  bool parse_args(int argc, char** argv, Config& config)
+  {
+    for (int i = 1; i < argc; ++i)
+    {
+      const char* arg = argv[i];
+      if (std::strncmp(arg, "--filter=", 9) == 0) config.filter = arg + 9;
+      else if (std::strncmp(arg, "--out=", 6) == 0) config.out = arg + 6;
+      else if (std::strncmp(arg, "--min-time=", 11) == 0) config.min_time = std::atof(arg + 11);
+      else if (std::strncmp(arg, "--repetitions=", 14) == 0) config.repetitions = std::max(1, std::atoi(arg + 14));
+      else if (std::strcmp(arg, "--format=json") == 0) config.format = Format::Json;
+      else if (std::strcmp(arg, "--format=csv") == 0) config.format = Format::Csv;
+      else if (std::strcmp(arg, "--format=console") == 0) config.format = Format::Console;
+      else
+      {
+        std::fprintf(stderr,
+                     "Usage: %s [--filter=<substring>] [--format=json|csv|console] [--out=<file>]\n"
+                     "          [--min-time=<seconds>] [--repetitions=<n>]\n",
+                     argv[0]);
+        return false;
+      }
+    }
+    return true;
+  }
+}
+
+namespace bench {
+
+  bool add(const char* name, Function f, const uint32_t* args, size_t nargs)
+  {
+    if (nargs == 0) registry().push_back(Entry{ name, f, 0 });
+    for (size_t i = 0; i < nargs; ++i)
+    {
+      registry().push_back(Entry{ std::string(name) + "/" + std::to_string(args[i]), f, args[i] });
+    }
+    return true;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  Config config;
+  if (false == parse_args(argc, argv, config)) return 2;
+
+  FILE* out = stdout;
+  if (config.out != nullptr && (out = std::fopen(config.out, "w")) == nullptr)
+  {
+    std::perror(config.out);
+    return 1;
+  }
+
+  std::vector<Result> results;
+  for (const auto& entry : registry())
+  {
+    if (config.filter != nullptr && entry.name.find(config.filter) == std::string::npos) continue;
+    results.push_back(run(entry, config));
+    if (config.format == Format::Console) print_console(out, results.back());
+  }
+
+  if (config.format == Format::Json) print_json(out, results);
+  else if (config.format == Format::Csv) print_csv(out, results);
+
+  if (out != stdout) std::fclose(out);
+  return 0;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+/// \file harness.hpp
+/// Minimal self-contained benchmark harness for host builds.
+/// Results are written in the JSON layout used by Google Benchmark, so runs from different commits can be compared
+/// with bench/compare.py (or Google Benchmark's own compare.py)
+
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+namespace bench {
+
+  /// \brief State passed to each benchmark, which controls how many times the measured loop runs
+  struct State
+  {
+    /// \brief Number of iterations to run in the measured loop
+    uint64_t iterations;
+    /// \brief Total bytes processed by the measured loop, used to report throughput (0 to omit)
+    uint64_t bytes_processed;
+    /// \brief Total items processed by the measured loop, used to report rate (0 to omit)
+    uint64_t items_processed;
+    /// \brief Argument selected for this run (e.g. table size), or 0
+    uint32_t arg;
+  };
+
+  typedef void (*Function)(State& state);
+
+  /// \brief Register a benchmark function
+  /// \param name Base name of the benchmark
+  /// \param f    Function to run, which must run its measured loop state.iterations times
+  /// \param args Optional list of arguments, each of which is run as a separate benchmark named "name/arg"
+  /// \param nargs Number of arguments
+  bool add(const char* name, Function f, const uint32_t* args = nullptr, size_t nargs = 0);
+
+  /// \brief Prevent the compiler from optimizing away a value
+  template<class T>
+  inline void do_not_optimize(const T& value)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+  }
+
+  /// \brief Prevent the compiler from caching memory contents across this point
+  inline void clobber_memory()
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#endif
+  }
+}
+
+#define BENCH_CONCAT_(A, B) A##B
+#define BENCH_CONCAT(A, B)  BENCH_CONCAT_(A, B)
+
+/// \brief Register a benchmark function at static initialization time
+#define BENCHMARK(FUNCTION) \
+  static const bool BENCH_CONCAT(bench_registered_, __LINE__) = ::bench::add(#FUNCTION, FUNCTION)
+
+/// \brief Register a benchmark function, to be run once for each of the listed arguments
+#define BENCHMARK_ARGS(FUNCTION, ...)                                                         \
+  static const uint32_t BENCH_CONCAT(bench_args_, __LINE__)[] = { __VA_ARGS__ };             \
+  static const bool     BENCH_CONCAT(bench_registered_, __LINE__) = ::bench::add(             \
+    #FUNCTION, FUNCTION, BENCH_CONCAT(bench_args_, __LINE__),                                 \
+    sizeof(BENCH_CONCAT(bench_args_, __LINE__)) / sizeof(BENCH_CONCAT(bench_args_, __LINE__)[0]))
@@ -0,0 +1,253 @@
+#pragma once
+
+/// \file bit.hpp
+/// Bit manipulation functions similar to C++20 <bit>, usable in constant expressions.
+/// GCC and Clang builtins are constexpr and compile to the native instructions (LZCNT/BSR/TZCNT/POPCNT on x86,
+/// CLZ/RBIT/REV on ARM). Other compilers use their intrinsics at runtime where constant evaluation can be detected,
+/// and portable constexpr fallbacks otherwise
+
+#include <cstdint>
+#include <type_traits>
+#include <limits>
+
+#include "estd.hpp"
+
+#if defined(__ICCARM__)
+#include <intrinsics.h> // __CLZ, __RBIT, __REV, __REV16
+#elif defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+/// \brief Compiler builtins can be used directly in constant expressions
+#define ESTD_CONSTEXPR_BUILTINS 1
+#elif defined(__cpp_lib_is_constant_evaluated)
+/// \brief Compiler intrinsics may be used when not evaluating a constant expression
+#define ESTD_IS_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#endif
+
+namespace estd {
+
+namespace detail {
+
+  template<class T>
+  struct is_bit_type
+    : std::integral_constant<bool, std::is_unsigned<T>::value && !std::is_same<T, bool>::value && sizeof(T) <= 8>
+  {};
+
+  /// \brief Portable count of leading zeroes, by binary search
+  template<class T>
+  constexpr int countl_zero_fallback(T value) NOEXCEPT
+  {
+    constexpr int digits = std::numeric_limits<T>::digits;
+    if(value == 0) return digits;
+    int count = 0;
+    for(int shift = digits / 2; shift > 0; shift /= 2)
+    {
+      if((value >> (digits - shift)) == 0)
+      {
+        count += shift;
+        value = static_cast<T>(value << shift);
+      }
+    }
+    return count;
+  }
+
+  /// \brief Portable count of trailing zeroes
+  template<class T>
+  constexpr int countr_zero_fallback(T value) NOEXCEPT
+  {
+    if(value == 0) return std::numeric_limits<T>::digits;
+    int count = 0;
+    while((value & 1U) == 0)
+    {
+      value >>= 1;
+      ++count;
+    }
+    return count;
+  }
+
+  /// \brief Portable population count, using parallel bit summing
+  constexpr int popcount_fallback(uint64_t value) NOEXCEPT
+  {
+    value = value - ((value >> 1) & 0x5555555555555555ULL);
+    value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+    value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<int>((value * 0x0101010101010101ULL) >> 56);
+  }
+
+  /// \brief Portable byte swap
+  template<class T>
+  constexpr T byteswap_fallback(T value) NOEXCEPT
+  {
+    T result = 0;
+    for(unsigned i = 0; i < sizeof(T); ++i)
+    {
+      result = static_cast<T>((result << 8) | (value & 0xFFU));
+      value  = static_cast<T>(value >> 8);
+    }
+    return result;
+  }
+
+  constexpr int clz32(uint32_t value) NOEXCEPT
+  {
+#if defined(ESTD_CONSTEXPR_BUILTINS)
+    return value == 0 ? 32 : __builtin_clz(value);
+#elif defined(ESTD_IS_CONSTANT_EVALUATED) && defined(__ICCARM__)
+    return ESTD_IS_CONSTANT_EVALUATED() ? countl_zero_fallback(value) : static_cast<int>(__CLZ(value));
+#elif defined(ESTD_IS_CONSTANT_EVALUATED) && defined(_MSC_VER)
+    if(ESTD_IS_CONSTANT_EVALUATED() || value == 0) return countl_zero_fallback(value);
+    unsigned long index = 0;
+    _BitScanReverse(&index, value);
+    return 31 - static_cast<int>(index);
+#else
+    return countl_zero_fallback(value);
+#endif
+  }
+
+  constexpr int clz64(uint64_t value) NOEXCEPT
+  {
+#if defined(ESTD_CONSTEXPR_BUILTINS)
+    return value == 0 ? 64 : __builtin_clzll(value);
+#else
+    return (value >> 32) != 0 ? clz32(static_cast<uint32_t>(value >> 32))
+                              : 32 + clz32(static_cast<uint32_t>(value));
+#endif
+  }
+
+  constexpr int ctz32(uint32_t value) NOEXCEPT
+  {
+#if defined(ESTD_CONSTEXPR_BUILTINS)
+    return value == 0 ? 32 : __builtin_ctz(value);
+#elif defined(ESTD_IS_CONSTANT_EVALUATED) && defined(__ICCARM__)
+    // ARM has no count trailing zeroes instruction: reverse the bits and count leading zeroes instead
+    return ESTD_IS_CONSTANT_EVALUATED() ? countr_zero_fallback(value) : static_cast<int>(__CLZ(__RBIT(value)));
+#elif defined(ESTD_IS_CONSTANT_EVALUATED) && defined(_MSC_VER)
+    if(ESTD_IS_CONSTANT_EVALUATED() || value == 0) return countr_zero_fallback(value);
+    unsigned long index = 0;
+    _BitScanForward(&index, value);
+    return static_cast<int>(index);
+#else
+    return countr_zero_fallback(value);
+#endif
+  }
+
+  constexpr int ctz64(uint64_t value) NOEXCEPT
+  {
+#if defined(ESTD_CONSTEXPR_BUILTINS)
+    return value == 0 ? 64 : __builtin_ctzll(value);
+#else
+    return static_cast<uint32_t>(value) != 0 ? ctz32(static_cast<uint32_t>(value))
+                                             : 32 + ctz32(static_cast<uint32_t>(value >> 32));
+#endif
+  }
+
+  constexpr int popcount64(uint64_t value) NOEXCEPT
+  {
+#if defined(ESTD_CONSTEXPR_BUILTINS)
+    return __builtin_popcountll(value);
+#else
+    return popcount_fallback(value);
+#endif
+  }
+
+  constexpr uint16_t bswap16(uint16_t value) NOEXCEPT
+  {
+#if defined(ESTD_CONSTEXPR_BUILTINS)
+    return __builtin_bswap16(value);
+#elif defined(ESTD_IS_CONSTANT_EVALUATED) && defined(__ICCARM__)
+    return ESTD_IS_CONSTANT_EVALUATED() ? byteswap_fallback(value) : static_cast<uint16_t>(__REV16(value));
+#else
+    return byteswap_fallback(value);
+#endif
+  }
+
+  constexpr uint32_t bswap32(uint32_t value) NOEXCEPT
+  {
+#if defined(ESTD_CONSTEXPR_BUILTINS)
+    return __builtin_bswap32(value);
+#elif defined(ESTD_IS_CONSTANT_EVALUATED) && defined(__ICCARM__)
+    return ESTD_IS_CONSTANT_EVALUATED() ? byteswap_fallback(value) : static_cast<uint32_t>(__REV(value));
+#else
+    return byteswap_fallback(value);
+#endif
+  }
+
+  constexpr uint64_t bswap64(uint64_t value) NOEXCEPT
+  {
+#if defined(ESTD_CONSTEXPR_BUILTINS)
+    return __builtin_bswap64(value);
+#else
+    return (uint64_t(bswap32(static_cast<uint32_t>(value))) << 32) | bswap32(static_cast<uint32_t>(value >> 32));
+#endif
+  }
+}
+
+/// \brief Count consecutive zero bits, starting from the most significant bit
+/// \returns Number of zero bits, or the width of T if value is 0
+template<class T>
+constexpr int countl_zero(T value) NOEXCEPT
+{
+  static_assert(detail::is_bit_type<T>::value, "countl_zero requires an unsigned integer type");
+  return sizeof(T) <= 4 ? detail::clz32(static_cast<uint32_t>(value)) - (32 - std::numeric_limits<T>::digits)
+                        : detail::clz64(static_cast<uint64_t>(value));
+}
+
+/// \brief Count consecutive zero bits, starting from the least significant bit
+/// \returns Number of zero bits, or the width of T if value is 0
+template<class T>
+constexpr int countr_zero(T value) NOEXCEPT
+{
+  static_assert(detail::is_bit_type<T>::value, "countr_zero requires an unsigned integer type");
+  return value == 0 ? std::numeric_limits<T>::digits
+         : sizeof(T) <= 4 ? detail::ctz32(static_cast<uint32_t>(value))
+                          : detail::ctz64(static_cast<uint64_t>(value));
+}
+
+/// \brief Count the number of bits set in value
+template<class T>
+constexpr int popcount(T value) NOEXCEPT
+{
+  static_assert(detail::is_bit_type<T>::value, "popcount requires an unsigned integer type");
+  return detail::popcount64(static_cast<uint64_t>(value));
+}
+
+/// \brief Get the number of bits needed to represent value (0 for 0)
+template<class T>
+constexpr int bit_width(T value) NOEXCEPT
+{
+  static_assert(detail::is_bit_type<T>::value, "bit_width requires an unsigned integer type");
+  return std::numeric_limits<T>::digits - countl_zero(value);
+}
+
+/// \brief Check if value is a power of two
+template<class T>
+constexpr bool has_single_bit(T value) NOEXCEPT
+{
+  static_assert(detail::is_bit_type<T>::value, "has_single_bit requires an unsigned integer type");
+  return value != 0 && (value & (value - 1)) == 0;
+}
+
+/// \brief Reverse the order of bytes in value, similar to C++23 std::byteswap
+template<class T>
+constexpr T byteswap(T value) NOEXCEPT
+{
+  static_assert(std::is_integral<T>::value && sizeof(T) <= 8, "byteswap requires an integer type");
+  typedef std::make_unsigned_t<T> U;
+  return static_cast<T>(sizeof(T) == 1   ? static_cast<U>(value)
+                        : sizeof(T) == 2 ? detail::bswap16(static_cast<uint16_t>(value))
+                        : sizeof(T) == 4 ? detail::bswap32(static_cast<uint32_t>(value))
+                                         : detail::bswap64(static_cast<uint64_t>(value)));
+}
+
+static_assert(countl_zero(uint32_t(1)) == 31 && countl_zero(uint8_t(1)) == 7 && countl_zero(uint64_t(0)) == 64,
+              "countl_zero is not usable in constant expressions");
+static_assert(detail::countl_zero_fallback(uint32_t(0x00F00000)) == 8 && detail::countl_zero_fallback(uint16_t(1)) == 15,
+              "countl_zero fallback is incorrect");
+static_assert(countr_zero(uint32_t(0x100)) == 8 && countr_zero(uint16_t(0)) == 16, "countr_zero is incorrect");
+static_assert(popcount(uint32_t(0xF0F0)) == 8 && detail::popcount_fallback(0xFFULL << 40) == 8, "popcount is incorrect");
+static_assert(bit_width(uint32_t(0)) == 0 && bit_width(uint32_t(255)) == 8, "bit_width is incorrect");
+static_assert(byteswap(uint32_t(0x12345678)) == 0x78563412 && detail::byteswap_fallback(uint16_t(0x1234)) == 0x3412,
+              "byteswap is incorrect");
+
+}
@@ -2,11 +2,14 @@
 
 #include "eobject.hpp"
 
+#include <limits>
+
 using eobject::Error;
 using eobject::DataType;
 using eobject::Object;
 using eobject::Record;
 using eobject::Array;
+using eobject::Table;
 using eobject::Variable;
 
 namespace {
@@ -16,7 +19,7 @@ eformat::stream& print_object_not_found(eformat::stream& so, const estd::string_
   return so << "Object " << object_name << " not found";
 }
 
-eformat::stream& operator<<(eformat::stream so, std::nullptr_t)
+eformat::stream& operator<<(eformat::stream& so, std::nullptr_t)
 {
   return so << "null";
 }
@@ -36,6 +39,16 @@ eformat::stream& operator<<(eformat::stream& so, Object::ClassId type)
   return so << to_string(type);
 }
 
+eformat::stream& operator<<(eformat::stream& so, const Record::Info& info)
+{
+  so << '(' << info.nelem << ')';
+  for(const auto& field : info)
+  {
+    so << "\n\t" << field.name << ": " << info.descriptor(field).type;
+  }
+  return so;
+}
+
 eformat::stream& operator<<(eformat::stream& so, const Object::Info& info)
 {
   so << info.otype << ':';
@@ -44,6 +57,13 @@ eformat::stream& operator<<(eformat::stream& so, const Object::Info& info)
     case Object::ClassId::Array: return so << info.type << '(' << info.nelem << ')';
     case Object::ClassId::Variable: return so << info.type;
     case Object::ClassId::Record: return so << static_cast<const Record::Info&>(info);
+    case Object::ClassId::Table:
+    {
+      auto& table = static_cast<const Table::Info&>(info);
+      so << info.type << '(' << table.extents[0];
+      for(uint8_t r = 1; r < table.rank; ++r) so << 'x' << table.extents[r];
+      return so << ')';
+    }
     default: return so;
   }
 }
@@ -56,12 +76,36 @@ eformat::stream& print(eformat::stream& so, const void* data, size_t size)
   else return so << *temp;
 }
 
+/// \brief Print integer scaled by the decimals of unit, followed by its symbol
+template<class T, class Wide>
+eformat::stream& print_scaled(eformat::stream& so, const void* data, const Object::Unit& unit)
+{
+  const T* temp = static_cast<const T*>(data);
+  if(temp == nullptr) return so << nullptr;
+  so << eformat::fixed(static_cast<Wide>(*temp), unit.decimals);
+  if(false == unit.symbol.empty()) so << ' ' << unit.symbol;
+  return so;
+}
+
+eformat::stream& print_binstring(eformat::stream& so, const void* data, size_t size)
+{
+  if(data == nullptr) return so << nullptr;
+  return so << estd::span<const uint8_t>(static_cast<const uint8_t*>(data), static_cast<uint32_t>(size));
+}
+
 eformat::stream& print_string(eformat::stream& so, const void* data, size_t size)
 {
-  return so << '\"' << estd::string_view{static_cast<const char*>(data), size} << '\"';
+  // String storage is null padded, so only print up to the first null
+  auto str = static_cast<const char*>(data);
+  if(str == nullptr) return so << nullptr;
+  return so << '\"' << estd::string_view{str, static_cast<estd::string_view::size_type>(strnlen(str, size))} << '\"';
+}
 }
 
-eformat::stream& print_value(eformat::stream& so, const void* data, size_t size, DataType type)
+namespace console
+{
+
+eformat::stream& print_value(eformat::stream& so, const void* data, size_t size, DataType type) NOEXCEPT
 {
   switch(type)
   {
@@ -72,11 +116,51 @@ eformat::stream& print_value(eformat::stream& so, const void* data, size_t size,
   case DataType::I16:    return print<int16_t> (so, data, size);
   case DataType::I32:    return print<int32_t> (so, data, size);
   case DataType::String: return print_string   (so, data, size);
+  case DataType::BinString: return print_binstring(so, data, size);
   case DataType::Record: return so << "{...}";
   default: return so << "Type Invalid";
   }
 }
 
+eformat::stream& print_value(eformat::stream& so, const void* data, size_t size, DataType type,
+                             const Object::Unit* unit) NOEXCEPT
+{
+  if(unit == nullptr) return print_value(so, data, size, type);
+  switch(type)
+  {
+  case DataType::U8:     return print_scaled<uint8_t,  uint32_t>(so, data, *unit);
+  case DataType::U16:    return print_scaled<uint16_t, uint32_t>(so, data, *unit);
+  case DataType::U32:    return print_scaled<uint32_t, uint32_t>(so, data, *unit);
+  case DataType::I8:     return print_scaled<int8_t,   int32_t> (so, data, *unit);
+  case DataType::I16:    return print_scaled<int16_t,  int32_t> (so, data, *unit);
+  case DataType::I32:    return print_scaled<int32_t,  int32_t> (so, data, *unit);
+  default: return print_value(so, data, size, type);
+  }
+}
+
+}
+
+namespace {
+
+using console::print_value;
+
+/// \brief Largest column of a table, of 255 rows of 4 byte values
+constexpr size_t MaxColumnSize = 255 * sizeof(uint32_t);
+
+/// \brief Print consecutive values of a table row or column, separated by spaces
+eformat::stream& print_values(eformat::stream& so, const void* data, size_t size, DataType type,
+                              const Object::Unit* unit)
+{
+  const size_t elem_size = eobject::type_size(type);
+  auto         values    = static_cast<const uint8_t*>(data);
+  for(size_t i = 0; elem_size > 0 && i + elem_size <= size; i += elem_size)
+  {
+    if(i > 0) so << ' ';
+    print_value(so, values + i, elem_size, type, unit);
+  }
+  return so;
+}
+
 eformat::stream& print_field(eformat::stream& so, Object::const_iterator field)
 {
   auto info = field.info();
@@ -84,7 +168,7 @@ eformat::stream& print_field(eformat::stream& so, Object::const_iterator field)
   uint8_t buffer[64];
   int e = field.get_to(buffer, sizeof(buffer));
   if(e > 0){
-    return print_value(so, buffer, e, info.info->type);
+    return print_value(so, buffer, e, info.info->type, unit_of(*info.info));
   }
   else
   {
@@ -100,13 +184,25 @@ eformat::stream& operator<<(eformat::stream& so, const Object& object)
     int e =  object.get(buffer, sizeof(buffer));
     so << ' ';
     if(e > 0){
-       return print_value(so, buffer, e, object.type());
+       return print_value(so, buffer, e, object.type(), unit_of(object.info()));
     }
     else
     {
       return so << static_cast<eobject::Error>(e);
     }
   }
+  else if(object.otype() == Object::ClassId::Table)
+  {
+    // Rows are numbered from 0, as they are selected by get and set
+    alignas(uint32_t) uint8_t buffer[Table::MaxRowSize];
+    for(uint8_t subIdx = 1; subIdx <= object.info().nelem; ++subIdx)
+    {
+      so << "\n\t" << subIdx - 1u << ": ";
+      int e = object.get(subIdx, buffer, sizeof(buffer));
+      if(e > 0) print_values(so, buffer, e, object.type(), unit_of(object.info()));
+      else so << static_cast<eobject::Error>(e);
+    }
+  }
   else
   {
     for(const auto& value : object)
@@ -132,17 +228,45 @@ Error parse_value(estd::string_view& str, void* data, size_t& size)
   return Error::DataTypeError;
 }
 
+/// \brief Parse value given in the scaled unit, e.g. 1.25 for an object counting hundredths
+template<class T, class Wide>
+Error parse_scaled(estd::string_view& str, void* data, size_t& size, const Object::Unit& unit)
+{
+  if(sizeof(T) > size) return Error::ParamTooLong;
+  Wide value;
+  eformat::ParseStatus status = eformat::parse_fixed(str, value, unit.decimals);
+  if(eformat::ParseStatus::OK != status) return Error::DataTypeError;
+  if(value < std::numeric_limits<T>::min() || value > std::numeric_limits<T>::max()) return Error::DataTypeError;
+  
+  size = sizeof(T);
+  *static_cast<T*>(data) = static_cast<T>(value);
+  return Error::OK;
+}
+
 Error parse_string(estd::string_view& str,  void* data, size_t& size)
 {
+  // Strings must be quoted
+  if(str.size() < 2 || str.front() != '\"' || str.back() != '\"') return Error::DataTypeError;
   if(str.size()-2 > size) return Error::ParamTooLong;
+  
   size = str.size() - 2;
+  memcpy(data, str.data()+1, size);
+  return Error::OK;
+}
 
-  if(str.front() == '\"' && str.back() == '\"') 
+Error parse_binstring(estd::string_view& str, void* data, size_t& size)
+{
+  // Binary strings are given as pairs of hex digits
+  estd::span<uint8_t> bytes(static_cast<uint8_t*>(data), static_cast<uint32_t>(size));
+  switch(eformat::parse(str, bytes))
   {
-    memcpy(data, str.data()+1, size);
-    return Error::OK;
+  case eformat::ParseStatus::OK: break;
+  case eformat::ParseStatus::Overflow: return Error::ParamTooLong;
+  default: return Error::DataTypeError;
   }
-  return Error::DataTypeError;
+  if(false == str.empty()) return Error::DataTypeError;
+  size = bytes.size();
+  return Error::OK;
 }
 
 Error parse(void* buffer, size_t& size, estd::string_view& vstring, DataType type)
@@ -156,9 +280,57 @@ Error parse(void* buffer, size_t& size, estd::string_view& vstring, DataType typ
   case DataType::I16: return parse_value<int16_t>(vstring, buffer, size);
   case DataType::I32: return parse_value<int32_t>(vstring, buffer, size);
   case DataType::String: return parse_string(vstring, buffer, size);
+  case DataType::BinString: return parse_binstring(vstring, buffer, size);
   default: return eobject::Error::DataTypeError;
   }
 }
+
+Error parse(void* buffer, size_t& size, estd::string_view& vstring, DataType type, const Object::Unit* unit)
+{
+  if(unit == nullptr) return parse(buffer, size, vstring, type);
+  switch(type)
+  {
+  case DataType::U8:  return parse_scaled<uint8_t,  uint32_t>(vstring, buffer, size, *unit);
+  case DataType::U16: return parse_scaled<uint16_t, uint32_t>(vstring, buffer, size, *unit);
+  case DataType::U32: return parse_scaled<uint32_t, uint32_t>(vstring, buffer, size, *unit);
+  case DataType::I8:  return parse_scaled<int8_t,   int32_t> (vstring, buffer, size, *unit);
+  case DataType::I16: return parse_scaled<int16_t,  int32_t> (vstring, buffer, size, *unit);
+  case DataType::I32: return parse_scaled<int32_t,  int32_t> (vstring, buffer, size, *unit);
+  default: return parse(buffer, size, vstring, type);
+  }
+}
+
+/// \brief Parse values separated by spaces into consecutive values, e.g. a row or column of a table
+Error parse_values(void* buffer, size_t& size, estd::string_view& vstring, DataType type, const Object::Unit* unit)
+{
+  const size_t elem_size = eobject::type_size(type);
+  if(elem_size == 0) return Error::DataTypeError;
+
+  auto   values = static_cast<uint8_t*>(buffer);
+  size_t count  = 0;
+  for(trim_prefix(vstring, estd::isspace); false == vstring.empty(); trim_prefix(vstring, estd::isspace))
+  {
+    if((count + 1) * elem_size > size) return Error::ParamTooLong;
+    auto   token      = estd::next_token(vstring, estd::isspace);
+    size_t value_size = elem_size;
+    Error  e          = parse(values + count * elem_size, value_size, token, type, unit);
+    if(Error::OK != e) return e;
+    if(false == token.empty()) return Error::DataTypeError;
+    ++count;
+  }
+  size = count * elem_size;
+  return Error::OK;
+}
+
+/// \brief Check if query selects a column of a table, as c<N> with N from 0, e.g. map.c2
+bool query_column(const eobject::Dictionary::Query& query, uint16_t& column)
+{
+  if(query.item == nullptr || query.item->object.otype() != Object::ClassId::Table) return false;
+  estd::string_view name = query.subobject_name;
+  if(name.size() < 2 || name.front() != 'c') return false;
+  name.remove_prefix(1);
+  return eformat::parse(name, column) == eformat::ParseStatus::OK && name.empty();
+}
 }
 
 namespace console
@@ -177,17 +349,30 @@ namespace console
     so << prompt_; so.sync();
   }
   
+  int32_t Console::lookup(eobject::Dictionary::Query& query) const NOEXCEPT
+  {
+    return names_ != nullptr ? names_->query(query) : dictionary.query(query);
+  }
+
     void Console::command_list(estd::string_view& line)
     {
       if(line.empty())
       {
         so << "\nObjects:\n";
-        for(auto& item : dictionary)
-          so << "  " << item.object.name() << '\n';
+        if(visible_ != nullptr)
+        {
+          for(auto& item : *visible_)
+            so << "  " << item.object.name() << '\n';
+        }
+        else
+        {
+          for(auto& item : dictionary)
+            so << "  " << item.object.name() << '\n';
+        }
       }
       else
       {
-        auto item = dictionary.find(line);
+        auto item = names_ != nullptr ? names_->find(line) : dictionary.find(line);
         if(item != nullptr) so << item->object.info();
         else print_object_not_found(so, line);
       }
@@ -195,10 +380,20 @@ namespace console
     
     void Console::command_get(estd::string_view& line)
     {
-      if(line.empty()) { so << "Usage: get <object>(.<item>)"; return; }
+      if(line.empty()) { so << "Usage: get <object>(.<item>|.<row>|.c<column>)"; return; }
       eobject::Dictionary::Query query{line};
       
-      auto e = dictionary.query(query);
+      auto     e = lookup(query);
+      uint16_t column;
+      if(e == eobject::Error::FieldNotFound && query_column(query, column))
+      {
+        so << query.item->object.name() << '.' << query.subobject_name << ':';
+        alignas(uint32_t) uint8_t buffer[MaxColumnSize];
+        int s = Table::get_column(query.item->object, column, buffer, sizeof(buffer));
+        if(s > 0) print_values(so, buffer, s, query.item->object.type(), unit_of(query.item->object.info()));
+        else so << static_cast<eobject::Error>(s);
+        return;
+      }
       if(e == eobject::Error::OK)
       {
         so << query.item->object.name();
@@ -209,13 +404,20 @@ namespace console
         {
           so << query.item->object;
         }
+        else if(query.item->object.otype() == Object::ClassId::Table)
+        {
+          alignas(uint32_t) uint8_t buffer[Table::MaxRowSize];
+          int s = query.item->object.get(query.subIdx, buffer, sizeof(buffer));
+          if(s > 0) print_values(so, buffer, s, query.info->type, unit_of(*query.info));
+          else so << static_cast<eobject::Error>(s);
+        }
         else
         {
           uint8_t buffer[64];
           int s = query.item->object.get(query.subIdx, buffer, sizeof(buffer));
           if(s > 0)
           {
-            print_value(so, buffer, s, query.info->type);
+            print_value(so, buffer, s, query.info->type, unit_of(*query.info));
             return;
           }
           else
@@ -237,61 +439,132 @@ namespace console
       trim_prefix(line, estd::isspace);
       
       // Got an endline before second token
-      if(line.empty()) { so << "Usage: set <object>(.<item>) <value>"; return; }
+      if(line.empty()) { so << "Usage: set <object>(.<item>|.<row>|.c<column>) <value>..."; return; }
       
       eobject::Dictionary::Query query{name};
-      auto e = dictionary.query(query);
-      if(e == Error::OK)
+      int32_t  e = lookup(query);
+      uint16_t column;
+      if(e == Error::FieldNotFound && query_column(query, column))
       {
-        uint8_t buffer[64];
+        alignas(uint32_t) uint8_t buffer[MaxColumnSize];
+        size_t size = sizeof(buffer);
+        e = parse_values(buffer, size, line, query.item->object.type(), unit_of(query.item->object.info()));
+        if(Error::OK == e)
+        {
+          etrace::SourceScope source(etrace::Source::Console);
+          e = Table::set_column(query.item->object, column, buffer, size);
+        }
+      }
+      else if(e == Error::OK && query.item->object.otype() == Object::ClassId::Table)
+      {
+        if(query.subIdx < 0) { so << "Must select row or column to set"; return; }
+        alignas(uint32_t) uint8_t buffer[Table::MaxRowSize];
         size_t size = sizeof(buffer);
-        e = parse(buffer, size, line, query.info->type);
+        e = parse_values(buffer, size, line, query.info->type, unit_of(*query.info));
         if(Error::OK == e)
         {
-          if(query.subIdx < 0)
+          etrace::SourceScope source(etrace::Source::Console);
+          e = query.item->object.set(query.subIdx, buffer, size);
+        }
+      }
+      else if(e == Error::OK)
+      {
+        if(query.subIdx < 0)
+        {
+          if(query.item->object.otype() == Object::ClassId::Variable)
+          {
+            query.subIdx = 0;
+          }
+          else
           {
-            if(query.item->object.otype() == Object::ClassId::Variable)
-            {
-              query.subIdx = 0;
-            }
-            else
-            {
-              so << "Must select subobject to set";
-              return;
-            }
+            so << "Must select subobject to set";
+            return;
           }
         }
-        e = query.item->object.set(query.subIdx, buffer, size);
+        
+        uint8_t buffer[64];
+        size_t size = sizeof(buffer);
+        e = parse(buffer, size, line, query.info->type, unit_of(*query.info));
+        if(Error::OK == e)
+        {
+          etrace::SourceScope source(etrace::Source::Console);
+          e = query.item->object.set(query.subIdx, buffer, size);
+        }
       }
-      so << e;
+      so << static_cast<Error>(e);
     }
   
+    void Console::command_trace(estd::string_view& line)
+    {
+      if(recorder_ == nullptr) { so << "Trace not enabled"; return; }
+      if(line == "clear") { recorder_->clear(); so << Error::OK; return; }
+
+      uint32_t count = 10;
+      if(false == line.empty() && eformat::parse(line, count) != eformat::ParseStatus::OK)
+      {
+        so << "Usage: trace (<count>|clear)"; return;
+      }
+
+      uint32_t end   = recorder_->end();
+      uint32_t begin = recorder_->begin();
+      if(end - begin > count) begin = end - count;
+      so << "Writes " << begin << " to " << end << ':';
+
+      for(uint32_t sequence = begin; sequence != end; ++sequence)
+      {
+        etrace::Entry entry;
+        if(false == recorder_->read(sequence, entry)) continue;
+
+        so << "\n  " << entry.time << ' ';
+        const Object* object = entry.address == etrace::NoAddress ? nullptr : dictionary.get(entry.address);
+        if(object == nullptr) { so << "unknown object"; continue; }
+
+        // Values hold the first bytes of the value, so they are printed as the type they were set as
+        auto field = object->info(entry.subIdx);
+        so << object->name();
+        if(field.valid()) so << '.' << *field.name;
+        else if(object->otype() == Object::ClassId::Table) so << '.' << entry.subIdx - 1u;
+        so << ": ";
+        auto unit = unit_of(*field.info);
+        print_value(so, &entry.old_value, sizeof(entry.old_value), field.info->type, unit) << " -> ";
+        print_value(so, &entry.new_value, sizeof(entry.new_value), field.info->type, unit);
+        so << " (" << etrace::to_string(static_cast<etrace::Source>(entry.source)) << ')';
+      }
+    }
+
+  void Console::execute(estd::string_view line) NOEXCEPT
+  {
+    so.write(line) << eformat::endl;
+
+    auto commandstr = estd::next_token(line, estd::isspace);
+    estd::trim_prefix(line, estd::isspace);
+    
+    if(commandstr == "ls") command_list(line);
+    else if(commandstr == "get") command_get(line);
+    else if(commandstr == "set") command_set(line);
+    else if(commandstr == "trace") command_trace(line);
+    else if(commandstr == "status") { so << "Status not implemented\n"; }
+    else {  so << "Unknown command: " << commandstr; }
+    
+    pprompt();
+  }
+
   int Console::poll() NOEXCEPT
   {
     auto status = so.buf.poll();
       
-    if(status < 0)
-    {
-      so.buf.gflush();
-      so << "Input buffer overflow!";
-      pprompt();
-    }
-    else if(status > 0)
+    if(status != 0)
     { 
       estd::string_view line = so.buf.getline();
       if(false == line.empty()) 
       {
-        so.write(line) << eformat::endl;
-
-        auto commandstr = estd::next_token(line, estd::isspace);
-        estd::trim_prefix(line, estd::isspace);
-        
-        if(commandstr == "ls") command_list(line);
-        else if(commandstr == "get") command_get(line);
-        else if(commandstr == "set") command_set(line);
-        else if(commandstr == "status") { so << "Status not implemented\n"; }
-        else {  so << "Unknown command: " << commandstr; }
-        
+        execute(line);
+      }
+      else if(status < 0)
+      {
+        // Buffer is full without a complete line, so the line can never be completed
+        so.buf.gflush();
+        so << "Input buffer overflow!";
         pprompt();
       }
       else if(eio::isendline(so.buf.sgetc()))
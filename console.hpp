@@ -7,10 +7,21 @@
 #include "eformat.hpp"
 
 #include "eobject.hpp"
+#include "etrace.hpp"
 
 namespace console
 {
 
+/// \brief Print value of a native type, as the console does for get commands
+/// \param data Pointer to value, or nullptr to print null
+/// \param size Size of value, which limits the length of strings
+eformat::stream& print_value(eformat::stream& so, const void* data, size_t size, eobject::DataType type) NOEXCEPT;
+
+/// \brief Print value of a native type in the scaled unit of its object, e.g. 1.25 A for 125 hundredths
+/// \param unit Unit of value, or nullptr to print the value as stored
+eformat::stream& print_value(eformat::stream& so, const void* data, size_t size, eobject::DataType type,
+                             const eobject::Object::Unit* unit) NOEXCEPT;
+
 struct Console
 {
  
@@ -23,20 +34,40 @@ public:
   
   /// \brief Poll the console to check for commands
   int poll() NOEXCEPT;
+
+  /// \brief Run a command line which has been read by the caller, e.g. from a coroutine, and print the next prompt
+  void execute(estd::string_view line) NOEXCEPT;
+
+  /// \brief Set recorder shown by the trace command, or nullptr to disable the command
+  void trace(etrace::Recorder* recorder) NOEXCEPT { recorder_ = recorder; }
+
+  /// \brief Set view of the objects listed by the ls command, or nullptr to list all objects
+  void visible(const eobject::View* view) NOEXCEPT { visible_ = view; }
+
+  /// \brief Set index used to look up names given in commands, or nullptr to search the dictionary
+  /// \remarks The index must be of the console's dictionary
+  void names(const eobject::NameIndex* index) NOEXCEPT { names_ = index; }
   
 private:
   const eobject::Dictionary& dictionary;
 
   eformat::stream so;
   estd::string_view prompt_;
+  etrace::Recorder* recorder_ = nullptr;
+  const eobject::View* visible_ = nullptr;
+  const eobject::NameIndex* names_ = nullptr;
   
   void pprompt() NOEXCEPT;
+
+  int32_t lookup(eobject::Dictionary::Query& query) const NOEXCEPT;
   
   void command_list(estd::string_view& line) NOEXCEPT;
     
   void command_get(estd::string_view& line) NOEXCEPT;
     
   void command_set(estd::string_view& line) NOEXCEPT;
+
+  void command_trace(estd::string_view& line) NOEXCEPT;
   
 };
 
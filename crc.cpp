@@ -0,0 +1,115 @@
+/// \file crc.cpp
+/// \brief Implementation of table driven checksums, and selection of CRC instructions
+
+#include "crc.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+/// \brief SSE4.2 crc32 instructions may be used when the processor has them
+#define ESTD_CRC_SSE42 1
+#include <atomic>
+#include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+/// \brief ARMv8 CRC instructions are enabled for the target, and always used
+#define ESTD_CRC_ARM 1
+#include <arm_acle.h>
+#endif
+
+namespace estd
+{
+  namespace detail
+  {
+    namespace {
+
+      /// \brief Load 32 bits in little-endian order, which compiles to a single load on little-endian processors
+      inline uint32_t load_le32(const uint8_t* p) NOEXCEPT
+      {
+        return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+      }
+
+      inline uint64_t load_le64(const uint8_t* p) NOEXCEPT
+      {
+        return uint64_t(load_le32(p)) | uint64_t(load_le32(p + 4)) << 32;
+      }
+
+#if defined(ESTD_CRC_SSE42)
+      __attribute__((target("sse4.2"))) uint32_t crc32c_update_sse42(uint32_t crc, const uint8_t* data,
+                                                                     size_t size) NOEXCEPT
+      {
+        for(; size > 0 && (reinterpret_cast<uintptr_t>(data) & 7) != 0; --size) crc = _mm_crc32_u8(crc, *data++);
+#if defined(__x86_64__)
+        uint64_t crc64 = crc;
+        for(; size >= 8; size -= 8, data += 8) crc64 = _mm_crc32_u64(crc64, load_le64(data));
+        crc = static_cast<uint32_t>(crc64);
+#endif
+        for(; size >= 4; size -= 4, data += 4) crc = _mm_crc32_u32(crc, load_le32(data));
+        for(; size > 0; --size) crc = _mm_crc32_u8(crc, *data++);
+        return crc;
+      }
+
+      typedef uint32_t (*crc32c_function)(uint32_t crc, const uint8_t* data, size_t size);
+
+      uint32_t crc32c_resolve(uint32_t crc, const uint8_t* data, size_t size) NOEXCEPT;
+
+      /// \brief Implementation used by crc32c_update, chosen on the first call. Concurrent first calls choose the same,
+      ///        and the pointer is atomic so they do not race on it
+      std::atomic<crc32c_function> crc32c_selected{ crc32c_resolve };
+
+      uint32_t crc32c_resolve(uint32_t crc, const uint8_t* data, size_t size) NOEXCEPT
+      {
+        __builtin_cpu_init();
+        const crc32c_function f = __builtin_cpu_supports("sse4.2") ? crc32c_update_sse42 : crc32c_update_table;
+        crc32c_selected.store(f, std::memory_order_relaxed);
+        return f(crc, data, size);
+      }
+#endif
+    }
+
+    uint32_t crc32c_update_table(uint32_t crc, const uint8_t* data, size_t size) NOEXCEPT
+    {
+      auto& t = crc32c_tables.table;
+#if ESTD_CRC_TABLES == 8
+      for(; size >= 8; size -= 8, data += 8)
+      {
+        uint32_t one = load_le32(data) ^ crc;
+        uint32_t two = load_le32(data + 4);
+        crc = t[7][one & 0xFF] ^ t[6][(one >> 8) & 0xFF] ^ t[5][(one >> 16) & 0xFF] ^ t[4][one >> 24] ^
+              t[3][two & 0xFF] ^ t[2][(two >> 8) & 0xFF] ^ t[1][(two >> 16) & 0xFF] ^ t[0][two >> 24];
+      }
+#endif
+      for(; size > 0; --size) crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xFF];
+      return crc;
+    }
+
+    uint32_t crc32c_update(uint32_t crc, const uint8_t* data, size_t size) NOEXCEPT
+    {
+#if defined(ESTD_CRC_SSE42)
+      return crc32c_selected.load(std::memory_order_relaxed)(crc, data, size);
+#elif defined(ESTD_CRC_ARM)
+      for(; size > 0 && (reinterpret_cast<uintptr_t>(data) & 7) != 0; --size) crc = __crc32cb(crc, *data++);
+#if defined(__aarch64__)
+      for(; size >= 8; size -= 8, data += 8) crc = __crc32cd(crc, load_le64(data));
+#endif
+      for(; size >= 4; size -= 4, data += 4) crc = __crc32cw(crc, load_le32(data));
+      for(; size > 0; --size) crc = __crc32cb(crc, *data++);
+      return crc;
+#else
+      return crc32c_update_table(crc, data, size);
+#endif
+    }
+
+    uint16_t crc16_update(uint16_t crc, const uint8_t* data, size_t size) NOEXCEPT
+    {
+      auto& t = crc16_tables.table;
+#if ESTD_CRC_TABLES == 8
+      // The checksum is combined with the first two bytes of each step, as it is shifted out through them
+      for(; size >= 8; size -= 8, data += 8)
+      {
+        crc = static_cast<uint16_t>(t[7][data[0] ^ (crc >> 8)] ^ t[6][data[1] ^ (crc & 0xFF)] ^ t[5][data[2]] ^
+                                    t[4][data[3]] ^ t[3][data[4]] ^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]]);
+      }
+#endif
+      for(; size > 0; --size) crc = static_cast<uint16_t>((crc << 8) ^ t[0][(crc >> 8) ^ *data++]);
+      return crc;
+    }
+  }
+}
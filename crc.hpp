@@ -0,0 +1,155 @@
+#pragma once
+
+/// \file crc.hpp
+/// Checksums for frames, persistence images and protocol checks: CRC-32C (Castagnoli, as used by iSCSI, ext4 and
+/// SCTP) and CRC-16/CCITT-FALSE (as used by XMODEM-style framing and many field buses).
+/// Checksums of byte spans use the SSE4.2 crc32 instruction on x86 when the processor has it, selected at runtime,
+/// the ARMv8 CRC instructions when the target enables them, and otherwise tables processing 8 bytes per step.
+/// Checksums of string views are constexpr, so names and constant data can be hashed at compile time.
+/// Both take the checksum of the preceding data, so data can be checksummed in pieces:
+/// crc32c(b, crc32c(a)) == crc32c(a + b)
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "estd.hpp"
+#include "estring.hpp"
+#include "span.hpp"
+
+/// \brief Number of tables used by table driven checksums: 8 to process 8 bytes per step with 8 KiB of tables for
+///        CRC-32C and 4 KiB for CRC-16, or 1 to process a byte per step with 1 KiB and 512 bytes
+#ifndef ESTD_CRC_TABLES
+#define ESTD_CRC_TABLES 8
+#endif
+
+#if defined(__cpp_lib_is_constant_evaluated)
+#define ESTD_CRC_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#elif defined(__GNUC__) && __GNUC__ >= 9 || defined(__clang__) && __clang_major__ >= 9
+#define ESTD_CRC_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+
+namespace estd {
+
+namespace detail {
+
+  /// \brief Reflected CRC-32C polynomial
+  static constexpr uint32_t crc32c_polynomial = 0x82F63B78;
+
+  /// \brief CRC-16/CCITT polynomial
+  static constexpr uint16_t crc16_polynomial = 0x1021;
+
+  /// \brief Shift one byte through a CRC-32C, a bit at a time
+  constexpr uint32_t crc32c_byte(uint32_t crc) NOEXCEPT
+  {
+    for(int i = 0; i < 8; ++i) crc = (crc >> 1) ^ (crc & 1 ? crc32c_polynomial : 0);
+    return crc;
+  }
+
+  /// \brief Shift one byte through a CRC-16, a bit at a time
+  constexpr uint16_t crc16_byte(uint16_t crc) NOEXCEPT
+  {
+    for(int i = 0; i < 8; ++i) crc = static_cast<uint16_t>((crc << 1) ^ (crc & 0x8000 ? crc16_polynomial : 0));
+    return crc;
+  }
+
+  /// \brief Tables of checksums of each byte value followed by k zero bytes in table k, for processing several bytes
+  ///        per step
+  template<class T, size_t Slices>
+  struct crc_tables
+  {
+    T table[Slices][256];
+  };
+
+  constexpr crc_tables<uint32_t, ESTD_CRC_TABLES> make_crc32c_tables() NOEXCEPT
+  {
+    crc_tables<uint32_t, ESTD_CRC_TABLES> t{};
+    for(uint32_t i = 0; i < 256; ++i) t.table[0][i] = crc32c_byte(i);
+    for(size_t k = 1; k < ESTD_CRC_TABLES; ++k)
+    {
+      for(uint32_t i = 0; i < 256; ++i)
+        t.table[k][i] = (t.table[k - 1][i] >> 8) ^ t.table[0][t.table[k - 1][i] & 0xFF];
+    }
+    return t;
+  }
+
+  constexpr crc_tables<uint16_t, ESTD_CRC_TABLES> make_crc16_tables() NOEXCEPT
+  {
+    crc_tables<uint16_t, ESTD_CRC_TABLES> t{};
+    for(uint32_t i = 0; i < 256; ++i) t.table[0][i] = crc16_byte(static_cast<uint16_t>(i << 8));
+    for(size_t k = 1; k < ESTD_CRC_TABLES; ++k)
+    {
+      for(uint32_t i = 0; i < 256; ++i)
+        t.table[k][i] = static_cast<uint16_t>((t.table[k - 1][i] << 8) ^ t.table[0][t.table[k - 1][i] >> 8]);
+    }
+    return t;
+  }
+
+  inline constexpr auto crc32c_tables = make_crc32c_tables();
+  inline constexpr auto crc16_tables  = make_crc16_tables();
+
+  /// \brief Update CRC-32C, without the inversions at start and end, using tables
+  uint32_t crc32c_update_table(uint32_t crc, const uint8_t* data, size_t size) NOEXCEPT;
+
+  /// \brief Update CRC-32C, without the inversions at start and end, with the fastest method of this processor
+  uint32_t crc32c_update(uint32_t crc, const uint8_t* data, size_t size) NOEXCEPT;
+
+  /// \brief Update CRC-16 using tables
+  uint16_t crc16_update(uint16_t crc, const uint8_t* data, size_t size) NOEXCEPT;
+
+  constexpr uint32_t crc32c_constexpr(const char* data, size_t size, uint32_t crc) NOEXCEPT
+  {
+    crc = ~crc;
+    for(size_t i = 0; i < size; ++i)
+      crc = (crc >> 8) ^ crc32c_tables.table[0][(crc ^ static_cast<uint8_t>(data[i])) & 0xFF];
+    return ~crc;
+  }
+
+  constexpr uint16_t crc16_constexpr(const char* data, size_t size, uint16_t crc) NOEXCEPT
+  {
+    for(size_t i = 0; i < size; ++i)
+      crc = static_cast<uint16_t>((crc << 8) ^ crc16_tables.table[0][(crc >> 8) ^ static_cast<uint8_t>(data[i])]);
+    return crc;
+  }
+}
+
+/// \brief Compute CRC-32C of data
+/// \param crc CRC-32C of the preceding data, or 0 to start
+inline uint32_t crc32c(span<const uint8_t> data, uint32_t crc = 0) NOEXCEPT
+{
+  return ~detail::crc32c_update(~crc, data.data(), data.size());
+}
+
+/// \brief Compute CRC-32C of a string, at compile time if it is a constant
+/// \param crc CRC-32C of the preceding data, or 0 to start
+constexpr uint32_t crc32c(string_view data, uint32_t crc = 0) NOEXCEPT
+{
+#if defined(ESTD_CRC_CONSTANT_EVALUATED)
+  if(!ESTD_CRC_CONSTANT_EVALUATED())
+    return ~detail::crc32c_update(~crc, reinterpret_cast<const uint8_t*>(data.data()), data.size());
+#endif
+  return detail::crc32c_constexpr(data.data(), data.size(), crc);
+}
+
+/// \brief Compute CRC-16/CCITT-FALSE of data
+/// \param crc CRC-16 of the preceding data, or 0xFFFF to start
+inline uint16_t crc16_ccitt(span<const uint8_t> data, uint16_t crc = 0xFFFF) NOEXCEPT
+{
+  return detail::crc16_update(crc, data.data(), data.size());
+}
+
+/// \brief Compute CRC-16/CCITT-FALSE of a string, at compile time if it is a constant
+/// \param crc CRC-16 of the preceding data, or 0xFFFF to start
+constexpr uint16_t crc16_ccitt(string_view data, uint16_t crc = 0xFFFF) NOEXCEPT
+{
+#if defined(ESTD_CRC_CONSTANT_EVALUATED)
+  if(!ESTD_CRC_CONSTANT_EVALUATED())
+    return detail::crc16_update(crc, reinterpret_cast<const uint8_t*>(data.data()), data.size());
+#endif
+  return detail::crc16_constexpr(data.data(), data.size(), crc);
+}
+
+static_assert(crc32c("123456789") == 0xE3069283, "CRC-32C check value");
+static_assert(crc16_ccitt("123456789") == 0x29B1, "CRC-16/CCITT-FALSE check value");
+
+}
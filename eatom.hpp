@@ -0,0 +1,147 @@
+#pragma once
+
+/// \file eatom.hpp
+/// Interned names: each distinct name, compared without case as estd::string_view does, is given a small integer
+/// atom by a table of spellings. Names are interned by a hash and a single string comparison, after which names are
+/// compared as integers. Tables are constexpr, so names known at compile time are interned while compiling, and each
+/// spelling is stored once however many times it is used
+
+#include <cstddef>
+#include <cstdint>
+
+#include "estd.hpp"
+#include "estring.hpp"
+
+namespace eatom {
+
+  using estd::string_view;
+
+  /// \brief Interned name, numbered from 0 in order of interning
+  typedef uint16_t atom;
+
+  /// \brief Atom of names which are not in a table
+  static constexpr atom NoAtom = 0xFFFF;
+
+  /// \brief Hash of name without case, so names which compare equal have the same hash (32-bit FNV-1a)
+  constexpr uint32_t hash(const string_view& name) NOEXCEPT
+  {
+    uint32_t h = 2166136261u;
+    for (char c : name) h = (h ^ static_cast<uint8_t>(estd::tolower(c))) * 16777619u;
+    return h;
+  }
+
+  /// \brief Table of interned names, which looks up atoms by name and spellings by atom
+  struct Atoms
+  {
+    /// \brief Get atom of name, or NoAtom if it has not been interned
+    constexpr atom find(const string_view& name) const NOEXCEPT { return find(name, hash(name)); }
+
+    /// \brief Get atom of name with hash already computed
+    constexpr atom find(const string_view& name, uint32_t h) const NOEXCEPT
+    {
+      return slots[probe(spellings, hashes, slots, mask, name, h)];
+    }
+
+    /// \brief Get spelling of atom, as first interned, or an empty string for NoAtom
+    constexpr string_view operator[](atom a) const NOEXCEPT { return a < count ? spellings[a] : string_view(); }
+
+    /// \brief Get number of atoms
+    constexpr uint16_t size() const NOEXCEPT { return count; }
+
+  protected:
+    constexpr Atoms(const string_view* spellings_in, const uint32_t* hashes_in, const atom* slots_in,
+                    uint16_t slot_count) NOEXCEPT
+      : count(0)
+      , mask(static_cast<uint16_t>(slot_count - 1))
+      , spellings(spellings_in)
+      , hashes(hashes_in)
+      , slots(slots_in)
+    {}
+
+    /// \brief Find slot holding the atom of name, or the empty slot where it would be added
+    /// \remarks Slots are open addressed, and at most half full, so lookups probe about one slot
+    static constexpr uint16_t probe(const string_view* spellings, const uint32_t* hashes, const atom* slots,
+                                    uint16_t mask, const string_view& name, uint32_t h) NOEXCEPT
+    {
+      uint16_t i = h & mask;
+      for (; slots[i] != NoAtom; i = (i + 1) & mask)
+      {
+        if (hashes[slots[i]] == h && spellings[slots[i]] == name) break;
+      }
+      return i;
+    }
+
+    uint16_t           count;
+    uint16_t           mask;
+    const string_view* spellings;
+    const uint32_t*    hashes;
+    const atom*        slots;
+  };
+
+  /// \brief Table with storage for up to Capacity atoms
+  /// \remarks The table refers to its own storage, so it cannot be copied, and is constructed in place
+  template<uint16_t Capacity>
+  struct TAtoms : Atoms
+  {
+    // Slots are at least twice the capacity and a power of two, which must fit a uint16_t
+    static_assert(Capacity > 0 && Capacity <= 16384, "Tables hold 1 to 16384 atoms");
+
+    /// \brief Number of hash slots, a power of two of at least twice the capacity
+    static constexpr uint16_t slot_count = [] {
+      uint32_t n = 2;
+      while (n < 2u * Capacity) n *= 2;
+      return static_cast<uint16_t>(n);
+    }();
+
+    string_view spellings_n[Capacity];
+    uint32_t    hashes_n[Capacity];
+    atom        slots_n[slot_count];
+
+    /// \brief Create empty table
+    constexpr TAtoms() NOEXCEPT
+      : Atoms(spellings_n, hashes_n, slots_n, slot_count)
+      , spellings_n{}
+      , hashes_n{}
+      , slots_n{}
+    {
+      for (auto& slot : slots_n) slot = NoAtom;
+    }
+
+    /// \brief Create table of names, where names which compare equal share one atom, optionally at compile time, e.g.
+    ///        constexpr TAtoms<2> atoms({ "speed", "current" })
+    template<size_t N>
+    constexpr TAtoms(const string_view (&names)[N]) NOEXCEPT
+      : TAtoms()
+    {
+      static_assert(N <= Capacity, "More names than atoms");
+      for (auto& name : names) intern(name);
+    }
+
+    TAtoms(const TAtoms&) = delete;
+    TAtoms& operator=(const TAtoms&) = delete;
+
+    /// \brief Remove every atom
+    constexpr void clear() NOEXCEPT
+    {
+      count = 0;
+      for (auto& slot : slots_n) slot = NoAtom;
+    }
+
+    /// \brief Get atom of name, adding it to the table if it is new
+    /// \remarks The spelling is kept by reference, so it must outlive the table
+    /// \returns Atom, or NoAtom if the name is new and the table is full
+    constexpr atom intern(const string_view& name) NOEXCEPT
+    {
+      const uint32_t h = hash(name);
+      const uint16_t i = probe(spellings_n, hashes_n, slots_n, mask, name, h);
+      if (slots_n[i] != NoAtom) return slots_n[i];
+      if (count == Capacity) return NoAtom;
+
+      spellings_n[count] = name;
+      hashes_n[count]    = h;
+      slots_n[i]         = count;
+      return count++;
+    }
+  };
+
+}
@@ -0,0 +1,470 @@
+#include "ecbor.hpp"
+
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace {
+  using namespace ecbor;
+  using eobject::Record;
+  using eobject::Table;
+
+  /// \brief Additional information values which select the size of the argument following the initial byte
+  enum : uint8_t
+  {
+    OneByte    = 24,
+    TwoBytes   = 25,
+    FourBytes  = 26,
+    EightBytes = 27,
+  };
+
+  /// \brief Map parse status of a data item head to the error reported to the caller
+  int32_t to_error(ParseStatus status) NOEXCEPT
+  {
+    switch(status)
+    {
+      case ParseStatus::OK:         return Error::OK;
+      case ParseStatus::Incomplete: return Error::ParamTooShort;
+      case ParseStatus::Overflow:   return Error::ValueTooHigh;
+      default:                      return Error::DataTypeError;
+    }
+  }
+
+  /// \brief Decode head of a data item, which must have the expected major type
+  int32_t expect_head(string_view& in, Head& head, Major expected) NOEXCEPT
+  {
+    string_view temp = in;
+    auto status = ecbor::decode_head(temp, head);
+    if(status != ParseStatus::OK) return to_error(status);
+    if(head.major != expected) return Error::DataTypeError;
+    in = temp;
+    return Error::OK;
+  }
+
+  /// \brief Get payload of a text or byte string, whose head has already been decoded
+  int32_t take_string(string_view& in, const Head& head, string_view& value) NOEXCEPT
+  {
+    if(head.value > in.size()) return Error::ParamTooShort;
+    value = string_view(in.data(), head.value);
+    in.remove_prefix(head.value);
+    return Error::OK;
+  }
+
+  bool is_null(const Head& head) NOEXCEPT { return head.major == Major::Simple && head.value == Simple::Null; }
+
+  template<class T>
+  int encode_integer(buffer& out, const void* data) NOEXCEPT
+  {
+    T value;
+    memcpy(&value, data, sizeof(value));
+    return std::is_signed<T>::value ? encode_int(out, static_cast<int32_t>(value))
+                                    : encode_uint(out, static_cast<uint32_t>(value));
+  }
+
+  /// \brief Convert argument of an integer data item to T, checking that it is in range
+  template<class T>
+  int32_t to_integer(const Head& head, T& value) NOEXCEPT
+  {
+    // Argument n of a negative integer encodes -1 - n, so the lowest value of T has argument -1 - min
+    constexpr uint32_t max_negative = std::is_signed<T>::value
+                                      ? static_cast<uint32_t>(-1 - static_cast<int32_t>(std::numeric_limits<T>::min()))
+                                      : 0;
+    if(head.major == Major::Unsigned)
+    {
+      if(head.value > static_cast<uint32_t>(std::numeric_limits<T>::max())) return Error::ValueTooHigh;
+      value = static_cast<T>(head.value);
+    }
+    else if(head.major == Major::Negative)
+    {
+      if(!std::is_signed<T>::value || head.value > max_negative) return Error::ValueTooLow;
+      value = static_cast<T>(-1 - static_cast<int32_t>(head.value));
+    }
+    else
+    {
+      return Error::DataTypeError;
+    }
+    return Error::OK;
+  }
+
+  template<class T>
+  int32_t set_integer(const Object& object, uint8_t subIdx, const Head& head) NOEXCEPT
+  {
+    T value;
+    auto e = to_integer(head, value);
+    if(e != Error::OK) return e;
+    return object.set(subIdx, &value, sizeof(value));
+  }
+
+  /// \brief Decode one value of a native type, and set it at subindex of object
+  int32_t decode_value(string_view& in, const Object& object, uint8_t subIdx, DataType type) NOEXCEPT
+  {
+    Head head;
+    auto status = ecbor::decode_head(in, head);
+    if(status != ParseStatus::OK) return to_error(status);
+    if(is_null(head)) return Error::OK;
+
+    string_view value;
+    switch(type)
+    {
+      case DataType::U8:  return set_integer<uint8_t>(object, subIdx, head);
+      case DataType::U16: return set_integer<uint16_t>(object, subIdx, head);
+      case DataType::U32: return set_integer<uint32_t>(object, subIdx, head);
+      case DataType::I8:  return set_integer<int8_t>(object, subIdx, head);
+      case DataType::I16: return set_integer<int16_t>(object, subIdx, head);
+      case DataType::I32: return set_integer<int32_t>(object, subIdx, head);
+      case DataType::String:
+      case DataType::BinString:
+      {
+        if(head.major != (type == DataType::String ? Major::Text : Major::Bytes)) return Error::DataTypeError;
+        auto e = take_string(in, head, value);
+        if(e != Error::OK) return e;
+        return object.set(subIdx, value.data(), value.size());
+      }
+      default: return Error::DataTypeError;
+    }
+  }
+
+  int32_t decode_array(string_view& in, const Object& object) NOEXCEPT
+  {
+    Head head;
+    auto e = expect_head(in, head, Major::Array);
+    if(e != Error::OK) return e;
+    if(head.value > object.info().nelem) return Error::ParamTooLong;
+
+    for(uint32_t i = 0; e == Error::OK && i < head.value; ++i)
+    {
+      e = decode_value(in, object, static_cast<uint8_t>(i + 1), object.type());
+    }
+    return e;
+  }
+
+  int32_t decode_record(string_view& in, const Object& object) NOEXCEPT
+  {
+    auto& info = static_cast<const Record::Info&>(object.info());
+
+    Head head;
+    auto e = expect_head(in, head, Major::Map);
+    if(e != Error::OK) return e;
+
+    for(uint32_t i = 0; e == Error::OK && i < head.value; ++i)
+    {
+      Head key;
+      auto status = ecbor::decode_head(in, key);
+      if(status != ParseStatus::OK) return to_error(status);
+
+      // Fields are identified by name, or by subindex starting at 1
+      uint32_t subIdx = key.value;
+      if(key.major == Major::Text)
+      {
+        string_view name;
+        e = take_string(in, key, name);
+        if(e != Error::OK) return e;
+        subIdx = static_cast<uint32_t>(info.find(name) - info.begin()) + 1;
+      }
+      else if(key.major != Major::Unsigned)
+      {
+        return Error::DataTypeError;
+      }
+      if(subIdx == 0 || subIdx > info.nelem) return Error::FieldNotFound;
+
+      e = decode_value(in, object, static_cast<uint8_t>(subIdx), info.descriptor(info.fields[subIdx - 1]).type);
+    }
+    return e;
+  }
+
+  /// \brief Convert argument of an integer data item to T, and store it at dest, which may be unaligned
+  template<class T>
+  int32_t store_integer(const Head& head, uint8_t* dest) NOEXCEPT
+  {
+    T value;
+    auto e = to_integer(head, value);
+    if(e == Error::OK) memcpy(dest, &value, sizeof(value));
+    return e;
+  }
+
+  /// \brief Decode a table row of integers, which must have a value for every column
+  int32_t decode_row(string_view& in, const Table::Info& info, uint8_t* row) NOEXCEPT
+  {
+    Head head;
+    auto e = expect_head(in, head, Major::Array);
+    if(e != Error::OK) return e;
+    if(head.value > info.row_length()) return Error::ParamTooLong;
+    if(head.value < info.row_length()) return Error::ParamTooShort;
+
+    const size_t elem_size = eobject::type_size(info.type);
+    for(uint32_t i = 0; e == Error::OK && i < head.value; ++i, row += elem_size)
+    {
+      Head value;
+      auto status = ecbor::decode_head(in, value);
+      if(status != ParseStatus::OK) return to_error(status);
+      switch(info.type)
+      {
+        case DataType::U8:  e = store_integer<uint8_t>(value, row); break;
+        case DataType::U16: e = store_integer<uint16_t>(value, row); break;
+        case DataType::U32: e = store_integer<uint32_t>(value, row); break;
+        case DataType::I8:  e = store_integer<int8_t>(value, row); break;
+        case DataType::I16: e = store_integer<int16_t>(value, row); break;
+        case DataType::I32: e = store_integer<int32_t>(value, row); break;
+        default:            e = Error::DataTypeError; break;
+      }
+    }
+    return e;
+  }
+
+  /// \brief Decode rows of a table, each set whole so that its values are checked together. Null rows are skipped
+  int32_t decode_table(string_view& in, const Object& object) NOEXCEPT
+  {
+    auto& info = static_cast<const Table::Info&>(object.info());
+
+    Head head;
+    auto e = expect_head(in, head, Major::Array);
+    if(e != Error::OK) return e;
+    if(head.value > info.nelem) return Error::ParamTooLong;
+
+    uint8_t row[Table::MaxRowSize];
+    for(uint32_t i = 0; e == Error::OK && i < head.value; ++i)
+    {
+      string_view temp = in;
+      Head        item;
+      auto        status = ecbor::decode_head(temp, item);
+      if(status != ParseStatus::OK) return to_error(status);
+      if(is_null(item))
+      {
+        in = temp;
+        continue;
+      }
+      e = decode_row(in, info, row);
+      if(e == Error::OK) e = object.set(static_cast<uint8_t>(i + 1), row, info.row_size());
+    }
+    return e;
+  }
+
+  int32_t decode_object(string_view& in, const Object& object) NOEXCEPT
+  {
+    switch(object.otype())
+    {
+      case Object::ClassId::Variable: return decode_value(in, object, 0, object.type());
+      case Object::ClassId::Array:    return decode_array(in, object);
+      case Object::ClassId::Record:   return decode_record(in, object);
+      case Object::ClassId::Table:    return decode_table(in, object);
+      default:                        return Error::DataTypeError;
+    }
+  }
+}
+
+namespace ecbor {
+
+  int encode_head(buffer& out, Major major, uint32_t value) NOEXCEPT
+  {
+    const uint8_t type = static_cast<uint8_t>(major) << 5;
+    if(value < OneByte) return out.sputc(static_cast<char_type>(type | value)) < 0 ? EOF : 0;
+
+    // Arguments are stored big-endian after the initial byte
+    char_type bytes[5];
+    size_t    size;
+    if(value <= 0xFF)
+    {
+      bytes[0] = static_cast<char_type>(type | OneByte);
+      size = 1;
+    }
+    else if(value <= 0xFFFF)
+    {
+      bytes[0] = static_cast<char_type>(type | TwoBytes);
+      size = 2;
+    }
+    else
+    {
+      bytes[0] = static_cast<char_type>(type | FourBytes);
+      size = 4;
+    }
+    for(size_t i = size; i > 0; --i, value >>= 8) bytes[i] = static_cast<char_type>(value);
+    return out.sputn(bytes, size + 1);
+  }
+
+  int encode_text(buffer& out, string_view text) NOEXCEPT
+  {
+    if(encode_head(out, Major::Text, text.size()) < 0) return EOF;
+    return text.empty() ? 0 : out.sputn(text.data(), text.size());
+  }
+
+  int encode_bytes(buffer& out, const void* data, size_t size) NOEXCEPT
+  {
+    if(encode_head(out, Major::Bytes, size) < 0) return EOF;
+    return size == 0 ? 0 : out.sputn(static_cast<const char_type*>(data), size);
+  }
+
+  int encode_value(buffer& out, DataType type, const void* data, size_t size) NOEXCEPT
+  {
+    switch(type)
+    {
+      case DataType::U8:  return encode_integer<uint8_t>(out, data);
+      case DataType::U16: return encode_integer<uint16_t>(out, data);
+      case DataType::U32: return encode_integer<uint32_t>(out, data);
+      case DataType::I8:  return encode_integer<int8_t>(out, data);
+      case DataType::I16: return encode_integer<int16_t>(out, data);
+      case DataType::I32: return encode_integer<int32_t>(out, data);
+      case DataType::String:
+      {
+        auto str = static_cast<const char_type*>(data);
+        auto end = static_cast<const char_type*>(memchr(str, '\0', size));
+        return encode_text(out, string_view(str, end == nullptr ? size : end - str));
+      }
+      case DataType::BinString: return encode_bytes(out, data, size);
+      default: return Error::DataTypeError;
+    }
+  }
+
+  int encode(buffer& out, const Object& object, Keys keys) NOEXCEPT
+  {
+    if(object.data() == nullptr) return encode_simple(out, Simple::Null);
+
+    auto& info = object.info();
+    switch(info.otype)
+    {
+      case Object::ClassId::Variable: return encode_value(out, info.type, object.data(), info.data_size);
+      case Object::ClassId::Array:
+      {
+        if(encode_head(out, Major::Array, info.nelem) < 0) return EOF;
+        size_t elem_size = eobject::type_size(info.type);
+        auto   data      = static_cast<const uint8_t*>(object.data());
+        for(uint8_t i = 0; i < info.nelem; ++i, data += elem_size)
+        {
+          int ret = encode_value(out, info.type, data, elem_size);
+          if(ret != 0) return ret;
+        }
+        return 0;
+      }
+      case Object::ClassId::Record:
+      {
+        auto& record = static_cast<const Record::Info&>(info);
+        if(encode_head(out, Major::Map, record.nelem) < 0) return EOF;
+        uint8_t subIdx = 1;
+        for(auto& field : record)
+        {
+          int ret = keys == Keys::Names ? encode_text(out, field.name) : encode_uint(out, subIdx);
+          auto& descriptor = record.descriptor(field);
+          if(ret == 0) ret = encode_value(out, descriptor.type, object.data(field.data_offset), descriptor.data_size);
+          if(ret != 0) return ret;
+          ++subIdx;
+        }
+        return 0;
+      }
+      case Object::ClassId::Table:
+      {
+        auto& table = static_cast<const Table::Info&>(info);
+        if(encode_head(out, Major::Array, table.nelem) < 0) return EOF;
+        size_t elem_size = eobject::type_size(table.type);
+        auto   data      = static_cast<const uint8_t*>(object.data());
+        for(uint8_t row = 0; row < table.nelem; ++row)
+        {
+          if(encode_head(out, Major::Array, table.row_length()) < 0) return EOF;
+          for(uint16_t column = 0; column < table.row_length(); ++column, data += elem_size)
+          {
+            int ret = encode_value(out, table.type, data, elem_size);
+            if(ret != 0) return ret;
+          }
+        }
+        return 0;
+      }
+      default: return Error::DataTypeError;
+    }
+  }
+
+  /// \brief Encode items of a dictionary or view as a map
+  template<class Items>
+  int encode_items(buffer& out, const Items& items, size_t count, Keys keys) NOEXCEPT
+  {
+    if(encode_head(out, Major::Map, count) < 0) return EOF;
+    for(auto& item : items)
+    {
+      int ret = keys == Keys::Names ? encode_text(out, item.object.name()) : encode_uint(out, item.address);
+      if(ret == 0) ret = encode(out, item.object, keys);
+      if(ret != 0) return ret;
+    }
+    return 0;
+  }
+
+  int encode(buffer& out, const Dictionary& dictionary, Keys keys) NOEXCEPT
+  {
+    return encode_items(out, dictionary, dictionary.count, keys);
+  }
+
+  int encode(buffer& out, const View& view, Keys keys) NOEXCEPT
+  {
+    return encode_items(out, view, view.size(), keys);
+  }
+
+  ParseStatus decode_head(string_view& in, Head& head) NOEXCEPT
+  {
+    if(in.empty()) return ParseStatus::Incomplete;
+
+    auto    initial = static_cast<uint8_t>(in[0]);
+    uint8_t info    = initial & 0x1F;
+    size_t  size    = 0;
+    if(info >= OneByte)
+    {
+      // Reserved values and indefinite lengths are not supported
+      if(info > EightBytes) return ParseStatus::NotMatched;
+      size = size_t(1) << (info - OneByte);
+    }
+    if(in.size() < size + 1) return ParseStatus::Incomplete;
+
+    uint32_t value = size == 0 ? info : 0;
+    for(size_t i = 1; i <= size; ++i)
+    {
+      // Values are limited to 32 bits, so the upper half of an 8-byte argument must be zero
+      if(size == 8 && i <= 4 && in[i] != 0) return ParseStatus::Overflow;
+      value = (value << 8) | static_cast<uint8_t>(in[i]);
+    }
+
+    head  = Head{ static_cast<Major>(initial >> 5), info, value };
+    in.remove_prefix(size + 1);
+    return ParseStatus::OK;
+  }
+
+  int32_t decode(string_view& in, const Object& object) NOEXCEPT
+  {
+    string_view temp = in;
+    auto e = decode_object(temp, object);
+    if(e == Error::OK) in = temp;
+    return e;
+  }
+
+  int32_t decode(string_view& in, const Dictionary& dictionary) NOEXCEPT
+  {
+    string_view temp = in;
+    Head head;
+    auto e = expect_head(temp, head, Major::Map);
+
+    for(uint32_t i = 0; e == Error::OK && i < head.value; ++i)
+    {
+      Head key;
+      auto status = ecbor::decode_head(temp, key);
+      if(status != ParseStatus::OK) return to_error(status);
+
+      // Objects are identified by name, or by address
+      const Object* object = nullptr;
+      if(key.major == Major::Text)
+      {
+        string_view name;
+        e = take_string(temp, key, name);
+        if(e != Error::OK) return e;
+        auto item = dictionary.find(name);
+        if(item != nullptr) object = &item->object;
+      }
+      else if(key.major == Major::Unsigned)
+      {
+        if(key.value <= 0xFFFF) object = dictionary.get(static_cast<uint16_t>(key.value));
+      }
+      else
+      {
+        return Error::DataTypeError;
+      }
+      if(object == nullptr) return Error::ObjectNotFound;
+
+      e = decode_object(temp, *object);
+    }
+    if(e == Error::OK) in = temp;
+    return e;
+  }
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+/// \file ecbor.hpp
+/// Compact binary serialization of dictionary objects as CBOR (RFC 8949), without dynamic allocation or exceptions.
+/// Values are encoded straight from object data into an IO buffer, and decoded straight from the input into the
+/// object set functions, so the same range checks apply as for any other write
+
+#include "eformat.hpp"
+#include "eio.hpp"
+#include "eobject.hpp"
+
+namespace ecbor {
+  typedef eio::buffer buffer;
+  typedef estd::string_view string_view;
+  using estd::char_type;
+  using eformat::ParseStatus;
+  using eobject::DataType;
+  using eobject::Dictionary;
+  using eobject::Error;
+  using eobject::Object;
+  using eobject::View;
+
+  /// \brief CBOR major types, stored in the upper 3 bits of the initial byte of each data item
+  enum class Major : uint8_t
+  {
+    Unsigned = 0,
+    Negative = 1,
+    Bytes    = 2,
+    Text     = 3,
+    Array    = 4,
+    Map      = 5,
+    Tag      = 6,
+    Simple   = 7
+  };
+
+  /// \brief Simple values used by the encoder
+  enum Simple : uint8_t
+  {
+    False = 20,
+    True  = 21,
+    Null  = 22,
+  };
+
+  /// \brief Selects how the keys of encoded maps identify their values
+  enum class Keys : uint8_t
+  {
+    Names   = 0, ///< Object and field names, so the output is self-describing
+    Indices = 1  ///< Object addresses and field subindices, so the output is smaller
+  };
+
+  /// \brief Initial byte and argument of a data item
+  struct Head
+  {
+    Major    major;
+    uint8_t  info;  ///< Additional information in the low 5 bits of the initial byte
+    uint32_t value; ///< Argument: the value, length, or number of elements
+  };
+
+  /// \defgroup Encode Encoding functions
+  /// \returns 0 on success, EOF if the buffer is full, or a negative Error if a type cannot be encoded
+  /// @{
+
+  /// \brief Encode initial byte and argument, using the shortest form for the argument
+  int encode_head(buffer& out, Major major, uint32_t value) NOEXCEPT;
+
+  inline int encode_uint(buffer& out, uint32_t value) NOEXCEPT { return encode_head(out, Major::Unsigned, value); }
+
+  inline int encode_int(buffer& out, int32_t value) NOEXCEPT
+  {
+    // Negative integers are stored as -1 - n, so their magnitude never overflows
+    return value < 0 ? encode_head(out, Major::Negative, static_cast<uint32_t>(-1 - value))
+                     : encode_head(out, Major::Unsigned, static_cast<uint32_t>(value));
+  }
+
+  inline int encode_simple(buffer& out, Simple value) NOEXCEPT { return encode_head(out, Major::Simple, value); }
+
+  int encode_text(buffer& out, string_view text) NOEXCEPT;
+  int encode_bytes(buffer& out, const void* data, size_t size) NOEXCEPT;
+
+  /// \brief Encode value of native type from memory
+  /// \remarks Strings are encoded up to the first null character
+  int encode_value(buffer& out, DataType type, const void* data, size_t size) NOEXCEPT;
+
+  /// \brief Encode object value
+  /// \remarks Variables are encoded as a single value, arrays as an array of elements, records as a map of fields,
+  ///          and tables as an array of rows, each an array of values. Write-only objects are encoded as null
+  int encode(buffer& out, const Object& object, Keys keys = Keys::Names) NOEXCEPT;
+
+  /// \brief Encode all objects in dictionary as a map
+  int encode(buffer& out, const Dictionary& dictionary, Keys keys = Keys::Names) NOEXCEPT;
+
+  /// \brief Encode the objects in a view as a map, e.g. the persisted objects of a dictionary as a snapshot which can
+  ///        be decoded into the dictionary again
+  int encode(buffer& out, const View& view, Keys keys = Keys::Names) NOEXCEPT;
+
+  /// @}
+
+  /// \defgroup Decode Decoding functions
+  /// \remarks Input is only consumed on success
+  /// @{
+
+  /// \brief Decode initial byte and argument of next data item
+  /// \returns Incomplete if input is too short, NotMatched for indefinite lengths, Overflow for 64-bit arguments
+  ParseStatus decode_head(string_view& in, Head& head) NOEXCEPT;
+
+  /// \brief Decode value, and set it in object
+  /// \remarks Strings are passed to the set function directly from the input, without copying. Null values are
+  ///          skipped, and map keys may be names or subindices. If a field fails to set, the fields before it keep
+  ///          their new values
+  /// \returns Error::OK, an error from the set function, ParamTooShort if input is truncated, or DataTypeError if
+  ///          input does not match the object
+  int32_t decode(string_view& in, const Object& object) NOEXCEPT;
+
+  /// \brief Decode map of objects, and set them in dictionary
+  /// \remarks Keys may be object names or addresses. Decoding stops at the first error, and objects before it keep
+  ///          their new values
+  int32_t decode(string_view& in, const Dictionary& dictionary) NOEXCEPT;
+
+  /// @}
+}
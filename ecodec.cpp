@@ -0,0 +1,330 @@
+/// \file ecodec.cpp
+/// \brief Implementation of column codecs
+
+#include "ecodec.hpp"
+
+#include <cstring>
+
+#include "bit.hpp"
+
+using eobject::Error;
+
+namespace ecodec
+{
+  namespace {
+
+    /// \brief Largest size of a varint holding 32 bits
+    static const size_t MaxVarint = 5;
+
+    /// \brief Widen value to 32 bits, sign extending signed types, so differences wrap around consistently
+    template<class T>
+    inline uint32_t widen(T value) NOEXCEPT
+    {
+      return static_cast<uint32_t>(value);
+    }
+
+    /// \brief Pack n values of width bits, least significant bit first
+    /// \returns End of packed data
+    uint8_t* pack(const uint32_t* values, size_t n, int width, uint8_t* out) NOEXCEPT
+    {
+      uint64_t acc    = 0;
+      int      filled = 0;
+      for (size_t i = 0; i < n; ++i)
+      {
+        acc |= static_cast<uint64_t>(values[i]) << filled;
+        filled += width;
+        if (filled >= 32)
+        {
+          out[0] = static_cast<uint8_t>(acc);
+          out[1] = static_cast<uint8_t>(acc >> 8);
+          out[2] = static_cast<uint8_t>(acc >> 16);
+          out[3] = static_cast<uint8_t>(acc >> 24);
+          out += 4;
+          acc >>= 32;
+          filled -= 32;
+        }
+      }
+      for (; filled > 0; filled -= 8, acc >>= 8) *out++ = static_cast<uint8_t>(acc);
+      return out;
+    }
+
+    /// \brief Unpack n values of width bits
+    void unpack(const uint8_t* in, size_t n, int width, uint32_t* values) NOEXCEPT
+    {
+      uint32_t mask   = width == 32 ? 0xFFFFFFFFu : (uint32_t(1) << width) - 1;
+      uint64_t acc    = 0;
+      int      filled = 0;
+      for (size_t i = 0; i < n; ++i)
+      {
+        while (filled < width)
+        {
+          acc |= static_cast<uint64_t>(*in++) << filled;
+          filled += 8;
+        }
+        values[i] = static_cast<uint32_t>(acc) & mask;
+        acc >>= width;
+        filled -= width;
+      }
+    }
+
+    size_t packed_size(size_t n, int width) NOEXCEPT { return (n * width + 7) / 8; }
+
+    size_t min(size_t a, size_t b) NOEXCEPT { return a < b ? a : b; }
+
+    uint8_t* put_varint(uint8_t* out, uint32_t value) NOEXCEPT
+    {
+      while (value >= 0x80)
+      {
+        *out++ = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+      }
+      *out++ = static_cast<uint8_t>(value);
+      return out;
+    }
+
+    bool get_varint(string_view& in, uint32_t& value) NOEXCEPT
+    {
+      value = 0;
+      for (int shift = 0; shift < 35 && false == in.empty(); shift += 7)
+      {
+        uint8_t byte = static_cast<uint8_t>(in.front());
+        in.remove_prefix(1);
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return true;
+      }
+      return false;
+    }
+
+    template<class T>
+    int32_t decode_packed(string_view& in, T* values, size_t count, bool second_order) NOEXCEPT
+    {
+      uint32_t z[BlockSize];
+      uint32_t previous       = 0;
+      uint32_t previous_delta = 0;
+
+      for (size_t start = 0; start < count; start += BlockSize)
+      {
+        size_t n = count - start < BlockSize ? count - start : BlockSize;
+        if (in.empty()) return Error::ParamTooShort;
+        int width = static_cast<uint8_t>(in.front());
+        if (width > 32) return Error::DataTypeError;
+        size_t size = packed_size(n, width);
+        if (in.size() < 1 + size) return Error::ParamTooShort;
+        unpack(reinterpret_cast<const uint8_t*>(in.data()) + 1, n, width, z);
+        in.remove_prefix(static_cast<string_view::size_type>(1 + size));
+
+        for (size_t i = 0; i < n; ++i)
+        {
+          uint32_t delta = static_cast<uint32_t>(unzigzag(z[i]));
+          if (second_order)
+          {
+            delta += previous_delta;
+            previous_delta = delta;
+          }
+          previous += delta;
+          values[start + i] = static_cast<T>(previous);
+        }
+      }
+      return Error::OK;
+    }
+
+    template<class T>
+    int32_t decode_rle(string_view& in, T* values, size_t count) NOEXCEPT
+    {
+      uint32_t previous = 0;
+      for (size_t i = 0; i < count;)
+      {
+        uint32_t run, delta;
+        if (false == get_varint(in, run) || false == get_varint(in, delta)) return Error::ParamTooShort;
+        if (run == 0 || run > count - i) return Error::DataTypeError;
+
+        previous += static_cast<uint32_t>(unzigzag(delta));
+        for (size_t end = i + run; i < end; ++i) values[i] = static_cast<T>(previous);
+      }
+      return Error::OK;
+    }
+
+    template<class T>
+    int32_t decode_as(string_view& in, void* data, size_t count, Codec codec) NOEXCEPT
+    {
+      T* values = static_cast<T*>(data);
+      switch (codec)
+      {
+        case Codec::Raw:
+          if (in.size() < count * sizeof(T)) return Error::ParamTooShort;
+          memcpy(data, in.data(), count * sizeof(T));
+          in.remove_prefix(static_cast<string_view::size_type>(count * sizeof(T)));
+          return Error::OK;
+        case Codec::Delta: return decode_packed(in, values, count, false);
+        case Codec::DeltaOfDelta: return decode_packed(in, values, count, true);
+        case Codec::Rle: return decode_rle(in, values, count);
+      }
+      return Error::DataTypeError;
+    }
+  }
+
+  string_view to_string(Codec codec) NOEXCEPT
+  {
+    switch (codec)
+    {
+      case Codec::Raw: return "raw";
+      case Codec::Delta: return "delta";
+      case Codec::DeltaOfDelta: return "delta-of-delta";
+      case Codec::Rle: return "rle";
+    }
+    return "unknown";
+  }
+
+  size_t max_encoded_size(size_t count, DataType type, Codec codec) NOEXCEPT
+  {
+    size_t size = eobject::type_size(type);
+    switch (codec)
+    {
+      case Codec::Raw: return count * size;
+      // Differences of 32 bit values take up to 32 bits, plus a width byte per block
+      case Codec::Delta:
+      case Codec::DeltaOfDelta: return count * sizeof(uint32_t) + (count + BlockSize - 1) / BlockSize;
+      case Codec::Rle: return count * 2 * MaxVarint;
+    }
+    return 0;
+  }
+
+  bool Encoder::put(const void* data, size_t size) NOEXCEPT
+  {
+    written_ += static_cast<int32_t>(size);
+    if (out_.sputn(static_cast<const char*>(data), static_cast<eio::size_type>(size)) == 0) return true;
+    error_ = EOF;
+    return false;
+  }
+
+  bool Encoder::flush_block() NOEXCEPT
+  {
+    if (pending_ == 0) return true;
+
+    // The width of the largest value holds every value in the block
+    uint8_t block[1 + BlockSize * sizeof(uint32_t)];
+    int     width = estd::bit_width(bits_);
+    block[0]      = static_cast<uint8_t>(width);
+    auto end      = pack(block_, pending_, width, block + 1);
+    pending_      = 0;
+    bits_         = 0;
+    return put(block, end - block);
+  }
+
+  bool Encoder::flush_run() NOEXCEPT
+  {
+    if (run_length_ == 0) return true;
+
+    uint8_t run[2 * MaxVarint];
+    auto    end = put_varint(run, run_length_);
+    end         = put_varint(end, zigzag(static_cast<int32_t>(run_value_ - previous_)));
+    previous_   = run_value_;
+    run_length_ = 0;
+    return put(run, end - run);
+  }
+
+  template<class T>
+  int32_t Encoder::write_as(const T* values, size_t count) NOEXCEPT
+  {
+    switch (codec_)
+    {
+      case Codec::Raw: put(values, count * sizeof(T)); break;
+      case Codec::Delta:
+      case Codec::DeltaOfDelta:
+      {
+        // State is kept in locals in the loop, as stores to the block could otherwise alias it
+        bool     second_order   = codec_ == Codec::DeltaOfDelta;
+        uint32_t previous       = previous_;
+        uint32_t previous_delta = previous_delta_;
+        for (size_t i = 0; i < count;)
+        {
+          size_t   n    = min(count - i, BlockSize - pending_);
+          uint32_t bits = 0;
+          for (size_t end = i + n, j = pending_; i < end; ++i, ++j)
+          {
+            uint32_t value = widen(values[i]);
+            uint32_t delta = value - previous;
+            previous       = value;
+            if (second_order)
+            {
+              uint32_t delta2 = delta - previous_delta;
+              previous_delta  = delta;
+              delta           = delta2;
+            }
+            uint32_t z  = zigzag(static_cast<int32_t>(delta));
+            block_[j]   = z;
+            bits       |= z;
+          }
+          bits_    |= bits;
+          pending_ += static_cast<uint16_t>(n);
+          if (pending_ == BlockSize && false == flush_block()) break;
+        }
+        previous_       = previous;
+        previous_delta_ = previous_delta;
+        break;
+      }
+      case Codec::Rle:
+        for (size_t i = 0; i < count; ++i)
+        {
+          uint32_t value = widen(values[i]);
+          if (run_length_ > 0 && value == run_value_)
+          {
+            ++run_length_;
+            continue;
+          }
+          if (false == flush_run()) break;
+          run_value_  = value;
+          run_length_ = 1;
+        }
+        break;
+      default: error_ = Error::DataTypeError; break;
+    }
+    return error_;
+  }
+
+  int32_t Encoder::write(const void* data, size_t count) NOEXCEPT
+  {
+    if (error_ != 0) return error_;
+    switch (type_)
+    {
+      case DataType::U8: return write_as(static_cast<const uint8_t*>(data), count);
+      case DataType::U16: return write_as(static_cast<const uint16_t*>(data), count);
+      case DataType::U32: return write_as(static_cast<const uint32_t*>(data), count);
+      case DataType::I8: return write_as(static_cast<const int8_t*>(data), count);
+      case DataType::I16: return write_as(static_cast<const int16_t*>(data), count);
+      case DataType::I32: return write_as(static_cast<const int32_t*>(data), count);
+      default: return error_ = Error::DataTypeError;
+    }
+  }
+
+  int32_t Encoder::finish() NOEXCEPT
+  {
+    if (error_ == 0) flush_block() && flush_run();
+    return error_ != 0 ? error_ : written_;
+  }
+
+  int32_t encode(eio::buffer& out, const void* data, size_t count, DataType type, Codec codec) NOEXCEPT
+  {
+    Encoder encoder(out, type, codec);
+    encoder.write(data, count);
+    return encoder.finish();
+  }
+
+  int32_t decode(string_view& in, void* data, size_t count, DataType type, Codec codec) NOEXCEPT
+  {
+    string_view column = in;
+    int32_t     e;
+    switch (type)
+    {
+      case DataType::U8: e = decode_as<uint8_t>(column, data, count, codec); break;
+      case DataType::U16: e = decode_as<uint16_t>(column, data, count, codec); break;
+      case DataType::U32: e = decode_as<uint32_t>(column, data, count, codec); break;
+      case DataType::I8: e = decode_as<int8_t>(column, data, count, codec); break;
+      case DataType::I16: e = decode_as<int16_t>(column, data, count, codec); break;
+      case DataType::I32: e = decode_as<int32_t>(column, data, count, codec); break;
+      default: e = Error::DataTypeError; break;
+    }
+    if (e == Error::OK) in = column;
+    return e;
+  }
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+/// \file ecodec.hpp
+/// Compression of integer columns, such as captured signals and traces, for export over slow links.
+/// Slowly changing signals have small differences between samples, so they are transformed into differences
+/// (delta) or differences of differences (delta-of-delta, for ramps), zig-zag encoded so small negative differences
+/// are small numbers too, and bit-packed in blocks of 128 values at the width of the largest value in each block.
+/// Signals which hold their value for long runs are better run-length encoded. All codecs are lossless, and work on
+/// the integer data types of the dictionary
+
+#include <cstddef>
+#include <cstdint>
+
+#include "estd.hpp"
+#include "eio.hpp"
+#include "eobject.hpp"
+#include "span.hpp"
+
+namespace ecodec {
+
+  using eobject::DataType;
+  using estd::string_view;
+
+  /// \brief Compression method of a column
+  enum class Codec : uint8_t
+  {
+    Raw          = 0, ///< Values as stored, in native byte order
+    Delta        = 1, ///< Bit-packed zig-zag differences from the previous value
+    DeltaOfDelta = 2, ///< Bit-packed zig-zag differences from the previous difference
+    Rle          = 3  ///< Runs of equal values, as varint run length and zig-zag varint difference from the last run
+  };
+
+  /// \brief Get name of codec
+  string_view to_string(Codec codec) NOEXCEPT;
+
+  /// \brief Number of values packed at the same bit width
+  static constexpr size_t BlockSize = 128;
+
+  /// \brief Get the largest encoded size of a column, for sizing buffers
+  size_t max_encoded_size(size_t count, DataType type, Codec codec) NOEXCEPT;
+
+  /// \brief Encoder which streams a column into a buffer, so a column can be written in pieces, e.g. from a ring
+  /// \remarks Values are packed in blocks, and runs are counted, across calls to write, so the output is the same as
+  ///          encoding the whole column at once
+  struct Encoder
+  {
+    /// \brief Create encoder of a column of values of type, which must be an integer type
+    Encoder(eio::buffer& out, DataType type, Codec codec) NOEXCEPT
+      : out_(out), type_(type), codec_(codec)
+    {}
+
+    /// \brief Append values to the column
+    /// \returns Error::OK, Error::DataTypeError if the type is not an integer type, or EOF if the buffer failed
+    int32_t write(const void* data, size_t count) NOEXCEPT;
+
+    /// \brief Write the values which are still held, ending the column
+    /// \returns Number of bytes written for the column, or a negative error as for write
+    int32_t finish() NOEXCEPT;
+
+  private:
+    template<class T>
+    int32_t write_as(const T* values, size_t count) NOEXCEPT;
+
+    /// \brief Write the pending block of packed values
+    bool flush_block() NOEXCEPT;
+
+    /// \brief Write the pending run of equal values
+    bool flush_run() NOEXCEPT;
+
+    bool put(const void* data, size_t size) NOEXCEPT;
+
+    eio::buffer& out_;
+    DataType     type_;
+    Codec        codec_;
+    int32_t      error_   = 0;
+    int32_t      written_ = 0;
+
+    uint32_t previous_       = 0; ///< Last value, or value of the last run
+    uint32_t previous_delta_ = 0;
+    uint32_t bits_           = 0; ///< Bits used by the values in the pending block
+    uint16_t pending_        = 0; ///< Number of values in the pending block
+    uint32_t block_[BlockSize];
+
+    uint32_t run_value_  = 0;
+    uint32_t run_length_ = 0;
+  };
+
+  /// \brief Encode column of values into buffer
+  /// \param data  Values, of an integer data type
+  /// \param count Number of values
+  /// \returns Number of bytes written, or a negative error as for Encoder::write
+  int32_t encode(eio::buffer& out, const void* data, size_t count, DataType type, Codec codec) NOEXCEPT;
+
+  /// \brief Decode column of values
+  /// \param in    Encoded data, which is advanced past the column, or left unchanged on error
+  /// \param data  Storage for count values of type
+  /// \returns Error::OK, or Error if the data is truncated or corrupt
+  int32_t decode(string_view& in, void* data, size_t count, DataType type, Codec codec) NOEXCEPT;
+
+  /// \brief Encode column of values into buffer
+  template<class T>
+  int32_t encode(eio::buffer& out, estd::span<const T> column, Codec codec) NOEXCEPT
+  {
+    return encode(out, column.data(), column.size(), eobject::Type_<T>::id, codec);
+  }
+
+  /// \brief Decode column of values
+  template<class T>
+  int32_t decode(string_view& in, estd::span<T> column, Codec codec) NOEXCEPT
+  {
+    return decode(in, column.begin(), column.size(), eobject::Type_<T>::id, codec);
+  }
+
+  /// \brief Map signed number to unsigned, so numbers near zero are small: 0, -1, 1, -2 map to 0, 1, 2, 3
+  constexpr uint32_t zigzag(int32_t value) NOEXCEPT
+  {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+  }
+
+  /// \brief Map zig-zag encoded number back to signed
+  constexpr int32_t unzigzag(uint32_t value) NOEXCEPT
+  {
+    return static_cast<int32_t>((value >> 1) ^ (0u - (value & 1u)));
+  }
+}
@@ -0,0 +1,308 @@
+#pragma once
+
+/// \file ecoro.hpp
+/// C++20 coroutines for asynchronous IO, run as tasks of the esched scheduler.
+/// A coroutine suspends on an awaitable operation, such as co_await ecoro::read_line(buf, input), and the scheduler
+/// resumes it when the operation can complete: when a driver signals the event the operation waits for, or when its
+/// time is due. Coroutine frames are allocated from a fixed pool, so no heap is needed.
+/// Only available when the compiler supports C++20 coroutines; the rest of the library remains C++17
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+
+#include "bit.hpp"
+#include "eio.hpp"
+#include "esched.hpp"
+
+/// \brief Size of each block in the coroutine frame pool. Frames hold the locals which live across suspensions
+#ifndef ECORO_FRAME_SIZE
+#define ECORO_FRAME_SIZE 256
+#endif
+
+/// \brief Number of blocks in the coroutine frame pool, which is the number of coroutines that can exist at once
+#ifndef ECORO_FRAME_COUNT
+#define ECORO_FRAME_COUNT 8
+#endif
+
+namespace ecoro {
+
+  using esched::tick_type;
+
+  /// \brief Fixed pool of coroutine frames, with a bit per block to mark the free blocks
+  struct FramePool
+  {
+    static_assert(ECORO_FRAME_COUNT > 0 && ECORO_FRAME_COUNT <= 32, "ECORO_FRAME_COUNT must be between 1 and 32");
+
+    /// \brief Allocate a frame
+    /// \returns Pointer to frame, or nullptr if the frame is too large or the pool is exhausted
+    static void* allocate(size_t size) NOEXCEPT
+    {
+      if(size > ECORO_FRAME_SIZE || free_ == 0) return nullptr;
+      int block = estd::countr_zero(free_);
+      free_ &= ~(uint32_t(1) << block);
+      return blocks_[block].data;
+    }
+
+    /// \brief Return a frame to the pool
+    static void release(void* frame) NOEXCEPT
+    {
+      auto block = static_cast<size_t>(static_cast<Block*>(frame) - blocks_);
+      free_ |= uint32_t(1) << block;
+    }
+
+    /// \brief Get number of free frames
+    static int available() NOEXCEPT { return estd::popcount(free_); }
+
+  private:
+    struct Block
+    {
+      alignas(std::max_align_t) unsigned char data[ECORO_FRAME_SIZE];
+    };
+
+    static inline Block    blocks_[ECORO_FRAME_COUNT];
+    static inline uint32_t free_ = ECORO_FRAME_COUNT == 32 ? ~uint32_t(0) : (uint32_t(1) << ECORO_FRAME_COUNT) - 1;
+  };
+
+  /// \brief Base class of operations a coroutine can wait for
+  /// \remarks The coroutine stays suspended, and its task sleeps, until ready returns true
+  struct Awaiter
+  {
+    /// \brief Check if the operation has completed, and complete it if it can be done without blocking
+    /// \param signalled True if the task was woken by the event returned from wait, rather than by a timeout
+    virtual bool ready(bool signalled) NOEXCEPT = 0;
+
+    /// \brief Get condition for the scheduler to wait for before checking again
+    virtual esched::Wait wait() NOEXCEPT = 0;
+
+    /// \brief Suspend the coroutine when the operation has not completed straight away
+    bool await_ready() NOEXCEPT { return ready(false); }
+    template<class Promise>
+    void await_suspend(std::coroutine_handle<Promise> handle) NOEXCEPT { handle.promise().awaiter = this; }
+  };
+
+  /// \brief Coroutine, which is run as a task of the scheduler
+  /// \remarks Functions returning Coroutine may use co_await on the operations below, and co_return to finish.
+  ///          The coroutine starts when it is added to a scheduler, and its frame is freed when it is destroyed.
+  ///          If the frame pool is exhausted, the coroutine is not valid, and finishes without running. A coroutine
+  ///          may be destroyed once it has finished or been removed from its scheduler, outside of a step
+  struct Coroutine final : esched::Task
+  {
+    struct promise_type
+    {
+      Awaiter* awaiter = nullptr; ///< Operation the coroutine is suspended on, or nullptr to run on the next pass
+
+      Coroutine get_return_object() NOEXCEPT
+      {
+        return Coroutine(std::coroutine_handle<promise_type>::from_promise(*this));
+      }
+      static Coroutine get_return_object_on_allocation_failure() NOEXCEPT { return Coroutine(nullptr); }
+
+      // Frames have to be allocated by a non-throwing function, so that allocation failure can be detected
+      static void* operator new(size_t size) noexcept { return FramePool::allocate(size); }
+      static void operator delete(void* frame) NOEXCEPT { FramePool::release(frame); }
+
+      std::suspend_always initial_suspend() NOEXCEPT { return {}; }
+      std::suspend_always final_suspend() noexcept { return {}; }
+      void return_void() NOEXCEPT {}
+      void unhandled_exception() NOEXCEPT {}
+    };
+
+    Coroutine(Coroutine&& other) NOEXCEPT
+      : handle_(other.handle_)
+    {
+      other.handle_ = nullptr;
+    }
+
+    Coroutine(const Coroutine&) = delete;
+    Coroutine& operator=(const Coroutine&) = delete;
+
+    ~Coroutine()
+    {
+      if(handle_) handle_.destroy();
+    }
+
+    /// \brief Check if the coroutine frame was allocated
+    bool valid() const NOEXCEPT { return static_cast<bool>(handle_); }
+
+    /// \brief Check if the coroutine has returned
+    bool done() const NOEXCEPT { return false == valid() || handle_.done(); }
+
+    esched::Wait step(esched::Scheduler&) NOEXCEPT
+    {
+      if(done()) return esched::Wait::done();
+
+      auto& promise = handle_.promise();
+      if(promise.awaiter != nullptr && false == promise.awaiter->ready(signalled())) return promise.awaiter->wait();
+
+      // Run until the next suspension, which sets the operation to wait for
+      promise.awaiter = nullptr;
+      handle_.resume();
+
+      if(handle_.done()) return esched::Wait::done();
+      return promise.awaiter != nullptr ? promise.awaiter->wait() : esched::Wait::yield();
+    }
+
+  private:
+    explicit Coroutine(std::coroutine_handle<promise_type> handle) NOEXCEPT
+      : handle_(handle)
+    {}
+
+    std::coroutine_handle<promise_type> handle_;
+  };
+
+  /// \brief Operation which waits for a time, returned from sleep
+  struct SleepAwaiter final : Awaiter
+  {
+    explicit SleepAwaiter(tick_type ms) NOEXCEPT : ms_(ms) {}
+
+    bool ready(bool) NOEXCEPT { return slept_; }
+    esched::Wait wait() NOEXCEPT { slept_ = true; return esched::Wait::sleep(ms_); }
+    void await_resume() NOEXCEPT {}
+
+  private:
+    tick_type ms_;
+    bool      slept_ = false;
+  };
+
+  /// \brief Operation which waits for an event, returned from wait
+  struct EventAwaiter final : Awaiter
+  {
+    EventAwaiter(const esched::Event& event, int32_t timeout_ms) NOEXCEPT : event_(event), timeout_(timeout_ms) {}
+
+    bool ready(bool signalled) NOEXCEPT { signalled_ = signalled; return waited_; }
+    esched::Wait wait() NOEXCEPT
+    {
+      waited_ = true;
+      return timeout_ < 0 ? esched::Wait::on(event_) : esched::Wait::on(event_, static_cast<tick_type>(timeout_));
+    }
+
+    /// \returns True if the event was signalled, false on timeout
+    bool await_resume() NOEXCEPT { return signalled_; }
+
+  private:
+    const esched::Event& event_;
+    int32_t              timeout_;
+    bool                 waited_    = false;
+    bool                 signalled_ = false;
+  };
+
+  /// \brief Operation which reads a line from a buffer, returned from read_line
+  struct ReadLineAwaiter final : Awaiter
+  {
+    ReadLineAwaiter(eio::buffer& buf, const esched::Event& input) NOEXCEPT : buf_(buf), input_(input) {}
+
+    bool ready(bool) NOEXCEPT
+    {
+      int status = buf_.poll();
+      line_      = buf_.get_next_token(eio::isendline);
+      if(false == line_.empty()) return true;
+
+      if(status < 0)
+      {
+        // Buffer is full without a complete line, so the line can never be completed
+        buf_.gflush();
+        return true;
+      }
+
+      if(buf_.closed())
+      {
+        // No more input will arrive, so the rest of the input is the last line, even without an end of line
+        line_ = buf_.get();
+        buf_.gflush();
+        return true;
+      }
+      return false;
+    }
+
+    esched::Wait wait() NOEXCEPT { return esched::Wait::on(input_); }
+
+    /// \returns Line without the end of line, or empty if the buffer overflowed or the input closed after the last
+    ///          line. The view is valid until the buffer is next polled
+    eio::string_view await_resume() NOEXCEPT { return line_; }
+
+  private:
+    eio::buffer&         buf_;
+    const esched::Event& input_;
+    eio::string_view     line_;
+  };
+
+  /// \brief Operation which flushes a buffer, returned from flush
+  struct FlushAwaiter final : Awaiter
+  {
+    FlushAwaiter(eio::buffer& buf, const esched::Event* writable) NOEXCEPT : buf_(buf), writable_(writable) {}
+
+    bool ready(bool) NOEXCEPT { return buf_.flush(0) >= 0; }
+
+    /// \remarks Drivers without an event for space to write are retried every millisecond
+    esched::Wait wait() NOEXCEPT
+    {
+      return writable_ != nullptr ? esched::Wait::on(*writable_) : esched::Wait::sleep(1);
+    }
+
+    void await_resume() NOEXCEPT {}
+
+  private:
+    eio::buffer&         buf_;
+    const esched::Event* writable_;
+  };
+
+  /// \brief Operation which flushes a buffer and waits for the device to finish writing, returned from sync
+  struct SyncAwaiter final : Awaiter
+  {
+    SyncAwaiter(eio::IODevice& device, const esched::Event* writable) NOEXCEPT
+      : device_(device), writable_(writable)
+    {}
+
+    bool ready(bool) NOEXCEPT { return device_.getbuf().flush(0) >= 0 && device_.sync(0) >= 0; }
+
+    esched::Wait wait() NOEXCEPT
+    {
+      return writable_ != nullptr ? esched::Wait::on(*writable_) : esched::Wait::sleep(1);
+    }
+
+    void await_resume() NOEXCEPT {}
+
+  private:
+    eio::IODevice&       device_;
+    const esched::Event* writable_;
+  };
+
+  /// \brief Suspend coroutine for a time
+  inline SleepAwaiter sleep(tick_type ms) NOEXCEPT { return SleepAwaiter(ms); }
+
+  /// \brief Suspend coroutine until event is next signalled
+  inline EventAwaiter wait(const esched::Event& event) NOEXCEPT { return EventAwaiter(event, -1); }
+
+  /// \brief Suspend coroutine until event is next signalled, or a timeout
+  /// \returns True if the event was signalled, false on timeout
+  inline EventAwaiter wait(const esched::Event& event, tick_type timeout_ms) NOEXCEPT
+  {
+    return EventAwaiter(event, static_cast<int32_t>(timeout_ms));
+  }
+
+  /// \brief Read a line from buffer, suspending until a complete line has arrived
+  /// \param input Event signalled by the driver when input arrives
+  inline ReadLineAwaiter read_line(eio::buffer& buf, const esched::Event& input) NOEXCEPT
+  {
+    return ReadLineAwaiter(buf, input);
+  }
+
+  /// \brief Flush buffer, suspending while the device is not ready to write
+  /// \param writable Event signalled by the driver when it can write again, or nullptr to retry periodically
+  inline FlushAwaiter flush(eio::buffer& buf, const esched::Event* writable = nullptr) NOEXCEPT
+  {
+    return FlushAwaiter(buf, writable);
+  }
+
+  /// \brief Flush device buffer, and suspend until the device has finished writing
+  /// \param writable Event signalled by the driver when it can write again, or nullptr to retry periodically
+  inline SyncAwaiter sync(eio::IODevice& device, const esched::Event* writable = nullptr) NOEXCEPT
+  {
+    return SyncAwaiter(device, writable);
+  }
+}
+
+#endif
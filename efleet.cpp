@@ -0,0 +1,241 @@
+/// \file efleet.cpp
+/// \brief Implementation of the work stealing pool, and of bulk operations over many dictionaries
+
+#include "efleet.hpp"
+
+#include <algorithm>
+
+#include "eio_buffer.hpp"
+#include "epatch.hpp"
+
+namespace efleet {
+
+  namespace {
+
+    typedef eobject::Object Object;
+    typedef eobject::Error  Error;
+
+    /// \brief Range of subindices holding values: 0 for variables, 1 to the number of children otherwise
+    void value_range(const Object& object, unsigned& first, unsigned& last) NOEXCEPT
+    {
+      const Object::Info& info = object.info();
+      first                    = info.otype == Object::ClassId::Variable ? 0 : 1;
+      last                     = info.otype == Object::ClassId::Variable ? 0 : info.nelem;
+    }
+
+    /// \brief Driver collecting everything written to its buffer into a string
+    struct string_driver final : public eio::IODevice::Driver
+    {
+      string_driver(std::string& out)
+        : output(out)
+        , buffer_(*this)
+      {}
+
+      int write(const void* data, uint16_t count) NOEXCEPT override
+      {
+        output.append(static_cast<const char*>(data), count);
+        return count;
+      }
+
+      int read(void*, uint16_t) NOEXCEPT override { return 0; }
+
+      int sync(int timeout) NOEXCEPT override { return timeout; }
+
+      eio::buffer& getbuf() NOEXCEPT override { return buffer_; }
+
+    private:
+      std::string&                          output;
+      eio::iobuffer<string_driver, 256, 16> buffer_;
+    };
+
+    /// \brief Concatenate the results of each device, in device order
+    template<class T>
+    std::vector<T> merge(std::vector<std::vector<T>>& results)
+    {
+      size_t total = 0;
+      for (auto& r : results) total += r.size();
+      std::vector<T> merged;
+      merged.reserve(total);
+      for (auto& r : results) merged.insert(merged.end(), r.begin(), r.end());
+      return merged;
+    }
+  }
+
+  Pool::Pool(unsigned threads)
+    : ranges_(threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency()))
+  {
+    threads_.reserve(ranges_.size() - 1);
+    for (unsigned worker = 1; worker < ranges_.size(); ++worker) threads_.emplace_back(&Pool::loop, this, worker);
+  }
+
+  Pool::~Pool()
+  {
+    {
+      std::lock_guard<std::mutex> guard(lock_);
+      stop_ = true;
+    }
+    start_.notify_all();
+    for (auto& t : threads_) t.join();
+  }
+
+  void Pool::run(size_t count, Function function, void* context)
+  {
+    if (count == 0) return;
+    const size_t n = ranges_.size();
+    if (n == 1 || count == 1)
+    {
+      for (size_t i = 0; i < count; ++i) function(context, i, 0);
+      return;
+    }
+
+    for (size_t w = 0; w < n; ++w)
+    {
+      std::lock_guard<std::mutex> guard(ranges_[w].lock);
+      ranges_[w].begin = count * w / n;
+      ranges_[w].end   = count * (w + 1) / n;
+    }
+
+    {
+      std::lock_guard<std::mutex> guard(lock_);
+      function_ = function;
+      context_  = context;
+      busy_     = static_cast<unsigned>(n - 1);
+      ++generation_;
+    }
+    start_.notify_all();
+
+    work(0);
+
+    std::unique_lock<std::mutex> guard(lock_);
+    done_.wait(guard, [this] { return busy_ == 0; });
+  }
+
+  void Pool::loop(unsigned worker)
+  {
+    uint64_t seen = 0;
+    for (;;)
+    {
+      {
+        std::unique_lock<std::mutex> guard(lock_);
+        start_.wait(guard, [&] { return stop_ || generation_ != seen; });
+        if (stop_) return;
+        seen = generation_;
+      }
+
+      work(worker);
+
+      std::lock_guard<std::mutex> guard(lock_);
+      if (--busy_ == 0) done_.notify_one();
+    }
+  }
+
+  void Pool::work(unsigned worker)
+  {
+    size_t index;
+    do
+    {
+      while (take(worker, index)) function_(context_, index, worker);
+    } while (steal(worker));
+  }
+
+  bool Pool::take(unsigned worker, size_t& index)
+  {
+    Range&                      own = ranges_[worker];
+    std::lock_guard<std::mutex> guard(own.lock);
+    if (own.begin == own.end) return false;
+    index = own.begin++;
+    return true;
+  }
+
+  bool Pool::steal(unsigned worker)
+  {
+    for (;;)
+    {
+      // Pick the thread with the most indices left, so each steal takes as much work as possible
+      size_t victim = ranges_.size(), most = 0;
+      for (size_t w = 0; w < ranges_.size(); ++w)
+      {
+        if (w == worker) continue;
+        std::lock_guard<std::mutex> guard(ranges_[w].lock);
+        size_t                      left = ranges_[w].end - ranges_[w].begin;
+        if (left > most)
+        {
+          most   = left;
+          victim = w;
+        }
+      }
+      if (victim == ranges_.size()) return false;
+
+      size_t begin, end;
+      {
+        Range&                      from = ranges_[victim];
+        std::lock_guard<std::mutex> guard(from.lock);
+        // The victim may have taken its last indices since it was picked
+        if (from.begin == from.end) continue;
+        end      = from.end;
+        begin    = from.begin + (from.end - from.begin) / 2;
+        from.end = begin;
+      }
+
+      // Stolen indices are held only by this thread until placed in its range, and so are never lost
+      Range&                      own = ranges_[worker];
+      std::lock_guard<std::mutex> guard(own.lock);
+      own.begin = begin;
+      own.end   = end;
+      return true;
+    }
+  }
+
+  void validate(const Dictionary& dictionary, uint32_t device, std::vector<Issue>& issues)
+  {
+    for (const auto& item : dictionary)
+    {
+      unsigned first, last;
+      value_range(item.object, first, last);
+      for (unsigned subIdx = first; subIdx <= last; ++subIdx)
+      {
+        int32_t error = item.object.validate(static_cast<uint8_t>(subIdx));
+        if (error == Error::ValueTooLow || error == Error::ValueTooHigh)
+          issues.push_back(Issue{ device, item.address, static_cast<uint8_t>(subIdx), error });
+      }
+    }
+  }
+
+  void diff(const Dictionary& dictionary, const Dictionary& other, uint32_t device,
+            std::vector<Difference>& differences)
+  {
+    epatch::compare(dictionary, other, [&](const Dictionary::Item& item, const Object*, uint8_t subIdx) {
+      differences.push_back(Difference{ device, item.address, subIdx });
+    });
+  }
+
+  std::vector<Issue> validate(Pool& pool, estd::span<const Dictionary* const> devices)
+  {
+    std::vector<std::vector<Issue>> results(devices.size());
+    auto body = [&](size_t i, unsigned) { validate(*devices[i], static_cast<uint32_t>(i), results[i]); };
+    pool.run(devices.size(), body);
+    return merge(results);
+  }
+
+  std::vector<Difference> diff(Pool& pool, estd::span<const Dictionary* const> devices,
+                               estd::span<const Dictionary* const> others)
+  {
+    const size_t                         count = std::min(devices.size(), others.size());
+    std::vector<std::vector<Difference>> results(count);
+    auto body = [&](size_t i, unsigned) { diff(*devices[i], *others[i], static_cast<uint32_t>(i), results[i]); };
+    pool.run(count, body);
+    return merge(results);
+  }
+
+  std::vector<std::string> snapshot(Pool& pool, estd::span<const Dictionary* const> devices, ecbor::Keys keys)
+  {
+    std::vector<std::string> results(devices.size());
+    auto                     body = [&](size_t i, unsigned) {
+      string_driver driver(results[i]);
+      if (ecbor::encode(driver.getbuf(), *devices[i], keys) != 0) results[i].clear();
+      else driver.getbuf().sync(0);
+    };
+    pool.run(devices.size(), body);
+    return results;
+  }
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+/// \file efleet.hpp
+/// Bulk operations over many object dictionaries on a host, e.g. one dictionary per device image when commissioning
+/// a fleet. Devices are spread over a pool of threads, which steal work from each other so devices which take longer
+/// do not hold up the rest. Each device's results are kept apart while running and merged in device order, so results
+/// are the same whatever the number of threads. Host only: uses threads and the heap
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ecbor.hpp"
+#include "eobject.hpp"
+#include "epatch.hpp"
+#include "span.hpp"
+
+namespace efleet {
+
+  using eobject::Dictionary;
+
+  /// \brief Pool of worker threads running parallel loops over indices
+  struct Pool
+  {
+    /// \brief Function run for each index, on the worker numbered worker
+    typedef void (*Function)(void* context, size_t index, unsigned worker);
+
+    /// \brief Create pool
+    /// \param threads Number of threads taking part in loops, including the caller of run, or 0 for one per core
+    explicit Pool(unsigned threads = 0);
+    ~Pool();
+
+    Pool(const Pool&)            = delete;
+    Pool& operator=(const Pool&) = delete;
+
+    /// \brief Get number of threads taking part in loops, including the caller of run
+    unsigned size() const NOEXCEPT { return static_cast<unsigned>(ranges_.size()); }
+
+    /// \brief Run function for every index in [0, count), returning when all have finished
+    /// \remarks Indices are split evenly between threads, and a thread which runs out takes the upper half of the
+    ///          largest remaining share. Loops may not be nested or run concurrently on one pool
+    void run(size_t count, Function function, void* context);
+
+    /// \brief Run body(index, worker) for every index in [0, count)
+    template<class Body>
+    void run(size_t count, Body& body)
+    {
+      run(count, [](void* context, size_t index, unsigned worker) { (*static_cast<Body*>(context))(index, worker); },
+          &body);
+    }
+
+  private:
+    /// \brief Indices not yet taken by a thread
+    struct Range
+    {
+      std::mutex lock;
+      size_t     begin = 0;
+      size_t     end   = 0;
+    };
+
+    void work(unsigned worker);
+    bool take(unsigned worker, size_t& index);
+    bool steal(unsigned worker);
+    void loop(unsigned worker);
+
+    std::vector<Range>       ranges_;
+    std::vector<std::thread> threads_;
+
+    std::mutex              lock_;
+    std::condition_variable start_;
+    std::condition_variable done_;
+    uint64_t                generation_ = 0;
+    unsigned                busy_       = 0; ///< Number of workers still in the current loop
+    bool                    stop_       = false;
+
+    Function function_ = nullptr;
+    void*    context_  = nullptr;
+  };
+
+  /// \brief Value found out of range by validate
+  struct Issue
+  {
+    uint32_t device;  ///< Index of device
+    uint16_t address; ///< Address of object
+    uint8_t  subIdx;  ///< Subindex of value
+    int32_t  error;   ///< Error::ValueTooLow or Error::ValueTooHigh
+
+    bool operator==(const Issue& other) const NOEXCEPT
+    {
+      return device == other.device && address == other.address && subIdx == other.subIdx && error == other.error;
+    }
+  };
+
+  /// \brief Value which differs between two devices, found by diff
+  struct Difference
+  {
+    /// \brief Subindex reported for an object which is missing from the other device, or has a different layout
+    static constexpr uint8_t WholeObject = epatch::WholeObject;
+
+    uint32_t device;  ///< Index of device pair
+    uint16_t address; ///< Address of object
+    uint8_t  subIdx;  ///< Subindex of value, or WholeObject
+
+    bool operator==(const Difference& other) const NOEXCEPT
+    {
+      return device == other.device && address == other.address && subIdx == other.subIdx;
+    }
+  };
+
+  /// \brief Check every value of a dictionary against the range in its metadata
+  /// \param device Device index recorded in issues
+  void validate(const Dictionary& dictionary, uint32_t device, std::vector<Issue>& issues);
+
+  /// \brief Find values of a dictionary which differ from those in another with the same objects
+  /// \remarks Objects are matched by address as by epatch::compare, and values compared byte for byte. Objects only
+  ///          in other are not reported
+  void diff(const Dictionary& dictionary, const Dictionary& other, uint32_t device,
+            std::vector<Difference>& differences);
+
+  /// \brief Check every value of every device, in parallel
+  /// \returns Issues ordered by device, then by address and subindex
+  std::vector<Issue> validate(Pool& pool, estd::span<const Dictionary* const> devices);
+
+  /// \brief Compare each device with the device at the same index in others, in parallel
+  /// \returns Differences ordered by device, then by address and subindex
+  std::vector<Difference> diff(Pool& pool, estd::span<const Dictionary* const> devices,
+                               estd::span<const Dictionary* const> others);
+
+  /// \brief Encode every device as CBOR, in parallel
+  /// \returns Encoded dictionary of each device, or an empty string for devices which failed to encode
+  std::vector<std::string> snapshot(Pool& pool, estd::span<const Dictionary* const> devices,
+                                    ecbor::Keys keys = ecbor::Keys::Indices);
+}
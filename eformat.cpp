@@ -1,6 +1,16 @@
 #include "eformat.hpp"
 
-#include <arm_acle.h> // __clz intrinsic
+#include "bit.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <limits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+/// \brief SSSE3 shuffles may be used to encode hex when the processor has them
+#define ESTD_HEX_SSSE3 1
+#include <tmmintrin.h>
+#endif
 
 namespace {
   using namespace eformat;
@@ -20,15 +30,20 @@ namespace {
     }
     
     
+  #ifdef __ICCARM__
   __FORCEINLINE
   template<class T>
   T max(const T l, const T r)  NOEXCEPT
+  #else
+  template<class T>
+  __FORCEINLINE T max(const T l, const T r)  NOEXCEPT
+  #endif
   {
     return l > r ? l : r;
   }
   
-  template<class T>
-    T abs(T value)  NOEXCEPT { return value > 0 ? value : -value; }
+  /// \brief Check for decimal digit, safe for any char value unlike std::isdigit
+  constexpr bool isdigit(char_type c)  NOEXCEPT { return c >= '0' && c <= '9'; }
   
   inline constexpr uint32_t pow10(uint32_t value)  NOEXCEPT
   {
@@ -42,12 +57,13 @@ namespace {
     uint8_t number;
   };
   
-  uint32_t constexpr digits(uint32_t v)  NOEXCEPT
+  /// \brief Count decimal digits of value the slow way, for building tables
+  template<class T>
+  constexpr uint8_t count_digits(T v)  NOEXCEPT
   {
-     return 1 + ((v >= 1000000000u) ? 9 : (v >= 100000000u) ? 8 : 
-                (v >= 10000000u) ? 7 : (v >= 1000000u) ? 6 : 
-                (v >= 100000u) ? 5 : (v >= 10000u) ? 4 :
-                (v >= 1000u) ? 3 : (v >= 100u) ? 2 : (v >= 10u) ? 1u : 0u); 
+    uint8_t n = 1;
+    while(v >= 10U) { v /= 10U; ++n; }
+    return n;
   }
   
    static constexpr uint32_t digit_values[] = {
@@ -64,56 +80,42 @@ namespace {
        1000000000  
    };
    
-   static constexpr uint8_t digits_by_leading_zeroes[] = {
-       digits(UINT32_MAX),
-       digits(UINT32_MAX >> 1),
-       digits(UINT32_MAX >> 2),
-       digits(UINT32_MAX >> 3),
-       digits(UINT32_MAX >> 4),
-       digits(UINT32_MAX >> 5),
-       digits(UINT32_MAX >> 6),
-       digits(UINT32_MAX >> 7),
-       digits(UINT32_MAX >> 8),
-       digits(UINT32_MAX >> 9),
-       digits(UINT32_MAX >> 10),
-       digits(UINT32_MAX >> 11),
-       digits(UINT32_MAX >> 12),
-       digits(UINT32_MAX >> 13),
-       digits(UINT32_MAX >> 14),
-       digits(UINT32_MAX >> 15),
-       digits(UINT32_MAX >> 16),
-       digits(UINT32_MAX >> 17),
-       digits(UINT32_MAX >> 18),
-       digits(UINT32_MAX >> 19),
-       digits(UINT32_MAX >> 20),
-       digits(UINT32_MAX >> 21),
-       digits(UINT32_MAX >> 22),
-       digits(UINT32_MAX >> 23),
-       digits(UINT32_MAX >> 24),
-       digits(UINT32_MAX >> 25),
-       digits(UINT32_MAX >> 26),
-       digits(UINT32_MAX >> 27),
-       digits(UINT32_MAX >> 28),
-       digits(UINT32_MAX >> 29),
-       digits(UINT32_MAX >> 30),
-       digits(UINT32_MAX >> 31),
-       1
-     };
+   /// \brief Upper estimate of the number of decimal digits for each count of leading zeroes in T.
+   /// The estimate is at most one too high, which get_digits corrects by comparing with digit_values
+   template<class T>
+   struct digits_by_leading_zeroes
+   {
+     static constexpr int bits = std::numeric_limits<T>::digits;
+     
+     uint8_t digits[bits + 1];
+     
+     constexpr digits_by_leading_zeroes() NOEXCEPT
+       : digits()
+     {
+       for(int zeroes = 0; zeroes < bits; ++zeroes)
+       {
+         digits[zeroes] = count_digits(static_cast<T>(~T(0) >> zeroes));
+       }
+       digits[bits] = 1;
+     }
+     
+     constexpr uint8_t operator[](int zeroes) const NOEXCEPT { return digits[zeroes]; }
+   };
+   
+   static constexpr digits_by_leading_zeroes<uint32_t> digits_by_leading_zeroes32;
+   
    constexpr int16_t get_digits(uint32_t value)  NOEXCEPT
    { 
      // Estimate number of digits by counting leading zeroes
-     uint8_t digits = digits_by_leading_zeroes[__clz(value)];
+     uint8_t digits = digits_by_leading_zeroes32[estd::countl_zero(value)];
      
      if(digits > 1 && value < digit_values[digits]) --digits;
      return digits;
    }
    
-    constexpr int16_t get_digits(int32_t value)  NOEXCEPT
-    {
-      // Add sign digit
-      return get_digits(static_cast<uint32_t>(abs(value))) + 1;
-    }
-    
+   static_assert(get_digits(0U) == 1 && get_digits(9U) == 1 && get_digits(10U) == 2 && get_digits(999999999U) == 9
+                 && get_digits(1000000000U) == 10 && get_digits(UINT32_MAX) == 10, "get_digits is incorrect");
+   
      
    struct field_formatter 
    {
@@ -122,9 +124,12 @@ namespace {
      uint16_t rpad_width; 
    };
    
-  field_formatter format_field(char* out, Options fmt, uint32_t actual_width)  NOEXCEPT
+  /// \brief Write left padding of field, and calculate right padding
+  /// \param size Space available at out, the field is truncated to fit
+  field_formatter format_field(char* out, uint32_t size, Options fmt, uint32_t actual_width)  NOEXCEPT
   {   
-    uint32_t field_width = fmt.width > 0 ? fmt.width : actual_width;
+    uint32_t field_width = fmt.width > actual_width ? fmt.width : actual_width;
+    if(field_width > size) field_width = size;
     
     field_formatter f;
       
@@ -145,7 +150,7 @@ namespace {
       else if(fmt.align == eformat::Align::Center)
       {
         pad_left = total_pad/2U;
-        f.rpad_width = total_pad/2U+1U;
+        f.rpad_width = total_pad - pad_left;
       }
       else
       {
@@ -156,16 +161,29 @@ namespace {
     return f;
   }
   
-  int do_format_decimal(char* out, uint32_t value, Options fmt, int16_t digits, char sign)  NOEXCEPT
+  /// \brief Write value padded to field width directly to buffer, so the width is not limited by a temporary buffer
+  int write_field(buffer& buf, const char_type* data, uint32_t size, Options fmt)  NOEXCEPT
   {
-    auto field = format_field(out, fmt, digits);
-    digits = field.cwidth;
+    uint32_t total_pad = fmt.width > size ? fmt.width - size : 0;
+    uint32_t pad_left  = fmt.align == Align::Right ? total_pad : fmt.align == Align::Center ? total_pad/2U : 0;
     
-    if(sign != '\0')
+    int status = 0;
+    for(uint32_t i = 0; i < pad_left; ++i) if(buf.sputc(' ') < 0) status = EOF;
+    if(buf.sputn(data, size) < 0) status = EOF;
+    for(uint32_t i = pad_left; i < total_pad; ++i) if(buf.sputc(' ') < 0) status = EOF;
+    return status;
+  }
+  
+  char* do_format_decimal(char* out, uint32_t value, int16_t digits, char sign)  NOEXCEPT
+  {
+    if(sign != '\0' && digits > 0)
     { 
       *out++ = sign; --digits;
     }
     
+    // Keep the least significant digits if the field was truncated
+    if(digits < 10) value = value % digit_values[digits + 1];
+    
     // print out digits in descenting order until we hit 0
     while(digits > 0)
     {
@@ -174,23 +192,212 @@ namespace {
       value = value % dvalue;
     }
     
-    fill(out, field.rpad_width, ' ');
+    return out;
+  }
+  /// \brief Write value with the decimal point decimals digits from the right, and at least one digit before it
+  char* do_format_fixed(char* out, uint32_t value, uint8_t decimals, char sign)  NOEXCEPT
+  {
+    if(decimals > 9) decimals = 9;
+    if(sign != '\0') *out++ = sign;
     
-    return digits;
+    const uint32_t scale = digit_values[decimals + 1];
+    const uint32_t whole = value / scale;
+    out = do_format_decimal(out, whole, get_digits(whole), '\0');
+    if(decimals > 0)
+    {
+      *out++ = '.';
+      out = do_format_decimal(out, value % scale, decimals, '\0');
+    }
+    return out;
+  }
+  
+  /// \brief Write formatted text into a field, truncating it to the space available
+  int copy_field(char* out, uint16_t size, const char* text, uint32_t width, Options fmt)  NOEXCEPT
+  {
+    if(width > size) width = size;
+    auto field = format_field(out, size, fmt, width);
+    memcpy(field.out, text, width);
+    field.out = fill(field.out + width, field.rpad_width, ' ');
+    return field.out - out;
+  }
+  
+  /// \brief Pairs of hex digits for every byte value, so bytes are encoded with one lookup each
+  struct HexTables
+  {
+    char    pairs[256][2];
+    uint8_t values[256]; ///< Value of each hex digit character, or 0xFF for other characters
+    
+    static constexpr char digit(unsigned value) NOEXCEPT { return value < 10 ? '0' + value : 'A' + (value - 10); }
+    
+    constexpr HexTables() NOEXCEPT : pairs{}, values{}
+    {
+      for(unsigned i = 0; i < 256; ++i)
+      {
+        pairs[i][0] = digit(i >> 4);
+        pairs[i][1] = digit(i & 0xF);
+        values[i]   = i >= '0' && i <= '9' ? i - '0' : i >= 'A' && i <= 'F' ? i - 'A' + 10 :
+                      i >= 'a' && i <= 'f' ? i - 'a' + 10 : 0xFF;
+      }
+    }
+  };
+  
+  constexpr HexTables hex_tables;
+  
+  char* encode_hex_table(char* out, const uint8_t* data, size_t size) NOEXCEPT
+  {
+    for(; size > 0; --size, out += 2) memcpy(out, hex_tables.pairs[*data++], 2);
+    return out;
+  }
+  
+#if defined(ESTD_HEX_SSSE3)
+  /// \brief Encode 16 bytes at a time, looking up the digits of every nibble with one shuffle
+  __attribute__((target("ssse3"))) char* encode_hex_ssse3(char* out, const uint8_t* data, size_t size) NOEXCEPT
+  {
+    const __m128i digits = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F');
+    const __m128i low    = _mm_set1_epi8(0x0F);
+    for(; size >= 16; size -= 16, data += 16, out += 32)
+    {
+      __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+      __m128i hi    = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(bytes, 4), low));
+      __m128i lo    = _mm_shuffle_epi8(digits, _mm_and_si128(bytes, low));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(hi, lo));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+    return encode_hex_table(out, data, size);
+  }
+  
+  typedef char* (*encode_hex_function)(char* out, const uint8_t* data, size_t size);
+  
+  char* encode_hex_resolve(char* out, const uint8_t* data, size_t size) NOEXCEPT;
+  
+  /// \brief Implementation used by encode_hex, chosen on the first call
+  std::atomic<encode_hex_function> encode_hex_selected{ encode_hex_resolve };
+  
+  char* encode_hex_resolve(char* out, const uint8_t* data, size_t size) NOEXCEPT
+  {
+    __builtin_cpu_init();
+    const encode_hex_function f = __builtin_cpu_supports("ssse3") ? encode_hex_ssse3 : encode_hex_table;
+    encode_hex_selected.store(f, std::memory_order_relaxed);
+    return f(out, data, size);
+  }
+#endif
+  
+  /// \brief Write two hex digits for each byte, without bounds checks
+  char* encode_hex(char* out, const uint8_t* data, size_t size) NOEXCEPT
+  {
+#if defined(ESTD_HEX_SSSE3)
+    // Short values are not worth the indirect call
+    if(size >= 16) return encode_hex_selected.load(std::memory_order_relaxed)(out, data, size);
+#endif
+    return encode_hex_table(out, data, size);
+  }
+  
+  /// \brief Decode up to pairs pairs of hex digits, stopping at the first pair with a character which is not a digit
+  /// \returns Number of bytes decoded
+  size_t decode_hex_table(uint8_t* out, const char* in, size_t pairs) NOEXCEPT
+  {
+    const auto& values = hex_tables.values;
+    size_t count = 0;
+    for(; count < pairs; ++count, in += 2)
+    {
+      uint8_t hi = values[static_cast<uint8_t>(in[0])];
+      uint8_t lo = values[static_cast<uint8_t>(in[1])];
+      if(((hi | lo) & 0x80) != 0) break;
+      out[count] = static_cast<uint8_t>(hi << 4 | lo);
+    }
+    return count;
+  }
+  
+#if defined(ESTD_HEX_SSSE3)
+  /// \brief Convert 16 hex digits to their values, clearing valid for any character which is not a digit
+  __attribute__((target("ssse3"))) __m128i hex_values_ssse3(__m128i chars, __m128i& valid) NOEXCEPT
+  {
+    // Characters are digits if subtracting the first digit leaves at most the last, compared unsigned with min
+    const __m128i digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    const __m128i alpha = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    const __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    const __m128i is_alpha = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+    valid = _mm_and_si128(valid, _mm_or_si128(is_digit, is_alpha));
+    return _mm_or_si128(_mm_and_si128(is_digit, digit),
+                        _mm_and_si128(is_alpha, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+  }
+  
+  /// \brief Decode 16 bytes at a time, combining each pair of digit values with one multiply-add
+  __attribute__((target("ssse3"))) size_t decode_hex_ssse3(uint8_t* out, const char* in, size_t pairs) NOEXCEPT
+  {
+    const __m128i weights = _mm_set1_epi16(0x0110);
+    size_t count = 0;
+    for(; pairs - count >= 16; count += 16, in += 32)
+    {
+      __m128i valid = _mm_set1_epi8(-1);
+      __m128i first  = hex_values_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)), valid);
+      __m128i second = hex_values_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16)), valid);
+      // The block with the end of the digits is left to the table, which finds where they stop
+      if(_mm_movemask_epi8(valid) != 0xFFFF) break;
+      __m128i bytes = _mm_packus_epi16(_mm_maddubs_epi16(first, weights), _mm_maddubs_epi16(second, weights));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + count), bytes);
+    }
+    return count + decode_hex_table(out + count, in, pairs - count);
+  }
+  
+  typedef size_t (*decode_hex_function)(uint8_t* out, const char* in, size_t pairs);
+  
+  size_t decode_hex_resolve(uint8_t* out, const char* in, size_t pairs) NOEXCEPT;
+  
+  /// \brief Implementation used by decode_hex, chosen on the first call
+  std::atomic<decode_hex_function> decode_hex_selected{ decode_hex_resolve };
+  
+  size_t decode_hex_resolve(uint8_t* out, const char* in, size_t pairs) NOEXCEPT
+  {
+    __builtin_cpu_init();
+    const decode_hex_function f = __builtin_cpu_supports("ssse3") ? decode_hex_ssse3 : decode_hex_table;
+    decode_hex_selected.store(f, std::memory_order_relaxed);
+    return f(out, in, pairs);
   }
+#endif
+  
+  size_t decode_hex(uint8_t* out, const char* in, size_t pairs) NOEXCEPT
+  {
+#if defined(ESTD_HEX_SSSE3)
+    if(pairs >= 16) return decode_hex_selected.load(std::memory_order_relaxed)(out, in, pairs);
+#endif
+    return decode_hex_table(out, in, pairs);
+  }
+  
+  /// \brief Write one line of a hexdump: offset, up to 16 bytes in hex in two groups of 8, and the bytes as ASCII
+  char* do_format_hexdump_line(char* out, uint32_t offset, const uint8_t* data, size_t size) NOEXCEPT
+  {
+    for(int shift = 24; shift >= 0; shift -= 8, out += 2) memcpy(out, hex_tables.pairs[(offset >> shift) & 0xFF], 2);
+    *out++ = ' ';
+    for(size_t i = 0; i < 16; ++i)
+    {
+      if(i == 8) *out++ = ' ';
+      *out++ = ' ';
+      if(i < size) out = encode_hex_table(out, data + i, 1);
+      else out = fill(out, 2, ' ');
+    }
+    *out++ = ' ';
+    *out++ = ' ';
+    *out++ = '|';
+    for(size_t i = 0; i < size; ++i) *out++ = data[i] >= 0x20 && data[i] < 0x7F ? static_cast<char>(data[i]) : '.';
+    *out++ = '|';
+    *out++ = '\n';
+    return out;
+  }
+  
   uint8_t get_hex_digits(uint32_t value)  NOEXCEPT {
-    uint8_t d = (32U-__clz(value) + 3U) / 4U + 2U; 
+    uint8_t d = (estd::bit_width(value) + 3U) / 4U + 2U;
     if(d < 3) d = 3;
     return d;
   }
   
-  char* do_format_hex(char* b, uint32_t value, Options fmt, uint8_t digits)  NOEXCEPT
+  char* do_format_hex(char* b, uint32_t value, int32_t digits)  NOEXCEPT
   { 
-    *b++ = '0';
-    *b++ = 'x';
+    if(digits-- > 0) *b++ = '0';
+    if(digits-- > 0) *b++ = 'x';
     
     // 4 bits per hex digit
-    uint32_t bit = (digits-2) * 4U;
+    uint32_t bit = digits > 0 ? digits * 4U : 0U;
     
     while(bit > 0)
     {
@@ -208,26 +415,29 @@ namespace eformat
 {
   int format_decimal(char* out, uint16_t size, uint32_t value, Options fmt) NOEXCEPT
   {
-    auto digits = get_digits(value);
+    int16_t digits = get_digits(value);
     if(digits > size) digits = size;
-    do_format_decimal(&out[0], value, fmt, digits, '\0');
-    return digits;
+    
+    auto field = format_field(&out[0], size, fmt, digits);
+    field.out = do_format_decimal(field.out, value, digits, '\0');
+    field.out = fill(field.out, field.rpad_width, ' ');
+    return field.out - out;
   }
   
   int format_decimal(char* out, uint16_t size, int32_t value, Options fmt)  NOEXCEPT
   {
-    auto digits = get_digits(value);
+    // Negate in unsigned arithmetic, so INT32_MIN does not overflow
+    uint32_t absval = value < 0 ? 0U - static_cast<uint32_t>(value) : static_cast<uint32_t>(value);
+    char sign = value < 0 ? '-' : ' ';
+    
+    // Add sign digit
+    int16_t digits = get_digits(absval) + 1;
     if(digits > size) digits = size;
 
-    uint32_t absval = value;
-    char sign = ' ';
-    if(value < 0)
-    {
-      absval = -value;
-      sign = '-';
-    }
-    do_format_decimal(&out[0], absval, fmt, digits, sign);
-    return digits;
+    auto field = format_field(&out[0], size, fmt, digits);
+    field.out = do_format_decimal(field.out, absval, digits, sign);
+    field.out = fill(field.out, field.rpad_width, ' ');
+    return field.out - out;
   }
   
   int format_hex(char* out, uint16_t size, uint32_t value, Options fmt) NOEXCEPT
@@ -235,75 +445,145 @@ namespace eformat
     uint8_t digits = get_hex_digits(value);
     if(digits > size) digits = size;
 
-    auto field = format_field(&out[0], fmt, digits);
-    field.out = do_format_hex(field.out, value, fmt, digits);
+    auto field = format_field(&out[0], size, fmt, digits);
+    field.out = do_format_hex(field.out, value, digits);
     field.out = fill(field.out, field.rpad_width, ' ');
     return field.out - out;
   }
   
   int format_binary(char* out, uint16_t size, uint32_t value, Options fmt) NOEXCEPT
   {
-    int32_t digits = 32 - __clz(value) + 2;
+    int32_t digits = (value != 0 ? estd::bit_width(value) : 1) + 2;
     if(digits > size) digits = size;
 
-    auto field = format_field(&out[0], fmt, digits);
+    auto field = format_field(&out[0], size, fmt, digits);
     
     if(digits-- > 0) *field.out++ = '0';
     if(digits-- > 0) *field.out++ = 'b';
 
-    uint8_t bit = 1 << digits;
-    
-    while(bit > 0)
+    // Print the remaining digits from the most significant bit down
+    while(digits-- > 0)
     {  
-      *field.out++ = (bit & value) != 0U ? '1' : '0';
-      bit >>= 1U;
+      *field.out++ = ((value >> digits) & 1U) != 0U ? '1' : '0';
     }
-
-    return digits + 2;
+    
+    field.out = fill(field.out, field.rpad_width, ' ');
+    return field.out - out;
+  }
+  
+  int format_fixed(char* out, uint16_t size, uint32_t value, uint8_t decimals, Options fmt) NOEXCEPT
+  {
+    char temp[16];
+    return copy_field(out, size, temp, do_format_fixed(temp, value, decimals, '\0') - temp, fmt);
+  }
+  
+  int format_fixed(char* out, uint16_t size, int32_t value, uint8_t decimals, Options fmt) NOEXCEPT
+  {
+    // Signed values have a sign character, as format_decimal, so columns of them line up
+    uint32_t absval = value < 0 ? 0U - static_cast<uint32_t>(value) : static_cast<uint32_t>(value);
+    char temp[16];
+    return copy_field(out, size, temp, do_format_fixed(temp, absval, decimals, value < 0 ? '-' : ' ') - temp, fmt);
+  }
+  
+  int format_fixed(buffer& out, uint32_t value, uint8_t decimals, Options fmt) NOEXCEPT
+  {
+    char temp[16];
+    return write_field(out, temp, do_format_fixed(temp, value, decimals, '\0') - temp, fmt);
+  }
+  
+  int format_fixed(buffer& out, int32_t value, uint8_t decimals, Options fmt) NOEXCEPT
+  {
+    uint32_t absval = value < 0 ? 0U - static_cast<uint32_t>(value) : static_cast<uint32_t>(value);
+    char temp[16];
+    return write_field(out, temp, do_format_fixed(temp, absval, decimals, value < 0 ? '-' : ' ') - temp, fmt);
+  }
+  
+  int format_hex(char* out, uint16_t size, estd::span<const uint8_t> value) NOEXCEPT
+  {
+    size_t count = value.size() < size / 2U ? value.size() : size / 2U;
+    return encode_hex(out, value.data(), count) - out;
+  }
+  
+  int format(buffer& out, estd::span<const uint8_t> value, Options fmt) NOEXCEPT
+  {
+    const uint32_t size      = value.size() * 2U;
+    const uint32_t total_pad = fmt.width > size ? fmt.width - size : 0;
+    const uint32_t pad_left  = fmt.align == Align::Right ? total_pad : fmt.align == Align::Center ? total_pad/2U : 0;
+    
+    int status = 0;
+    for(uint32_t i = 0; i < pad_left; ++i) if(out.sputc(' ') < 0) status = EOF;
+    
+    // Encode in blocks through a small buffer, so values of any length need no more stack
+    char temp[128];
+    const uint8_t* data = value.data();
+    for(size_t left = value.size(); left > 0;)
+    {
+      size_t count = left < sizeof(temp) / 2U ? left : sizeof(temp) / 2U;
+      if(out.sputn(temp, encode_hex(temp, data, count) - temp) < 0) status = EOF;
+      data += count;
+      left -= count;
+    }
+    
+    for(uint32_t i = pad_left; i < total_pad; ++i) if(out.sputc(' ') < 0) status = EOF;
+    return status;
+  }
+  
+  int format_hexdump(buffer& out, estd::span<const uint8_t> value, uint32_t offset) NOEXCEPT
+  {
+    int status = 0;
+    char line[80];
+    for(uint32_t i = 0; i < value.size(); i += 16)
+    {
+      size_t count = value.size() - i < 16 ? value.size() - i : 16;
+      if(out.sputn(line, do_format_hexdump_line(line, offset + i, value.data() + i, count) - line) < 0) status = EOF;
+    }
+    return status;
   }
   
   int format_int(buffer& out, int32_t value, const Options fmt)  NOEXCEPT
   {
-    char temp[32];
+    // Format unpadded, so the field width is not limited by the size of temp
+    Options plain = fmt;
+    plain.width = 0;
+    
+    char temp[36];
     int count = 0;
-    if(fmt.base == Base::Decimal)  { count = format_decimal(temp, sizeof(temp), value, fmt);  }
-    else if(fmt.base == Base::Hex) { count = format_hex(temp, sizeof(temp), value, fmt); }
-    else                           { count = format_binary(temp, sizeof(temp), value, fmt); }
-    return out.sputn(temp, count);
+    if(fmt.base == Base::Decimal)  { count = format_decimal(temp, sizeof(temp), value, plain);  }
+    else if(fmt.base == Base::Hex) { count = format_hex(temp, sizeof(temp), value, plain); }
+    else                           { count = format_binary(temp, sizeof(temp), value, plain); }
+    return write_field(out, temp, count, fmt);
   }
   
   int format_int(buffer& out, uint32_t value, const Options fmt)  NOEXCEPT
   {
-    char temp[32];
+    Options plain = fmt;
+    plain.width = 0;
+    
+    char temp[36];
     int count = 0;
-    if(fmt.base == Base::Decimal)  { count = format_decimal(temp, sizeof(temp), value, fmt); }
-    else if(fmt.base == Base::Hex) { count = format_hex(temp, sizeof(temp),  value, fmt); }
-    else                           { count = format_binary(temp, sizeof(temp), value, fmt); }
-    return out.sputn(temp, count);
+    if(fmt.base == Base::Decimal)  { count = format_decimal(temp, sizeof(temp), value, plain); }
+    else if(fmt.base == Base::Hex) { count = format_hex(temp, sizeof(temp),  value, plain); }
+    else                           { count = format_binary(temp, sizeof(temp), value, plain); }
+    return write_field(out, temp, count, fmt);
   }
 
   
-    ParseStatus match(string_view& buf, const string_view& str)
+    ParseStatus match(string_view& buf, const string_view& str) NOEXCEPT
     {
-      auto c = buf.begin();
+      if(str.size() > buf.size()) return ParseStatus::NotMatched;
       
-      auto it = str.begin();
-      
-      while(c != buf.end() && *c++ == *it++)
+      for(size_type i = 0; i < str.size(); ++i)
       {
-        if(it == str.end()) 
-        {
-          buf.remove_prefix(c - buf.begin());
-          return ParseStatus::OK;
-        }
+        if(buf[i] != str[i]) return ParseStatus::NotMatched;
       }
       
-      return ParseStatus::NotMatched;
+      buf.remove_prefix(str.size());
+      return ParseStatus::OK;
     }
     
  
 #define FORMAT_INT_TYPE(TYPE) \
-  int format(buffer& out, const TYPE& value, Options options) NOEXCEPT { return format_int(out, value, options ); }
+  int format(buffer& out, TYPE value, Options options) NOEXCEPT { return format_int(out, value, options ); }
   FORMAT_INT_TYPE(uint8_t)
   FORMAT_INT_TYPE(uint16_t)
   FORMAT_INT_TYPE(uint32_t)
@@ -312,103 +592,131 @@ namespace eformat
   FORMAT_INT_TYPE(int32_t)
     
     
-  ParseStatus parse(string_view& in, uint8_t& value)  NOEXCEPT
+  /// \brief Parse an integer into a wider temporary, and only consume input if it fits in T
+  template<class T, class Wide>
+  ParseStatus parse_narrow(string_view& in, T& value) NOEXCEPT
   {
-    uint32_t temp = 0;
-    auto ret = parse(in, temp);
+    string_view temp_in = in;
+    Wide temp = 0;
+    auto ret = parse(temp_in, temp);
     if(ret != ParseStatus::OK) return ret;
     
-    if(temp > UINT8_MAX) return ParseStatus::Overflow;
-    value = temp;
+    if(temp > std::numeric_limits<T>::max() || temp < std::numeric_limits<T>::min()) return ParseStatus::Overflow;
+    value = static_cast<T>(temp);
+    in = temp_in;
     return ParseStatus::OK;
   }
   
+  ParseStatus parse(string_view& in, uint8_t& value)  NOEXCEPT
+  {
+    return parse_narrow<uint8_t, uint32_t>(in, value);
+  }
+  
   ParseStatus parse(string_view& in, uint16_t& value) NOEXCEPT
   {
-    uint32_t temp = 0;
-    auto ret = parse(in, temp);
-    if(ret != ParseStatus::OK) return ret;
-    
-    if(temp > UINT16_MAX) return ParseStatus::Overflow;
-    value = temp;
-    return ParseStatus::OK;
+    return parse_narrow<uint16_t, uint32_t>(in, value);
   }
   
   ParseStatus parse(string_view& in, uint32_t& value) NOEXCEPT
   {
     auto c = in.begin();
-    if(c != in.end() && std::isdigit(*c))
+    if(c == in.end() || !isdigit(*c)) return ParseStatus::NotMatched;
+    
+    uint32_t result = 0;
+    for(; c != in.end() && isdigit(*c); ++c)
     {
-      value = (*c - '0');
-      while(c != in.end() && std::isdigit(*(++c)))
-      {
-        uint32_t v = (*c - '0');
-        if(value > UINT32_MAX / 10U) return ParseStatus::Overflow;
-        value = value * 10U;
-        if(value > UINT32_MAX - v)  return ParseStatus::Overflow;
-        value += v;
-      }
-      in.remove_prefix(c - in.data());
-      return ParseStatus::OK;
+      uint32_t v = (*c - '0');
+      if(result > (UINT32_MAX - v) / 10U) return ParseStatus::Overflow;
+      result = result * 10U + v;
     }
-    return ParseStatus::NotMatched;
+    
+    value = result;
+    in.remove_prefix(c - in.begin());
+    return ParseStatus::OK;
   }
   
   ParseStatus parse(string_view& in, int32_t& value)  NOEXCEPT
   {
-    auto c = in.begin();
-    int sign = 0;
-    if(*c == '-') 
-    {
-      sign = -1;
-      ++c;
-    }
-    else if(*c == '+')
+    string_view digits = in;
+    bool negative = false;
+    if(!digits.empty() && (digits.front() == '-' || digits.front() == '+'))
     {
-      sign = 1;
-      ++c;
+      negative = digits.front() == '-';
+      digits.remove_prefix(1);
     }
     
-    if(std::isdigit(*c))
-    {
-      if(sign == 0) sign = 1;
-      value = sign * (*c - '0');
-      while(c < in.end() && std::isdigit(*(++c)))
-      {
-        int32_t v = *c - '0';
-        if(value > INT32_MAX / 10) return ParseStatus::Overflow;
-        value = value * 10;
-        if(value > INT32_MAX - v)  return ParseStatus::Overflow;
-        value += v;
-      }
-      in.remove_prefix(c - in.data());
-      
-      return ParseStatus::OK;
-    }
+    // Parse the magnitude, which for negative numbers may be one larger than INT32_MAX
+    uint32_t magnitude = 0;
+    auto ret = parse(digits, magnitude);
+    if(ret != ParseStatus::OK) return ret;
+    
+    if(magnitude > (negative ? uint32_t(INT32_MAX) + 1U : uint32_t(INT32_MAX))) return ParseStatus::Overflow;
     
-    return ParseStatus::NotMatched;
+    value = negative ? -static_cast<int32_t>(magnitude - 1U) - 1 : static_cast<int32_t>(magnitude);
+    in = digits;
+    return ParseStatus::OK;
   }
   
-  
   ParseStatus parse(string_view& in, int8_t& value)   NOEXCEPT
   {
-    int32_t temp;
-    auto ret = parse(in, temp);
+    return parse_narrow<int8_t, int32_t>(in, value);
+  }
+  
+  ParseStatus parse(string_view& in, int16_t& value)  NOEXCEPT
+  {
+    return parse_narrow<int16_t, int32_t>(in, value);
+  }
+  
+  ParseStatus parse_fixed(string_view& in, uint32_t& value, uint8_t decimals) NOEXCEPT
+  {
+    if(decimals > 9) return ParseStatus::NotMatched;
+    
+    string_view temp = in;
+    uint32_t whole = 0;
+    auto ret = parse(temp, whole);
     if(ret != ParseStatus::OK) return ret;
     
-    if(temp > INT8_MAX) return ParseStatus::Overflow;
-    value = temp;
+    const uint32_t scale = digit_values[decimals + 1];
+    if(whole > UINT32_MAX / scale) return ParseStatus::Overflow;
+    
+    uint32_t fraction = 0;
+    if(!temp.empty() && temp.front() == '.')
+    {
+      temp.remove_prefix(1);
+      uint8_t count = 0;
+      for(; !temp.empty() && isdigit(temp.front()); temp.remove_prefix(1))
+      {
+        if(++count > decimals) return ParseStatus::NotMatched;
+        fraction = fraction * 10U + static_cast<uint32_t>(temp.front() - '0');
+      }
+      if(count == 0) return ParseStatus::NotMatched;
+      fraction *= digit_values[decimals - count + 1];
+    }
+    
+    if(whole * scale > UINT32_MAX - fraction) return ParseStatus::Overflow;
+    value = whole * scale + fraction;
+    in = temp;
     return ParseStatus::OK;
   }
   
-  ParseStatus parse(string_view& in, int16_t& value)  NOEXCEPT
+  ParseStatus parse_fixed(string_view& in, int32_t& value, uint8_t decimals)  NOEXCEPT
   {
-    int32_t temp;
-    auto ret = parse(in, temp);
+    string_view digits = in;
+    bool negative = false;
+    if(!digits.empty() && (digits.front() == '-' || digits.front() == '+'))
+    {
+      negative = digits.front() == '-';
+      digits.remove_prefix(1);
+    }
+    
+    uint32_t magnitude = 0;
+    auto ret = parse_fixed(digits, magnitude, decimals);
     if(ret != ParseStatus::OK) return ret;
     
-    if(temp > INT16_MAX) return ParseStatus::Overflow;
-    value = temp;
+    if(magnitude > (negative ? uint32_t(INT32_MAX) + 1U : uint32_t(INT32_MAX))) return ParseStatus::Overflow;
+    
+    value = negative ? -static_cast<int32_t>(magnitude - 1U) - 1 : static_cast<int32_t>(magnitude);
+    in = digits;
     return ParseStatus::OK;
   }
   
@@ -429,11 +737,11 @@ namespace eformat
     
     auto c = in.cbegin();
     
-    while(*c != delimeter) {
+    while(c != in.cend() && *c != delimeter) {
       if(pos == end) return ParseStatus::Overflow;
-      if(c == in.cend()) return ParseStatus::Incomplete;
       *pos++ = *c++;  
     }
+    if(c == in.cend()) return ParseStatus::Incomplete;
     
     // Consume characters from string_view and resize span to represent actual size
     auto count = pos - begin;
@@ -443,19 +751,31 @@ namespace eformat
     return ParseStatus::OK;
   }
   
-  int format(buffer& buf, estd::string_view value, Options fmt) NOEXCEPT
+  ParseStatus parse(string_view& in, estd::span<uint8_t>& value) NOEXCEPT
   {
-    if(fmt.width < value.size()) return buf.sputn(&value[0], value.size());
-
-    char temp[32];
-    uint32_t size = value.size() < sizeof(temp) ? value.size() : sizeof(temp);
-
-    auto field = format_field(temp, fmt, size);
-    memcpy(field.out, value.data(), size);
-    field.out += size;
-    field.out = fill(field.out, field.rpad_width, ' ');
+    const auto&  values = hex_tables.values;
+    const size_t pairs  = in.size() / 2U < value.size() ? in.size() / 2U : value.size();
+    const size_t count  = decode_hex(value.begin(), in.data(), pairs);
+    const size_t digits = count * 2U;
+    auto is_digit = [&](size_t i) { return i < in.size() && values[static_cast<uint8_t>(in[i])] != 0xFF; };
+    
+    if(count == value.size() && is_digit(digits) && is_digit(digits + 1)) return ParseStatus::Overflow;
+    // A digit left over after the last whole pair is half a byte
+    if(count == 0 || is_digit(digits)) return ParseStatus::NotMatched;
     
-    return buf.sputn(temp, field.out - &temp[0]);
+    value = value.first(count);
+    in.remove_prefix(digits);
+    return ParseStatus::OK;
+  }
+  
+  int format(buffer& buf, estd::string_view value, Options fmt) NOEXCEPT
+  {
+    return write_field(buf, value.data(), value.size(), fmt);
+  }
+  
+  int format(buffer& buf, char value, Options fmt) NOEXCEPT
+  {
+    return write_field(buf, &value, 1, fmt);
   }
   
   int format(buffer& out, bool value, Options fmt) NOEXCEPT
@@ -465,16 +785,15 @@ namespace eformat
   
   int format(buffer& buf, const void* value, Options fmt) NOEXCEPT
   {
-    const intptr_t ptrval = reinterpret_cast<intptr_t>(value);
+    // Only the low 32 bits are shown on hosts with wider pointers
+    const uint32_t ptrval = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(value));
     uint32_t digits = get_hex_digits(ptrval);
-    uint32_t size = digits+2;
-    char temp[32];
-    auto field = format_field(temp, fmt, size);
-    *field.out++ = '<';
-
-    field.out = do_format_hex(field.out, ptrval, fmt, digits);
-    *field.out++ = '>';
-    return buf.sputn(temp, field.out - &temp[0]);
+    char temp[16];
+    char* out = temp;
+    *out++ = '<';
+    out = do_format_hex(out, ptrval, digits);
+    *out++ = '>';
+    return write_field(buf, temp, out - temp, fmt);
   }
   
   bool arg_value::format(parse_context& parse, buffer&  fmt) const  NOEXCEPT
@@ -521,6 +840,18 @@ namespace eformat
       format(s.buf, value, s.o);
       return s;
     }
+    
+    stream& operator<<(stream& s, estd::span<const uint8_t> value) NOEXCEPT
+    {
+      format(s.buf, value, s.o);
+      return s;
+    }
+    
+    stream& operator<<(stream& s, hexdump_view value) NOEXCEPT
+    {
+      format_hexdump(s.buf, value.value, value.offset);
+      return s;
+    }
   
       /// \brief Write character to buffer (unformatted)
      stream& operator<<(stream& s, const char value) NOEXCEPT 
@@ -15,9 +15,10 @@ namespace eformat {
   typedef uint32_t size_type;
   
   /// Format option to specify field alignment
-  enum class Align { Left = 0, Right=1, Center=2  };
+  /// Unsigned, so values fit the 2 bit fields in Options
+  enum class Align : uint8_t { Left = 0, Right=1, Center=2  };
   /// Format option to specify numeric base
-  enum class Base  { Decimal = 0, Hex=1, Binary=2 };
+  enum class Base : uint8_t { Decimal = 0, Hex=1, Binary=2 };
   
   /// \brief Field formatting options
   struct Options 
@@ -42,6 +43,16 @@ namespace eformat {
   int format_hex(char* out, uint16_t size, uint32_t value, Options fmt=Options{}) NOEXCEPT;
   int format_binary(char* out, uint16_t size, uint32_t value, Options fmt=Options{}) NOEXCEPT;
 
+  /// \brief Format bytes as pairs of hex digits, without a prefix or separators
+  /// \returns Number of characters written, which is only whole bytes if size is too small for every byte
+  int format_hex(char* out, uint16_t size, estd::span<const uint8_t> value) NOEXCEPT;
+
+  /// \brief Format integer as a fixed-point decimal number, inserting the decimal point decimals digits from the right,
+  ///        e.g. 1234 with 2 decimals as 12.34, without converting through floating point
+  /// \param decimals Number of digits after the decimal point, up to 9, or 0 to format as an integer
+  int format_fixed(char* out, uint16_t size, uint32_t value, uint8_t decimals, Options fmt=Options{}) NOEXCEPT;
+  int format_fixed(char* out, uint16_t size, int32_t value, uint8_t decimals, Options fmt=Options{}) NOEXCEPT;
+
   int format(buffer& out, uint8_t value, Options options) NOEXCEPT;
   int format(buffer& out, uint16_t value, Options options) NOEXCEPT;
   int format(buffer& out, uint32_t value, Options options) NOEXCEPT;
@@ -49,9 +60,49 @@ namespace eformat {
   int format(buffer& out, int16_t value, Options options) NOEXCEPT;
   int format(buffer& out, int32_t value, Options options) NOEXCEPT;
   int format(buffer& out, string_view value, Options options) NOEXCEPT;
+  int format(buffer& out, char value, Options options) NOEXCEPT;
   int format(buffer& out, const void* const value, Options options) NOEXCEPT;
   int format(buffer& out, bool value, Options options) NOEXCEPT;
+  int format_fixed(buffer& out, uint32_t value, uint8_t decimals, Options options) NOEXCEPT;
+  int format_fixed(buffer& out, int32_t value, uint8_t decimals, Options options) NOEXCEPT;
+  int format(buffer& out, estd::span<const uint8_t> value, Options options) NOEXCEPT;
+
+  /// \brief Format bytes as a canonical hexdump: lines of 16 bytes with the offset of the first, the bytes in hex and
+  ///        the bytes as ASCII, with '.' for those which are not printable
+  /// \param offset Offset printed for the first byte, e.g. its address
+  int format_hexdump(buffer& out, estd::span<const uint8_t> value, uint32_t offset = 0) NOEXCEPT;
   /// @}
+
+  /// \brief Bytes to be formatted as a hexdump
+  struct hexdump_view
+  {
+    estd::span<const uint8_t> value;
+    uint32_t                  offset;
+  };
+
+  /// \brief Function to indicate bytes should be formatted as a hexdump rather than a string of hex digits
+  inline constexpr hexdump_view hexdump(estd::span<const uint8_t> value, uint32_t offset = 0) NOEXCEPT
+  {
+    return hexdump_view{ value, offset };
+  }
+
+  /// \brief Integer to be formatted as a fixed-point decimal number
+  template<class T>
+  struct fixed_point
+  {
+    T       value;
+    uint8_t decimals;
+  };
+
+  /// \brief Function to indicate value should be formatted with decimals digits after the decimal point
+  inline constexpr fixed_point<int32_t> fixed(int32_t value, uint8_t decimals) NOEXCEPT
+  {
+    return fixed_point<int32_t>{ value, decimals };
+  }
+  inline constexpr fixed_point<uint32_t> fixed(uint32_t value, uint8_t decimals) NOEXCEPT
+  {
+    return fixed_point<uint32_t>{ value, decimals };
+  }
             
   template<class T> struct false_type { static constexpr bool value = false; };
   template<class T> struct true_type { static constexpr bool value = true; typedef T type; };
@@ -105,7 +156,7 @@ namespace eformat {
         case 'b': options.base = Base::Binary; break;
         case '}': c.fmt_pos = ++pos; return true;
         default:
-          if(std::isdigit(*pos)) options.width = options.width * 10 + *pos - '0';
+          if(*pos >= '0' && *pos <= '9') options.width = options.width * 10 + *pos - '0';
           else return false;
           break;
         }
@@ -134,6 +185,36 @@ namespace eformat {
     }
   };
   
+  /// \brief Formatter for fixed-point numbers
+  template<class T>
+  struct formatter<fixed_point<T>> : base_formatter
+  {
+    int format(buffer& ctx, const fixed_point<T>& value) const NOEXCEPT
+    {
+      return ::eformat::format_fixed(ctx, value.value, value.decimals, options);
+    }
+  };
+
+  /// \brief Formatter for bytes, as pairs of hex digits
+  template<>
+  struct formatter<estd::span<const uint8_t>> : base_formatter
+  {
+    int format(buffer& ctx, estd::span<const uint8_t> value) const NOEXCEPT
+    {
+      return ::eformat::format(ctx, value, options);
+    }
+  };
+
+  /// \brief Formatter for hexdumps, which are whole lines so take no options
+  template<>
+  struct formatter<hexdump_view> : base_formatter
+  {
+    int format(buffer& ctx, const hexdump_view& value) const NOEXCEPT
+    {
+      return ::eformat::format_hexdump(ctx, value.value, value.offset);
+    }
+  };
+
   /// \brief Boxed argument value with format function
   struct arg_value 
   {
@@ -151,8 +232,8 @@ namespace eformat {
       __FORCEINLINE constexpr arg_value(const uint32_t& i) NOEXCEPT : ptr(&i), fformat(format_arg<uint32_t>) {}
       __FORCEINLINE constexpr arg_value(const bool& i)  NOEXCEPT    : ptr(&i), fformat(format_arg<bool>) {}
       __FORCEINLINE constexpr arg_value(const char& i)  NOEXCEPT    : ptr(&i), fformat(format_arg<char>) {}
-      __FORCEINLINE constexpr arg_value(string_view& i)  NOEXCEPT   : ptr(&i), fformat(format_arg<string_view>) {}
-      __FORCEINLINE constexpr arg_value(const void* i)  NOEXCEPT    : ptr(i), fformat(format_arg<const void*>){}
+      __FORCEINLINE constexpr arg_value(const string_view& i) NOEXCEPT : ptr(&i), fformat(format_arg<string_view>) {}
+      __FORCEINLINE constexpr arg_value(const void* i)  NOEXCEPT    : ptr(i), fformat(format_pointer){}
       #ifdef __ICCARM__
       __FORCEINLINE 
       template<class T, typename = custom_type_t<T>>
@@ -178,6 +259,13 @@ namespace eformat {
       else
         return false;
      }
+     
+    /// Pointers are stored by value in ptr, so are formatted without dereferencing
+    static bool format_pointer(parse_context& parse_ctx, const void* arg, buffer& ctx) 
+    {
+      formatter<void*> f{};
+      return f.parse_options(parse_ctx) && f.format(ctx, arg) >= 0;
+    }
     };
   
   /// \brief Base class representing an argument pack to be used by the formatter
@@ -196,9 +284,14 @@ namespace eformat {
   {
   public:
     
-     __FORCEINLINE
+    #ifdef __ICCARM__
+    __FORCEINLINE
     template<class... T>
     constexpr arg_store(const T&... args)  NOEXCEPT
+    #else
+    template<class... T>
+    __FORCEINLINE constexpr arg_store(const T&... args)  NOEXCEPT
+    #endif
       :  basic_format_args{ &values[0], &values[0] + N}, values{args...}
     {
       static_assert(sizeof...(T) <= N, "Too many args passed to format");
@@ -319,6 +412,20 @@ namespace eformat {
     /// \brief Write character to buffer (unformatted)
     stream& operator<<(stream& s, const char value) NOEXCEPT;
 
+    /// \brief Write bytes to buffer as pairs of hex digits
+    stream& operator<<(stream& s, estd::span<const uint8_t> value) NOEXCEPT;
+
+    /// \brief Write bytes to buffer as a hexdump
+    stream& operator<<(stream& s, hexdump_view value) NOEXCEPT;
+
+    /// \brief Write fixed-point number to buffer
+    template<class T>
+    inline stream& operator<<(stream& s, const fixed_point<T> value) NOEXCEPT
+    {
+      format_fixed(s.buf, value.value, value.decimals, s.o);
+      return s;
+    }
+
 
     /// \brief Unformatted string writes directly to buffer
     inline stream& operator<<(stream& s, unformatted_string_view value) NOEXCEPT
@@ -403,7 +510,8 @@ namespace eformat {
     }
 
     /// \brief Match input buffer contents with a given string
-    ParseStatus match(const string_view& buf, const string_view& str);
+    /// \returns OK and consumes str from buf if buf starts with str, NotMatched otherwise
+    ParseStatus match(string_view& buf, const string_view& str) NOEXCEPT;
       
     ParseStatus parse(string_view& in, uint8_t& value)  NOEXCEPT;
     ParseStatus parse(string_view& in, uint16_t& value) NOEXCEPT;
@@ -412,7 +520,19 @@ namespace eformat {
     ParseStatus parse(string_view& in, int16_t& value)  NOEXCEPT;
     ParseStatus parse(string_view& in, int32_t& value)  NOEXCEPT;
     ParseStatus parse(string_view& in, bool& value)     NOEXCEPT;
+
+    /// \brief Parse fixed-point decimal number, such as 12.34, into an integer scaled by 10^decimals, e.g. 1234 for 2
+    ///        decimals, without converting through floating point
+    /// \remarks Fewer fractional digits than decimals are padded with zeros. More are NotMatched, as they cannot be
+    ///          stored, as is a decimal point without digits after it
+    ParseStatus parse_fixed(string_view& in, uint32_t& value, uint8_t decimals) NOEXCEPT;
+    ParseStatus parse_fixed(string_view& in, int32_t& value, uint8_t decimals)  NOEXCEPT;
     ParseStatus parse(string_view& in, estd::span<char_type>& value, char_type delimeter) NOEXCEPT;
+
+    /// \brief Parse pairs of hex digits, in either case, into bytes
+    /// \param value Storage for bytes, which is resized to the number parsed
+    /// \returns OK, NotMatched if there are no digits or an odd number, or Overflow if value is too small
+    ParseStatus parse(string_view& in, estd::span<uint8_t>& value) NOEXCEPT;
   
     template<class Predicate=bool (*)(char ch)>
     inline constexpr ParseStatus parse(string_view& in, estd::span<char_type>& value, Predicate pred=estd::isspace) NOEXCEPT
@@ -423,11 +543,11 @@ namespace eformat {
       
       auto c = in.cbegin();
       
-      while(false == pred(*c)) {
+      while(c != in.cend() && false == pred(*c)) {
         if(pos == end) return ParseStatus::Overflow;
-        if(c == in.cend()) return ParseStatus::Incomplete;
         *pos++ = *c++;  
       }
+      if(c == in.cend()) return ParseStatus::Incomplete;
       
       // Consume characters from string_view and resize span to represent actual size
       auto count = pos - begin;
@@ -22,7 +22,7 @@ namespace eio {
   {
     /// \brief Construct a buffer base class with pointers to internal buffers
     constexpr buffer(char_type* pbase, char_type* pend, char_type* gbase) NOEXCEPT
-      : pbase_(pbase), pptr_(pbase), epptr_(pend), gbase_(gbase), gptr_(gbase), egptr_(gbase) { }
+      : pbase_(pbase), pptr_(pbase), epptr_(pend), gbase_(gbase), gptr_(gbase), egptr_(gbase), closed_(false) { }
     
     /// \defgroup PutFunctions Put area functions
     /// @{
@@ -30,7 +30,8 @@ namespace eio {
     /// \brief Put a character to put area
     int sputc(char_type c) NOEXCEPT
     {
-      if(pptr_ != epptr_) return *pptr_++ = c;
+      // Return unsigned value, so characters above 0x7F are not mistaken for EOF
+      if(pptr_ != epptr_) return static_cast<unsigned char>(*pptr_++ = c);
       else return overflow(c);
     }
     
@@ -111,7 +112,7 @@ namespace eio {
     void gflush() NOEXCEPT { egptr_ = gptr_; }
     
     /// \brief Poll device for more data
-    /// \returns Number of bytes read, 0 if no data, EOF if buffer is full
+    /// \returns Number of bytes available, 0 if no data, EOF if buffer is full
     virtual int poll(int timeout=0) NOEXCEPT = 0;
     
     /// \brief Advance input area to specified location
@@ -134,6 +135,9 @@ namespace eio {
     
     /// \brief Return how many characters are available in the get area
     int in_avail() const NOEXCEPT { return gptr_ - gbase_; }
+
+    /// \brief Check if the driver has reported that its input closed, so no more input will arrive
+    bool closed() const NOEXCEPT { return closed_; }
     
     /// @}
 
@@ -153,6 +157,8 @@ namespace eio {
     char_type* egptr_; ///< End of current get aread
     /// @}
 
+    bool closed_; ///< Driver returned EOF from read
+
     /// \brief Write buffer overflow -- request more write buffer space, without writing if possible
     /// \param c Character to write to put buffer
     /// \returns Value of c if successfully written, EOF if buffer is full
@@ -188,7 +194,7 @@ public:
   /// \brief Get read buffered contents from device
   /// \param buffer  Pointer to memory to read into
   /// \param count   Maximum number of bytes to read.
-  /// \param Number of bytes read, or Status code
+  /// \param Number of bytes read, or Status code. Drivers return EOF once their input has closed
   int read(void* buffer, uint16_t count) NOEXCEPT { return driver_->read(buffer, count); }
   
   /// \brief Get IO buffer to enable buffered IO
@@ -71,7 +71,10 @@ namespace eio {
 
   protected:
 
-    int try_get() NOEXCEPT
+    /// \brief Read available input from the driver
+    /// \param compact Allow unread input to be moved to make room. Only done when polling, since callers may hold
+    ///                views into the get area while writing output, which also reads input
+    int try_get(bool compact=false) NOEXCEPT
     {
       int read = 0;
       // Adjust egptr, if necessary to make room
@@ -80,7 +83,16 @@ namespace eio {
         // If the get pointer has reached the end of the buffer, reset all the pointers
         egptr_ = gbase_ = gptr_ = inbuf_start();
       }
-        
+      else if(compact && egptr_ == inbuf_end() && gptr_ != inbuf_start())
+      {
+        // If the buffer is full but partly consumed, move the unread input to the start,
+        // so a partially received line can be completed
+        auto count = egptr_ - gptr_;
+        memmove(inbuf_start(), gptr_, count);
+        gbase_ = gptr_ = inbuf_start();
+        egptr_ = gptr_ + count;
+      }
+
       read = inbuf_end() - egptr_;
         
       // If buffer is full, return EOF
@@ -92,6 +104,12 @@ namespace eio {
       {
         egptr_ += read;
       }
+      else if(read < 0)
+      {
+        // Input has closed, which is kept apart from a full buffer
+        closed_ = true;
+        read    = 0;
+      }
       return read;
     }
 
@@ -103,7 +121,7 @@ namespace eio {
       {
         return EOF;
       }
-      return *pptr_++ = c;
+      return static_cast<unsigned char>(*pptr_++ = c);
     }
     
     int poll(int timeout=0) NOEXCEPT
@@ -112,9 +130,11 @@ namespace eio {
       do {
         // Flush write buffers
         flush(0);
-        read = try_get();
-      } while(timeout-- > 0 && read <= 0);
+        read = try_get(true);
+      } while(timeout-- > 0 && read == 0);
 
+      // A full buffer is reported, so callers can discard input which will never be completed
+      if(read == EOF) return EOF;
       return egptr_ - gptr_;
     }
 
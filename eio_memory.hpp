@@ -0,0 +1,68 @@
+#pragma once
+
+/// \file eio_memory.hpp
+/// In-memory IO driver, which allows buffers and consoles to be driven from host code without a device
+
+#include "eio.hpp"
+#include "eio_buffer.hpp"
+
+namespace eio {
+
+  /// \brief Driver which reads from a caller-provided input view and discards written data after recording it
+  template<size_type OutbufSize=256, size_type InbufSize=128>
+  struct memory_driver final : public IODevice::Driver
+  {
+    typedef iobuffer<memory_driver, OutbufSize, InbufSize> BufferType;
+
+    memory_driver() NOEXCEPT
+      : buffer_(*this)
+      {}
+
+    /// \brief Set input to be returned by subsequent reads
+    /// \remarks The view is not copied, so the data it refers to must outlive the reads
+    void feed(string_view input) NOEXCEPT { input_ = input; }
+
+    /// \brief Get input which has not been read yet
+    string_view pending() const NOEXCEPT { return input_; }
+
+    /// \brief Get contents of the last write to this driver
+    /// \remarks The view refers to the output buffer, and is only valid until the buffer is written again
+    string_view last_write() const NOEXCEPT { return last_write_; }
+
+    /// \brief Get total number of bytes written to this driver
+    uint32_t written() const NOEXCEPT { return written_; }
+
+    int write(const void* data, uint16_t count) NOEXCEPT
+    {
+      last_write_ = string_view(static_cast<const char_type*>(data), count);
+      written_ += count;
+      return count;
+    }
+
+    int read(void* data, uint16_t count) NOEXCEPT
+    {
+      auto n = estd::min(static_cast<uint32_t>(count), input_.size());
+      if(n == 0) return 0;
+      memcpy(data, input_.data(), n);
+      input_.remove_prefix(n);
+      return n;
+    }
+
+    int sync(int timeout) NOEXCEPT
+    {
+      return timeout;
+    }
+
+    buffer& getbuf() NOEXCEPT
+    {
+      return buffer_;
+    }
+
+  private:
+    BufferType  buffer_;
+    string_view input_;
+    string_view last_write_;
+    uint32_t    written_ = 0;
+  };
+
+}
@@ -0,0 +1,65 @@
+/// \file eio_posix.cpp
+/// \brief Implementation of IO driver for POSIX file descriptors
+
+#include "eio_posix.hpp"
+
+#include <poll.h>
+#include <unistd.h>
+
+namespace eio
+{
+  posix_driver::posix_driver(int in_fd, int out_fd) NOEXCEPT
+    : buffer_(*this), in_fd_(in_fd), out_fd_(out_fd), eof_(false)
+    {}
+
+  int posix_driver::write(const void* data, uint16_t count) NOEXCEPT
+  {
+    const uint8_t* d = static_cast<const uint8_t*>(data);
+    int remaining = count;
+    while(remaining > 0)
+    {
+      auto written = ::write(out_fd_, d, remaining);
+      if(written < 0) return EOF;
+      d += written;
+      remaining -= written;
+    }
+    return count;
+  }
+
+  int posix_driver::read(void* data, uint16_t count) NOEXCEPT
+  {
+    // Never block: the buffer polls the driver, so only read when input is ready
+    if(eof_) return EOF;
+    if(false == wait(0)) return 0;
+
+    auto n = ::read(in_fd_, data, count);
+    if(n <= 0)
+    {
+      eof_ = true;
+      return EOF;
+    }
+    return n;
+  }
+
+  int posix_driver::sync(int timeout) NOEXCEPT
+  {
+    // Writes complete synchronously, so there is nothing to wait for
+    return timeout;
+  }
+
+  buffer& posix_driver::getbuf() NOEXCEPT
+  {
+    return buffer_;
+  }
+
+  bool posix_driver::wait(int timeout_ms) NOEXCEPT
+  {
+    if(eof_) return true;
+    pollfd fd = { in_fd_, POLLIN, 0 };
+    return ::poll(&fd, 1, timeout_ms) > 0;
+  }
+
+  static posix_driver posix_console_driver_(STDIN_FILENO, STDOUT_FILENO);
+
+  IODevice console(&posix_console_driver_);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+/// \file eio_posix.hpp
+/// IO driver for POSIX file descriptors, used to run consoles on host systems
+
+#include "eio.hpp"
+#include "eio_buffer.hpp"
+
+namespace eio {
+
+  /// \brief Driver which reads and writes a pair of POSIX file descriptors (e.g. stdin/stdout, a pty or a socket)
+  struct posix_driver final : public IODevice::Driver
+  {
+    typedef iobuffer<posix_driver, 1024, 128> BufferType;
+
+    /// \brief Create driver for a pair of file descriptors
+    /// \param in_fd  Descriptor to read input from
+    /// \param out_fd Descriptor to write output to
+    posix_driver(int in_fd, int out_fd) NOEXCEPT;
+
+    int write(const void* data, uint16_t count) NOEXCEPT;
+    /// \returns Number of bytes read, 0 if no input is ready, or EOF once the input has closed
+    int read(void* data, uint16_t count) NOEXCEPT;
+    int sync(int timeout) NOEXCEPT;
+    buffer& getbuf() NOEXCEPT;
+
+    /// \brief Wait for input to become available
+    /// \param timeout_ms Time to wait in milliseconds, or negative to wait indefinitely
+    /// \returns true if input is available (or the input has been closed), false on timeout
+    bool wait(int timeout_ms) NOEXCEPT;
+
+    /// \brief Check if the input descriptor has reached end of file
+    bool eof() const NOEXCEPT { return eof_; }
+
+  private:
+    BufferType buffer_;
+    int        in_fd_;
+    int        out_fd_;
+    bool       eof_;
+  };
+
+}
@@ -0,0 +1,671 @@
+#include "ejson.hpp"
+
+#include "bit.hpp"
+#include "console.hpp"
+
+#include <cstring>
+#include <type_traits>
+
+namespace {
+  using namespace ejson;
+  using eobject::Error;
+  using eobject::Record;
+  using eobject::Table;
+
+  /// \defgroup Scanner Word-at-a-time scanning of string content
+  /// Each test sets the high bit of the matching bytes in a word. A borrow can also set bits above a match, so only
+  /// the lowest set bit is exact, which is all that is needed to find the first match
+  /// @{
+
+  typedef std::conditional_t<sizeof(void*) >= 8, uint64_t, uint32_t> word_type;
+
+  constexpr word_type repeat(uint8_t byte) NOEXCEPT { return ~word_type(0) / 0xFF * byte; }
+
+  /// \brief Match bytes with a value below limit, which must be at most 0x80
+  constexpr word_type bytes_below(word_type word, uint8_t limit) NOEXCEPT
+  {
+    return (word - repeat(limit)) & ~word & repeat(0x80);
+  }
+
+  constexpr word_type bytes_equal(word_type word, uint8_t byte) NOEXCEPT
+  {
+    return bytes_below(word ^ repeat(byte), 1);
+  }
+
+  /// \brief Check for a character which ends a run of plain string content
+  constexpr bool is_special(char c) NOEXCEPT
+  {
+    return c == '"' || c == '\\' || static_cast<uint8_t>(c) < 0x20;
+  }
+
+  /// \brief Find first quote, backslash or control character
+  const char* find_special(const char* p, const char* end) NOEXCEPT
+  {
+    for(; end - p >= static_cast<ptrdiff_t>(sizeof(word_type)); p += sizeof(word_type))
+    {
+      word_type word;
+      memcpy(&word, p, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+      // Put the first character in the lowest byte, so borrows only run towards later characters
+      word = estd::byteswap(word);
+#endif
+      word_type found = bytes_equal(word, '"') | bytes_equal(word, '\\') | bytes_below(word, 0x20);
+      if(found != 0) return p + estd::countr_zero(found) / 8;
+    }
+    while(p != end && !is_special(*p)) ++p;
+    return p;
+  }
+
+  /// @}
+
+  const char hex_digits[] = "0123456789ABCDEF";
+
+  /// \brief Sets options for writing JSON values, and restores the caller's options when done
+  struct plain_options
+  {
+    eformat::stream& so;
+    eformat::Options saved;
+
+    explicit plain_options(eformat::stream& s) NOEXCEPT
+      : so(s), saved(s.o)
+    {
+      so.o = eformat::Options{ eformat::Align::Left, eformat::Base::Decimal, 0 };
+    }
+    ~plain_options() { so.o = saved; }
+  };
+
+  eformat::stream& write_null(eformat::stream& so) NOEXCEPT { return so.write("null"); }
+
+  eformat::stream& write_object(eformat::stream& so, const Object& object) NOEXCEPT
+  {
+    if(object.data() == nullptr) return write_null(so);
+
+    auto& info = object.info();
+    switch(info.otype)
+    {
+      case Object::ClassId::Variable: return write_value(so, object.data(), info.data_size, info.type);
+      case Object::ClassId::Array:
+      {
+        size_t elem_size = eobject::type_size(info.type);
+        auto   data      = static_cast<const uint8_t*>(object.data());
+        so.buf.sputc('[');
+        for(uint8_t i = 0; i < info.nelem; ++i, data += elem_size)
+        {
+          if(i != 0) so.buf.sputc(',');
+          write_value(so, data, elem_size, info.type);
+        }
+        so.buf.sputc(']');
+        return so;
+      }
+      case Object::ClassId::Record:
+      {
+        bool first = true;
+        so.buf.sputc('{');
+        auto& record = static_cast<const Record::Info&>(info);
+        for(auto& field : record)
+        {
+          auto& descriptor = record.descriptor(field);
+          if(false == first) so.buf.sputc(',');
+          first = false;
+          write_string(so, field.name);
+          so.buf.sputc(':');
+          write_value(so, object.data(field.data_offset), descriptor.data_size, descriptor.type);
+        }
+        so.buf.sputc('}');
+        return so;
+      }
+      case Object::ClassId::Table:
+      {
+        auto&  table     = static_cast<const Table::Info&>(info);
+        size_t elem_size = eobject::type_size(table.type);
+        auto   data      = static_cast<const uint8_t*>(object.data());
+        so.buf.sputc('[');
+        for(uint8_t row = 0; row < table.nelem; ++row)
+        {
+          if(row != 0) so.buf.sputc(',');
+          so.buf.sputc('[');
+          for(uint16_t column = 0; column < table.row_length(); ++column, data += elem_size)
+          {
+            if(column != 0) so.buf.sputc(',');
+            write_value(so, data, elem_size, table.type);
+          }
+          so.buf.sputc(']');
+        }
+        so.buf.sputc(']');
+        return so;
+      }
+      default: return write_null(so);
+    }
+  }
+
+  /// \brief Find the closing quote of a string
+  /// \param p       Opening quote
+  /// \param content Set to content between the quotes, still escaped
+  /// \param escaped Set if content contains escape sequences
+  ParseStatus scan_string(const char* p, const char* end, string_view& content, bool& escaped) NOEXCEPT
+  {
+    const char* start = ++p;
+    escaped = false;
+    for(;;)
+    {
+      p = find_special(p, end);
+      if(p == end) return ParseStatus::Incomplete;
+      if(*p == '"') break;
+      // Control characters must be escaped
+      if(*p != '\\') return ParseStatus::NotMatched;
+      if(end - p < 2) return ParseStatus::Incomplete;
+      escaped = true;
+      p += 2;
+    }
+    content = string_view(start, p);
+    return ParseStatus::OK;
+  }
+
+  int hex_value(char c) NOEXCEPT
+  {
+    if(c >= '0' && c <= '9') return c - '0';
+    if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+  }
+
+  /// \brief Decode escape sequences in string content
+  /// \returns NotMatched if an escape sequence is invalid, Overflow if the result does not fit the buffer
+  ParseStatus unescape(string_view content, char* buffer, size_t capacity, string_view& value) NOEXCEPT
+  {
+    char*       out = buffer;
+    char* const out_end = buffer + capacity;
+    for(auto p = content.begin(); p != content.end(); ++p)
+    {
+      char c = *p;
+      if(c == '\\')
+      {
+        // Content was scanned, so an escape is always followed by another character
+        switch(*++p)
+        {
+          case '"':  c = '"'; break;
+          case '\\': c = '\\'; break;
+          case '/':  c = '/'; break;
+          case 'b':  c = '\b'; break;
+          case 'f':  c = '\f'; break;
+          case 'n':  c = '\n'; break;
+          case 'r':  c = '\r'; break;
+          case 't':  c = '\t'; break;
+          case 'u':
+          {
+            if(content.end() - p < 5) return ParseStatus::NotMatched;
+            uint32_t code = 0;
+            for(int i = 0; i < 4; ++i)
+            {
+              int digit = hex_value(*++p);
+              if(digit < 0) return ParseStatus::NotMatched;
+              code = (code << 4) | digit;
+            }
+            // Encode as UTF-8. Surrogate pairs are not combined, so each half is encoded separately
+            if(code >= 0x80)
+            {
+              int n = code >= 0x800 ? 3 : 2;
+              if(out_end - out < n) return ParseStatus::Overflow;
+              if(n == 3)
+              {
+                *out++ = static_cast<char>(0xE0 | (code >> 12));
+                *out++ = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+              }
+              else
+              {
+                *out++ = static_cast<char>(0xC0 | (code >> 6));
+              }
+              *out++ = static_cast<char>(0x80 | (code & 0x3F));
+              continue;
+            }
+            c = static_cast<char>(code);
+            break;
+          }
+          default: return ParseStatus::NotMatched;
+        }
+      }
+      if(out == out_end) return ParseStatus::Overflow;
+      *out++ = c;
+    }
+    value = string_view(buffer, out);
+    return ParseStatus::OK;
+  }
+
+  /// \brief Check for a character which may be part of a number or literal
+  constexpr bool is_token_char(char c) NOEXCEPT
+  {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '-' || c == '+'
+           || c == '.';
+  }
+
+  template<class T>
+  int32_t set_integer(const Object& object, uint8_t subIdx, string_view token) NOEXCEPT
+  {
+    bool negative = token.front() == '-';
+    if(negative && std::is_unsigned<T>::value) return Error::ValueTooLow;
+
+    T    value;
+    auto status = eformat::parse(token, value);
+    if(status == ParseStatus::Overflow) return negative ? Error::ValueTooLow : Error::ValueTooHigh;
+    // All numeric types are integers, so fractions and exponents are rejected
+    if(status != ParseStatus::OK || false == token.empty()) return Error::DataTypeError;
+    return object.set(subIdx, &value, sizeof(value));
+  }
+}
+
+namespace ejson {
+
+  eformat::stream& write_string(eformat::stream& so, string_view str) NOEXCEPT
+  {
+    so.buf.sputc('"');
+    auto p   = str.begin();
+    auto end = str.end();
+    while(p != end)
+    {
+      // Write plain content in runs, and escape the character which ends each run
+      auto run = find_special(p, end);
+      if(run != p) so.buf.sputn(p, run - p);
+      if(run == end) break;
+
+      char   c = *run;
+      char   escape[6] = { '\\', c };
+      size_t size      = 2;
+      switch(c)
+      {
+        case '"':
+        case '\\': break;
+        case '\b': escape[1] = 'b'; break;
+        case '\f': escape[1] = 'f'; break;
+        case '\n': escape[1] = 'n'; break;
+        case '\r': escape[1] = 'r'; break;
+        case '\t': escape[1] = 't'; break;
+        default:
+          escape[1] = 'u';
+          escape[2] = '0';
+          escape[3] = '0';
+          escape[4] = hex_digits[(c >> 4) & 0xF];
+          escape[5] = hex_digits[c & 0xF];
+          size      = 6;
+          break;
+      }
+      so.buf.sputn(escape, size);
+      p = run + 1;
+    }
+    so.buf.sputc('"');
+    return so;
+  }
+
+  eformat::stream& write_value(eformat::stream& so, const void* data, size_t size, DataType type) NOEXCEPT
+  {
+    switch(type)
+    {
+      case DataType::U8:
+      case DataType::U16:
+      case DataType::U32:
+      case DataType::I8:
+      case DataType::I16:
+      case DataType::I32: return console::print_value(so, data, size, type);
+      case DataType::String:
+      {
+        auto str = static_cast<const char*>(data);
+        if(str == nullptr) return write_null(so);
+        return write_string(so, string_view(str, strnlen(str, size)));
+      }
+      default: return write_null(so);
+    }
+  }
+
+  eformat::stream& write(eformat::stream& so, const Object& object) NOEXCEPT
+  {
+    plain_options options(so);
+    return write_object(so, object);
+  }
+
+  eformat::stream& write(eformat::stream& so, const Dictionary& dictionary) NOEXCEPT
+  {
+    plain_options options(so);
+    bool first = true;
+    so.buf.sputc('{');
+    for(auto& item : dictionary)
+    {
+      if(false == first) so.buf.sputc(',');
+      first = false;
+      write_string(so, item.object.name());
+      so.buf.sputc(':');
+      write_object(so, item.object);
+    }
+    so.buf.sputc('}');
+    return so;
+  }
+
+  reader::reader(const Dictionary& dictionary) NOEXCEPT
+    : dictionary_(dictionary)
+  {
+    reset();
+  }
+
+  void reader::reset() NOEXCEPT
+  {
+    item_    = nullptr;
+    subIdx_  = -1;
+    type_    = DataType::Invalid;
+    index_   = 0;
+    depth_   = 0;
+    skip_    = 0;
+    state_   = State::Begin;
+    objects_ = 0;
+    error_   = Error::OK;
+    count_   = 0;
+  }
+
+  void reader::fail(int32_t e) NOEXCEPT
+  {
+    if(error_ == Error::OK) error_ = e;
+  }
+
+  void reader::select(string_view key) NOEXCEPT
+  {
+    type_ = DataType::Invalid;
+    if(skip_ != 0) return;
+
+    int32_t e;
+    if(depth_ == 1)
+    {
+      // Top-level keys are queries, so a single field can be selected with "object.field"
+      Dictionary::Query query{ key };
+      e     = dictionary_.query(query);
+      item_ = e == Error::OK ? query.item : nullptr;
+      if(e == Error::OK)
+      {
+        subIdx_ = query.subIdx;
+        type_   = query.info->type;
+        return;
+      }
+    }
+    else
+    {
+      // Keys of a nested object select fields of the object selected at the top level
+      string_view           none;
+      Dictionary::Query     query{ none };
+      query.item           = item_;
+      query.subobject_name = key;
+      e = key.empty() ? static_cast<int32_t>(Error::FieldNotFound) : Dictionary::query_field(query);
+      if(e == Error::OK)
+      {
+        subIdx_ = query.subIdx;
+        type_   = query.info->type;
+        return;
+      }
+    }
+    fail(e);
+  }
+
+  void reader::select_next() NOEXCEPT
+  {
+    type_ = DataType::Invalid;
+    if(skip_ != 0 || depth_ != 2) return;
+
+    // Values of a nested array are the fields of the object selected at the top level, in order
+    auto& info = item_->object.info();
+    if(index_ > info.nelem)
+    {
+      fail(Error::FieldNotFound);
+      return;
+    }
+    subIdx_ = index_++;
+    if(info.otype == Object::ClassId::Record)
+    {
+      auto& record = static_cast<const Record::Info&>(info);
+      type_        = record.descriptor(record.fields[subIdx_ - 1]).type;
+    }
+    else
+    {
+      type_ = info.type;
+    }
+  }
+
+  bool reader::open(bool object) NOEXCEPT
+  {
+    if(depth_ == max_depth)
+    {
+      state_ = State::Overflow;
+      return false;
+    }
+
+    if(skip_ == 0 && depth_ != 0)
+    {
+      // Only a whole record or array selected at the top level can be given as an object or array
+      auto otype = depth_ == 1 && type_ != DataType::Invalid && subIdx_ < 0 ? item_->object.otype()
+                                                                            : Object::ClassId::Invalid;
+      if(otype == Object::ClassId::Record || otype == Object::ClassId::Array)
+      {
+        index_ = 1;
+      }
+      else
+      {
+        if(type_ != DataType::Invalid) fail(Error::DataTypeError);
+        skip_ = depth_ + 1;
+      }
+    }
+
+    if(object) objects_ |= uint32_t(1) << depth_;
+    else objects_ &= ~(uint32_t(1) << depth_);
+    ++depth_;
+    state_ = object ? State::FirstKey : State::FirstValue;
+    return true;
+  }
+
+  bool reader::close(bool object) NOEXCEPT
+  {
+    bool is_object = depth_ > 0 && ((objects_ >> (depth_ - 1)) & 1U) != 0;
+    if(depth_ == 0 || is_object != object)
+    {
+      state_ = State::Invalid;
+      return false;
+    }
+    --depth_;
+    if(depth_ < skip_) skip_ = 0;
+    type_  = DataType::Invalid;
+    state_ = depth_ == 0 ? State::Done : State::Next;
+    return true;
+  }
+
+  void reader::set(string_view token, bool string) NOEXCEPT
+  {
+    if(type_ == DataType::Invalid) return;
+
+    const Object& object = item_->object;
+    int16_t       subIdx = subIdx_;
+    if(subIdx < 0)
+    {
+      // A whole object can only be set from a single value if it is a variable
+      if(object.otype() != Object::ClassId::Variable)
+      {
+        fail(Error::DataTypeError);
+        return;
+      }
+      subIdx = 0;
+    }
+
+    int32_t e = Error::DataTypeError;
+    auto    id = static_cast<uint8_t>(subIdx);
+    if(string)
+    {
+      if(type_ == DataType::String || type_ == DataType::BinString) e = object.set(id, token.data(), token.size());
+    }
+    else
+    {
+      switch(type_)
+      {
+        case DataType::U8:  e = set_integer<uint8_t>(object, id, token); break;
+        case DataType::U16: e = set_integer<uint16_t>(object, id, token); break;
+        case DataType::U32: e = set_integer<uint32_t>(object, id, token); break;
+        case DataType::I8:  e = set_integer<int8_t>(object, id, token); break;
+        case DataType::I16: e = set_integer<int16_t>(object, id, token); break;
+        case DataType::I32: e = set_integer<int32_t>(object, id, token); break;
+        default: break;
+      }
+    }
+
+    if(e == Error::OK) ++count_;
+    else fail(e);
+  }
+
+  ParseStatus reader::parse(string_view& in) NOEXCEPT
+  {
+    const char* p   = in.begin();
+    const char* end = in.end();
+    char        temp[64]; // Decoded strings which contain escape sequences
+    bool        more = true;
+
+    while(more && state_ < State::Done)
+    {
+      while(p != end && estd::isspace(*p)) ++p;
+      if(p == end) break;
+
+      const char* next = p + 1; // End of the token at p
+      switch(state_)
+      {
+        case State::Begin:
+          if(*p == '{') open(true);
+          else state_ = State::Invalid;
+          break;
+
+        case State::FirstKey:
+          if(*p == '}')
+          {
+            close(true);
+            break;
+          }
+          // fall through
+        case State::Key:
+        {
+          string_view content, key;
+          bool        escaped;
+          auto        status = *p == '"' ? scan_string(p, end, content, escaped) : ParseStatus::NotMatched;
+          if(status == ParseStatus::OK && escaped) status = unescape(content, temp, sizeof(temp), key);
+          else key = content;
+
+          if(status == ParseStatus::Incomplete) more = false;
+          else if(status == ParseStatus::NotMatched) state_ = State::Invalid;
+          else
+          {
+            if(status == ParseStatus::OK) select(key);
+            else
+            {
+              // Too long to be the name of anything, so skip its value
+              if(depth_ == 1) item_ = nullptr;
+              type_ = DataType::Invalid;
+              if(skip_ == 0) fail(Error::ObjectNotFound);
+            }
+            next   = content.end() + 1;
+            state_ = State::Colon;
+          }
+          break;
+        }
+
+        case State::Colon:
+          if(*p == ':') state_ = State::Value;
+          else state_ = State::Invalid;
+          break;
+
+        case State::FirstValue:
+          if(*p == ']')
+          {
+            close(false);
+            break;
+          }
+          // fall through
+        case State::Value:
+          if(*p == '{') open(true);
+          else if(*p == '[')
+          {
+            if(open(false)) select_next();
+          }
+          else if(*p == '"')
+          {
+            string_view content, value;
+            bool        escaped;
+            auto        status = scan_string(p, end, content, escaped);
+            if(status == ParseStatus::OK && escaped) status = unescape(content, temp, sizeof(temp), value);
+            else value = content;
+
+            if(status == ParseStatus::Incomplete) more = false;
+            else if(status == ParseStatus::NotMatched) state_ = State::Invalid;
+            else
+            {
+              if(status == ParseStatus::OK) set(value, true);
+              else if(type_ != DataType::Invalid) fail(Error::ParamTooLong);
+              next   = content.end() + 1;
+              state_ = State::Next;
+            }
+          }
+          else
+          {
+            // Numbers and literals end at the next delimiter, so they are only complete once it has been received
+            const char* q = p;
+            while(q != end && is_token_char(*q)) ++q;
+            string_view token(p, q);
+            if(q == end) more = false;
+            else if(token.empty()) state_ = State::Invalid;
+            else
+            {
+              if(token == "true") set("1", false);
+              else if(token == "false") set("0", false);
+              else if(token == "null") {}
+              else if(token[0] == '-' || (token[0] >= '0' && token[0] <= '9')) set(token, false);
+              else state_ = State::Invalid;
+
+              next = q;
+              if(state_ != State::Invalid) state_ = State::Next;
+            }
+          }
+          break;
+
+        case State::Next:
+          if(*p == ',')
+          {
+            if(((objects_ >> (depth_ - 1)) & 1U) != 0) state_ = State::Key;
+            else
+            {
+              state_ = State::Value;
+              select_next();
+            }
+          }
+          else if(*p == '}' || *p == ']') close(*p == '}');
+          else state_ = State::Invalid;
+          break;
+
+        default: break;
+      }
+
+      if(more) p = next;
+    }
+
+    in = string_view(p, end);
+    switch(state_)
+    {
+      case State::Done:     return ParseStatus::OK;
+      case State::Invalid:  return ParseStatus::NotMatched;
+      case State::Overflow: return ParseStatus::Overflow;
+      default:              return ParseStatus::Incomplete;
+    }
+  }
+
+  ParseStatus reader::poll(buffer& buf) NOEXCEPT
+  {
+    int         available = buf.poll();
+    string_view in        = buf.get();
+    auto        start     = in.data();
+    auto        status    = parse(in);
+    buf.gadvance(in.data());
+
+    // The buffer is full without holding a complete token, so the token can never be parsed
+    if(status == ParseStatus::Incomplete && available == EOF && in.data() == start)
+    {
+      state_ = State::Overflow;
+      return ParseStatus::Overflow;
+    }
+    return status;
+  }
+}
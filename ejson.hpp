@@ -0,0 +1,108 @@
+#pragma once
+
+/// \file ejson.hpp
+/// JSON export and import of dictionary objects, without dynamic allocation or exceptions.
+/// The writer streams objects to an eformat::stream. The reader is incremental: it parses input as it arrives and
+/// sets each value as soon as it is parsed, so a document never has to be held in memory, only its current token
+
+#include "eformat.hpp"
+#include "eio.hpp"
+#include "eobject.hpp"
+
+namespace ejson {
+  typedef eio::buffer buffer;
+  typedef estd::string_view string_view;
+  using eformat::ParseStatus;
+  using eobject::DataType;
+  using eobject::Dictionary;
+  using eobject::Object;
+
+  /// \defgroup Writer Functions to write objects as JSON
+  /// @{
+
+  /// \brief Write string as a JSON string, escaping quotes, backslashes and control characters
+  eformat::stream& write_string(eformat::stream& so, string_view str) NOEXCEPT;
+
+  /// \brief Write value of native type
+  /// \remarks Strings are written up to the first null, and types without a JSON representation are written as null
+  eformat::stream& write_value(eformat::stream& so, const void* data, size_t size, DataType type) NOEXCEPT;
+
+  /// \brief Write object value
+  /// \remarks Variables are written as a single value, arrays as an array of elements, records as an object keyed
+  ///          by field name, and tables as an array of rows, each an array of values. Write-only objects are written
+  ///          as null
+  eformat::stream& write(eformat::stream& so, const Object& object) NOEXCEPT;
+
+  /// \brief Write all objects in dictionary, as an object keyed by object name
+  eformat::stream& write(eformat::stream& so, const Dictionary& dictionary) NOEXCEPT;
+
+  /// @}
+
+  /// \brief Incremental reader, which sets dictionary values from a JSON document
+  /// \remarks The document is an object keyed by dictionary queries, such as "motor" or "motor.speed". Records and
+  ///          arrays may be given as objects keyed by field name, or as arrays of values in field order, and null
+  ///          values are skipped. Tables are not read, since their rows are set whole, and fail with DataTypeError.
+  ///          An error from a lookup or set function does not stop parsing: the value is skipped, and the first error
+  ///          is kept
+  struct reader
+  {
+    /// \brief Maximum depth of nested objects and arrays
+    static const uint8_t max_depth = 32;
+
+    explicit reader(const Dictionary& dictionary) NOEXCEPT;
+
+    /// \brief Parse as much of the input as possible
+    /// \param in Input, which is advanced past each complete token. A token cut off by the end of the input is left
+    ///           in place, and the next call must start with it
+    /// \returns OK once the document is complete, Incomplete if more input is needed, NotMatched on a syntax error,
+    ///          or Overflow if nesting is too deep
+    ParseStatus parse(string_view& in) NOEXCEPT;
+
+    /// \brief Read available input from buffer, and parse it
+    /// \returns As for parse, or Overflow if the input buffer is full without holding a complete token
+    ParseStatus poll(buffer& buf) NOEXCEPT;
+
+    /// \brief Prepare to read a new document
+    void reset() NOEXCEPT;
+
+    /// \brief Get first error from looking up or setting a value, or Error::OK
+    int32_t error() const NOEXCEPT { return error_; }
+
+    /// \brief Get number of values set
+    uint16_t count() const NOEXCEPT { return count_; }
+
+  private:
+    enum class State : uint8_t
+    {
+      Begin,      ///< Before the document
+      FirstKey,   ///< After '{', expecting a key or '}'
+      Key,        ///< After ',' in an object, expecting a key
+      Colon,      ///< After a key
+      FirstValue, ///< After '[', expecting a value or ']'
+      Value,      ///< After ':', or ',' in an array
+      Next,       ///< After a value, expecting ',' or the end of the container
+      Done,       ///< After the document
+      Invalid,    ///< After a syntax error
+      Overflow    ///< After nesting too deep, or a token too long for the buffer
+    };
+
+    void fail(int32_t e) NOEXCEPT;
+    void select(string_view key) NOEXCEPT;
+    void select_next() NOEXCEPT;
+    bool open(bool object) NOEXCEPT;
+    bool close(bool object) NOEXCEPT;
+    void set(string_view token, bool string) NOEXCEPT;
+
+    const Dictionary&       dictionary_;
+    const Dictionary::Item* item_;    ///< Object selected by the last top-level key, or nullptr
+    int16_t                 subIdx_;  ///< Subindex selected for the next value, or -1 for the whole object
+    DataType                type_;    ///< Type of the next value, or Invalid if it is skipped
+    uint8_t                 index_;   ///< Subindex of the next value in an array of fields
+    uint8_t                 depth_;   ///< Number of open objects and arrays
+    uint8_t                 skip_;    ///< Depth of the outermost container being skipped, or 0
+    State                   state_;
+    uint32_t                objects_; ///< Bit set for each open container which is an object rather than an array
+    int32_t                 error_;
+    uint16_t                count_;
+  };
+}
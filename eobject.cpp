@@ -46,6 +46,7 @@ string_view to_string(Object::ClassId type) NOEXCEPT
     case Object::ClassId::Variable: return "Variable";
     case Object::ClassId::Record: return "Record";
     case Object::ClassId::Array: return "Array";
+    case Object::ClassId::Table: return "Table";
     default: return "Object";
   }
 }
@@ -107,9 +108,10 @@ int32_t Object::get(uint8_t subIdx, void* buffer, size_t size) const NOEXCEPT
         }
         else
         {
-          const Record::FieldInfo& info      = static_cast<const Record::Info&>(this->info()).fields[subIdx-1];
-          const void*              dataptr   = data(info.data_offset);
-          size_t                   data_size = info.data_size;
+          auto&       info      = static_cast<const Record::Info&>(this->info());
+          auto&       field     = info.fields[subIdx - 1];
+          const void* dataptr   = data(field.data_offset);
+          size_t      data_size = info.descriptor(field).data_size;
           if (data_size > size) return static_cast<int>(Error::ParamTooShort);
           memcpy(buffer, dataptr, data_size);
           return data_size;
@@ -119,10 +121,182 @@ int32_t Object::get(uint8_t subIdx, void* buffer, size_t size) const NOEXCEPT
       {
         return static_cast<int>(Error::FieldNotFound);
       }
+    case Object::ClassId::Table:
+      if (subIdx <= info_->nelem)
+      {
+        if(subIdx == 0)
+        {
+          *reinterpret_cast<uint8_t*>(buffer) = info_->nelem;
+          return sizeof(uint8_t);
+        }
+        else
+        {
+          size_t      row_size = static_cast<const Table::Info&>(this->info()).row_size();
+          const void* dataptr  = data(info_->data_offset + row_size * (subIdx - 1u));
+          if (row_size > size) return static_cast<int>(Error::ParamTooShort);
+          memcpy(buffer, dataptr, row_size);
+          return row_size;
+        }
+      }
+      else
+      {
+        return static_cast<int>(Error::FieldNotFound);
+      }
     default: return static_cast<int>(Error::ObjectNotFound);
   }
 }
 
+Object::TraceFunctionType Object::trace_function = nullptr;
+
+const void* Object::locate(uint8_t subIdx, size_t& size) const NOEXCEPT
+{
+  size = 0;
+  if (data_ == nullptr) return nullptr;
+
+  switch (info_->otype)
+  {
+    case ClassId::Variable:
+      if (subIdx != 0) return nullptr;
+      size = info_->data_size;
+      return data(info_->data_offset);
+    case ClassId::Array:
+    {
+      if (subIdx == 0 || subIdx > info_->nelem) return nullptr;
+      size_t elem_size = type_size(info_->type);
+      size             = elem_size;
+      return data(static_cast<uint16_t>(info_->data_offset + elem_size * (subIdx - 1u)));
+    }
+    case ClassId::Record:
+    {
+      if (subIdx == 0 || subIdx > info_->nelem) return nullptr;
+      auto& info  = *static_cast<const Record::Info*>(info_);
+      auto& field = info.fields[subIdx - 1];
+      size        = info.descriptor(field).data_size;
+      return data(field.data_offset);
+    }
+    case ClassId::Table:
+    {
+      if (subIdx == 0 || subIdx > info_->nelem) return nullptr;
+      size_t row_size = static_cast<const Table::Info*>(info_)->row_size();
+      size            = row_size;
+      return data(static_cast<uint16_t>(info_->data_offset + row_size * (subIdx - 1u)));
+    }
+    default: return nullptr;
+  }
+}
+
+uint32_t Object::trace_value(uint8_t subIdx) const NOEXCEPT
+{
+  size_t      size   = 0;
+  const void* source = locate(subIdx, size);
+
+  // Numbers are traced whole, and strings by their first characters. Copies are of fixed size, so they are inlined
+  uint32_t value = 0;
+  switch (size)
+  {
+    case 0: break;
+    case 1: memcpy(&value, source, 1); break;
+    case 2: memcpy(&value, source, 2); break;
+    case 3: memcpy(&value, source, 3); break;
+    default: memcpy(&value, source, 4); break;
+  }
+  return value;
+}
+
+int32_t Object::set_traced(uint8_t subIdx, const void* data, size_t size, uint16_t address) const NOEXCEPT
+{
+  uint32_t old_value = trace_value(subIdx);
+  int32_t  ret       = info_->set_function(*this, subIdx, data, size);
+
+  // Read the function again, in case tracing was stopped while setting
+  TraceFunctionType trace = trace_function;
+  if (ret == Error::OK && trace != nullptr) trace(*this, address, subIdx, old_value, trace_value(subIdx));
+  return ret;
+}
+
+namespace {
+  template<class T>
+  int32_t check_range(const Object::RangeInfo& range, const void* value, size_t size) NOEXCEPT
+  {
+    return Object::detail::check<T>(range.min<T>(), range.max<T>(), value, size);
+  }
+
+  /// \brief Check every value of a table row, which may be unaligned
+  template<class T>
+  int32_t check_row(const Object::RangeInfo& range, const void* row, size_t size) NOEXCEPT
+  {
+    auto values = static_cast<const uint8_t*>(row);
+    for (size_t i = 0; i + sizeof(T) <= size; i += sizeof(T))
+    {
+      T value;
+      memcpy(&value, values + i, sizeof(T));
+      auto e = check_range<T>(range, &value, sizeof(T));
+      if (e != Error::OK) return e;
+    }
+    return Error::OK;
+  }
+}
+
+int32_t Object::validate(uint8_t subIdx) const NOEXCEPT
+{
+  size_t      size  = 0;
+  const void* value = locate(subIdx, size);
+  if (value == nullptr) return data_ == nullptr ? Error::WriteOnly : Error::FieldNotFound;
+
+  const RangeInfo* range = nullptr;
+  DataType         type  = info_->type;
+  switch (info_->otype)
+  {
+    case ClassId::Variable: range = &static_cast<const Variable::Info*>(info_)->range; break;
+    case ClassId::Array: range = &static_cast<const Array::Info*>(info_)->range; break;
+    case ClassId::Record:
+    {
+      auto& info       = *static_cast<const Record::Info*>(info_);
+      auto& descriptor = info.descriptor(info.fields[subIdx - 1]);
+      range            = &descriptor.range;
+      type             = descriptor.type;
+      break;
+    }
+    case ClassId::Table:
+    {
+      auto& table = static_cast<const Table::Info*>(info_)->range;
+      switch (type)
+      {
+        case DataType::U8: return check_row<uint8_t>(table, value, size);
+        case DataType::U16: return check_row<uint16_t>(table, value, size);
+        case DataType::U32: return check_row<uint32_t>(table, value, size);
+        case DataType::I8: return check_row<int8_t>(table, value, size);
+        case DataType::I16: return check_row<int16_t>(table, value, size);
+        case DataType::I32: return check_row<int32_t>(table, value, size);
+        default: return Error::OK;
+      }
+    }
+    default: return Error::OK;
+  }
+
+  switch (type)
+  {
+    case DataType::U8: return check_range<uint8_t>(*range, value, size);
+    case DataType::U16: return check_range<uint16_t>(*range, value, size);
+    case DataType::U32: return check_range<uint32_t>(*range, value, size);
+    case DataType::I8: return check_range<int8_t>(*range, value, size);
+    case DataType::I16: return check_range<int16_t>(*range, value, size);
+    case DataType::I32: return check_range<int32_t>(*range, value, size);
+    default: return Error::OK;
+  }
+}
+
+const Object::Unit* unit_of(const Object::Info& info) NOEXCEPT
+{
+  switch (info.otype)
+  {
+    case Object::ClassId::Variable: return static_cast<const Variable::Info&>(info).unit;
+    case Object::ClassId::Array: return static_cast<const Array::Info&>(info).unit;
+    case Object::ClassId::Table: return static_cast<const Table::Info&>(info).unit;
+    default: return nullptr;
+  }
+}
+
 Object::FieldInfo Object::info(uint8_t subIdx) const NOEXCEPT
 {
   FieldInfo finfo = { &info(), nullptr };
@@ -135,10 +309,11 @@ Object::FieldInfo Object::info(uint8_t subIdx) const NOEXCEPT
     switch (info_->otype)
     {
       case ClassId::Record: {
-        auto temp  = static_cast<const Record::Info*>(info_)->fields + subIdx - 1;
-        finfo.info = temp;
-        finfo.name = &temp->name;
-        finfo.size = temp->data_size;
+        auto& record = *static_cast<const Record::Info*>(info_);
+        auto  temp   = record.fields + subIdx - 1;
+        finfo.info   = &record.descriptor(*temp);
+        finfo.name   = &temp->name;
+        finfo.size   = finfo.info->data_size;
         break;
       }
       case ClassId::Array: {
@@ -148,12 +323,57 @@ Object::FieldInfo Object::info(uint8_t subIdx) const NOEXCEPT
         finfo.offset = info_->data_offset + finfo.size * (subIdx - 1u);
         break;
       }
+      case ClassId::Table: {
+        // Rows are numbered, not named
+        finfo.size   = static_cast<const Table::Info*>(info_)->row_size();
+        finfo.offset = info_->data_offset + finfo.size * (subIdx - 1u);
+        break;
+      }
       default: break;
     }
   }
   return finfo;
 }
 
+int32_t Table::get_column(const Object& object, uint16_t column, void* buffer, size_t size) NOEXCEPT
+{
+  auto& info = static_cast<const Info&>(object.info());
+  if (info.otype != Object::ClassId::Table || column >= info.row_length()) return Error::FieldNotFound;
+  if (object.data() == nullptr) return Error::WriteOnly;
+
+  const size_t elem_size = type_size(info.type);
+  if (size < elem_size * info.nelem) return Error::ParamTooShort;
+
+  auto source = static_cast<const uint8_t*>(object.data()) + elem_size * column;
+  auto dest   = static_cast<uint8_t*>(buffer);
+  for (uint8_t row = 0; row < info.nelem; ++row, source += info.row_size(), dest += elem_size)
+    memcpy(dest, source, elem_size);
+  return static_cast<int32_t>(elem_size * info.nelem);
+}
+
+int32_t Table::set_column(const Object& object, uint16_t column, const void* data, size_t size) NOEXCEPT
+{
+  auto& info = static_cast<const Info&>(object.info());
+  if (info.otype != Object::ClassId::Table || column >= info.row_length()) return Error::FieldNotFound;
+  if (object.data() == nullptr) return Error::WriteOnly;
+
+  const size_t elem_size = type_size(info.type);
+  if (size > elem_size * info.nelem) return Error::ParamTooLong;
+  else if (size < elem_size * info.nelem)
+    return Error::ParamTooShort;
+
+  uint8_t row[MaxRowSize];
+  auto    source = static_cast<const uint8_t*>(data);
+  for (uint8_t subIdx = 1; subIdx <= info.nelem; ++subIdx, source += elem_size)
+  {
+    object.get(subIdx, row, sizeof(row));
+    memcpy(row + elem_size * column, source, elem_size);
+    auto e = object.set(subIdx, row, info.row_size());
+    if (e != Error::OK) return e;
+  }
+  return Error::OK;
+}
+
 Record::Info::iterator Record::Info::find(string_view name) const NOEXCEPT
 {
   auto it = fields;
@@ -166,6 +386,7 @@ Record::Info::iterator Record::Info::find(string_view name) const NOEXCEPT
 
 const Dictionary::Item* Dictionary::find(const string_view& name) const NOEXCEPT
 {
+  if (names != nullptr) return names->find(name);
   for (auto& item : *this)
   {
     if (item.object.name() == name) return &item;
@@ -173,6 +394,73 @@ const Dictionary::Item* Dictionary::find(const string_view& name) const NOEXCEPT
   return nullptr;
 }
 
+namespace {
+  /// \brief Copies defaults over the data of objects in a mask, in runs of objects which are contiguous in both
+  struct Reset
+  {
+    explicit Reset(PermissionMask mask_in) NOEXCEPT
+      : mask(mask_in)
+    {}
+
+    void add(const Object::Info& info, const void* data, const void* defaults) NOEXCEPT
+    {
+      if (defaults == nullptr || data == nullptr || (permission_mask(info.perm) & mask) == 0) return;
+
+      auto to   = static_cast<uint8_t*>(const_cast<void*>(data));
+      auto from = static_cast<const uint8_t*>(defaults);
+      if (to != run_data + run_size || from != run_defaults + run_size)
+      {
+        if (run_size != 0) memcpy(run_data, run_defaults, run_size);
+        run_data     = to;
+        run_defaults = from;
+        run_size     = 0;
+      }
+      run_size += info.data_size;
+      ++count;
+    }
+
+    /// \returns Number of objects reset
+    uint16_t finish() NOEXCEPT
+    {
+      if (run_size != 0) memcpy(run_data, run_defaults, run_size);
+      run_size = 0;
+      return count;
+    }
+
+    PermissionMask mask;
+    uint8_t*       run_data     = nullptr;
+    const uint8_t* run_defaults = nullptr;
+    size_t         run_size     = 0;
+    uint16_t       count        = 0;
+  };
+}
+
+uint16_t Dictionary::reset(PermissionMask mask) const NOEXCEPT
+{
+  if (defaults == nullptr) return 0;
+  Reset reset(mask);
+  for (const auto& item : *this) reset.add(item.object.info(), item.object.data(), defaults[&item - begin()]);
+  return reset.finish();
+}
+
+uint16_t View::reset() const NOEXCEPT
+{
+  if (dictionary->defaults == nullptr) return 0;
+  Reset reset(mask);
+  for (auto it = begin(); it != end(); ++it)
+    reset.add(it->object.info(), it->object.data(), dictionary->defaults[*it.slot]);
+  return reset.finish();
+}
+
+uint16_t CompactDictionary::reset(PermissionMask mask) const NOEXCEPT
+{
+  if (defaults == nullptr) return 0;
+  Reset reset(mask);
+  for (uint16_t i = 0; i < count; ++i)
+    reset.add(*infos[i], static_cast<uint8_t*>(storage) + offsets[i], static_cast<const uint8_t*>(defaults) + offsets[i]);
+  return reset.finish();
+}
+
 const Object* Dictionary::get(uint16_t address) const NOEXCEPT
 {
   auto it = estd::lower_bound(
@@ -182,40 +470,122 @@ const Object* Dictionary::get(uint16_t address) const NOEXCEPT
 
 int32_t Dictionary::query(Dictionary::Query& q) const NOEXCEPT
 {
+  if (names != nullptr) return names->query(q);
   q.item = find(q.object_name);
-  if (q.item != nullptr)
+  if (q.item != nullptr) return query_field(q);
+  return Error::ObjectNotFound;
+}
+
+CompactDictionary::Ref<Object> CompactDictionary::get(uint16_t address) const NOEXCEPT
+{
+  auto it = estd::lower_bound(
+    addresses, addresses + count, address, [](uint16_t l, uint16_t address) -> bool { return l < address; });
+  if (it == addresses + count || *it != address) return Ref<Object>{ Object(), false };
+  return Ref<Object>{ (*this)[static_cast<uint16_t>(it - addresses)].object, true };
+}
+
+CompactDictionary::Ref<CompactDictionary::Item> CompactDictionary::find(const string_view& name) const NOEXCEPT
+{
+  for (uint16_t i = 0; i < count; ++i)
   {
-    if (q.subobject_name.empty() == false)
+    if (this->name(i) == name) return Ref<Item>{ (*this)[i], true };
+  }
+  return Ref<Item>{ Item(), false };
+}
+
+int32_t CompactDictionary::query(Query& q) const NOEXCEPT
+{
+  auto item = find(q.object_name);
+  if (item == nullptr) return Error::ObjectNotFound;
+  q.found = *item;
+  q.item  = &q.found;
+  return Dictionary::query_field(q);
+}
+
+const Dictionary::Item* NameIndex::find(const string_view& name) const NOEXCEPT
+{
+  eatom::atom a = atoms->find(name);
+  if (a == eatom::NoAtom || items[a] == NoItem) return nullptr;
+  return dictionary->begin() + items[a];
+}
+
+int32_t NameIndex::query(Dictionary::Query& q) const NOEXCEPT
+{
+  q.item = find(q.object_name);
+  if (q.item == nullptr) return Error::ObjectNotFound;
+
+  // Subobjects of other classes are not named, e.g. rows of tables
+  auto otype = q.item->object.otype();
+  if (q.subobject_name.empty() || (otype != Object::ClassId::Record && otype != Object::ClassId::Array))
+    return Dictionary::query_field(q);
+
+  const uint16_t i = static_cast<uint16_t>(q.item - dictionary->begin());
+  eatom::atom    a = atoms->find(q.subobject_name);
+  for (uint16_t f = first[i]; a != eatom::NoAtom && f != first[i + 1]; ++f)
+  {
+    if (fields[f] != a) continue;
+    q.subIdx = static_cast<int16_t>(f - first[i] + 1);
+    if (otype == Object::ClassId::Record)
     {
-      if (q.item->object.otype() == Object::ClassId::Record)
-      {
-        const Record::Info& info  = static_cast<const Record::Info&>(q.item->object.info());
-        auto                finfo = info.find(q.subobject_name);
-        // Get type info for this field
-        if (finfo != info.end())
-        {
-          q.info   = &(*finfo);
-          q.subIdx = finfo - info.begin() + 1;
-          return Error::OK;
-        }
-      }
-      else if (q.item->object.otype() == Object::ClassId::Array)
+      auto& record = static_cast<const Record::Info&>(q.item->object.info());
+      q.info       = &record.descriptor(record.fields[q.subIdx - 1]);
+    }
+    else
+    {
+      q.info = &q.item->object.info();
+    }
+    return Error::OK;
+  }
+  return Error::FieldNotFound;
+}
+
+int32_t Dictionary::query_field(Dictionary::Query& q) NOEXCEPT
+{
+  if (q.subobject_name.empty() == false)
+  {
+    if (q.item->object.otype() == Object::ClassId::Record)
+    {
+      const Record::Info& info  = static_cast<const Record::Info&>(q.item->object.info());
+      auto                finfo = info.find(q.subobject_name);
+      // Get type info for this field
+      if (finfo != info.end())
       {
-        const Array::Info& info = static_cast<const Array::Info&>(q.item->object.info());
-        q.subIdx                = info.find(q.subobject_name) + 1;
-        // All array elements share the same type
-        q.info = &info;
-        if (q.subIdx != info.nelem) { return Error::OK; }
+        q.info   = &info.descriptor(*finfo);
+        q.subIdx = finfo - info.begin() + 1;
+        return Error::OK;
       }
-      return Error::FieldNotFound;
     }
-    else
+    else if (q.item->object.otype() == Object::ClassId::Array)
     {
-      // Simple info
+      const Array::Info& info = static_cast<const Array::Info&>(q.item->object.info());
+      q.subIdx                = info.find(q.subobject_name) + 1;
+      // All array elements share the same type
+      q.info = &info;
+      if (q.subIdx <= info.nelem) { return Error::OK; }
+    }
+    else if (q.item->object.otype() == Object::ClassId::Table)
+    {
+      // Rows are addressed by number from 0, so map.2 is the third row
+      uint32_t row = 0;
+      for (char c : q.subobject_name)
+      {
+        if (c < '0' || c > '9' || row > 255) return Error::FieldNotFound;
+        row = row * 10 + (c - '0');
+      }
       q.info = &q.item->object.info();
-      return Error::OK;
+      if (row < q.info->nelem)
+      {
+        q.subIdx = static_cast<uint8_t>(row + 1);
+        return Error::OK;
+      }
     }
+    return Error::FieldNotFound;
   }
-  return Error::ObjectNotFound;
+  else
+  {
+    // Simple info
+    q.info = &q.item->object.info();
+    return Error::OK;
+  }
+}
 }
-}
\ No newline at end of file
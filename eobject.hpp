@@ -8,7 +8,9 @@
 /// parameters
 
 #include "array.hpp"
+#include "eatom.hpp"
 #include "estring.hpp"
+#include "mdspan.hpp"
 #include "span.hpp"
 #include <cassert>
 #include <iterator>
@@ -81,6 +83,9 @@ enum class DataType : uint8_t
 /// \brief Get string describing type
 string_view to_string(DataType type) NOEXCEPT;
 
+/// \brief Get size of a single value of a native type, or of one character for strings
+size_t type_size(DataType type) NOEXCEPT;
+
 /// \brief Lookup native datatype ID by type
 template<class T>
 struct Type_
@@ -208,6 +213,19 @@ struct Object
       return Error::OK;
     }
 
+    /// \brief Set binary string, which has no terminator so may fill its storage
+    template<size_t Length>
+    static int32_t set_binstring_variable(const Object& object, uint8_t, const void* data, size_t size) NOEXCEPT
+    {
+      if (size > Length) return Error::ParamTooLong;
+
+      char* dest_data = static_cast<char*>(const_cast<void*>(object.data()));
+      memcpy(dest_data, data, size);
+      if(size < Length)
+        memset(dest_data + size, 0, Length - size);
+      return Error::OK;
+    }
+
     template<class T, int32_t (*setf)(T), T min = T(), T max = T()>
     static int32_t set_wrapper(const Object&, uint8_t, const void* data, size_t size) NOEXCEPT
     {
@@ -238,7 +256,8 @@ struct Object
     Invalid  = 0x0, ///< Invalid/unassigned
     Variable = 0x1, ///< Simple variable (contains single value)
     Array    = 0x2, ///< Array contains multiple named members with same type
-    Record   = 0x3  ///< Record contains multiple named members with varying types
+    Record   = 0x3, ///< Record contains multiple named members with varying types
+    Table    = 0x4  ///< Table contains values of the same type in two or more dimensions, addressed by row
   };
 
   /// \brief Represents how access is controlled to this object
@@ -276,6 +295,14 @@ struct Object
     constexpr bool valid() const NOEXCEPT { return max != min; }
   };
 
+  /// \brief Engineering unit of a scaled integer value, which holds the value in units times 10^decimals, e.g. 1234
+  ///        for 12.34 A with 2 decimals. Shared by every value in the unit, so it costs a pointer per value
+  struct Unit
+  {
+    uint8_t     decimals; ///< Number of decimal digits after the point, up to 9
+    string_view symbol;   ///< Symbol printed after values, may be empty
+  };
+
   /// \brief Packages ranges of different types together for storage in a generic type
   union RangeInfo
   {
@@ -351,7 +378,7 @@ struct Object
   const string_view& name() const { return name_; }
 
   /// \brief Get object metadata
-  const Info& info() const NOEXCEPT { return *info_; }
+  constexpr const Info& info() const NOEXCEPT { return *info_; }
   /// \brief Get object category
   ClassId otype() const { return info_->otype; }
   /// \brief Get data type
@@ -359,9 +386,30 @@ struct Object
   /// \brief Get number of elements contained in object
   uint8_t count() const { return info_->nelem; }
 
+  /// \brief Address passed to the trace function for objects which are not set through a dictionary
+  static constexpr uint16_t NoAddress = 0xFFFF;
+
+  /// \brief Function called after a value has been set, e.g. to record changes
+  /// \param address   Address of the object in the dictionary which set it, or NoAddress
+  /// \param old_value First 4 bytes of the value before it was set, in native byte order and zero padded
+  /// \param new_value First 4 bytes of the value after it was set
+  typedef void (*TraceFunctionType)(const Object& object, uint16_t address, uint8_t subIdx, uint32_t old_value,
+                                    uint32_t new_value);
+
+  /// \brief Function to call after every successful set, or nullptr to trace nothing
+  /// \remarks Tracing costs a single test on each set while it is disabled
+  static TraceFunctionType trace_function;
+
   /// \brief Set value in object
   int32_t set(uint8_t subIdx, const void* data, size_t size) const NOEXCEPT
   {
+    return set(subIdx, data, size, NoAddress);
+  }
+
+  /// \brief Set value in object at address of a dictionary, which is passed to the trace function
+  int32_t set(uint8_t subIdx, const void* data, size_t size, uint16_t address) const NOEXCEPT
+  {
+    if (trace_function != nullptr) return set_traced(subIdx, data, size, address);
     return info_->set_function(*this, subIdx, data, size);
   }
 
@@ -406,6 +454,17 @@ struct Object
 
   FieldInfo info(uint8_t subIdx) const NOEXCEPT;
 
+  /// \brief Get pointer to the value stored at subindex, so it can be read directly, e.g. by a sampler
+  /// \param size Set to the size of the value
+  /// \returns Pointer to value, or nullptr if the subindex does not exist or the object has no storage
+  const void* locate(uint8_t subIdx, size_t& size) const NOEXCEPT;
+
+  /// \brief Check that the value stored at subindex is in the range of its metadata, e.g. after the storage has been
+  ///        loaded from an image rather than written through set
+  /// \returns Error::OK, Error::ValueTooLow or Error::ValueTooHigh, or Error::FieldNotFound if the subindex does not
+  ///          exist. Strings and values without a range are always in range
+  int32_t validate(uint8_t subIdx) const NOEXCEPT;
+
   /// \brief Iterator type representing one field in this record, binding a metadata iterator to the object
   template<bool IsConst = false>
   struct Field
@@ -460,11 +519,12 @@ struct Object
   typedef Field<false> iterator;
   typedef Field<true>  const_iterator;
 
-  iterator begin() { return iterator(*this, 0); }
-  iterator end() { return iterator(*this, info_->nelem); }
+  /// \remarks Subindex 0 holds the element count, so fields are iterated from subindex 1
+  iterator begin() { return iterator(*this, 1); }
+  iterator end() { return iterator(*this, info_->nelem + 1); }
 
-  const_iterator begin() const { return const_iterator(*this, 0); }
-  const_iterator end() const { return const_iterator(*this, info_->nelem); }
+  const_iterator begin() const { return const_iterator(*this, 1); }
+  const_iterator end() const { return const_iterator(*this, info_->nelem + 1); }
 
   constexpr Object(string_view name, const Info* info, const void* data)
     : name_(name)
@@ -478,6 +538,12 @@ struct Object
   constexpr Object& operator=(const Object&) = default;
 
 private:
+  /// \brief Set value, and pass the values before and after to the trace function
+  int32_t set_traced(uint8_t subIdx, const void* data, size_t size, uint16_t address) const NOEXCEPT;
+
+  /// \brief Get first 4 bytes of value at subindex, or 0 if the value is not stored in the object
+  uint32_t trace_value(uint8_t subIdx) const NOEXCEPT;
+
   string_view name_ = string_view();
   const Info* info_ = nullptr;
   const void* data_ = nullptr;
@@ -488,10 +554,26 @@ string_view to_string(Object::ClassId type) NOEXCEPT;
 
 struct Variable
 {
+  struct detail
+  {
+    /// Set function for a variable, checking that the value is in the range stored in its Info
+    /// \remarks Only one function is instantiated per type, however many variables use it
+    template<class T>
+    static int32_t set_value(const Object& object, uint8_t, const void* data, size_t size) NOEXCEPT
+    {
+      auto& range = static_cast<const Variable::Info&>(object.info()).range;
+      auto  e     = Object::detail::check<T>(range.min<T>(), range.max<T>(), data, size);
+      if (e != Error::OK) return e;
+      (*static_cast<T*>(const_cast<void*>(object.data()))) = *static_cast<const T*>(data);
+      return Error::OK;
+    }
+  };
+
   struct Info : Object::Info
   {
     /// \brief Range of variable (default, min, max)
-    Object::RangeInfo range;
+    Object::RangeInfo   range;
+    const Object::Unit* unit = nullptr; ///< Unit of a scaled value, or nullptr for plain counts
 
     constexpr Info()
       : Object::Info{ Object::ClassId::Variable, DataType::Invalid, 1, Object::Permissions{}, 0, 0, nullptr }
@@ -527,7 +609,7 @@ struct Variable
 
   template<uint16_t Length>
   constexpr Info static make_binstring_info(Object::Permissions perm, 
-    Object::Info::SetFunctionType setf = Object::detail::set_string_variable<Length>) NOEXCEPT
+    Object::Info::SetFunctionType setf = Object::detail::set_binstring_variable<Length>) NOEXCEPT
   {
     return Info(perm, DataType::BinString, setf, Length);
   }
@@ -598,13 +680,30 @@ struct Array
       (static_cast<DataClass&>(object.data).*member)[subIdx - 1] = v.value;
       return Error::OK;
     }
+
+    /// Set function for an element of an array object, checking that the value is in the range stored in its Info
+    /// \remarks Only one function is instantiated per type, however many arrays use it
+    template<class T>
+    static int32_t set_element(const Object& object, uint8_t subIdx, const void* data, size_t size) NOEXCEPT
+    {
+      if (subIdx == 0) return Error::ReadOnly;
+      else if (subIdx > object.info().nelem)
+        return Error::FieldNotFound;
+
+      auto& range = static_cast<const Array::Info&>(object.info()).range;
+      auto  e     = Object::detail::check<T>(range.min<T>(), range.max<T>(), data, size);
+      if (e != Error::OK) return e;
+      static_cast<T*>(const_cast<void*>(object.data()))[subIdx - 1] = *static_cast<const T*>(data);
+      return Error::OK;
+    }
   };
 
   struct Info : Object::Info
   {
     /// \brief Range of variable (default, min, max)
-    Object::RangeInfo range;
-    string_view       names[1]; ///< Pointer to array of subobject names
+    Object::RangeInfo   range;
+    const Object::Unit* unit = nullptr; ///< Unit of scaled elements, or nullptr for plain counts
+    string_view         names[1];       ///< Pointer to array of subobject names
 
     typedef const string_view* iterator;
 
@@ -805,6 +904,11 @@ struct Array
 
 struct Record
 {
+  /// \brief Type, range, unit and set function of record fields, which fields with the same ones share, so each is
+  ///        stored once however many fields use it. The permissions and offset of a descriptor are unused, as each
+  ///        field has its own
+  typedef Variable::Info Descriptor;
+
   struct detail
   {
     static int32_t set_data(const Object& obj, uint8_t subIdx, const void* data, size_t size) NOEXCEPT
@@ -812,26 +916,88 @@ struct Record
       if (obj.info().otype != Object::ClassId::Record || subIdx > obj.info().nelem) return Error::FieldNotFound;
       if (subIdx == 0) return Error::ReadOnly;
 
-      return static_cast<const Record::Info&>(obj.info()).fields[subIdx - 1].set_function(obj, subIdx, data, size);
+      auto& info = static_cast<const Record::Info&>(obj.info());
+      return info.descriptor(info.fields[subIdx - 1]).set_function(obj, subIdx, data, size);
     }
 
+    /// Set function for a record field, using the offset of its FieldInfo and the range of its descriptor
+    /// \remarks Only one function is instantiated per type, however many fields use it. Called through set_data,
+    ///          which has already checked the subindex
+    template<class T>
+    static int32_t set_field(const Object& obj, uint8_t subIdx, const void* data, size_t size) NOEXCEPT
+    {
+      auto& info  = static_cast<const Record::Info&>(obj.info());
+      auto& field = info.fields[subIdx - 1];
+      auto& range = info.descriptor(field).range;
+      auto  e     = Object::detail::check<T>(range.min<T>(), range.max<T>(), data, size);
+      if (e != Error::OK) return e;
+      *static_cast<T*>(const_cast<void*>(obj.data(field.data_offset))) = *static_cast<const T*>(data);
+      return Error::OK;
+    }
+
+    /// \brief Get range of descriptor as one integer, with the bits of min above those of max, so descriptors of the
+    ///        same type are compared without reading the range by type each time
+    static constexpr uint64_t range_key(const Descriptor& d) NOEXCEPT
+    {
+      switch (d.type)
+      {
+        case DataType::U8: return uint64_t(d.range.u8.min) << 32 | d.range.u8.max;
+        case DataType::U16: return uint64_t(d.range.u16.min) << 32 | d.range.u16.max;
+        case DataType::U32: return uint64_t(d.range.u32.min) << 32 | d.range.u32.max;
+        case DataType::I8: return uint64_t(uint32_t(d.range.i8.min)) << 32 | uint32_t(d.range.i8.max);
+        case DataType::I16: return uint64_t(uint32_t(d.range.i16.min)) << 32 | uint32_t(d.range.i16.max);
+        case DataType::I32: return uint64_t(uint32_t(d.range.i32.min)) << 32 | uint32_t(d.range.i32.max);
+        default: return 0;
+      }
+    }
   };
 
-  struct FieldInfo : Variable::Info
+  /// \brief Make descriptor of fields of type T, e.g. for a table of descriptors shared by records
+  template<class T>
+  static constexpr Descriptor descriptor(Object::Info::SetFunctionType setf, T min = T(), T max = T()) NOEXCEPT
+  {
+    return Descriptor(Object::Permissions{}, 0, setf, min, max);
+  }
+
+  /// \brief Field of a record, which refers to its type by index in the descriptors of the record
+  struct FieldInfo
+  {
+    string_view         name;        ///< Name of this field
+    uint16_t            data_offset; ///< Offset of this field in the data of the record
+    uint8_t             descriptor;  ///< Index of the descriptor of this field
+    Object::Permissions perm;        ///< Permissions of this field
+
+    constexpr FieldInfo() NOEXCEPT
+      : name()
+      , data_offset(0)
+      , descriptor(0)
+      , perm()
+    {}
+
+    constexpr FieldInfo(Object::Permissions perm_in, string_view name_in, uint16_t offset, uint8_t descriptor_in) NOEXCEPT
+      : name(name_in)
+      , data_offset(offset)
+      , descriptor(descriptor_in)
+      , perm(perm_in)
+    {}
+  };
+
+  /// \brief Field with its descriptor written out, as listed by fields() before make_info shares descriptors
+  struct FieldSpec : Descriptor
   {
     /// \brief Name of this field
     string_view name;
 
-    constexpr FieldInfo() NOEXCEPT
-      : Info()
+    constexpr FieldSpec() NOEXCEPT
+      : Descriptor()
       , name()
     {}
 
     /// \brief Create Field metadata definition
     template<class T>
-    constexpr FieldInfo(
+    constexpr FieldSpec(
       Object::Permissions perm, string_view nameIn, uint16_t offset, SetFunctionType setf, T min, T max)
-      : Variable::Info{ perm, offset, setf, min, max }
+      : Descriptor{ perm, offset, setf, min, max }
       , name(nameIn)
     {}
   };
@@ -840,22 +1006,24 @@ struct Record
   struct FieldList
   {
 
-    const FieldInfo fields_arr[Count + 1];
+    const FieldSpec fields_arr[Count + 1];
 
     constexpr FieldList() NOEXCEPT {}
 
     template<uint16_t OldOffset, uint16_t OldSize, uint8_t... Ns>
     constexpr FieldList(const FieldList<uint8_t(Count - 1), OldOffset, OldSize>& info,
-                        const FieldInfo&                                         last,
+                        const FieldSpec&                                         last,
                         std::integer_sequence<uint8_t, Ns...>) NOEXCEPT
       : /*data_offset(info.data_offset), data_size(info.data_size), */ fields_arr{ info.fields_arr[Ns]..., last }
     {}
 
     template<uint16_t OldOffset, uint16_t OldSize>
-    constexpr FieldList(const FieldList<uint8_t(Count - 1), OldOffset, OldSize>& info, const FieldInfo& last) NOEXCEPT
+    constexpr FieldList(const FieldList<uint8_t(Count - 1), OldOffset, OldSize>& info, const FieldSpec& last) NOEXCEPT
       : FieldList(info, last, std::make_integer_sequence<uint8_t, Count - 1>{})
     {}
 
+    /// \remarks Fields are set by Record::detail::set_field<T> unless another function is given, so fields of the
+    ///          same type and range share a descriptor
     template<class DataClass,
              class T,
              T DataClass::*member,
@@ -867,13 +1035,13 @@ struct Record
     constexpr FieldList<Count + 1, NewOffset, NewSize> field(
       Object::Permissions           perm,
       string_view                   name,
-      Object::Info::SetFunctionType setf = Object::detail::set_default<DataClass, T, member, min, max>) NOEXCEPT
+      Object::Info::SetFunctionType setf = detail::set_field<T>) NOEXCEPT
     {
       static_assert(Count == 0 || offset == Size + Offset,
                     "Gap in structure! Make sure all fields are defined in order and none are missing");
 
       return FieldList<Count + 1, NewOffset, NewSize>(
-        *this, FieldInfo{ perm, name, static_cast<uint16_t>(offset), setf, min, max });
+        *this, FieldSpec{ perm, name, static_cast<uint16_t>(offset), setf, min, max });
     }
 
 
@@ -891,7 +1059,7 @@ struct Record
 
       return FieldList<Count + 1, NewOffset, NewSize>(
         *this,
-        FieldInfo{
+        FieldSpec{
           perm, name, static_cast<uint16_t>(offset), &Object::detail::set_wrapper<T, setf, min, max>, min, max });
     }
   };
@@ -899,7 +1067,8 @@ struct Record
   /// \brief Record metadata object
   struct Info : Object::Info
   {
-    const FieldInfo fields[1]; ///< Properties contained in this object
+    const Descriptor* descriptors; ///< Descriptors of the fields, indexed by FieldInfo::descriptor
+    FieldInfo         fields[1];   ///< Properties contained in this object
 
     typedef const FieldInfo* iterator;
     /// \brief Get iterator to metadata of first field in this record
@@ -910,63 +1079,256 @@ struct Record
     /// \brief Find field metadata by name
     iterator find(string_view name) const;
 
-    constexpr Info(
-      Object::Permissions perm, const FieldInfo& field, uint8_t count, uint16_t start_offset, uint16_t size)
-      : Object::Info{ Object::ClassId::Record, DataType::Record, count, perm, start_offset, size, detail::set_data }
-      , fields{ field }
-    {}
+    /// \brief Get type, range, unit and set function of field
+    const Descriptor& descriptor(const FieldInfo& field) const NOEXCEPT { return descriptors[field.descriptor]; }
 
-    constexpr Info(
-      Object::Permissions perm, const FieldInfo& field, uint8_t count, uint16_t start_offset, uint16_t size, SetFunctionType setf)
+    constexpr Info(Object::Permissions perm,
+                   const Descriptor*   descriptors_in,
+                   const FieldInfo&    field,
+                   uint8_t             count,
+                   uint16_t            start_offset,
+                   uint16_t            size,
+                   SetFunctionType     setf = detail::set_data)
       : Object::Info{ Object::ClassId::Record, DataType::Record, count, perm, start_offset, size, setf }
+      , descriptors(descriptors_in)
       , fields{ field }
     {}
   };
 
+  /// \brief Record metadata with storage for Count fields, whose descriptors are in a table which records may share,
+  ///        as written by the schema generator
   template<uint8_t Count>
   struct TInfo : Info
   {
-    static constexpr uint8_t fields_n_count = Count > 0 ? Count : 1;
-    const FieldInfo          fields_n[fields_n_count];
+    static constexpr uint8_t fields_n_count = Count > 1 ? Count - 1 : 1;
+    FieldInfo                fields_n[fields_n_count];
 
-    /// Specialization to init array constexpr
-    template<uint16_t Offset, uint16_t Size, uint8_t first, uint8_t... Ns>
-    constexpr TInfo(Object::Permissions              perm,
-                    FieldList<Count, Offset, Size>&& fields,
-                    SetFunctionType setf,
-                    std::integer_sequence<uint8_t, first, Ns...>)
-      : Info{ perm, fields.fields_arr[0], Count, Offset, Size, setf }
-      , fields_n{ fields.fields_arr[Ns]... }
-    {}
+    /// Constructor from a flat list of fields with precomputed offset and size
+    /// \remarks Builds no intermediate FieldList, so the cost of compiling does not grow with the square of Count
+    template<class... Fields>
+    constexpr TInfo(Object::Permissions perm,
+                    uint16_t            offset,
+                    uint16_t            size,
+                    SetFunctionType     setf,
+                    const Descriptor*   descriptors_in,
+                    const FieldInfo&    first,
+                    const Fields&... rest)
+      : Info{ perm, descriptors_in, first, Count, offset, size, setf }
+      , fields_n{ rest... }
+    {
+      static_assert(sizeof...(Fields) + 1 == Count, "Number of fields does not match record size");
+    }
 
-    /// Specialization for a single field
-    template<uint8_t first, uint16_t Offset, uint16_t Size>
-    constexpr TInfo(Object::Permissions              perm,
-                    FieldList<Count, Offset, Size>&& fields,
-                    SetFunctionType setf,
-                    std::integer_sequence<uint8_t, first>)
-      : Info{ perm, fields.fields_arr[0], Count, Offset, Size, setf }
+  protected:
+    /// Constructor for records whose fields are filled in afterwards
+    constexpr TInfo(
+      Object::Permissions perm, uint16_t offset, uint16_t size, SetFunctionType setf, const Descriptor* descriptors_in)
+      : Info{ perm, descriptors_in, FieldInfo(), Count, offset, size, setf }
       , fields_n{}
     {}
 
-    /// Constructor that creates full info structure
+    constexpr FieldInfo& field(uint8_t index) NOEXCEPT { return index == 0 ? fields[0] : fields_n[index - 1]; }
+  };
+
+  /// \brief Record metadata which holds the descriptors of its own fields, as made by make_info from fields(), where
+  ///        fields with the same type, range, unit and set function share a descriptor
+  /// \remarks The metadata refers to its own descriptors, which copies of it refer to in turn. Metadata returned by
+  ///          make_info cannot be copied while compiling, so it is constructed in place instead:
+  ///          constexpr Record::TLocalInfo<2> info(perm, Record::fields().field<...>(...).field<...>(...))
+  template<uint8_t Count>
+  struct TLocalInfo : TInfo<Count>
+  {
+    static constexpr uint8_t descriptors_n_count = Count > 0 ? Count : 1;
+    Descriptor               descriptors_n[descriptors_n_count];
+
     template<uint16_t Offset, uint16_t Size>
-    constexpr TInfo(Object::Permissions perm, FieldList<Count, Offset, Size>&& fields, SetFunctionType setf=detail::set_data)
-      : TInfo(perm, std::move(fields), setf, std::make_integer_sequence<uint8_t, Count>{})
-    {}
+    constexpr TLocalInfo(Object::Permissions                   perm,
+                         const FieldList<Count, Offset, Size>& list,
+                         Info::SetFunctionType                 setf = detail::set_data)
+      : TInfo<Count>(perm, Offset, Size, setf, descriptors_n)
+      , descriptors_n{}
+    {
+      uint64_t keys[descriptors_n_count] = {};
+      uint8_t  used                      = 0;
+      for (uint8_t i = 0; i < Count; ++i)
+      {
+        const FieldSpec& spec = list.fields_arr[i];
+        const uint64_t   key  = detail::range_key(spec);
+        uint8_t          d    = 0;
+        while (d < used && (keys[d] != key || descriptors_n[d].type != spec.type ||
+                            descriptors_n[d].set_function != spec.set_function || descriptors_n[d].unit != spec.unit))
+          ++d;
+        if (d == used)
+        {
+          keys[used]            = key;
+          descriptors_n[used++] = spec;
+        }
+        this->field(i) = FieldInfo(spec.perm, spec.name, spec.data_offset, d);
+      }
+    }
 
+    constexpr TLocalInfo(const TLocalInfo& other) NOEXCEPT
+      : TInfo<Count>(other)
+      , descriptors_n{}
+    {
+      for (uint8_t d = 0; d < descriptors_n_count; ++d) descriptors_n[d] = other.descriptors_n[d];
+      this->descriptors = descriptors_n;
+    }
   };
 
   static constexpr FieldList<0> fields() { return FieldList<0>{}; }
 
   template<uint8_t Count, uint16_t Offset, uint16_t Size>
-  static constexpr TInfo<Count> make_info(Object::Permissions perm, FieldList<Count, Offset, Size>&& fields, Info::SetFunctionType setf=detail::set_data)
+  static constexpr TLocalInfo<Count> make_info(Object::Permissions perm, FieldList<Count, Offset, Size>&& fields, Info::SetFunctionType setf=detail::set_data)
+  {
+    return TLocalInfo<Count>(perm, fields, setf);
+  }
+
+};
+
+/// \brief Tables hold values of one type in two or more dimensions, such as calibration maps. The last dimension is
+///        contiguous, and each run of it is a row, at subindex 1 for the first row. Tables of more than two dimensions
+///        are rows of all the other dimensions in row-major order, so every table has up to 255 rows, but rows can be
+///        long and tables can hold many more values than arrays
+struct Table
+{
+  /// \brief Largest number of dimensions of a table
+  static constexpr uint8_t MaxRank = 3;
+
+  /// \brief Largest size of a row in bytes, so rows can be copied through buffers on the stack
+  static constexpr uint16_t MaxRowSize = 256;
+
+  struct Info : Object::Info
+  {
+    Object::RangeInfo   range;                 ///< Range of every value
+    const Object::Unit* unit = nullptr;        ///< Unit of scaled values, or nullptr for plain counts
+    uint8_t             rank;                  ///< Number of dimensions
+    uint16_t            extents[MaxRank];      ///< Number of indices of each dimension, the last being the row
+
+    /// \brief Get number of values in each row
+    constexpr uint16_t row_length() const NOEXCEPT { return extents[rank - 1]; }
+
+    /// \brief Get size of each row in bytes
+    uint16_t row_size() const NOEXCEPT { return static_cast<uint16_t>(row_length() * type_size(type)); }
+
+    /// \brief Create metadata of table stored as T[E0][E1]
+    template<class T, size_t E0, size_t E1>
+    constexpr Info(Object::Permissions perm, T (&)[E0][E1], SetFunctionType setf_in, T min, T max)
+      : Object::Info{ Object::ClassId::Table, Type_<T>::id, E0, perm, 0, sizeof(T) * E0 * E1, setf_in }
+      , range{ Object::TRange<T>{ min, max } }
+      , rank(2)
+      , extents{ E0, E1, 0 }
+    {
+      static_assert(E0 > 0 && E0 < 256, "Tables must have 1 to 255 rows");
+      static_assert(sizeof(T) * E1 <= MaxRowSize, "Rows must be at most MaxRowSize bytes");
+    }
+
+    /// \brief Create metadata of table stored as T[E0][E1][E2]
+    template<class T, size_t E0, size_t E1, size_t E2>
+    constexpr Info(Object::Permissions perm, T (&)[E0][E1][E2], SetFunctionType setf_in, T min, T max)
+      : Object::Info{ Object::ClassId::Table, Type_<T>::id, E0 * E1, perm, 0, sizeof(T) * E0 * E1 * E2, setf_in }
+      , range{ Object::TRange<T>{ min, max } }
+      , rank(3)
+      , extents{ E0, E1, E2 }
+    {
+      static_assert(E0 * E1 > 0 && E0 * E1 < 256, "Tables must have 1 to 255 rows");
+      static_assert(sizeof(T) * E2 <= MaxRowSize, "Rows must be at most MaxRowSize bytes");
+    }
+  };
+
+  struct detail
   {
-    return TInfo<Count>(perm, std::move(fields), setf);
+    /// Set function for a row of a table, checking that every value is in the range stored in its Info
+    /// \remarks Rows are copied through memcpy, so they may be unaligned, e.g. in a patch
+    template<class T>
+    static int32_t set_row(const Object& object, uint8_t subIdx, const void* data, size_t size) NOEXCEPT
+    {
+      if (subIdx == 0) return Error::ReadOnly;
+      else if (subIdx > object.info().nelem)
+        return Error::FieldNotFound;
+
+      auto&        info   = static_cast<const Table::Info&>(object.info());
+      const size_t length = info.row_length();
+      if (size > length * sizeof(T)) return Error::ParamTooLong;
+      else if (size < length * sizeof(T))
+        return Error::ParamTooShort;
+      else if (data == nullptr)
+        return Error::DataTypeError;
+
+      if (info.range.get<T>().valid())
+      {
+        auto values = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < length; ++i)
+        {
+          T value;
+          memcpy(&value, values + i * sizeof(T), sizeof(T));
+          auto e = Object::detail::check<T>(info.range.min<T>(), info.range.max<T>(), &value, sizeof(T));
+          if (e != Error::OK) return e;
+        }
+      }
+      memcpy(static_cast<T*>(const_cast<void*>(object.data())) + (subIdx - 1u) * length, data, size);
+      return Error::OK;
+    }
+  };
+
+  /// \brief Make metadata structure for table of two or three dimensions
+  template<class Storage, class T = std::remove_all_extents_t<Storage>>
+  static constexpr Info make_info(Object::Permissions perm,
+                                  Storage&            table,
+                                  Object::Info::SetFunctionType setf_in = detail::set_row<T>, T min = T(), T max = T())
+  {
+    return Info(perm, table, setf_in, min, max);
+  }
+
+  /// \brief Get strided view of the values of a table of Rank dimensions and values of type T
+  /// \returns View, which is empty if the table has a different type or number of dimensions, or no storage
+  template<class T, size_t Rank>
+  static estd::mdspan<const T, Rank> view(const Object& object) NOEXCEPT
+  {
+    auto& info = static_cast<const Info&>(object.info());
+    if (info.otype != Object::ClassId::Table || info.type != Type_<T>::id || info.rank != Rank ||
+        object.data() == nullptr)
+      return estd::mdspan<const T, Rank>();
+
+    uint32_t extents[Rank];
+    for (size_t r = 0; r < Rank; ++r) extents[r] = info.extents[r];
+    return estd::mdspan<const T, Rank>(static_cast<const T*>(object.data()), extents);
   }
 
+  /// \brief Get the value at index column of every row, in row order, e.g. a column of a two dimensional table
+  /// \returns Size of the values copied, or Error::FieldNotFound, Error::ParamTooShort or Error::WriteOnly
+  static int32_t get_column(const Object& object, uint16_t column, void* buffer, size_t size) NOEXCEPT;
+
+  /// \brief Set the value at index column of every row, from values in row order
+  /// \remarks Each row is set whole through the object, so values are range checked and traced as for rows. Rows
+  ///          before an error keep their new values
+  /// \returns Error::OK, or an error from setting a row
+  static int32_t set_column(const Object& object, uint16_t column, const void* data, size_t size) NOEXCEPT;
 };
 
+/// \brief Set of object permissions, with bit n set for Object::Permissions value n
+typedef uint8_t PermissionMask;
+
+/// \brief Get set holding a single permission
+constexpr PermissionMask permission_mask(Object::Permissions perm) NOEXCEPT
+{
+  return static_cast<PermissionMask>(1u << static_cast<uint8_t>(perm));
+}
+
+/// \brief Attach unit to the metadata of a variable, array, table or record field, whose values are then scaled integers
+template<class InfoType>
+constexpr InfoType with_unit(InfoType info, const Object::Unit* unit) NOEXCEPT
+{
+  info.unit = unit;
+  return info;
+}
+
+/// \brief Get unit of the values described by metadata of a variable, array, table or record field
+/// \returns Unit, or nullptr for plain counts and for records
+const Object::Unit* unit_of(const Object::Info& info) NOEXCEPT;
+
+struct NameIndex;
+
 /// \brief Object Dictionary stores index of objects by address
 struct Dictionary
 {
@@ -994,6 +1356,7 @@ struct Dictionary
     Query(estd::string_view& str)
       : object_name(estd::next_token(str, issep))
       , subobject_name(estd::next_token(str, issep))
+      , item(nullptr)
       , info(nullptr)
       , subIdx(-1)
     {
@@ -1005,8 +1368,16 @@ struct Dictionary
   typedef const Item* pointer;
 
   /// \brief Constructor builds index of objects, optionally at compile-time
-  constexpr Dictionary(uint16_t count_in, const Item item)
+  /// \param names_in    Index of the names of the objects, used by find and query, or nullptr to search the objects
+  /// \param defaults_in Default value of the data of each object, in the order of the items, used by reset, or
+  ///                    nullptr if none have defaults
+  constexpr Dictionary(uint16_t           count_in,
+                       const Item         item,
+                       const NameIndex*   names_in    = nullptr,
+                       const void* const* defaults_in = nullptr)
     : count(count_in)
+    , names(names_in)
+    , defaults(defaults_in)
     , items{ item }
   {}
 
@@ -1025,7 +1396,7 @@ struct Dictionary
   {
     const Object* o = get(address);
     if (o == nullptr) return Error::ObjectNotFound;
-    return o->set(subIdx, data, size);
+    return o->set(subIdx, data, size, address);
   }
 
   /// \brief Read value from object in dictionary
@@ -1037,13 +1408,27 @@ struct Dictionary
   }
 
   /// \brief Find object by name
+  /// \remarks Uses the name index if the dictionary has one, otherwise compares the name of every object
   const Item* find(const string_view& name) const NOEXCEPT;
 
+  /// \brief Restore default values of objects with permissions in mask, e.g. View::Persisted for a factory reset
+  /// \remarks Defaults are copied over the data without calling set or trace functions. Objects whose data and
+  ///          defaults both follow on from those of the previous object are copied together. Objects without
+  ///          defaults are left unchanged
+  /// \returns Number of objects reset
+  uint16_t reset(PermissionMask mask) const NOEXCEPT;
+
   /// \brief Get object/subobject from dictionary based on string
   int32_t query(Query& q) const NOEXCEPT;
 
-  size_t count;
-  Item   items[1];
+  /// \brief Get subobject of an item which has already been found, based on the subobject name of the query
+  /// \remarks If the subobject name is empty, the query selects the whole object
+  static int32_t query_field(Query& q) NOEXCEPT;
+
+  size_t             count;
+  const NameIndex*   names;    ///< Index of names, or nullptr
+  const void* const* defaults; ///< Default data of the object of each item, or nullptr
+  Item               items[1];
 };
 
 /// \brief Class for constructing a constexxpr dictionary that includes storage for the dictionary
@@ -1066,23 +1451,46 @@ struct TDictionary : Dictionary
     return l.object.name() < r.object.name();
   }
 
-  template<uint16_t first, uint16_t... Ns>
-  constexpr TDictionary(estd::array<Dictionary::Item, Count>&& objects,
-                        std::integer_sequence<uint16_t, first, Ns...>) NOEXCEPT
-    : Dictionary(Count, objects[0])
-    , items_n{ objects[Ns]... }
-  {}
-
-  template<uint16_t first>
-  constexpr TDictionary(estd::array<Dictionary::Item, Count>&& objects, std::integer_sequence<uint16_t, first>) NOEXCEPT
-    : Dictionary(Count, objects[0])
+  /// \brief Constructor builds index of objects, optionally at compile-time
+  /// \remarks Objects are placed in address order by loops over flat arrays rather than by expanding a parameter pack
+  ///          per object, and only 32-bit keys are sorted, so large dictionaries are cheap to evaluate
+  /// \param names    Index of the names of the objects, as Dictionary
+  /// \param defaults Default value of the data of each object, of its data_size bytes laid out as the data, or
+  ///                 nullptr for objects to keep their value, in address order as the objects are held, or nullptr
+  constexpr TDictionary(const estd::array<Dictionary::Item, Count>& objects,
+                        const NameIndex*                          names    = nullptr,
+                        const void* const*                        defaults = nullptr) NOEXCEPT
+    : Dictionary(Count, Item(), names, defaults)
     , items_n{}
-  {}
+  {
+    // Each key holds the address of an object above its position in the input
+    uint32_t keys[items_n_count] = {};
+    bool     sorted              = true;
+    for (uint16_t i = 0; i < Count; ++i)
+    {
+      keys[i] = (uint32_t(objects[i].address) << 16) | i;
+      if (i > 0 && keys[i] < keys[i - 1]) sorted = false;
+    }
+    if (!sorted)
+    {
+      // Radix sort on the address, a byte per pass, which takes far fewer steps to evaluate than a comparison sort
+      uint32_t temp[items_n_count] = {};
+      for (uint8_t shift = 16; shift < 32; shift += 8)
+      {
+        uint32_t start[257] = {};
+        for (uint16_t i = 0; i < Count; ++i) ++start[((keys[i] >> shift) & 0xFFu) + 1];
+        for (uint16_t b = 0; b < 256; ++b) start[b + 1] += start[b];
+        for (uint16_t i = 0; i < Count; ++i) temp[start[(keys[i] >> shift) & 0xFFu]++] = keys[i];
+        for (uint16_t i = 0; i < Count; ++i) keys[i] = temp[i];
+      }
+    }
 
-  /// \brief Constructor builds index of objects, optionally at compile-time
-  constexpr TDictionary(estd::array<Dictionary::Item, Count>&& objects) NOEXCEPT
-    : TDictionary(estd::sort(std::move(objects), compare_address), std::make_integer_sequence<uint16_t, Count>{})
-  {}
+    for (uint16_t i = 0; i < Count; ++i)
+    {
+      Item& item = i == 0 ? items[0] : items_n[i - 1];
+      item       = objects[keys[i] & 0xFFFFu];
+    }
+  }
 };
 
 template<class... Ts>
@@ -1092,4 +1500,396 @@ static constexpr TDictionary<sizeof...(Ts)> make_dictionary(Ts... args) NOEXCEPT
   return TDictionary<size>(estd::array<Dictionary::Item, size>{ args... });
 }
 
+/// \brief Dictionary stored as parallel arrays rather than an array of items, for flash-constrained targets. Objects
+///        are in address order, and each has a 16-bit address, the offset of its data in one block of storage, and
+///        its metadata. Names are in one string pool, where name i runs from names[i] to names[i + 1], so an object
+///        takes 10 bytes on 32-bit targets rather than the 20 of Dictionary::Item, and an address search reads only
+///        the 2-byte addresses. The tables are written by eobject_gen.py
+/// \remarks Items are made on access, so the API of Dictionary is kept by returning proxies where Dictionary returns
+///          pointers, which compare equal to nullptr if nothing was found
+struct CompactDictionary
+{
+  typedef Dictionary::Item Item;
+
+  /// \brief Proxy for a pointer to a value made on access, which is null if there is no value
+  template<class T>
+  struct Ref
+  {
+    T    value;
+    bool valid;
+
+    const T* operator->() const NOEXCEPT { return &value; }
+    const T& operator*() const NOEXCEPT { return value; }
+    bool     operator==(std::nullptr_t) const NOEXCEPT { return !valid; }
+    bool     operator!=(std::nullptr_t) const NOEXCEPT { return valid; }
+  };
+
+  /// \brief Iterator over the items of the dictionary, in address order
+  struct iterator
+  {
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Item                      value_type;
+    typedef std::ptrdiff_t            difference_type;
+    typedef Ref<Item>                 pointer;
+    typedef Item                      reference;
+
+    const CompactDictionary* dictionary;
+    uint16_t                 index;
+
+    reference operator*() const NOEXCEPT { return (*dictionary)[index]; }
+    pointer   operator->() const NOEXCEPT { return pointer{ (*dictionary)[index], true }; }
+    iterator& operator++() NOEXCEPT
+    {
+      ++index;
+      return *this;
+    }
+    bool operator==(const iterator& other) const NOEXCEPT { return index == other.index; }
+    bool operator!=(const iterator& other) const NOEXCEPT { return index != other.index; }
+  };
+
+  /// \brief Query which holds the item it finds, as Dictionary::Query points to an item in the dictionary
+  /// \remarks The item pointer of the query refers to found, so a copy of a query must be queried again
+  struct Query : Dictionary::Query
+  {
+    Item found;
+
+    explicit Query(estd::string_view& str)
+      : Dictionary::Query(str)
+      , found()
+    {}
+  };
+
+  /// \brief Create dictionary from its tables, optionally at compile-time
+  /// \param addresses_in    Address of each object, in ascending order
+  /// \param infos_in        Metadata of each object
+  /// \param offsets_in      Offset of the data of each object from storage_in
+  /// \param names_in        Offset in pool_in of the name of each object, and of the end of the last name
+  /// \param pdo_mappings_in PDO mapping of each object, or nullptr if no object is mapped
+  /// \param defaults_in     Default values of the storage, laid out as storage_in, used by reset, or nullptr if
+  ///                        objects have no defaults
+  constexpr CompactDictionary(uint16_t                   count_in,
+                              const uint16_t*            addresses_in,
+                              const Object::Info* const* infos_in,
+                              const uint16_t*            offsets_in,
+                              void*                      storage_in,
+                              const uint16_t*            names_in,
+                              const char*                pool_in,
+                              const uint16_t*            pdo_mappings_in = nullptr,
+                              const void*                defaults_in     = nullptr) NOEXCEPT
+    : count(count_in)
+    , addresses(addresses_in)
+    , infos(infos_in)
+    , offsets(offsets_in)
+    , storage(storage_in)
+    , names(names_in)
+    , pool(pool_in)
+    , pdo_mappings(pdo_mappings_in)
+    , defaults(defaults_in)
+  {}
+
+  /// \brief Get iterator to first object in dictionary
+  iterator begin() const NOEXCEPT { return iterator{ this, 0 }; }
+  /// \brief Get iterator past last object in dictionary
+  iterator end() const NOEXCEPT { return iterator{ this, count }; }
+
+  /// \brief Get number of objects in dictionary
+  size_t size() const NOEXCEPT { return count; }
+
+  /// \brief Get name of object at position index
+  string_view name(uint16_t index) const NOEXCEPT
+  {
+    return string_view(pool + names[index], static_cast<size_t>(names[index + 1] - names[index]));
+  }
+
+  /// \brief Make item of object at position index
+  Item operator[](uint16_t index) const NOEXCEPT
+  {
+    return Item{ addresses[index], pdo_mappings != nullptr ? pdo_mappings[index] : uint16_t(0),
+                 Object(name(index), infos[index], static_cast<uint8_t*>(storage) + offsets[index]) };
+  }
+
+  /// \brief Get object by address
+  /// \remarks Uses binary search on the addresses
+  /// \returns Object found, or a proxy equal to nullptr if no object found at this address
+  Ref<Object> get(uint16_t address) const NOEXCEPT;
+
+  /// \brief Write value to object in dicitionary
+  int32_t write(uint16_t address, uint8_t subIdx, const void* data, size_t size) const
+  {
+    // The object is made on access, so the address is passed on for tracing, as it cannot be found from the object
+    auto o = get(address);
+    if (o == nullptr) return Error::ObjectNotFound;
+    return o->set(subIdx, data, size, address);
+  }
+
+  /// \brief Read value from object in dictionary
+  int32_t read(uint16_t address, uint8_t subIdx, void* data, size_t size) const
+  {
+    auto o = get(address);
+    if (o == nullptr) return static_cast<int>(Error::ObjectNotFound);
+    return o->get(subIdx, data, size);
+  }
+
+  /// \brief Find object by name
+  /// \remarks Names are compared in the pool, so only the item found is made
+  Ref<Item> find(const string_view& name) const NOEXCEPT;
+
+  /// \brief Restore default values of objects with permissions in mask, as Dictionary::reset
+  uint16_t reset(PermissionMask mask) const NOEXCEPT;
+
+  /// \brief Get object/subobject from dictionary based on string, as Dictionary::query
+  int32_t query(Query& q) const NOEXCEPT;
+
+  uint16_t                   count;
+  const uint16_t*            addresses;
+  const Object::Info* const* infos;
+  const uint16_t*            offsets;
+  void*                      storage;
+  const uint16_t*            names;
+  const char*                pool;
+  const uint16_t*            pdo_mappings;
+  const void*                defaults; ///< Default values of the storage, or nullptr
+};
+
+/// \brief Objects of a dictionary with permissions in a set, as a list of their slots in the dictionary, so listings,
+///        snapshots and change tracking visit only the objects they need
+/// \remarks Like Dictionary, the first slot is stored here and the rest in TView, which should be used to create views
+struct View
+{
+  /// \brief Objects listed to users, which are all but hidden objects
+  static constexpr PermissionMask Visible = 0x7F & ~((1u << uint8_t(Object::Permissions::FactoryHidden)) |
+                                                     (1u << uint8_t(Object::Permissions::Hidden)));
+  /// \brief Configuration, which is written by users or in the factory and kept across restarts
+  static constexpr PermissionMask Persisted = (1u << uint8_t(Object::Permissions::FactoryHidden)) |
+                                              (1u << uint8_t(Object::Permissions::FactoryConfig)) |
+                                              (1u << uint8_t(Object::Permissions::Hidden)) |
+                                              (1u << uint8_t(Object::Permissions::UserConfig));
+  /// \brief Values which change while running, which are tracked rather than stored
+  static constexpr PermissionMask Live = (1u << uint8_t(Object::Permissions::Status)) |
+                                         (1u << uint8_t(Object::Permissions::Dynamic));
+
+  /// \brief Iterator over the items of the view, in address order
+  struct iterator
+  {
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Dictionary::Item          value_type;
+    typedef std::ptrdiff_t            difference_type;
+    typedef const Dictionary::Item*   pointer;
+    typedef const Dictionary::Item&   reference;
+
+    const Dictionary::Item* items;
+    const uint16_t*         slot;
+
+    reference operator*() const NOEXCEPT { return items[*slot]; }
+    pointer   operator->() const NOEXCEPT { return items + *slot; }
+    iterator& operator++() NOEXCEPT
+    {
+      ++slot;
+      return *this;
+    }
+    bool operator==(const iterator& other) const NOEXCEPT { return slot == other.slot; }
+    bool operator!=(const iterator& other) const NOEXCEPT { return slot != other.slot; }
+  };
+
+  constexpr View(const Dictionary& dictionary_in, PermissionMask mask_in) NOEXCEPT
+    : dictionary(&dictionary_in)
+    , mask(mask_in)
+    , count(0)
+    , slots{}
+  {}
+
+  /// \brief Get iterator to first item in view
+  iterator begin() const NOEXCEPT { return iterator{ dictionary->begin(), slots }; }
+  /// \brief Get iterator past last item in view
+  iterator end() const NOEXCEPT { return iterator{ dictionary->begin(), slots + count }; }
+
+  /// \brief Get number of objects in view
+  size_t size() const NOEXCEPT { return count; }
+
+  /// \brief Check if the permissions of object are in the view
+  constexpr bool contains(const Object& object) const NOEXCEPT
+  {
+    return (permission_mask(object.info().perm) & mask) != 0;
+  }
+
+  /// \brief Restore default values of the objects in view, as Dictionary::reset without scanning other objects
+  /// \returns Number of objects reset
+  uint16_t reset() const NOEXCEPT;
+
+  const Dictionary* dictionary;
+  PermissionMask    mask;
+  uint16_t          count;
+  uint16_t          slots[1];
+};
+
+/// \brief Count objects of dictionary with permissions in mask, for sizing a view
+template<uint16_t Count>
+constexpr uint16_t count_objects(const TDictionary<Count>& dictionary, PermissionMask mask) NOEXCEPT
+{
+  uint16_t n = 0;
+  for (uint16_t i = 0; i < Count; ++i)
+  {
+    const Dictionary::Item& item = i == 0 ? dictionary.items[0] : dictionary.items_n[i - 1];
+    if ((permission_mask(item.object.info().perm) & mask) != 0) ++n;
+  }
+  return n;
+}
+
+/// \brief Class for constructing a view that includes storage for up to Capacity slots
+template<uint16_t Capacity>
+struct TView : View
+{
+  static constexpr uint16_t slots_n_count = Capacity > 1 ? Capacity - 1 : 1;
+
+  uint16_t slots_n[slots_n_count];
+
+  /// \brief Constructor builds view, optionally at compile-time, where a capacity below the number of objects in the
+  ///        view is an error
+  template<uint16_t Count>
+  constexpr TView(const TDictionary<Count>& dictionary, PermissionMask mask) NOEXCEPT
+    : View(dictionary, mask)
+    , slots_n{}
+  {
+    for (uint16_t i = 0; i < Count; ++i)
+    {
+      const Dictionary::Item& item = i == 0 ? dictionary.items[0] : dictionary.items_n[i - 1];
+      if (contains(item.object)) slot(count++) = i;
+    }
+  }
+
+  /// \brief Constructor builds view of any dictionary at runtime, keeping the first Capacity objects
+  TView(const Dictionary& dictionary, PermissionMask mask) NOEXCEPT
+    : View(dictionary, mask)
+    , slots_n{}
+  {
+    for (auto& item : dictionary)
+    {
+      if (count == Capacity) break;
+      if (contains(item.object)) slot(count++) = static_cast<uint16_t>(&item - dictionary.begin());
+    }
+  }
+
+private:
+  constexpr uint16_t& slot(uint16_t index) NOEXCEPT { return index == 0 ? slots[0] : slots_n[index - 1]; }
+};
+
+/// \brief Make view of a dictionary with static storage, sized to hold exactly its objects with permissions in Mask
+template<const auto& Dict, PermissionMask Mask>
+constexpr TView<count_objects(Dict, Mask)> make_view() NOEXCEPT
+{
+  return TView<count_objects(Dict, Mask)>(Dict, Mask);
+}
+
+/// \brief Index of the names of a dictionary by atom, so a query interns each of its names once, by a hash and a
+///        string comparison, and then finds the object and subobject by comparing integers. The index is either
+///        written as constant tables by eobject_gen.py, or built at runtime by TNameIndex
+struct NameIndex
+{
+  /// \brief Item of atoms which do not name an object
+  static constexpr uint16_t NoItem = 0xFFFF;
+
+  /// \brief Create index from its tables
+  /// \param items_in  Position in the dictionary of the object named by each atom, or NoItem
+  /// \param first_in  Position in fields_in of the first subobject name of each object, and of the end of the last
+  /// \param fields_in Atoms of the subobject names of records and arrays, in subindex order
+  constexpr NameIndex(const Dictionary&   dictionary_in,
+                      const eatom::Atoms& atoms_in,
+                      const uint16_t*     items_in,
+                      const uint16_t*     first_in,
+                      const eatom::atom*  fields_in) NOEXCEPT
+    : dictionary(&dictionary_in)
+    , atoms(&atoms_in)
+    , items(items_in)
+    , first(first_in)
+    , fields(fields_in)
+  {}
+
+  /// \brief Find object by name, as Dictionary::find
+  const Dictionary::Item* find(const string_view& name) const NOEXCEPT;
+
+  /// \brief Get object/subobject from dictionary based on string, as Dictionary::query
+  int32_t query(Dictionary::Query& q) const NOEXCEPT;
+
+  const Dictionary*   dictionary;
+  const eatom::Atoms* atoms;
+  const uint16_t*     items;
+  const uint16_t*     first;
+  const eatom::atom*  fields;
+};
+
+/// \brief Class for building a name index of any dictionary at runtime, with storage for the names of up to Count
+///        objects, Names distinct names and Fields subobject names
+/// \remarks If the names of the dictionary do not fit, the index is left empty, so it finds nothing, and is not valid
+template<uint16_t Count, uint16_t Names, uint16_t Fields>
+struct TNameIndex : NameIndex
+{
+  static constexpr uint16_t fields_n_count = Fields > 0 ? Fields : 1;
+
+  eatom::TAtoms<Names> atoms_n;
+  uint16_t             items_n[Names];
+  uint16_t             first_n[Count + 1];
+  eatom::atom          fields_n[fields_n_count];
+
+  explicit TNameIndex(const Dictionary& dictionary) NOEXCEPT
+    : NameIndex(dictionary, atoms_n, items_n, first_n, fields_n)
+    , atoms_n()
+    , items_n{}
+    , first_n{}
+    , fields_n{}
+    , valid_(build(dictionary))
+  {
+    if (false == valid_) clear();
+  }
+
+  TNameIndex(const TNameIndex&) = delete;
+
+  /// \brief Check if every name of the dictionary fitted in the index
+  bool valid() const NOEXCEPT { return valid_; }
+
+private:
+  /// \brief Intern the names of the dictionary, stopping at the first which does not fit
+  /// \returns true if every name fitted
+  bool build(const Dictionary& dictionary) NOEXCEPT
+  {
+    if (dictionary.count > Count) return false;
+    for (auto& item : items_n) item = NoItem;
+
+    uint16_t i = 0, f = 0;
+    for (auto& item : dictionary)
+    {
+      first_n[i]    = f;
+      eatom::atom a = atoms_n.intern(item.object.name());
+      if (a == eatom::NoAtom) return false;
+      if (items_n[a] == NoItem) items_n[a] = i;
+
+      auto otype = item.object.otype();
+      if (otype == Object::ClassId::Record || otype == Object::ClassId::Array)
+      {
+        for (uint8_t subIdx = 1; subIdx <= item.object.info().nelem; ++subIdx)
+        {
+          if (f == Fields) return false;
+          // Unnamed elements never match, as no name interns to NoAtom
+          const string_view& name = *item.object.info(subIdx).name;
+          eatom::atom        field = name.empty() ? eatom::NoAtom : atoms_n.intern(name);
+          if (field == eatom::NoAtom && false == name.empty()) return false;
+          fields_n[f++] = field;
+        }
+      }
+      ++i;
+    }
+    first_n[i] = f;
+    return true;
+  }
+
+  /// \brief Leave the index empty, so no name is found and no subobject table is read
+  void clear() NOEXCEPT
+  {
+    atoms_n.clear();
+    for (auto& item : items_n) item = NoItem;
+    for (auto& first : first_n) first = 0;
+  }
+
+  bool valid_;
+};
+
 }
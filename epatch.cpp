@@ -0,0 +1,177 @@
+/// \file epatch.cpp
+/// \brief Implementation of patch encoding, comparison with images, and applying patches
+
+#include "epatch.hpp"
+
+#include "ecbor.hpp"
+
+namespace epatch {
+
+  namespace {
+
+    using eobject::Error;
+    using ecbor::Head;
+    using ecbor::Major;
+
+    /// \brief Size of the head of a data item with argument value
+    size_t head_size(uint32_t value) NOEXCEPT
+    {
+      return value < 24 ? 1 : value <= 0xFF ? 2 : value <= 0xFFFF ? 3 : 5;
+    }
+
+    /// \brief Writes entries of a patch, counting the bytes written
+    struct Writer
+    {
+      explicit Writer(eio::buffer& out) NOEXCEPT
+        : out_(out)
+      {}
+
+      void put(uint16_t address, uint8_t subIdx, const void* data, size_t size) NOEXCEPT
+      {
+        if (error_ != 0) return;
+        const uint32_t delta = address - previous_;
+        previous_            = address;
+        if (ecbor::encode_uint(out_, delta) < 0 || ecbor::encode_uint(out_, subIdx) < 0 ||
+            ecbor::encode_bytes(out_, data, size) < 0)
+        {
+          error_ = EOF;
+          return;
+        }
+        written_ += static_cast<int32_t>(head_size(delta) + head_size(subIdx) + head_size(size) + size);
+      }
+
+      /// \brief Write the whole value at subindex of object
+      void put(const Dictionary::Item& item, const Object& object, uint8_t subIdx) NOEXCEPT
+      {
+        size_t      size  = 0;
+        const void* value = object.locate(subIdx, size);
+        if (value != nullptr) put(item.address, subIdx, value, size);
+      }
+
+      int32_t result() const NOEXCEPT { return error_ != 0 ? error_ : written_; }
+
+    private:
+      eio::buffer& out_;
+      uint16_t     previous_ = 0;
+      int32_t      written_  = 0;
+      int32_t      error_    = 0;
+    };
+
+    /// \brief Decode an unsigned data item
+    int32_t get_uint(string_view& in, uint32_t& value) NOEXCEPT
+    {
+      Head head;
+      switch (ecbor::decode_head(in, head))
+      {
+        case eformat::ParseStatus::OK: break;
+        case eformat::ParseStatus::Incomplete: return Error::ParamTooShort;
+        default: return Error::DataTypeError;
+      }
+      if (head.major != Major::Unsigned) return Error::DataTypeError;
+      value = head.value;
+      return Error::OK;
+    }
+
+    /// \brief Reads entries of a patch
+    struct Reader
+    {
+      uint16_t    address = 0;
+      uint8_t     subIdx  = 0;
+      string_view value;
+
+      /// \brief Decode the next entry, consuming it from the input only on success
+      int32_t next(string_view& in) NOEXCEPT
+      {
+        string_view temp = in;
+        uint32_t    delta, sub, size;
+        int32_t     e = get_uint(temp, delta);
+        if (e == Error::OK) e = get_uint(temp, sub);
+        if (e != Error::OK) return e;
+
+        Head head;
+        switch (ecbor::decode_head(temp, head))
+        {
+          case eformat::ParseStatus::OK: break;
+          case eformat::ParseStatus::Incomplete: return Error::ParamTooShort;
+          default: return Error::DataTypeError;
+        }
+        size = head.value;
+        if (head.major != Major::Bytes || sub > 0xFF || delta > 0xFFFFu - address) return Error::DataTypeError;
+        if (size > temp.size()) return Error::ParamTooShort;
+
+        address = static_cast<uint16_t>(address + delta);
+        subIdx  = static_cast<uint8_t>(sub);
+        value   = string_view(temp.data(), size);
+        temp.remove_prefix(size);
+        in = temp;
+        return Error::OK;
+      }
+    };
+  }
+
+  int32_t diff(eio::buffer& out, const Dictionary& dictionary, const Dictionary& reference) NOEXCEPT
+  {
+    Writer writer(out);
+    compare(dictionary, reference, [&](const Dictionary::Item& item, const Object* other, uint8_t subIdx) {
+      if (subIdx != WholeObject) writer.put(item, *other, subIdx);
+    });
+    return writer.result();
+  }
+
+  int32_t diff(eio::buffer& out, const Dictionary& dictionary, string_view image) NOEXCEPT
+  {
+    Writer writer(out);
+    Reader reader;
+    auto   item = dictionary.begin();
+    while (!image.empty())
+    {
+      int32_t e = reader.next(image);
+      if (e != Error::OK) return e;
+
+      while (item != dictionary.end() && item->address < reader.address) ++item;
+      if (item == dictionary.end() || item->address != reader.address) continue;
+
+      size_t      size  = 0;
+      const void* value = item->object.locate(reader.subIdx, size);
+      if (value == nullptr || size != reader.value.size() || memcmp(value, reader.value.data(), size) == 0) continue;
+      writer.put(reader.address, reader.subIdx, reader.value.data(), size);
+    }
+    return writer.result();
+  }
+
+  int32_t image(eio::buffer& out, const Dictionary& dictionary) NOEXCEPT
+  {
+    Writer writer(out);
+    for (const auto& item : dictionary)
+    {
+      const Object::Info& info = item.object.info();
+      if (info.otype == Object::ClassId::Variable)
+        writer.put(item, item.object, 0);
+      else
+        for (unsigned subIdx = 1; subIdx <= info.nelem; ++subIdx)
+          writer.put(item, item.object, static_cast<uint8_t>(subIdx));
+    }
+    return writer.result();
+  }
+
+  int32_t apply(string_view& in, const Dictionary& dictionary) NOEXCEPT
+  {
+    Reader reader;
+    while (!in.empty())
+    {
+      string_view temp = in;
+      int32_t     e    = reader.next(temp);
+      if (e == Error::OK)
+      {
+        // Set functions load integers directly, so they are copied out of the patch to be aligned
+        uint32_t    aligned;
+        const void* value = reader.value.data();
+        if (reader.value.size() <= sizeof(aligned)) value = memcpy(&aligned, value, reader.value.size());
+        e = dictionary.write(reader.address, reader.subIdx, value, reader.value.size());
+      }
+      if (e != Error::OK) return e;
+      in = temp;
+    }
+    return Error::OK;
+  }
+}
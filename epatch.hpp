@@ -0,0 +1,116 @@
+#pragma once
+
+/// \file epatch.hpp
+/// Differences between object dictionaries, as patches which bring a device to a reference configuration.
+/// Dictionaries are compared in one pass over their address-sorted items. The data of each object is compared as a
+/// whole, and the elements or fields of arrays and records only when it differs, so comparing is proportional to the
+/// size of the data and encoding to the number of differences.
+/// A patch is a CBOR sequence of entries, each of three data items:
+///   - address of the object, as an unsigned difference from the address of the previous entry
+///   - subindex of the value, unsigned
+///   - value as stored, as a byte string
+/// Entries are in address order. A patch of every value is an image of the dictionary, which later dictionaries can
+/// be compared with instead of a live dictionary
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "estd.hpp"
+#include "eio.hpp"
+#include "eobject.hpp"
+
+namespace epatch {
+
+  using eobject::Dictionary;
+  using eobject::Object;
+  using estd::string_view;
+
+  /// \brief Subindex passed to visitors for an object which is missing from the other dictionary, or has a different
+  ///        layout there
+  static constexpr uint8_t WholeObject = 0xFF;
+
+  namespace detail {
+
+    /// \brief Visit the values of two objects with the same layout which differ
+    template<class Visitor>
+    void compare_values(const Dictionary::Item& item, const Object& other, Visitor& visit)
+    {
+      const Object& object = item.object;
+      if (object.data() == nullptr || other.data() == nullptr)
+      {
+        if (object.data() != other.data()) visit(item, &other, WholeObject);
+        return;
+      }
+      if (memcmp(object.data(), other.data(), object.size()) == 0) return;
+
+      if (object.info().otype == Object::ClassId::Variable)
+      {
+        visit(item, &other, 0);
+        return;
+      }
+      for (unsigned subIdx = 1; subIdx <= object.info().nelem; ++subIdx)
+      {
+        size_t      size = 0, other_size = 0;
+        const void* value       = object.locate(static_cast<uint8_t>(subIdx), size);
+        const void* other_value = other.locate(static_cast<uint8_t>(subIdx), other_size);
+        if (size != other_size || memcmp(value, other_value, size) != 0)
+          visit(item, &other, static_cast<uint8_t>(subIdx));
+      }
+    }
+  }
+
+  /// \brief Visit the values of dictionary which differ from those in other
+  /// \param visit Called as visit(const Dictionary::Item& item, const Object* other, uint8_t subIdx) for each value of
+  ///              item which differs from the same value of other, in address and subindex order. Objects missing
+  ///              from other, or with a different type or number of elements there, are visited once with subIdx
+  ///              WholeObject, and other nullptr if missing. Objects only in other are not visited
+  template<class Visitor>
+  void compare(const Dictionary& dictionary, const Dictionary& other, Visitor&& visit)
+  {
+    auto j = other.begin();
+    for (const auto& item : dictionary)
+    {
+      while (j != other.end() && j->address < item.address) ++j;
+      if (j == other.end() || j->address != item.address)
+      {
+        visit(item, static_cast<const Object*>(nullptr), WholeObject);
+        continue;
+      }
+
+      const Object::Info& info       = item.object.info();
+      const Object::Info& other_info = j->object.info();
+      if (info.otype != other_info.otype || info.type != other_info.type || info.nelem != other_info.nelem ||
+          info.data_size != other_info.data_size)
+      {
+        visit(item, &j->object, WholeObject);
+        continue;
+      }
+      detail::compare_values(item, j->object, visit);
+    }
+  }
+
+  /// \brief Write patch which brings dictionary to the values of reference
+  /// \remarks Objects missing from reference, or with a different layout there, are left out
+  /// \returns Number of bytes written, or EOF if the buffer failed
+  int32_t diff(eio::buffer& out, const Dictionary& dictionary, const Dictionary& reference) NOEXCEPT;
+
+  /// \brief Write patch which brings dictionary to the values of an image of reference
+  /// \remarks Values of the image for objects or subindices missing from dictionary, or of a different size, are
+  ///          left out
+  /// \returns Number of bytes written, EOF if the buffer failed, or Error::ParamTooShort or Error::DataTypeError if
+  ///          the image is truncated or corrupt
+  int32_t diff(eio::buffer& out, const Dictionary& dictionary, string_view image) NOEXCEPT;
+
+  /// \brief Write image of every value of dictionary, as a patch
+  /// \returns Number of bytes written, or EOF if the buffer failed
+  int32_t image(eio::buffer& out, const Dictionary& dictionary) NOEXCEPT;
+
+  /// \brief Apply patch to dictionary, setting each value through its object
+  /// \param in Patch, which is advanced past each entry applied, so on error it starts at the entry which failed
+  /// \remarks Values are set as by Dictionary::write, so ranges are checked and set functions called. Entries before
+  ///          an error keep their new values
+  /// \returns Error::OK, an error from setting a value, ObjectNotFound, or ParamTooShort or DataTypeError if the
+  ///          patch is truncated or corrupt
+  int32_t apply(string_view& in, const Dictionary& dictionary) NOEXCEPT;
+}
@@ -0,0 +1,195 @@
+#include "eremote.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace eremote {
+
+  using eobject::Error;
+  using eobject::Object;
+  using eobject::Record;
+  using detail::get16;
+  using detail::put16;
+  using detail::put32;
+
+  namespace {
+
+    /// \brief Append name as a length byte and characters, if it fits before end
+    /// \returns Position after name, or nullptr if it does not fit
+    uint8_t* put_name(uint8_t* p, const uint8_t* end, estd::string_view name) NOEXCEPT
+    {
+      const size_t length = std::min<size_t>(name.size(), 255);
+      if (static_cast<size_t>(end - p) < length + 1) return nullptr;
+      *p++ = static_cast<uint8_t>(length);
+      memcpy(p, name.data(), length);
+      return p + length;
+    }
+
+    /// \brief Read value as Object::get does, but checking its size against the buffer for every class of object
+    int32_t get(const Object& o, uint8_t subIdx, uint8_t* buffer, size_t capacity) NOEXCEPT
+    {
+      if (o.data() == nullptr) return Error::WriteOnly;
+      if (subIdx == 0 && o.otype() != Object::ClassId::Variable)
+      {
+        // Subindex 0 of other classes holds the number of elements
+        if (capacity < 1) return Error::ParamTooShort;
+        *buffer = o.info().nelem;
+        return sizeof(uint8_t);
+      }
+
+      size_t      size  = 0;
+      const void* value = o.locate(subIdx, size);
+      if (value == nullptr) return Error::FieldNotFound;
+      if (size > capacity) return Error::ParamTooShort;
+      memcpy(buffer, value, size);
+      return static_cast<int32_t>(size);
+    }
+
+  }
+
+  int Server::poll() NOEXCEPT
+  {
+    int answered = 0;
+    for (;;)
+    {
+      // Read the header, then the rest of the frame it gives the length of, so no bytes of the next are taken
+      uint16_t wanted = HeaderSize;
+      if (received_ >= 2) wanted = get16(request_);
+      if (wanted < HeaderSize || wanted > MaxFrame)
+      {
+        // Frames cannot be found again in a stream which has lost its framing, so drop what was received
+        received_ = 0;
+        continue;
+      }
+
+      if (received_ < wanted)
+      {
+        int n = device_.read(request_ + received_, static_cast<uint16_t>(wanted - received_));
+        if (n < 0) return n;
+        if (n == 0) return answered;
+        received_ = static_cast<uint16_t>(received_ + n);
+        if (received_ < wanted || (wanted == HeaderSize && get16(request_) > HeaderSize)) continue;
+      }
+
+      const uint16_t size = answer(wanted);
+      received_           = 0;
+      for (uint16_t sent = 0; sent < size;)
+      {
+        int n = device_.write(response_ + sent, static_cast<uint16_t>(size - sent));
+        if (n < 0) return n;
+        if (n == 0 && device_.sync(1) < 0) return EOF;
+        sent = static_cast<uint16_t>(sent + n);
+      }
+      ++answered;
+    }
+  }
+
+  uint16_t Server::answer(uint16_t size) NOEXCEPT
+  {
+    const uint8_t* payload = request_ + HeaderSize;
+    const uint16_t length  = static_cast<uint16_t>(size - HeaderSize);
+
+    uint16_t response = 0;
+    switch (static_cast<Op>(request_[3]))
+    {
+      case Op::Read: response = read(payload, length); break;
+      case Op::Write: response = write(payload, length); break;
+      case Op::Describe: response = describe(payload, length); break;
+      default: break;
+    }
+    if (response == 0)
+    {
+      // Malformed or unknown requests are answered with an error, so the client is not left waiting
+      put32(response_ + HeaderSize, static_cast<uint32_t>(Error::UnableToSet));
+      response = 4;
+    }
+
+    response = static_cast<uint16_t>(response + HeaderSize);
+    put16(response_, response);
+    response_[2] = request_[2];
+    response_[3] = request_[3];
+    return response;
+  }
+
+  uint16_t Server::read(const uint8_t* request, uint16_t size) NOEXCEPT
+  {
+    if (size == 0 || size % 5 != 0) return 0;
+
+    uint8_t*       p   = response_ + HeaderSize;
+    const uint8_t* end = response_ + MaxFrame;
+    for (const uint8_t* r = request; r != request + size; r += 5)
+    {
+      if (end - p < 4) return 0;
+
+      const Object* o        = dictionary_.get(get16(r));
+      const size_t  capacity = std::min<size_t>(get16(r + 3), static_cast<size_t>(end - p - 4));
+      const int32_t result   = o != nullptr ? get(*o, r[2], p + 4, capacity) : Error::ObjectNotFound;
+      put32(p, static_cast<uint32_t>(result));
+      p += 4 + (result > 0 ? result : 0);
+    }
+    return static_cast<uint16_t>(p - (response_ + HeaderSize));
+  }
+
+  uint16_t Server::write(const uint8_t* request, uint16_t size) NOEXCEPT
+  {
+    if (size < 3) return 0;
+
+    // Set functions load values by type, so the value is moved to aligned memory first
+    memcpy(response_, request + 3, size - 3u);
+    const int32_t result = dictionary_.write(get16(request), request[2], response_, size - 3u);
+    put32(response_ + HeaderSize, static_cast<uint32_t>(result));
+    return 4;
+  }
+
+  uint16_t Server::describe(const uint8_t* request, uint16_t size) NOEXCEPT
+  {
+    if (size != 3) return 0;
+
+    uint8_t*       p     = response_ + HeaderSize;
+    const uint8_t* end   = response_ + MaxFrame;
+    const uint16_t index = get16(request);
+    if (index >= dictionary_.count)
+    {
+      put32(p, static_cast<uint32_t>(Error::ObjectNotFound));
+      return 4;
+    }
+
+    const auto&         item = dictionary_.begin()[index];
+    const Object&       o    = item.object;
+    const Object::Info& info = o.info();
+    put32(p, Error::OK);
+    put16(p + 4, static_cast<uint16_t>(dictionary_.count));
+    put16(p + 6, item.address);
+    p[8]  = static_cast<uint8_t>(info.otype);
+    p[9]  = static_cast<uint8_t>(info.type);
+    p[10] = info.nelem;
+    p[11] = static_cast<uint8_t>(info.perm);
+    put16(p + 12, info.data_size);
+    p = put_name(p + 14, end, o.name());
+    if (p == nullptr || p == end) return 0;
+
+    // Fields of records and elements of arrays are named, while rows of tables are only numbered
+    uint8_t* included = p++;
+    *included         = 0;
+    if (o.otype() != Object::ClassId::Record && o.otype() != Object::ClassId::Array)
+      return static_cast<uint16_t>(p - response_ - HeaderSize);
+
+    for (unsigned subIdx = std::max<unsigned>(request[2], 1); subIdx <= info.nelem; ++subIdx)
+    {
+      const auto field = o.info(static_cast<uint8_t>(subIdx));
+      auto       perm  = info.perm;
+      if (o.otype() == Object::ClassId::Record) perm = static_cast<const Record::Info&>(info).fields[subIdx - 1].perm;
+
+      if (end - p < 4) break;
+      uint8_t* next = put_name(p + 4, end, *field.name);
+      if (next == nullptr) break;
+      p[0] = static_cast<uint8_t>(field.info->type);
+      p[1] = static_cast<uint8_t>(perm);
+      put16(p + 2, field.size);
+      p = next;
+      ++*included;
+    }
+    return static_cast<uint16_t>(p - response_ - HeaderSize);
+  }
+
+}
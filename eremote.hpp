@@ -0,0 +1,100 @@
+#pragma once
+
+/// \file eremote.hpp
+/// Access to an object dictionary from another machine over any IODevice, e.g. a host tool talking to a device over a
+/// serial or USB link. The device runs a Server, which answers binary requests, and the host a RemoteDictionary (see
+/// eremote_host.hpp), which sends them. Requests are tagged, so a client may have many outstanding at once and the
+/// link is kept busy however long its round trip, and one request may read many values.
+///
+/// Every frame, in either direction, starts with a header of its total length (2 bytes), a tag chosen by the client
+/// and echoed in the response (1 byte) and an operation (1 byte), followed by a payload. Integers are little endian,
+/// and values are in the native representation of the device, as returned by Object::get. Results are 4 byte integers
+/// holding the size of the value read, or an eobject::Error.
+///   Read:     request of (address: 2, subindex: 1, maximum size: 2) for each value, response of (result: 4, value)
+///             for each value, in the same order
+///   Write:    request of (address: 2, subindex: 1, value), response of (result: 4)
+///   Describe: request of (index: 2, first subindex: 1), response of (result: 4, number of objects: 2, address: 2,
+///             class: 1, type: 1, number of elements: 1, permissions: 1, size: 2, name, number of subobjects: 1)
+///             followed by (type: 1, permissions: 1, size: 2, name) for each named field or element from the first
+///             subindex, as many as fit in a frame. Names are a length byte followed by that many characters
+/// Frames carry no checksum, so links are expected to deliver bytes reliably and in order, as USB, TCP and pipes do
+
+#include <cstddef>
+#include <cstdint>
+
+#include "eio.hpp"
+#include "eobject.hpp"
+#include "estd.hpp"
+
+namespace eremote {
+
+  using eobject::Dictionary;
+
+  /// \brief Largest frame in either direction, including its header, which sets the size of the buffers of servers
+  static constexpr uint16_t MaxFrame = 512;
+
+  /// \brief Size of the header of frames: total length, tag and operation
+  static constexpr uint16_t HeaderSize = 4;
+
+  /// \brief Largest value read or written by a request, as the response holds a result and the value
+  static constexpr uint16_t MaxValue = MaxFrame - HeaderSize - 4;
+
+  /// \brief Operations requested of servers
+  enum class Op : uint8_t
+  {
+    Read     = 1, ///< Read one or more values
+    Write    = 2, ///< Write one value
+    Describe = 3  ///< Get metadata of the object at an index of the dictionary
+  };
+
+  namespace detail {
+
+    inline void put16(uint8_t* p, uint16_t v) NOEXCEPT
+    {
+      p[0] = static_cast<uint8_t>(v);
+      p[1] = static_cast<uint8_t>(v >> 8);
+    }
+
+    inline void put32(uint8_t* p, uint32_t v) NOEXCEPT
+    {
+      put16(p, static_cast<uint16_t>(v));
+      put16(p + 2, static_cast<uint16_t>(v >> 16));
+    }
+
+    inline uint16_t get16(const uint8_t* p) NOEXCEPT { return static_cast<uint16_t>(p[0] | p[1] << 8); }
+
+    inline uint32_t get32(const uint8_t* p) NOEXCEPT { return get16(p) | static_cast<uint32_t>(get16(p + 2)) << 16; }
+
+  }
+
+  /// \brief Answers requests for the objects of a dictionary received on a device
+  /// \remarks Uses no heap, so runs on targets, with buffers of a request and a response frame. Requests are answered
+  ///          in order of arrival, so a write is seen by every read requested after it
+  struct Server
+  {
+    Server(eio::IODevice device, const Dictionary& dictionary) NOEXCEPT
+      : device_(device)
+      , dictionary_(dictionary)
+      , received_(0)
+    {}
+
+    /// \brief Answer every request received so far, without waiting for more
+    /// \returns Number of requests answered, or a negative status of the device if it failed
+    int poll() NOEXCEPT;
+
+  private:
+    /// \brief Answer request in request_, leaving the response in response_
+    /// \returns Size of response
+    uint16_t answer(uint16_t size) NOEXCEPT;
+    uint16_t read(const uint8_t* request, uint16_t size) NOEXCEPT;
+    uint16_t write(const uint8_t* request, uint16_t size) NOEXCEPT;
+    uint16_t describe(const uint8_t* request, uint16_t size) NOEXCEPT;
+
+    eio::IODevice     device_;
+    const Dictionary& dictionary_;
+    uint16_t          received_; ///< Bytes of the next request received so far
+    uint8_t           request_[MaxFrame];
+    alignas(uint32_t) uint8_t response_[MaxFrame]; ///< Response, or value being written, aligned for its type
+  };
+
+}
@@ -0,0 +1,577 @@
+#include "eremote_host.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#include "eatom.hpp"
+
+namespace eremote {
+
+  using eobject::Error;
+  using detail::get16;
+  using detail::get32;
+  using detail::put16;
+
+  namespace {
+
+    /// \brief Take name of a length byte and characters from p
+    /// \returns Position after name, or nullptr if it runs past end
+    const uint8_t* get_name(const uint8_t* p, const uint8_t* end, std::string& name)
+    {
+      if (p == end || end - p - 1 < *p) return nullptr;
+      name.assign(reinterpret_cast<const char*>(p + 1), *p);
+      return p + 1 + *p;
+    }
+
+  }
+
+  RemoteDictionary::Query::Query(estd::string_view& str)
+    : item(nullptr)
+    , field(nullptr)
+    , subIdx(-1)
+    , type(DataType::Invalid)
+    , size(0)
+  {
+    // Names are split and trimmed as for local dictionaries
+    Dictionary::Query q(str);
+    object_name    = q.object_name;
+    subobject_name = q.subobject_name;
+  }
+
+  RemoteDictionary::RemoteDictionary(eio::IODevice device, uint8_t window, std::chrono::milliseconds timeout)
+    : device_(device)
+    , window_(std::max<uint8_t>(window, 1))
+    , timeout_(timeout)
+  {}
+
+  RemoteDictionary::pointer RemoteDictionary::begin()
+  {
+    load();
+    return items_.data();
+  }
+
+  RemoteDictionary::pointer RemoteDictionary::end()
+  {
+    load();
+    return items_.data() + items_.size();
+  }
+
+  const RemoteDictionary::Item* RemoteDictionary::get(uint16_t address)
+  {
+    auto it = std::lower_bound(
+      begin(), end(), address, [](const Item& item, uint16_t address) { return item.address < address; });
+    return it != end() && it->address == address ? it : nullptr;
+  }
+
+  const RemoteDictionary::Item* RemoteDictionary::find(const estd::string_view& name)
+  {
+    load();
+    auto range = names_.equal_range(eatom::hash(name));
+    for (auto it = range.first; it != range.second; ++it)
+    {
+      const Item& item = items_[it->second];
+      if (estd::string_view(item.name.data(), static_cast<uint32_t>(item.name.size())) == name) return &item;
+    }
+    return nullptr;
+  }
+
+  int32_t RemoteDictionary::query(Query& q)
+  {
+    q.item = find(q.object_name);
+    if (q.item == nullptr) return Error::ObjectNotFound;
+
+    q.type = q.item->type;
+    q.size = q.item->size;
+    if (q.subobject_name.empty()) return Error::OK;
+
+    if (q.item->otype == Object::ClassId::Record || q.item->otype == Object::ClassId::Array)
+    {
+      for (auto& field : q.item->fields)
+      {
+        if (estd::string_view(field.name.data(), static_cast<uint32_t>(field.name.size())) != q.subobject_name)
+          continue;
+        q.field  = &field;
+        q.subIdx = static_cast<int16_t>(&field - q.item->fields.data() + 1);
+        q.type   = field.type;
+        q.size   = field.size;
+        return Error::OK;
+      }
+    }
+    else if (q.item->otype == Object::ClassId::Table)
+    {
+      // Rows are addressed by number from 0, so map.2 is the third row
+      uint32_t row = 0;
+      for (char c : q.subobject_name)
+      {
+        if (c < '0' || c > '9' || row > 255) return Error::FieldNotFound;
+        row = row * 10 + (c - '0');
+      }
+      if (row < q.item->nelem)
+      {
+        q.subIdx = static_cast<int16_t>(row + 1);
+        q.size   = static_cast<uint16_t>(q.item->size / q.item->nelem);
+        return Error::OK;
+      }
+    }
+    return Error::FieldNotFound;
+  }
+
+  int32_t RemoteDictionary::write(uint16_t address, uint8_t subIdx, const void* data, size_t size)
+  {
+    int32_t result = NoResponse;
+    queue_write(address, subIdx, data, size, &result);
+    flush();
+    return result;
+  }
+
+  int32_t RemoteDictionary::read(uint16_t address, uint8_t subIdx, void* data, size_t size)
+  {
+    int32_t result = NoResponse;
+    queue_read(address, subIdx, data, size, &result);
+    flush();
+    return result;
+  }
+
+  void RemoteDictionary::queue_read(uint16_t address, uint8_t subIdx, void* data, size_t size, int32_t* result)
+  {
+    queue(Operation{ Op::Read, address, subIdx, data, nullptr, size, result });
+  }
+
+  void RemoteDictionary::queue_write(
+    uint16_t address, uint8_t subIdx, const void* data, size_t size, int32_t* result)
+  {
+    queue(Operation{ Op::Write, address, subIdx, nullptr, data, size, result });
+  }
+
+  void RemoteDictionary::queue(const Operation& operation)
+  {
+    operations_.push_back(operation);
+  }
+
+  int32_t RemoteDictionary::flush()
+  {
+    // Responses cannot be found once framing is lost, and no request can be sent while every tag is abandoned
+    bool ok = (framed_ && abandoned_ < 256) || resync();
+
+    auto last = std::chrono::steady_clock::now();
+    while (ok && (sent_ < operations_.size() || outstanding_ > 0))
+    {
+      if (!send()) break;
+
+      int n = receive();
+      if (n < 0) break;
+      if (n > 0)
+      {
+        last = std::chrono::steady_clock::now();
+        continue;
+      }
+      if (std::chrono::steady_clock::now() - last > timeout_ || device_.sync(1) < 0) break;
+    }
+
+    const bool done = sent_ == operations_.size() && outstanding_ == 0;
+    if (!done) fail();
+    operations_.clear();
+    sent_ = 0;
+    return done ? Error::OK : NoResponse;
+  }
+
+  bool RemoteDictionary::send()
+  {
+    out_.clear();
+    while (outstanding_ < window_ && outstanding_ + abandoned_ < 256 && sent_ < operations_.size())
+    {
+      const Operation& operation = operations_[sent_];
+      if (operation.op == Op::Write && operation.size > MaxFrame - HeaderSize - 3u)
+      {
+        complete(operation, Error::ParamTooLong);
+        ++sent_;
+        continue;
+      }
+
+      while (frames_[tag_].busy || frames_[tag_].abandoned) ++tag_;
+      const size_t start = out_.size();
+      out_.resize(start + HeaderSize);
+
+      size_t count = 1;
+      switch (operation.op)
+      {
+        case Op::Read:
+        {
+          // Reads queued together share a request, as long as the request and its response fit in frames
+          size_t response = HeaderSize;
+          for (count = 0; sent_ + count < operations_.size(); ++count)
+          {
+            const Operation& next  = operations_[sent_ + count];
+            const size_t     value = std::min<size_t>(next.size, MaxValue);
+            if (next.op != Op::Read || out_.size() + 5 - start > MaxFrame || response + 4 + value > MaxFrame) break;
+
+            uint8_t* p = &*out_.insert(out_.end(), 5, 0);
+            put16(p, next.address);
+            p[2] = next.subIdx;
+            put16(p + 3, static_cast<uint16_t>(value));
+            response += 4 + value;
+          }
+          break;
+        }
+        case Op::Write:
+        {
+          uint8_t* p = &*out_.insert(out_.end(), 3 + operation.size, 0);
+          put16(p, operation.address);
+          p[2] = operation.subIdx;
+          if (operation.size != 0) memcpy(p + 3, operation.value, operation.size);
+          break;
+        }
+        case Op::Describe:
+        {
+          uint8_t* p = &*out_.insert(out_.end(), 3, 0);
+          put16(p, operation.address);
+          p[2] = operation.subIdx;
+          break;
+        }
+      }
+
+      put16(&out_[start], static_cast<uint16_t>(out_.size() - start));
+      out_[start + 2] = tag_;
+      out_[start + 3] = static_cast<uint8_t>(operation.op);
+
+      Frame& frame = frames_[tag_++];
+      frame.op     = operation.op;
+      frame.first  = sent_;
+      frame.count  = count;
+      frame.busy   = true;
+      sent_ += count;
+      ++outstanding_;
+      ++stats_.frames;
+    }
+
+    // Requests are sent together, so drivers which send each write as a packet send as few as they can
+    for (size_t written = 0; written < out_.size();)
+    {
+      const uint16_t chunk = static_cast<uint16_t>(std::min<size_t>(out_.size() - written, 0xFFFF));
+      const int      n     = device_.write(out_.data() + written, chunk);
+      if (n < 0 || (n == 0 && device_.sync(1) < 0)) return false;
+      written += static_cast<size_t>(n);
+    }
+    stats_.bytes_sent += out_.size();
+    return true;
+  }
+
+  int RemoteDictionary::receive()
+  {
+    const size_t size = in_.size();
+    in_.resize(size + 4096);
+    const int n = device_.read(in_.data() + size, 4096);
+    in_.resize(size + static_cast<size_t>(std::max(n, 0)));
+    if (n <= 0) return n;
+    stats_.bytes_received += static_cast<uint64_t>(n);
+
+    size_t offset = 0;
+    bool   ok     = true;
+    while (ok && in_.size() - offset >= HeaderSize)
+    {
+      const uint16_t length = get16(&in_[offset]);
+      if (length < HeaderSize || length > MaxFrame)
+      {
+        // The start of the next frame is unknown, so nothing received can be used until the link is resynchronized
+        in_.clear();
+        framed_ = false;
+        return EOF;
+      }
+      if (in_.size() - offset < length) break;
+      ok = answer(&in_[offset], length);
+      offset += length;
+    }
+    // Frames with a malformed payload still have a valid length, so the frames after them are kept
+    in_.erase(in_.begin(), in_.begin() + static_cast<std::ptrdiff_t>(offset));
+    return ok ? n : EOF;
+  }
+
+  bool RemoteDictionary::answer(const uint8_t* data, uint16_t size)
+  {
+    // Responses to requests abandoned by an earlier flush are dropped, which frees their tags
+    Frame& frame = frames_[data[2]];
+    if (static_cast<uint8_t>(frame.op) != data[3]) return true;
+    if (frame.abandoned)
+    {
+      frame.abandoned = false;
+      --abandoned_;
+      return true;
+    }
+    if (!frame.busy) return true;
+
+    const uint8_t* payload = data + HeaderSize;
+    const uint8_t* end     = data + size;
+    const uint64_t before  = stats_.operations;
+    bool           ok      = end - payload >= 4;
+    if (ok)
+    {
+      const Operation& operation = operations_[frame.first];
+      const int32_t    result    = static_cast<int32_t>(get32(payload));
+      switch (frame.op)
+      {
+        case Op::Read:
+          // A request which could not be read at all is answered with a single error
+          if (frame.count > 1 && end - payload == 4 && result < 0)
+          {
+            for (size_t i = 0; i < frame.count; ++i) complete(operations_[frame.first + i], result);
+            break;
+          }
+          ok = answer_read(frame, payload, end);
+          break;
+        case Op::Write: complete(operation, result); break;
+        case Op::Describe: ok = answer_describe(operation, payload, end); break;
+      }
+    }
+    if (!ok)
+    {
+      // No result of a malformed response is trusted, even those taken before the fault was found
+      for (size_t i = 0; i < frame.count; ++i)
+      {
+        int32_t* result = operations_[frame.first + i].result;
+        if (result != nullptr) *result = NoResponse;
+      }
+      stats_.operations = before + frame.count;
+    }
+
+    // The response has arrived, so its tag is free whether or not it was well formed
+    frame.busy = false;
+    --outstanding_;
+    return ok;
+  }
+
+  bool RemoteDictionary::answer_read(const Frame& frame, const uint8_t* p, const uint8_t* end)
+  {
+    for (size_t i = 0; i < frame.count; ++i)
+    {
+      const Operation& operation = operations_[frame.first + i];
+      if (end - p < 4) return false;
+      const int32_t result = static_cast<int32_t>(get32(p));
+      p += 4;
+      if (result > 0)
+      {
+        if (end - p < result || static_cast<size_t>(result) > operation.size) return false;
+        memcpy(operation.data, p, static_cast<size_t>(result));
+        p += result;
+      }
+      complete(operation, result);
+    }
+    return p == end;
+  }
+
+  bool RemoteDictionary::answer_describe(const Operation& operation, const uint8_t* p, const uint8_t* end)
+  {
+    const int32_t result = static_cast<int32_t>(get32(p));
+    if (result != Error::OK)
+    {
+      complete(operation, result);
+      return true;
+    }
+
+    if (end - p < 14) return false;
+    const uint16_t count = get16(p + 4);
+    if (operation.address >= count) return false;
+    if (items_.size() != count) items_.resize(count);
+
+    Item& item   = items_[operation.address];
+    item.address = get16(p + 6);
+    item.otype   = static_cast<Object::ClassId>(p[8]);
+    item.type    = static_cast<DataType>(p[9]);
+    item.nelem   = p[10];
+    item.perm    = static_cast<Object::Permissions>(p[11]);
+    item.size    = get16(p + 12);
+    p            = get_name(p + 14, end, item.name);
+    if (p == nullptr || p == end) return false;
+
+    // Subobjects from the first requested follow, as many as fitted
+    uint8_t included = *p++;
+    if (operation.subIdx + included > item.nelem + 1u) return false;
+    if (operation.subIdx > 1) item.fields.resize(operation.subIdx - 1u);
+    else item.fields.clear();
+    for (; included > 0; --included)
+    {
+      if (end - p < 4) return false;
+      Field field;
+      field.type = static_cast<DataType>(p[0]);
+      field.perm = static_cast<Object::Permissions>(p[1]);
+      field.size = get16(p + 2);
+      p          = get_name(p + 4, end, field.name);
+      if (p == nullptr) return false;
+      item.fields.push_back(std::move(field));
+    }
+    complete(operation, Error::OK);
+    return p == end;
+  }
+
+  void RemoteDictionary::complete(const Operation& operation, int32_t result)
+  {
+    if (operation.result != nullptr) *operation.result = result;
+    ++stats_.operations;
+  }
+
+  void RemoteDictionary::fail()
+  {
+    // Responses may still arrive, so received bytes are kept and the tags are not reused until they do
+    for (auto& frame : frames_)
+    {
+      if (!frame.busy) continue;
+      for (size_t i = 0; i < frame.count; ++i) complete(operations_[frame.first + i], NoResponse);
+      frame.busy      = false;
+      frame.abandoned = true;
+      ++abandoned_;
+    }
+    for (; sent_ < operations_.size(); ++sent_) complete(operations_[sent_], NoResponse);
+    outstanding_ = 0;
+  }
+
+  bool RemoteDictionary::resync()
+  {
+    auto last = std::chrono::steady_clock::now();
+    for (;;)
+    {
+      uint8_t   buffer[256];
+      const int n = device_.read(buffer, sizeof(buffer));
+      if (n < 0) return false;
+      if (n > 0)
+      {
+        stats_.bytes_received += static_cast<uint64_t>(n);
+        last = std::chrono::steady_clock::now();
+        continue;
+      }
+      if (std::chrono::steady_clock::now() - last > timeout_) break;
+      if (device_.sync(1) < 0) break;
+    }
+
+    in_.clear();
+    for (auto& frame : frames_) frame.abandoned = false;
+    abandoned_ = 0;
+    framed_    = true;
+    return true;
+  }
+
+  int32_t RemoteDictionary::load()
+  {
+    if (loaded_) return Error::OK;
+    items_.clear();
+    names_.clear();
+
+    // The first object gives the number of objects, whose metadata is then requested all at once
+    int32_t result = NoResponse;
+    queue(Operation{ Op::Describe, 0, 1, nullptr, nullptr, 0, &result });
+    if (flush() != Error::OK) return NoResponse;
+    if (result != Error::OK && result != Error::ObjectNotFound) return result;
+
+    std::vector<int32_t> results(items_.size(), NoResponse);
+    if (!results.empty()) results[0] = Error::OK;
+    for (;;)
+    {
+      // Objects with more subobjects than fit in a frame are described by further requests from the first missing
+      size_t queued = 0;
+      size_t before = 0;
+      for (uint16_t i = 0; i < items_.size(); ++i)
+      {
+        const Item& item  = items_[i];
+        const bool  named = item.otype == Object::ClassId::Record || item.otype == Object::ClassId::Array;
+        const bool  known = results[i] == Error::OK;
+        before += item.fields.size() + known;
+        if (known && (!named || item.fields.size() >= item.nelem)) continue;
+
+        const uint8_t first = static_cast<uint8_t>(known ? item.fields.size() + 1 : 1);
+        results[i]          = NoResponse;
+        queue(Operation{ Op::Describe, i, first, nullptr, nullptr, 0, &results[i] });
+        ++queued;
+      }
+      if (queued == 0) break;
+      if (flush() != Error::OK) return NoResponse;
+
+      size_t after = 0;
+      for (uint16_t i = 0; i < items_.size(); ++i)
+      {
+        if (results[i] != Error::OK) return results[i];
+        after += items_[i].fields.size() + 1;
+      }
+      // A subobject whose name does not fit in a frame with the name of its object can never be described
+      if (after == before) return Error::UnableToSet;
+    }
+
+    for (uint16_t i = 0; i < items_.size(); ++i)
+    {
+      const std::string& name = items_[i].name;
+      names_.emplace(eatom::hash(estd::string_view(name.data(), static_cast<uint32_t>(name.size()))), i);
+    }
+    loaded_ = true;
+    return Error::OK;
+  }
+
+  void Loopback::Channel::send(const void* data, uint16_t count)
+  {
+    // Bytes are sent one after another, so they wait for bytes sent before them, and arrive in pieces as they are
+    // sent, so the far end can start on the first request of a long write before the last has been sent
+    static const uint16_t piece = 64;
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    free                 = std::max(Clock::now(), free);
+    for (uint16_t sent = 0; sent < count; sent = static_cast<uint16_t>(sent + piece))
+    {
+      const uint16_t n = std::min<uint16_t>(piece, static_cast<uint16_t>(count - sent));
+      if (bytes_per_second != 0) free += std::chrono::nanoseconds(uint64_t(n) * 1000000000u / bytes_per_second);
+      chunks.push_back(Chunk{ free + latency, std::vector<uint8_t>(bytes + sent, bytes + sent + n), 0 });
+    }
+  }
+
+  int Loopback::Channel::receive(void* data, uint16_t count, Clock::time_point now)
+  {
+    uint8_t* p = static_cast<uint8_t*>(data);
+    uint16_t n = 0;
+    while (n < count && !chunks.empty() && chunks.front().arrival <= now)
+    {
+      Chunk&       chunk = chunks.front();
+      const size_t take  = std::min<size_t>(count - n, chunk.bytes.size() - chunk.offset);
+      memcpy(p + n, chunk.bytes.data() + chunk.offset, take);
+      n = static_cast<uint16_t>(n + take);
+      chunk.offset += take;
+      if (chunk.offset == chunk.bytes.size()) chunks.pop_front();
+    }
+    return n;
+  }
+
+  Loopback::Clock::time_point Loopback::Channel::next() const
+  {
+    return chunks.empty() ? Clock::time_point::max() : chunks.front().arrival;
+  }
+
+  Loopback::Loopback(const Dictionary& dictionary, std::chrono::microseconds latency, uint32_t bytes_per_second)
+    : to_device_{ latency, bytes_per_second, Clock::time_point(), {} }
+    , to_host_{ latency, bytes_per_second, Clock::time_point(), {} }
+    , host_(*this, to_host_, to_device_)
+    , device_(*this, to_device_, to_host_)
+    , server_(eio::IODevice(&device_), dictionary)
+  {}
+
+  int Loopback::End::write(const void* data, uint16_t count) NOEXCEPT
+  {
+    out_.send(data, count);
+    return count;
+  }
+
+  int Loopback::End::read(void* data, uint16_t count) NOEXCEPT
+  {
+    return in_.receive(data, count, Clock::now());
+  }
+
+  int Loopback::End::sync(int timeout) NOEXCEPT
+  {
+    // The device end is never waited on, as the server only runs from here
+    if (this != &link_.host_) return timeout;
+
+    for (;;)
+    {
+      if (link_.server_.poll() < 0) return EOF;
+      const auto next = std::min(link_.to_host_.next(), link_.to_device_.next());
+      if (next == Clock::time_point::max()) return EOF;
+      if (link_.to_host_.next() <= Clock::now()) return timeout;
+      std::this_thread::sleep_until(next);
+    }
+  }
+
+}
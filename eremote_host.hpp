@@ -0,0 +1,273 @@
+#pragma once
+
+/// \file eremote_host.hpp
+/// Host side of remote dictionaries (see eremote.hpp): a proxy with the read, write and query API of a Dictionary,
+/// which forwards operations to a Server on a device, and an in-process link to a server for tests and benchmarks.
+/// Operations may be queued and then sent together, in which case as many requests are kept outstanding as the window
+/// allows and consecutive reads are coalesced into requests of many values, so the link is kept busy however long its
+/// round trip. Host only: uses the heap and the clock
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "eio.hpp"
+#include "eio_buffer.hpp"
+#include "eobject.hpp"
+#include "eremote.hpp"
+
+namespace eremote {
+
+  using eobject::DataType;
+  using eobject::Object;
+
+  /// \brief Result of operations which got no response, because the link failed, timed out or lost its framing
+  static constexpr int32_t NoResponse = -1;
+
+  /// \brief Proxy of a dictionary served by a Server over a device
+  /// \remarks Metadata of every object is fetched when first needed, by get, find, query or iteration, and kept until
+  ///          the proxy is destroyed. Values are never cached, so each read and write goes to the device
+  struct RemoteDictionary
+  {
+    /// \brief Metadata of a named field of a record or element of an array
+    struct Field
+    {
+      std::string         name;
+      DataType            type;
+      Object::Permissions perm;
+      uint16_t            size; ///< Size of value
+    };
+
+    /// \brief Metadata of an object
+    struct Item
+    {
+      uint16_t            address = 0;
+      std::string         name;
+      Object::ClassId     otype = Object::ClassId::Invalid;
+      DataType            type  = DataType::Invalid;
+      uint8_t             nelem = 0;
+      Object::Permissions perm  = Object::Permissions::FactoryHidden;
+      uint16_t            size  = 0; ///< Size of data of whole object
+      std::vector<Field>  fields;    ///< Fields of records or elements of arrays, empty for other classes
+    };
+
+    /// \brief Query of an object or subobject by name, as Dictionary::Query
+    struct Query
+    {
+      estd::string_view object_name;
+      estd::string_view subobject_name;
+      const Item*       item;
+      const Field*      field;  ///< Subobject found, or nullptr for whole objects and rows of tables
+      int16_t           subIdx; ///< Subindex found, or -1 for whole objects
+      DataType          type;   ///< Type of value found
+      uint16_t          size;   ///< Size of value found
+
+      /// \brief construct query from string
+      Query(estd::string_view& str);
+    };
+
+    /// \brief Traffic sent and received by the proxy
+    struct Stats
+    {
+      uint64_t operations     = 0; ///< Reads, writes and metadata requests completed or failed
+      uint64_t frames         = 0; ///< Request frames sent, each holding one or more operations
+      uint64_t bytes_sent     = 0;
+      uint64_t bytes_received = 0;
+    };
+
+    typedef const Item* pointer;
+
+    /// \brief Create proxy of the dictionary served on device
+    /// \param window  Largest number of requests outstanding at once, up to 255
+    /// \param timeout Time to wait for a response before the device is taken to have failed
+    explicit RemoteDictionary(eio::IODevice             device,
+                              uint8_t                   window  = 16,
+                              std::chrono::milliseconds timeout = std::chrono::milliseconds(1000));
+
+    RemoteDictionary(const RemoteDictionary&)            = delete;
+    RemoteDictionary& operator=(const RemoteDictionary&) = delete;
+
+    /// \brief Get iterator to metadata of first object, fetching metadata if needed
+    pointer begin();
+    /// \brief Get iterator past metadata of last object
+    pointer end();
+
+    /// \brief Get metadata of object by address, fetching metadata if needed
+    /// \returns pointer to metadata, or nullptr if no object found at this address
+    const Item* get(uint16_t address);
+
+    /// \brief Find metadata of object by name, fetching metadata if needed
+    const Item* find(const estd::string_view& name);
+
+    /// \brief Get object/subobject from metadata based on string, fetching metadata if needed
+    int32_t query(Query& q);
+
+    /// \brief Write value to object on device, after every queued operation
+    /// \returns Result of Dictionary::write on the device, or NoResponse
+    int32_t write(uint16_t address, uint8_t subIdx, const void* data, size_t size);
+
+    /// \brief Read value from object on device, after every queued operation
+    /// \returns Size read, or error of Dictionary::read on the device, or NoResponse
+    int32_t read(uint16_t address, uint8_t subIdx, void* data, size_t size);
+
+    /// \brief Queue read of value, to be sent by flush
+    /// \remarks data and result must stay valid until flush returns, which stores the result of the read in *result,
+    ///          unless result is nullptr. Values are read in one request with the reads queued next to them, up to
+    ///          a frame of values
+    void queue_read(uint16_t address, uint8_t subIdx, void* data, size_t size, int32_t* result);
+
+    /// \brief Queue write of value, to be sent by flush
+    /// \remarks data and result must stay valid until flush returns, which stores the result of the write in *result,
+    ///          unless result is nullptr
+    void queue_write(uint16_t address, uint8_t subIdx, const void* data, size_t size, int32_t* result);
+
+    /// \brief Send queued operations and wait for all of their results
+    /// \remarks Operations are done by the device in the order they were queued
+    /// \returns Error::OK if every operation got a result, or NoResponse if the device failed, in which case the
+    ///          result of operations without a response is NoResponse
+    int32_t flush();
+
+    /// \brief Fetch metadata of every object, unless already fetched
+    /// \returns Error::OK, an error of the device, or NoResponse
+    int32_t load();
+
+    /// \brief Get traffic so far
+    const Stats& stats() const NOEXCEPT { return stats_; }
+
+  private:
+    /// \brief Queued operation
+    struct Operation
+    {
+      Op          op;
+      uint16_t    address; ///< Address of object, or index of object to describe
+      uint8_t     subIdx;  ///< Subindex of value, or first subindex to describe
+      void*       data;    ///< Value read
+      const void* value;   ///< Value written
+      size_t      size;
+      int32_t*    result;
+    };
+
+    /// \brief Outstanding request, which covers count operations from first
+    struct Frame
+    {
+      Op     op        = Op::Read;
+      size_t first     = 0;
+      size_t count     = 0;
+      bool   busy      = false;
+      bool   abandoned = false; ///< Given up by an earlier flush, so its tag is kept until its response arrives
+    };
+
+    void queue(const Operation& operation);
+    /// \brief Send queued operations while the window allows
+    bool send();
+    /// \brief Read what the device has received, and answer operations of the complete responses in it
+    /// \returns Number of bytes read, or a negative status if the device failed or the responses were malformed
+    int  receive();
+    bool answer(const uint8_t* frame, uint16_t size);
+    bool answer_read(const Frame& frame, const uint8_t* payload, const uint8_t* end);
+    bool answer_describe(const Operation& operation, const uint8_t* payload, const uint8_t* end);
+    void complete(const Operation& operation, int32_t result);
+    /// \brief Give up on outstanding and unsent operations, keeping the tags of outstanding requests
+    void fail();
+    /// \brief Drop what the device sends until the link is quiet, after which no response is in flight and every
+    ///        abandoned tag is free again
+    /// \returns false if the device failed
+    bool resync();
+
+    eio::IODevice             device_;
+    uint8_t                   window_;
+    std::chrono::milliseconds timeout_;
+
+    std::vector<Operation> operations_;      ///< Operations queued since the last flush
+    size_t                 sent_        = 0; ///< Number of operations sent or completed without sending
+    Frame                  frames_[256];     ///< Outstanding requests by tag
+    uint8_t                outstanding_ = 0;
+    uint16_t               abandoned_   = 0;     ///< Number of abandoned requests, whose tags are not reused
+    uint8_t                tag_         = 0;     ///< Next tag to try
+    bool                   framed_      = true;  ///< False once received bytes could not be split into frames
+    std::vector<uint8_t>   out_;
+    std::vector<uint8_t>   in_;
+
+    std::vector<Item>                           items_; ///< Metadata in order of address
+    std::unordered_multimap<uint32_t, uint16_t> names_; ///< Indices of items by hash of name
+    bool                                        loaded_ = false;
+    Stats                                       stats_;
+  };
+
+  /// \brief In-process link to a Server of a dictionary, which delivers bytes in each direction after a latency and
+  ///        no faster than a bandwidth, as a serial or network link would
+  /// \remarks The server runs on the thread of the client, whenever the client waits on the device
+  struct Loopback
+  {
+    typedef std::chrono::steady_clock Clock;
+
+    /// \brief Create link to a server of dictionary
+    /// \param latency          Time from the end of sending bytes until they are received
+    /// \param bytes_per_second Rate bytes are sent at in each direction, or 0 for no limit
+    explicit Loopback(const Dictionary&         dictionary,
+                      std::chrono::microseconds latency          = std::chrono::microseconds(0),
+                      uint32_t                  bytes_per_second = 0);
+
+    Loopback(const Loopback&)            = delete;
+    Loopback& operator=(const Loopback&) = delete;
+
+    /// \brief Get device of the client end of the link
+    eio::IODevice device() NOEXCEPT { return eio::IODevice(&host_); }
+
+  private:
+    /// \brief Bytes in flight in one direction
+    struct Channel
+    {
+      struct Chunk
+      {
+        Clock::time_point    arrival;
+        std::vector<uint8_t> bytes;
+        size_t               offset;
+      };
+
+      std::chrono::microseconds latency;
+      uint32_t                  bytes_per_second;
+      Clock::time_point         free; ///< Time sending of bytes already sent ends
+      std::deque<Chunk>         chunks;
+
+      void              send(const void* data, uint16_t count);
+      int               receive(void* data, uint16_t count, Clock::time_point now);
+      Clock::time_point next() const;
+    };
+
+    /// \brief End of the link, which sends on one channel and receives on the other
+    struct End final : public eio::IODevice::Driver
+    {
+      typedef eio::iobuffer<End, 64, 64> BufferType;
+
+      End(Loopback& link, Channel& in, Channel& out) NOEXCEPT
+        : link_(link)
+        , in_(in)
+        , out_(out)
+        , buffer_(*this)
+      {}
+
+      int          write(const void* data, uint16_t count) NOEXCEPT;
+      int          read(void* data, uint16_t count) NOEXCEPT;
+      int          sync(int timeout) NOEXCEPT;
+      eio::buffer& getbuf() NOEXCEPT { return buffer_; }
+
+    private:
+      Loopback&  link_;
+      Channel&   in_;
+      Channel&   out_;
+      BufferType buffer_;
+    };
+
+    Channel to_device_;
+    Channel to_host_;
+    End     host_;
+    End     device_;
+    Server  server_;
+  };
+
+}
@@ -0,0 +1,279 @@
+/// \file esample.cpp
+/// \brief Implementation of sampler
+
+#include "esample.hpp"
+
+#include <cstring>
+
+namespace esample
+{
+  namespace {
+    /// \brief Copy value of a fixed size, so the copy is inlined
+    inline void copy(uint8_t* dest, const void* source, uint8_t size) NOEXCEPT
+    {
+      switch (size)
+      {
+        case 1: memcpy(dest, source, 1); break;
+        case 2: memcpy(dest, source, 2); break;
+        default: memcpy(dest, source, 4); break;
+      }
+    }
+
+    template<class T>
+    int32_t load_as(const void* data) NOEXCEPT
+    {
+      T value;
+      memcpy(&value, data, sizeof(value));
+      return static_cast<int32_t>(value);
+    }
+
+    size_t min(size_t a, size_t b) NOEXCEPT { return a < b ? a : b; }
+  }
+
+  int32_t Sampler::add(uint16_t address, uint8_t subIdx) NOEXCEPT
+  {
+    if (state_ != State::Stopped || count_ == ESAMPLE_MAX_SIGNALS) return Error::UnableToSet;
+
+    const eobject::Object* object = dictionary_.get(address);
+    if (object == nullptr) return Error::ObjectNotFound;
+
+    size_t      size = 0;
+    const void* data = object->locate(subIdx, size);
+    if (data == nullptr) return Error::FieldNotFound;
+
+    DataType type = object->info(subIdx).info->type;
+    if (type == DataType::String || type == DataType::BinString || (size != 1 && size != 2 && size != 4))
+    {
+      return Error::DataTypeError;
+    }
+
+    signals_[count_] = Signal{ data, static_cast<uint8_t>(size), type, address, subIdx, 0 };
+    row_size_        = static_cast<uint8_t>(row_size_ + size);
+    return count_++;
+  }
+
+  void Sampler::clear() NOEXCEPT
+  {
+    stop();
+    count_     = 0;
+    row_size_  = 0;
+    depth_     = 0;
+    taken_     = 0;
+    condition_ = Condition::Always;
+  }
+
+  int32_t Sampler::trigger(uint8_t signal, Condition condition, int32_t level) NOEXCEPT
+  {
+    if (state_ != State::Stopped && state_ != State::Done) return Error::UnableToSet;
+    if (signal >= count_ && condition != Condition::Always && condition != Condition::Never)
+    {
+      return Error::FieldNotFound;
+    }
+    trigger_signal_ = signal;
+    condition_      = condition;
+    level_          = level;
+    return Error::OK;
+  }
+
+  int32_t Sampler::start(uint32_t pre, uint32_t post, uint32_t period_us) NOEXCEPT
+  {
+    if (count_ == 0) return Error::FieldNotFound;
+    if (post == 0) post = 1;
+
+    // Columns take equal shares of storage, by number of samples
+    uint32_t depth = static_cast<uint32_t>(size_ / row_size_);
+    if (depth == 0 || pre > depth || post > depth - pre) return Error::ParamTooLong;
+
+    state_ = State::Stopped;
+    depth_ = depth;
+    uint32_t offset = 0;
+    for (uint8_t i = 0; i < count_; ++i)
+    {
+      signals_[i].offset = offset;
+      offset += depth * signals_[i].size;
+    }
+
+    next_        = 0;
+    taken_       = 0;
+    pre_         = pre;
+    remaining_   = post;
+    has_trigger_ = false;
+    period_us_   = period_us;
+    state_       = State::Armed;
+    return Error::OK;
+  }
+
+  void Sampler::stop() NOEXCEPT
+  {
+    if (state_ != State::Done) state_ = State::Stopped;
+  }
+
+  int32_t Sampler::load(const Signal& signal, const void* data) NOEXCEPT
+  {
+    switch (signal.type)
+    {
+      case DataType::U8: return load_as<uint8_t>(data);
+      case DataType::U16: return load_as<uint16_t>(data);
+      case DataType::U32: return load_as<uint32_t>(data);
+      case DataType::I8: return load_as<int8_t>(data);
+      case DataType::I16: return load_as<int16_t>(data);
+      default: return load_as<int32_t>(data);
+    }
+  }
+
+  bool Sampler::triggered(int32_t current) NOEXCEPT
+  {
+    int32_t previous = previous_;
+    previous_        = current;
+
+    // Edges need a previous sample
+    bool edge = taken_ > 1;
+    switch (condition_)
+    {
+      case Condition::Always: return true;
+      case Condition::Rising: return edge && previous < level_ && current >= level_;
+      case Condition::Falling: return edge && previous > level_ && current <= level_;
+      case Condition::Above: return current > level_;
+      case Condition::Below: return current < level_;
+      default: return false;
+    }
+  }
+
+  void Sampler::tick() NOEXCEPT
+  {
+    if (state_ != State::Armed && state_ != State::Triggered) return;
+
+    uint32_t slot = next_;
+    for (uint8_t i = 0; i < count_; ++i)
+    {
+      const Signal& s = signals_[i];
+      copy(storage_ + s.offset + slot * s.size, s.data, s.size);
+    }
+    ++taken_;
+    if (++next_ == depth_) next_ = 0;
+
+    if (state_ == State::Armed)
+    {
+      if (condition_ == Condition::Never) return;
+
+      // Test the value just stored, rather than the live value, which may have changed since
+      const Signal& s     = signals_[trigger_signal_];
+      bool          fired = triggered(load(s, storage_ + s.offset + slot * s.size));
+      if (taken_ <= pre_ || false == fired) return;
+
+      state_       = State::Triggered;
+      trigger_     = taken_ - 1;
+      has_trigger_ = true;
+    }
+
+    if (--remaining_ == 0) state_ = State::Done;
+  }
+
+  uint32_t Sampler::first() const NOEXCEPT
+  {
+    uint32_t available = taken_ < depth_ ? taken_ : depth_;
+    uint32_t first     = taken_ - available;
+
+    // Older samples than the pre-trigger window may still be held, but are not part of the capture
+    if (has_trigger_ && trigger_ - first > pre_) first = trigger_ - pre_;
+    return first;
+  }
+
+  uint32_t Sampler::samples() const NOEXCEPT { return taken_ - first(); }
+
+  uint32_t Sampler::slot(uint32_t index) const NOEXCEPT { return (first() + index) % depth_; }
+
+  int32_t Sampler::value(uint8_t signal, uint32_t index) const NOEXCEPT
+  {
+    const Signal& s = signals_[signal];
+    return load(s, storage_ + s.offset + slot(index) * s.size);
+  }
+
+  size_t Sampler::export_size() const NOEXCEPT
+  {
+    return sizeof(Header) + count_ * sizeof(SignalInfo) + static_cast<size_t>(samples()) * row_size_;
+  }
+
+  size_t Sampler::read(size_t offset, void* out, size_t size) const NOEXCEPT
+  {
+    size_t total = export_size();
+    if (offset >= total) return 0;
+    if (size > total - offset) size = total - offset;
+
+    uint8_t* o    = static_cast<uint8_t*>(out);
+    size_t   done = 0;
+    uint32_t n    = samples();
+
+    // Header and signal table are small, so they are built whole and the part requested is copied
+    size_t table_size = sizeof(Header) + count_ * sizeof(SignalInfo);
+    if (offset < table_size)
+    {
+      uint8_t table[sizeof(Header) + ESAMPLE_MAX_SIGNALS * sizeof(SignalInfo)];
+      Header  header = { Header::Magic, Header::Version, count_, n,
+                         has_trigger_ ? trigger_ - first() : Header::NoTrigger, period_us_ };
+      memcpy(table, &header, sizeof(header));
+      for (uint8_t i = 0; i < count_; ++i)
+      {
+        SignalInfo info = { signals_[i].address, signals_[i].subIdx, static_cast<uint8_t>(signals_[i].type) };
+        memcpy(table + sizeof(Header) + i * sizeof(SignalInfo), &info, sizeof(info));
+      }
+      done = min(size, table_size - offset);
+      memcpy(o, table + offset, done);
+    }
+
+    // Each column is a ring, so its samples are copied in up to two runs, from the oldest
+    size_t   column_start = table_size;
+    uint32_t first_slot   = n > 0 ? slot(0) : 0;
+    for (uint8_t i = 0; i < count_ && done < size; ++i)
+    {
+      const Signal& s           = signals_[i];
+      size_t        column_size = static_cast<size_t>(n) * s.size;
+      size_t        ring_size   = static_cast<size_t>(depth_) * s.size;
+      size_t        position    = offset + done;
+      if (position < column_start + column_size)
+      {
+        size_t byte = position - column_start;
+        while (byte < column_size && done < size)
+        {
+          size_t ring_byte = (first_slot * s.size + byte) % ring_size;
+          size_t run       = min(min(ring_size - ring_byte, column_size - byte), size - done);
+          memcpy(o + done, storage_ + s.offset + ring_byte, run);
+          byte += run;
+          done += run;
+        }
+      }
+      column_start += column_size;
+    }
+    return done;
+  }
+
+  int32_t Sampler::write(eio::buffer& out, ecodec::Codec codec) const NOEXCEPT
+  {
+    uint32_t n      = samples();
+    Header   header = { Header::Magic, Header::Encoded, count_, n,
+                        has_trigger_ ? trigger_ - first() : Header::NoTrigger, period_us_ };
+    if (out.sputn(reinterpret_cast<const char*>(&header), sizeof(header)) != 0) return EOF;
+    for (uint8_t i = 0; i < count_; ++i)
+    {
+      SignalInfo info = { signals_[i].address, signals_[i].subIdx, static_cast<uint8_t>(signals_[i].type) };
+      if (out.sputn(reinterpret_cast<const char*>(&info), sizeof(info)) != 0) return EOF;
+    }
+    if (out.sputc(static_cast<char>(codec)) == EOF) return EOF;
+
+    // The encoder carries blocks and runs over from the end of the ring to its start
+    int32_t  written    = static_cast<int32_t>(sizeof(header) + count_ * sizeof(SignalInfo) + 1);
+    uint32_t first_slot = n > 0 ? slot(0) : 0;
+    uint32_t head       = static_cast<uint32_t>(min(n, depth_ - first_slot));
+    for (uint8_t i = 0; i < count_; ++i)
+    {
+      const Signal&   s = signals_[i];
+      ecodec::Encoder encoder(out, s.type, codec);
+      encoder.write(storage_ + s.offset + first_slot * s.size, head);
+      encoder.write(storage_ + s.offset, n - head);
+      int32_t result = encoder.finish();
+      if (result < 0) return result;
+      written += result;
+    }
+    return written;
+  }
+}
@@ -0,0 +1,192 @@
+#pragma once
+
+/// \file esample.hpp
+/// Sampler which captures dictionary values at a fixed rate, like an oscilloscope.
+/// Signals are resolved from (address, subindex) to a pointer and size once, when they are added, so each tick only
+/// copies values into a ring with one contiguous column per signal, at a cost which depends only on the number of
+/// signals. A capture may wait for a trigger condition on a signal, keeping a window of samples from before the
+/// trigger and stopping after a window of samples following it. Finished captures are read out in bulk, in a binary
+/// format which tools/esample_dump.py converts to CSV
+
+#include <cstddef>
+#include <cstdint>
+
+#include "estd.hpp"
+#include "ecodec.hpp"
+#include "eobject.hpp"
+
+/// \brief Maximum number of signals sampled together
+#ifndef ESAMPLE_MAX_SIGNALS
+#define ESAMPLE_MAX_SIGNALS 32
+#endif
+
+namespace esample {
+
+  using eobject::DataType;
+  using eobject::Error;
+
+  /// \brief Signal sampled from a dictionary object
+  struct Signal
+  {
+    const void* data;    ///< Value in the object
+    uint8_t     size;    ///< Size of value, 1, 2 or 4 bytes
+    DataType    type;    ///< Type of value
+    uint16_t    address; ///< Address of object
+    uint8_t     subIdx;  ///< Subindex of value in object
+    uint32_t    offset;  ///< Offset of column in storage
+  };
+
+  /// \brief Condition on a signal which triggers a capture
+  enum class Condition : uint8_t
+  {
+    Always  = 0, ///< Trigger as soon as the pre-trigger window has been filled
+    Never   = 1, ///< Sample continuously until stopped, keeping the latest samples
+    Rising  = 2, ///< Signal rises to or above level
+    Falling = 3, ///< Signal falls to or below level
+    Above   = 4, ///< Signal is above level
+    Below   = 5  ///< Signal is below level
+  };
+
+  /// \brief Header of a capture in the export format, followed by the signal table and then the columns. Encoded
+  ///        exports have a Codec byte after the signal table, and each column encoded with it
+  struct Header
+  {
+    static constexpr uint32_t Magic     = 0x504D5345; ///< "ESMP" in little-endian order
+    static constexpr uint16_t Version   = 1;
+    static constexpr uint16_t Encoded   = 2; ///< Version of exports with encoded columns
+    static constexpr uint32_t NoTrigger = 0xFFFFFFFF;
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t signals;   ///< Number of signals, and of columns
+    uint32_t samples;   ///< Number of samples in each column
+    uint32_t trigger;   ///< Index of the trigger sample in the columns, or NoTrigger
+    uint32_t period_us; ///< Time between samples in microseconds, as given when the capture started
+  };
+
+  /// \brief Description of a signal in the export format
+  struct SignalInfo
+  {
+    uint16_t address;
+    uint8_t  subIdx;
+    uint8_t  type; ///< DataType of values in the column
+  };
+
+  static_assert(sizeof(Header) == 20 && sizeof(SignalInfo) == 4, "Export layout is read by host tools");
+
+  /// \brief Samples dictionary values into columns in caller provided storage
+  /// \remarks tick may be called from a timer interrupt. Signals may only be added while stopped, and a capture should
+  ///          only be read once it is done or stopped
+  struct Sampler
+  {
+    /// \brief State of capture
+    enum class State : uint8_t
+    {
+      Stopped   = 0, ///< Not sampling
+      Armed     = 1, ///< Sampling, and waiting for trigger
+      Triggered = 2, ///< Sampling after trigger
+      Done      = 3  ///< Capture finished
+    };
+
+    /// \brief Create sampler
+    /// \param storage    Storage for columns, which is shared among signals
+    /// \param size       Size of storage
+    /// \param dictionary Dictionary of objects to sample
+    Sampler(void* storage, size_t size, const eobject::Dictionary& dictionary) NOEXCEPT
+      : storage_(static_cast<uint8_t*>(storage)), size_(size), dictionary_(dictionary)
+    {}
+
+    /// \brief Add signal to sample
+    /// \returns Index of signal, or Error if the object is not found, its value is not a number or there are
+    ///          too many signals
+    int32_t add(uint16_t address, uint8_t subIdx) NOEXCEPT;
+
+    /// \brief Remove all signals
+    void clear() NOEXCEPT;
+
+    /// \brief Set condition on a signal which triggers the capture
+    /// \param level Level to compare the signal with. Unsigned 32 bit values are compared as signed
+    int32_t trigger(uint8_t signal, Condition condition, int32_t level = 0) NOEXCEPT;
+
+    /// \brief Start a capture
+    /// \param pre       Number of samples to keep from before the trigger
+    /// \param post      Number of samples to take after the trigger, including the trigger sample
+    /// \param period_us Time between ticks, which is only recorded in the capture
+    /// \returns Error::OK, or Error::ParamTooLong if the storage cannot hold pre + post samples of every signal
+    int32_t start(uint32_t pre, uint32_t post, uint32_t period_us) NOEXCEPT;
+
+    /// \brief Stop sampling, keeping the samples taken
+    void stop() NOEXCEPT;
+
+    /// \brief Take one sample of every signal
+    void tick() NOEXCEPT;
+
+    /// \brief Get state of capture
+    State state() const NOEXCEPT { return state_; }
+
+    /// \brief Get number of signals
+    uint8_t signals() const NOEXCEPT { return count_; }
+
+    /// \brief Get signal
+    const Signal& signal(uint8_t index) const NOEXCEPT { return signals_[index]; }
+
+    /// \brief Get number of samples in each column of the ring
+    uint32_t depth() const NOEXCEPT { return depth_; }
+
+    /// \brief Get number of samples in the capture
+    uint32_t samples() const NOEXCEPT;
+
+    /// \brief Get value of a sample in the capture
+    /// \param index Index of sample, from the oldest
+    int32_t value(uint8_t signal, uint32_t index) const NOEXCEPT;
+
+    /// \brief Get size of the capture in the export format
+    size_t export_size() const NOEXCEPT;
+
+    /// \brief Copy part of the capture in the export format, so large captures can be streamed in pieces
+    /// \param offset Offset into the export
+    /// \returns Number of bytes copied, which is 0 at the end of the export
+    size_t read(size_t offset, void* out, size_t size) const NOEXCEPT;
+
+    /// \brief Write the capture in the export format with columns encoded, which is much smaller for slowly
+    ///        changing signals
+    /// \returns Number of bytes written, or Error (negative) if the buffer failed
+    int32_t write(eio::buffer& out, ecodec::Codec codec) const NOEXCEPT;
+
+  private:
+    /// \brief Get number of the first sample in the capture
+    uint32_t first() const NOEXCEPT;
+
+    /// \brief Get slot in the ring of a sample in the capture
+    uint32_t slot(uint32_t index) const NOEXCEPT;
+
+    /// \brief Check trigger condition on the sample just taken
+    bool triggered(int32_t current) NOEXCEPT;
+
+    /// \brief Read the value of a signal as a signed number
+    static int32_t load(const Signal& signal, const void* data) NOEXCEPT;
+
+    uint8_t*                   storage_;
+    size_t                     size_;
+    const eobject::Dictionary& dictionary_;
+
+    Signal  signals_[ESAMPLE_MAX_SIGNALS];
+    uint8_t count_    = 0;
+    uint8_t row_size_ = 0; ///< Sum of the sizes of the signals
+
+    State     state_          = State::Stopped;
+    Condition condition_      = Condition::Always;
+    uint8_t   trigger_signal_ = 0;
+    bool      has_trigger_    = false; ///< Capture has been triggered
+    int32_t   level_          = 0;
+    int32_t   previous_       = 0;     ///< Value of trigger signal at the previous sample
+
+    uint32_t depth_     = 0; ///< Number of slots in each column
+    uint32_t next_      = 0; ///< Slot the next sample is written to
+    uint32_t taken_     = 0; ///< Number of samples taken since the capture started
+    uint32_t pre_       = 0;
+    uint32_t remaining_ = 0; ///< Number of samples still to take after the trigger
+    uint32_t trigger_   = 0; ///< Number of the trigger sample
+    uint32_t period_us_ = 0;
+  };
+}
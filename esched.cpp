@@ -0,0 +1,157 @@
+/// \file esched.cpp
+/// \brief Implementation of cooperative scheduler
+
+#include "esched.hpp"
+
+namespace esched
+{
+  void Scheduler::add(Task& task) NOEXCEPT
+  {
+    // A task removed during a pass stays in the list until the next pass, so it is only marked to run again
+    Task* t = head_;
+    while (t != nullptr && t != &task) t = t->next_;
+    if (t == nullptr)
+    {
+      task.next_ = head_;
+      head_      = &task;
+    }
+
+    task.event_     = nullptr;
+    task.timed_     = true;
+    task.deadline_  = platform_.now();
+    task.signalled_ = false;
+    task.removed_   = false;
+    added_          = true;
+  }
+
+  void Scheduler::remove(Task& task) NOEXCEPT
+  {
+    // During a pass the task is unlinked when the pass ends, so tasks can remove themselves or others while the list
+    // is being run
+    task.removed_ = true;
+    if (running_) purge_ = true;
+    else unlink(task);
+  }
+
+  void Scheduler::unlink(Task& task) NOEXCEPT
+  {
+    for (Task** link = &head_; *link != nullptr; link = &(*link)->next_)
+    {
+      if (*link == &task)
+      {
+        *link      = task.next_;
+        task.next_ = nullptr;
+        return;
+      }
+    }
+  }
+
+  int32_t Scheduler::time_to_ready(const Task& task, tick_type now) NOEXCEPT
+  {
+    if (task.removed_) return -1;
+    if (task.event_ != nullptr && task.event_->count() != task.seen_) return 0;
+    if (false == task.timed_) return -1;
+
+    // Difference of wrapping times, so deadlines work across the wrap around
+    int32_t remaining = static_cast<int32_t>(task.deadline_ - now);
+    return remaining > 0 ? remaining : 0;
+  }
+
+  int32_t Scheduler::run_once() NOEXCEPT
+  {
+    added_       = false;
+    running_     = true;
+    int32_t next = -1;
+
+    Task** link = &head_;
+    while (Task* task = *link)
+    {
+      if (task->removed_)
+      {
+        *link       = task->next_;
+        task->next_ = nullptr;
+        continue;
+      }
+
+      int32_t wait = time_to_ready(*task, platform_.now());
+      if (wait == 0)
+      {
+        task->signalled_ = task->event_ != nullptr && task->event_->count() != task->seen_;
+        Wait w           = task->step(*this);
+        if (w.flags & Wait::Done)
+        {
+          task->removed_ = true;
+          purge_         = true;
+        }
+        else if (false == task->removed_)
+        {
+          task->event_    = w.event;
+          task->seen_     = w.seen;
+          task->timed_    = (w.flags & Wait::Timed) != 0;
+          task->deadline_ = (w.flags & Wait::Absolute) ? w.time : platform_.now() + w.time;
+        }
+        wait = time_to_ready(*task, platform_.now());
+      }
+
+      if (wait >= 0 && (next < 0 || wait < next)) next = wait;
+      link = &task->next_;
+    }
+
+    // Tasks which finished or were removed during the pass are unlinked, so they may be destroyed once it returns
+    running_ = false;
+    if (purge_)
+    {
+      purge_ = false;
+      for (Task** l = &head_; *l != nullptr;)
+      {
+        Task* task = *l;
+        if (task->removed_)
+        {
+          *l          = task->next_;
+          task->next_ = nullptr;
+        }
+        else l = &task->next_;
+      }
+    }
+
+    // Tasks added while running have not been seen by this pass
+    return added_ ? 0 : next;
+  }
+
+  void Scheduler::run() NOEXCEPT
+  {
+    stopped_ = false;
+    while (false == stopped_)
+    {
+      int32_t timeout = run_once();
+      if (timeout != 0 && false == stopped_) platform_.idle(*this, timeout);
+    }
+  }
+
+  bool Scheduler::pending() const NOEXCEPT
+  {
+    tick_type now = platform_.now();
+    for (const Task* t = head_; t != nullptr; t = t->next_)
+    {
+      if (time_to_ready(*t, now) == 0) return true;
+    }
+    return false;
+  }
+
+  Wait PeriodicTask::step(Scheduler& scheduler) NOEXCEPT
+  {
+    tick_type now = scheduler.now();
+    if (false == started_)
+    {
+      next_    = now;
+      started_ = true;
+    }
+
+    function_(context_);
+
+    // Skip calls which have been missed, rather than making them back to back
+    next_ += period_;
+    if (static_cast<int32_t>(now - next_) >= 0) next_ = now + period_;
+    return Wait::until(next_);
+  }
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+/// \file esched.hpp
+/// Cooperative scheduler for embedded systems, without dynamic allocation or exceptions.
+/// Tasks are state machines: each step runs to completion and returns what the task waits for next, which may be an
+/// event, a time, or both. When no task is ready, the scheduler asks the platform to sleep until the next deadline or
+/// until an event source wakes it, rather than spinning
+
+#include <cstdint>
+
+#include "estd.hpp"
+#include "eobject.hpp"
+
+namespace esched {
+
+  /// \brief Time in milliseconds, which wraps around
+  typedef uint32_t tick_type;
+
+  struct Scheduler;
+
+  /// \brief Event which tasks can wait for, such as input becoming ready or an object being changed
+  /// \remarks Signalling only increments a counter, so it is safe from interrupt handlers. Every task waiting when an
+  ///          event is signalled is woken
+  struct Event
+  {
+    /// \brief Wake tasks waiting for this event
+    void signal() NOEXCEPT { count_ = count_ + 1; }
+
+    /// \brief Get number of times this event has been signalled
+    uint32_t count() const NOEXCEPT { return count_; }
+
+  private:
+    volatile uint32_t count_ = 0;
+  };
+
+  /// \brief Condition a task waits for after a step, returned from Task::step
+  struct Wait
+  {
+    /// \brief Run again on the next pass of the scheduler
+    static Wait yield() NOEXCEPT { return Wait{ nullptr, 0, 0, Timed }; }
+
+    /// \brief Run again after a delay
+    static Wait sleep(tick_type ms) NOEXCEPT { return Wait{ nullptr, 0, ms, Timed }; }
+
+    /// \brief Run again at an absolute time, as returned by Scheduler::now
+    static Wait until(tick_type time) NOEXCEPT { return Wait{ nullptr, 0, time, Timed | Absolute }; }
+
+    /// \brief Run again when event is next signalled
+    static Wait on(const Event& event) NOEXCEPT { return Wait{ &event, event.count(), 0, 0 }; }
+
+    /// \brief Run again when event is next signalled, or after a timeout
+    static Wait on(const Event& event, tick_type timeout_ms) NOEXCEPT
+    {
+      return Wait{ &event, event.count(), timeout_ms, Timed };
+    }
+
+    /// \brief Task has finished, and is removed from the scheduler
+    static Wait done() NOEXCEPT { return Wait{ nullptr, 0, 0, Done }; }
+
+  private:
+    friend struct Scheduler;
+
+    enum Flags : uint8_t
+    {
+      Timed    = 0x1, ///< Time is a timeout
+      Absolute = 0x2, ///< Time is absolute, rather than relative to the end of the step
+      Done     = 0x4  ///< Task has finished
+    };
+
+    constexpr Wait(const Event* event_in, uint32_t seen_in, tick_type time_in, uint8_t flags_in) NOEXCEPT
+      : event(event_in)
+      , seen(seen_in)
+      , time(time_in)
+      , flags(flags_in)
+    {}
+
+    const Event* event; ///< Event to wait for, or nullptr
+    uint32_t     seen;  ///< Count of event when the wait began
+    tick_type    time;
+    uint8_t      flags;
+  };
+
+  /// \brief Base class of tasks, which run one step at a time
+  struct Task
+  {
+    /// \brief Run one step of this task, without blocking
+    /// \returns Condition to wait for before the next step
+    virtual Wait step(Scheduler& scheduler) NOEXCEPT = 0;
+
+    /// \brief Check if the current step was started by the event being waited for, rather than by a timeout
+    bool signalled() const NOEXCEPT { return signalled_; }
+
+  private:
+    friend struct Scheduler;
+
+    Task*        next_      = nullptr;
+    const Event* event_     = nullptr;
+    uint32_t     seen_      = 0;
+    tick_type    deadline_  = 0;
+    bool         timed_     = false;
+    bool         signalled_ = false;
+    bool         removed_   = false;
+  };
+
+  /// \brief Platform support for the scheduler: a clock, and a way to sleep
+  struct Platform
+  {
+    /// \brief Get current time in milliseconds
+    virtual tick_type now() NOEXCEPT = 0;
+
+    /// \brief Sleep until an event source wakes the system, or until timeout
+    /// \param scheduler  Scheduler which is idle. Implementations should check Scheduler::pending again with wake-up
+    ///                   sources masked before sleeping, so an event signalled just before sleeping is not missed
+    /// \param timeout_ms Maximum time to sleep, or negative to sleep until woken
+    virtual void idle(const Scheduler& scheduler, int32_t timeout_ms) NOEXCEPT = 0;
+  };
+
+  /// \brief Cooperative scheduler, which runs tasks as they become ready and sleeps when none are
+  struct Scheduler
+  {
+    explicit Scheduler(Platform& platform) NOEXCEPT
+      : platform_(platform)
+    {}
+
+    /// \brief Add task, which runs on the next pass
+    void add(Task& task) NOEXCEPT;
+
+    /// \brief Remove task. It is not run again, and may be added again later
+    /// \remarks The task is unlinked at once, or when the pass ends if called from a step, after which it may be
+    ///          destroyed. Tasks which finish are unlinked at the end of their pass in the same way
+    void remove(Task& task) NOEXCEPT;
+
+    /// \brief Run every ready task once
+    /// \returns 0 if a task is still ready, time until the next deadline in milliseconds, or -1 if all tasks are
+    ///          waiting for events only
+    int32_t run_once() NOEXCEPT;
+
+    /// \brief Run tasks until stopped, sleeping whenever no task is ready
+    void run() NOEXCEPT;
+
+    /// \brief Make run return after the current pass
+    void stop() NOEXCEPT { stopped_ = true; }
+
+    /// \brief Check if any task is ready to run
+    bool pending() const NOEXCEPT;
+
+    /// \brief Get current time from platform
+    tick_type now() const NOEXCEPT { return platform_.now(); }
+
+  private:
+    /// \brief Check if task is ready to run at time, or get time until it is
+    /// \returns 0 if ready, time until its deadline, or -1 if it waits for an event only
+    static int32_t time_to_ready(const Task& task, tick_type now) NOEXCEPT;
+
+    /// \brief Remove task from the list, if it is there
+    void unlink(Task& task) NOEXCEPT;
+
+    Platform& platform_;
+    Task*     head_    = nullptr;
+    bool      added_   = false;
+    bool      stopped_ = false;
+    bool      running_ = false; ///< True while run_once runs tasks, when the list must not change under it
+    bool      purge_   = false; ///< True if tasks were removed during the pass, to be unlinked when it ends
+  };
+
+  /// \brief Task which calls a function at a fixed period
+  /// \remarks Calls are scheduled at multiples of the period from the first call, so they do not drift. If calls fall
+  ///          more than a period behind, the missed calls are skipped
+  struct PeriodicTask final : Task
+  {
+    typedef void (*Function)(void* context);
+
+    PeriodicTask(Function function, void* context, tick_type period_ms) NOEXCEPT
+      : function_(function)
+      , context_(context)
+      , period_(period_ms)
+    {}
+
+    Wait step(Scheduler& scheduler) NOEXCEPT;
+
+  private:
+    Function  function_;
+    void*     context_;
+    tick_type period_;
+    tick_type next_    = 0;
+    bool      started_ = false;
+  };
+
+  /// \brief Set function which calls another set function, then signals event if the value was set
+  /// \remarks Lets tasks wait for dictionary objects to change, e.g. set_and_signal<Variable::detail::set_value<int16_t>, changed>
+  template<eobject::Object::SetFunctionType setf, Event& event>
+  int32_t set_and_signal(const eobject::Object& object, uint8_t subIdx, const void* data, size_t size) NOEXCEPT
+  {
+    int32_t ret = setf(object, subIdx, data, size);
+    if (ret == eobject::Error::OK) event.signal();
+    return ret;
+  }
+}
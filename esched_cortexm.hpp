@@ -0,0 +1,29 @@
+#pragma once
+
+/// \file esched_cortexm.hpp
+/// Scheduler platform for Cortex-M targets, which sleeps with WFI until an interrupt.
+/// Uses CMSIS core intrinsics, so the device header must be included before this file
+
+#include "esched.hpp"
+
+namespace esched {
+
+  /// \brief Platform which reads a millisecond tick counter, and sleeps with WFI
+  /// \tparam Ticks Counter incremented every millisecond by a timer interrupt, e.g. SysTick_Handler
+  /// \remarks The tick interrupt wakes the core every millisecond, so deadlines are met without programming a timer
+  template<volatile uint32_t& Ticks>
+  struct cortexm_platform final : public Platform
+  {
+    tick_type now() NOEXCEPT { return Ticks; }
+
+    void idle(const Scheduler& scheduler, int32_t) NOEXCEPT
+    {
+      // WFI wakes on a pending interrupt even while interrupts are masked, so an event signalled by an interrupt after
+      // the check still ends the sleep, and its handler runs once interrupts are unmasked
+      __disable_irq();
+      if(false == scheduler.pending()) __WFI();
+      __enable_irq();
+    }
+  };
+
+}
@@ -0,0 +1,41 @@
+/// \file esched_posix.cpp
+/// \brief Implementation of scheduler platform for POSIX systems
+
+#include "esched_posix.hpp"
+
+#include <poll.h>
+#include <time.h>
+
+namespace esched
+{
+  bool posix_platform::watch(int fd, Event& event) NOEXCEPT
+  {
+    if(count_ == max_watches) return false;
+    fds_[count_]    = fd;
+    events_[count_] = &event;
+    ++count_;
+    return true;
+  }
+
+  tick_type posix_platform::now() NOEXCEPT
+  {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<tick_type>(ts.tv_sec * 1000u + ts.tv_nsec / 1000000);
+  }
+
+  void posix_platform::idle(const Scheduler& scheduler, int32_t timeout_ms) NOEXCEPT
+  {
+    // Assumes events are only signalled from this thread, so nothing can become ready between this check and poll()
+    if(scheduler.pending()) return;
+
+    pollfd fds[max_watches];
+    for(uint8_t i = 0; i < count_; ++i) fds[i] = pollfd{ fds_[i], POLLIN, 0 };
+
+    if(::poll(fds, count_, timeout_ms) <= 0) return;
+    for(uint8_t i = 0; i < count_; ++i)
+    {
+      if(fds[i].revents != 0) events_[i]->signal();
+    }
+  }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+/// \file esched_posix.hpp
+/// Scheduler platform for POSIX systems, used to run tasks on host systems and Linux gateways
+
+#include "esched.hpp"
+
+namespace esched {
+
+  /// \brief Platform which uses the monotonic clock, and sleeps in poll() on file descriptors being watched
+  struct posix_platform final : public Platform
+  {
+    /// \brief Maximum number of file descriptors which can be watched
+    static const uint8_t max_watches = 8;
+
+    /// \brief Signal event whenever file descriptor has input ready, or has been closed
+    /// \returns false if too many descriptors are watched already
+    bool watch(int fd, Event& event) NOEXCEPT;
+
+    tick_type now() NOEXCEPT;
+    void      idle(const Scheduler& scheduler, int32_t timeout_ms) NOEXCEPT;
+
+  private:
+    int     fds_[max_watches];
+    Event*  events_[max_watches];
+    uint8_t count_ = 0;
+  };
+
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+/// \file etable.hpp
+/// Interpolated lookup in calibration maps stored as table objects, e.g. an injection map indexed by speed and load.
+/// A lookup first locates each input on the breakpoints of its axis, as an index and a fraction of the way to the
+/// next breakpoint, then blends the values around that position in fixed point, 2 values per dimension. Positions
+/// are Q16.16 so axes of up to 65535 breakpoints interpolate with 16 bits of fraction and no floating point.
+/// Inputs outside an axis are clamped to its ends, so a map holds its edge values rather than extrapolating
+
+#include <cstddef>
+#include <cstdint>
+
+#include "estd.hpp"
+#include "mdspan.hpp"
+
+namespace etable {
+
+  /// \brief Position on an axis, with index of the breakpoint below in the upper 16 bits, and the fraction of the way
+  ///        to the next breakpoint in the lower 16 bits
+  typedef uint32_t Position;
+
+  /// \brief Number of fraction bits of a position
+  static constexpr unsigned FractionBits = 16;
+
+  /// \brief Make position from index and fraction
+  constexpr Position position(uint16_t index, uint16_t fraction = 0) NOEXCEPT
+  {
+    return (static_cast<Position>(index) << FractionBits) | fraction;
+  }
+
+  /// \brief Get index of breakpoint below position
+  constexpr uint16_t index(Position p) NOEXCEPT { return static_cast<uint16_t>(p >> FractionBits); }
+
+  /// \brief Get fraction of the way from breakpoint index(p) to the next
+  constexpr uint16_t fraction(Position p) NOEXCEPT { return static_cast<uint16_t>(p); }
+
+  /// \brief Locate value on an axis of count breakpoints in ascending order
+  /// \returns Position, clamped to the first and last breakpoints
+  template<class T>
+  Position locate(const T* breakpoints, uint16_t count, T value) NOEXCEPT
+  {
+    if (count < 2 || !(breakpoints[0] < value)) return position(0);
+    if (!(value < breakpoints[count - 1])) return position(count - 1);
+
+    // Find the last breakpoint below or at value
+    uint16_t low = 0, high = count - 1;
+    while (high - low > 1)
+    {
+      uint16_t mid = low + (high - low) / 2;
+      if (value < breakpoints[mid]) high = mid;
+      else low = mid;
+    }
+    const int64_t offset = static_cast<int64_t>(value) - breakpoints[low];
+    const int64_t span   = static_cast<int64_t>(breakpoints[high]) - breakpoints[low];
+    return position(low, static_cast<uint16_t>((offset << FractionBits) / span));
+  }
+
+  /// \brief Locate value on an axis of count breakpoints at first, first + step, first + 2 * step... without a search
+  /// \returns Position, clamped to the first and last breakpoints
+  constexpr Position locate_uniform(int32_t first, uint32_t step, uint16_t count, int32_t value) NOEXCEPT
+  {
+    if (count < 2 || step == 0 || value <= first) return position(0);
+    const uint64_t offset = static_cast<uint64_t>(static_cast<int64_t>(value) - first);
+    if (offset >= static_cast<uint64_t>(step) * (count - 1u)) return position(count - 1);
+    return position(static_cast<uint16_t>(offset / step), static_cast<uint16_t>(((offset % step) << FractionBits) / step));
+  }
+
+  /// \brief Blend a and b by fraction f of the way from a to b
+  template<class T>
+  constexpr T lerp(T a, T b, uint16_t f) NOEXCEPT
+  {
+    return static_cast<T>(a + (((static_cast<int64_t>(b) - a) * f) >> FractionBits));
+  }
+
+  namespace detail {
+    /// \brief Offset to the next breakpoint from position p on an axis of extent values and stride, which is 0 at
+    ///        the last breakpoint, so clamped positions read their value twice instead of past the end
+    inline uint32_t next(Position p, uint32_t extent, uint32_t stride) NOEXCEPT
+    {
+      return index(p) + 1u < extent ? stride : 0;
+    }
+  }
+
+  /// \brief Interpolate row by position x and column by position y in a table of two dimensions
+  template<class T>
+  T interpolate(estd::mdspan<const T, 2> table, Position x, Position y) NOEXCEPT
+  {
+    CHECK(index(x) < table.extent(0) && index(y) < table.extent(1));
+    const T*       p  = table.data() + index(x) * table.stride(0) + index(y) * table.stride(1);
+    const uint32_t dx = detail::next(x, table.extent(0), table.stride(0));
+    const uint32_t dy = detail::next(y, table.extent(1), table.stride(1));
+
+    const T low  = lerp(p[0], p[dy], fraction(y));
+    const T high = lerp(p[dx], p[dx + dy], fraction(y));
+    return lerp(low, high, fraction(x));
+  }
+
+  /// \brief Interpolate by positions x, y and z in a table of three dimensions
+  template<class T>
+  T interpolate(estd::mdspan<const T, 3> table, Position x, Position y, Position z) NOEXCEPT
+  {
+    CHECK(index(x) < table.extent(0) && index(y) < table.extent(1) && index(z) < table.extent(2));
+    const T* p = table.data() + index(x) * table.stride(0) + index(y) * table.stride(1) + index(z) * table.stride(2);
+    const uint32_t dx = detail::next(x, table.extent(0), table.stride(0));
+    const uint32_t dy = detail::next(y, table.extent(1), table.stride(1));
+    const uint32_t dz = detail::next(z, table.extent(2), table.stride(2));
+
+    const T low  = lerp(lerp(p[0], p[dz], fraction(z)), lerp(p[dy], p[dy + dz], fraction(z)), fraction(y));
+    const T high =
+      lerp(lerp(p[dx], p[dx + dz], fraction(z)), lerp(p[dx + dy], p[dx + dy + dz], fraction(z)), fraction(y));
+    return lerp(low, high, fraction(x));
+  }
+
+}
@@ -0,0 +1,181 @@
+/// \file etrace.cpp
+/// \brief Implementation of trace recorder
+
+#include "etrace.hpp"
+
+#include <cstring>
+
+#include "bit.hpp"
+
+namespace etrace
+{
+  namespace {
+    // Sequence numbers of entries are accessed as volatile, with fences ordering them against the other members
+    uint32_t load_sequence(const Entry& entry) NOEXCEPT
+    {
+      return *static_cast<const volatile uint32_t*>(&entry.sequence);
+    }
+
+    void store_sequence(Entry& entry, uint32_t sequence) NOEXCEPT
+    {
+      *static_cast<volatile uint32_t*>(&entry.sequence) = sequence;
+    }
+  }
+
+  string_view to_string(Source source) NOEXCEPT
+  {
+    switch (source)
+    {
+      case Source::Application: return "application";
+      case Source::Console: return "console";
+      case Source::Import: return "import";
+      case Source::Remote: return "remote";
+    }
+    return "unknown";
+  }
+
+  Recorder* Recorder::active_ = nullptr;
+  Source    Recorder::source_ = Source::Application;
+
+  Recorder::Recorder(void* storage, size_t size, const eobject::Dictionary& dictionary, ClockFunction clock) NOEXCEPT
+    : header_(static_cast<Header*>(storage))
+    , entries_(reinterpret_cast<Entry*>(header_ + 1))
+    , mask_(0)
+    , dictionary_(dictionary)
+    , clock_(clock)
+  {
+    CHECK_BOUNDS("Trace storage too small", size >= storage_size(1));
+    uint32_t fits     = static_cast<uint32_t>((size - sizeof(Header)) / sizeof(Entry));
+    uint32_t capacity = uint32_t(1) << (estd::bit_width(fits) - 1);
+    mask_             = capacity - 1;
+
+    // Continue a trace kept over a reset, rather than clearing it
+    if (header_->magic == Header::Magic && header_->version == Header::Version
+        && header_->entry_size == sizeof(Entry) && header_->capacity == capacity)
+    {
+      return;
+    }
+
+    header_->magic      = Header::Magic;
+    header_->version    = Header::Version;
+    header_->entry_size = sizeof(Entry);
+    header_->capacity   = capacity;
+    clear();
+  }
+
+  void Recorder::start() NOEXCEPT
+  {
+    active_                         = this;
+    eobject::Object::trace_function = trace;
+  }
+
+  void Recorder::stop() NOEXCEPT
+  {
+    if (active_ != this) return;
+    eobject::Object::trace_function = nullptr;
+    active_                         = nullptr;
+  }
+
+  void Recorder::clear() NOEXCEPT
+  {
+    memset(entries_, 0, capacity() * sizeof(Entry));
+    header_->head.store(0, std::memory_order_release);
+  }
+
+  uint32_t Recorder::begin() const NOEXCEPT
+  {
+    uint32_t head = end();
+    return head > capacity() ? head - capacity() : 0;
+  }
+
+  void Recorder::trace(const eobject::Object& object,
+                       uint16_t               address,
+                       uint8_t                subIdx,
+                       uint32_t               old_value,
+                       uint32_t               new_value) NOEXCEPT
+  {
+    Recorder* recorder = active_;
+    if (recorder != nullptr) recorder->record(object, address, subIdx, old_value, new_value);
+  }
+
+  uint16_t Recorder::address_of(const eobject::Object& object) const NOEXCEPT
+  {
+    // Items are found from their position, comparing addresses as integers since the object need not be an item
+    auto first  = reinterpret_cast<uintptr_t>(&dictionary_.begin()->object);
+    auto target = reinterpret_cast<uintptr_t>(&object);
+    if (target >= first)
+    {
+      uintptr_t offset = target - first;
+      uintptr_t index  = offset / sizeof(eobject::Dictionary::Item);
+      if (index < dictionary_.count && offset % sizeof(eobject::Dictionary::Item) == 0)
+        return dictionary_.begin()[index].address;
+    }
+
+    // Copies of items, e.g. taken by callers of get, share the metadata and data of the item
+    for (const auto& item : dictionary_)
+    {
+      if (&item.object.info() == &object.info() && item.object.data() == object.data()) return item.address;
+    }
+    return NoAddress;
+  }
+
+  void Recorder::record(const eobject::Object& object,
+                        uint16_t               address,
+                        uint8_t                subIdx,
+                        uint32_t               old_value,
+                        uint32_t               new_value) NOEXCEPT
+  {
+    uint32_t sequence = header_->head.fetch_add(1, std::memory_order_relaxed);
+    Entry&   entry    = entries_[sequence & mask_];
+
+    // Mark the entry as being written, so readers do not take a mix of two writes
+    store_sequence(entry, 0);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    entry.time      = clock_ != nullptr ? clock_() : 0;
+    entry.address   = address != NoAddress ? address : address_of(object);
+    entry.subIdx    = subIdx;
+    entry.source    = static_cast<uint8_t>(source_);
+    entry.old_value = old_value;
+    entry.new_value = new_value;
+
+    std::atomic_thread_fence(std::memory_order_release);
+    store_sequence(entry, sequence + 1);
+  }
+
+  bool Recorder::read(uint32_t sequence, Entry& entry) const NOEXCEPT
+  {
+    // Differences of sequence numbers, so reading works across the wrap around
+    uint32_t head = end();
+    if (head - sequence - 1 >= capacity()) return false;
+
+    const Entry& source = entries_[sequence & mask_];
+    uint32_t     before = load_sequence(source);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    memcpy(&entry, &source, sizeof(Entry));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint32_t after = load_sequence(source);
+
+    return before == sequence + 1 && after == before;
+  }
+
+  size_t Recorder::export_to(void* out, size_t size) const NOEXCEPT
+  {
+    if (size < storage_size()) return 0;
+
+    uint8_t* bytes = static_cast<uint8_t*>(out);
+    uint32_t head  = end();
+    memcpy(bytes, header_, offsetof(Header, head));
+    memcpy(bytes + offsetof(Header, head), &head, sizeof(head));
+
+    // Output need not be aligned, so entries are copied as bytes
+    uint8_t* entries = bytes + sizeof(Header);
+    memset(entries, 0, capacity() * sizeof(Entry));
+    for (uint32_t sequence = head > capacity() ? head - capacity() : 0; sequence != head; ++sequence)
+    {
+      Entry entry;
+      if (read(sequence, entry)) memcpy(entries + (sequence & mask_) * sizeof(Entry), &entry, sizeof(Entry));
+    }
+    return storage_size();
+  }
+}
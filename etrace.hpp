@@ -0,0 +1,194 @@
+#pragma once
+
+/// \file etrace.hpp
+/// Trace recorder for writes to dictionary objects. Each successful set is appended to a ring of fixed-size entries,
+/// holding the time, address, subindex, values before and after, and the source of the write, so changes can be
+/// reconstructed after the fact. Recording takes a few tens of cycles and never blocks, so it can stay enabled.
+/// The ring is laid out in the storage given to the recorder with a header describing it, so it can be kept in RAM
+/// which is not cleared on reset, or in a memory mapped file, and read back as is. Values are stored in native byte
+/// order, so tools/etrace_dump.py reads traces from little-endian targets
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "estd.hpp"
+#include "eobject.hpp"
+
+namespace etrace {
+
+  using estd::string_view;
+
+  /// \brief Origin of a write, recorded with each entry
+  enum class Source : uint8_t
+  {
+    Application = 0, ///< Written by the application, which is the default
+    Console     = 1, ///< Written by a console command
+    Import      = 2, ///< Written while importing a document, e.g. JSON or CBOR
+    Remote      = 3  ///< Written by a remote client
+  };
+
+  /// \brief Get name of source
+  string_view to_string(Source source) NOEXCEPT;
+
+  /// \brief Address recorded for objects which are not in the dictionary of the recorder
+  static constexpr uint16_t NoAddress = eobject::Object::NoAddress;
+
+  /// \brief Recorded write to an object
+  struct Entry
+  {
+    uint32_t sequence;  ///< Number of the write plus one, or 0 if the entry is empty or was being written
+    uint32_t time;      ///< Time from the clock function of the recorder
+    uint16_t address;   ///< Address of object, or NoAddress
+    uint8_t  subIdx;    ///< Subindex of object which was set
+    uint8_t  source;    ///< Source of the write
+    uint32_t old_value; ///< First 4 bytes of the value before it was set
+    uint32_t new_value; ///< First 4 bytes of the value after it was set
+  };
+
+  /// \brief Header at the start of trace storage, followed by the ring of entries
+  struct Header
+  {
+    static constexpr uint32_t Magic   = 0x43525445; ///< "ETRC" in little-endian order
+    static constexpr uint16_t Version = 1;
+
+    uint32_t              magic;
+    uint16_t              version;
+    uint16_t              entry_size;
+    uint32_t              capacity; ///< Number of entries in the ring, which is a power of two
+    std::atomic<uint32_t> head;     ///< Number of writes recorded, so the next entry is at head % capacity
+  };
+
+  static_assert(sizeof(Entry) == 20, "Entry layout is read by host tools");
+  static_assert(sizeof(Header) == 16, "Header layout is read by host tools");
+
+  /// \brief Records writes to objects of a dictionary into a ring in caller provided storage
+  /// \remarks Writers reserve entries with a single atomic increment, and readers check the sequence number of an
+  ///          entry before and after copying it, so recording needs no locks, even from interrupt handlers. When
+  ///          the ring is full, the oldest entries are overwritten
+  struct Recorder
+  {
+    /// \brief Function returning the time to record, e.g. in milliseconds
+    typedef uint32_t (*ClockFunction)();
+
+    /// \brief Create recorder in storage
+    /// \param storage    Storage aligned to 4 bytes for the header and entries. If it already holds a trace with
+    ///                   the same layout, e.g. in memory kept over a reset, the trace is continued
+    /// \param size       Size of storage. The ring uses the largest power of two number of entries which fits
+    /// \param dictionary Dictionary used to find the address of objects
+    /// \param clock      Function to get the time, or nullptr to record no time
+    Recorder(void* storage, size_t size, const eobject::Dictionary& dictionary, ClockFunction clock) NOEXCEPT;
+
+    /// \brief Start recording writes to objects. Only one recorder records at a time
+    void start() NOEXCEPT;
+
+    /// \brief Stop recording writes
+    void stop() NOEXCEPT;
+
+    /// \brief Check if this recorder is recording
+    bool recording() const NOEXCEPT { return active_ == this; }
+
+    /// \brief Record write to object
+    /// \param address Address of object, or NoAddress to find the object in the dictionary of the recorder
+    void record(const eobject::Object& object,
+                uint16_t               address,
+                uint8_t                subIdx,
+                uint32_t               old_value,
+                uint32_t               new_value) NOEXCEPT;
+
+    /// \brief Remove all entries
+    void clear() NOEXCEPT;
+
+    /// \brief Get number of entries in the ring
+    uint32_t capacity() const NOEXCEPT { return header_->capacity; }
+
+    /// \brief Get sequence number of the oldest write which may still be held
+    uint32_t begin() const NOEXCEPT;
+
+    /// \brief Get sequence number of the next write
+    uint32_t end() const NOEXCEPT { return header_->head.load(std::memory_order_acquire); }
+
+    /// \brief Read entry of a write
+    /// \returns true if the entry was read, false if it has been overwritten or is still being written
+    bool read(uint32_t sequence, Entry& entry) const NOEXCEPT;
+
+    /// \brief Copy trace in the storage layout, with entries which are being written left empty
+    /// \returns Number of bytes written, or 0 if size is too small
+    size_t export_to(void* out, size_t size) const NOEXCEPT;
+
+    /// \brief Get size of storage, or of an export
+    size_t storage_size() const NOEXCEPT { return sizeof(Header) + capacity() * sizeof(Entry); }
+
+    /// \brief Get size of storage needed for a number of entries
+    static constexpr size_t storage_size(uint32_t capacity) NOEXCEPT
+    {
+      return sizeof(Header) + capacity * sizeof(Entry);
+    }
+
+    /// \brief Get source recorded for writes
+    static Source source() NOEXCEPT { return source_; }
+
+    /// \brief Set source recorded for writes
+    /// \returns Previous source
+    static Source source(Source source) NOEXCEPT
+    {
+      Source previous = source_;
+      source_         = source;
+      return previous;
+    }
+
+  private:
+    /// \brief Trace function for objects, which records to the active recorder
+    static void trace(const eobject::Object& object,
+                      uint16_t               address,
+                      uint8_t                subIdx,
+                      uint32_t               old_value,
+                      uint32_t               new_value) NOEXCEPT;
+
+    /// \brief Find address of object set other than through Dictionary::write, which is an item of the dictionary or
+    ///        a copy of one
+    uint16_t address_of(const eobject::Object& object) const NOEXCEPT;
+
+    static Recorder* active_;
+    static Source    source_;
+
+    Header*                    header_;
+    Entry*                     entries_;
+    uint32_t                   mask_;
+    const eobject::Dictionary& dictionary_;
+    ClockFunction              clock_;
+  };
+
+  namespace detail {
+    /// \brief Storage of a TRecorder, which is a base class so it is constructed before the Recorder
+    template<uint32_t Capacity>
+    struct Storage
+    {
+      alignas(4) uint8_t storage[Recorder::storage_size(Capacity)];
+    };
+  }
+
+  /// \brief Recorder with storage for Capacity entries
+  template<uint32_t Capacity>
+  struct TRecorder : private detail::Storage<Capacity>, public Recorder
+  {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    TRecorder(const eobject::Dictionary& dictionary, ClockFunction clock) NOEXCEPT
+      : Recorder(detail::Storage<Capacity>::storage, sizeof(detail::Storage<Capacity>::storage), dictionary, clock)
+    {}
+  };
+
+  /// \brief Set the source recorded for writes until the end of the scope
+  struct SourceScope
+  {
+    explicit SourceScope(Source source) NOEXCEPT
+      : previous_(Recorder::source(source))
+    {}
+
+    ~SourceScope() { Recorder::source(previous_); }
+
+  private:
+    Source previous_;
+  };
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+/// \file fixture.hpp
+/// \brief Dictionary shared by the query and console fuzz targets, with one object of each class and data type
+
+#include <cstddef>
+
+#include "eobject.hpp"
+
+namespace fuzz {
+
+  using eobject::Array;
+  using eobject::Dictionary;
+  using eobject::Error;
+  using eobject::Object;
+  using eobject::Record;
+  using eobject::Table;
+  using eobject::Variable;
+
+  struct Motor
+  {
+    uint32_t current;
+    int16_t  speed;
+    uint16_t limit;
+  };
+
+  struct Data
+  {
+    Motor    motor;
+    uint32_t firmware;
+    uint32_t counter;
+    int16_t  setpoint;
+    uint8_t  level;
+    int8_t   trim;
+    uint16_t gains[3];
+    char     label[16];
+    int16_t  map[3][4];
+  };
+
+  inline Data& data()
+  {
+    static Data d;
+    return d;
+  }
+
+  /// \brief Restore initial values, so each input runs from the same state
+  inline void reset()
+  {
+    data() = Data{ { 0, 0, 2000 }, 0x00010002, 0, 0, 10, -1, { 100, 10, 1 }, "estd",
+                   { { 0, 10, 20, 30 }, { 10, 20, 30, 40 }, { 20, 30, 40, 50 } } };
+  }
+
+  constexpr auto motor_info = Record::make_info(
+    Object::Permissions::UserConfig,
+    Record::fields()
+      .field<Motor, uint32_t, &Motor::current, offsetof(Motor, current), 0, 10000>(Object::Permissions::Status,
+                                                                                  "current")
+      .field<Motor, int16_t, &Motor::speed, offsetof(Motor, speed), -3000, 3000>(Object::Permissions::UserConfig,
+                                                                                "speed")
+      .field<Motor, uint16_t, &Motor::limit, offsetof(Motor, limit), 0, 5000>(Object::Permissions::UserConfig,
+                                                                             "limit"));
+
+  constexpr auto firmware_info = Variable::make_info<uint32_t>(Object::Permissions::Info, Object::detail::set_readonly);
+  constexpr auto counter_info  = Variable::make_info<uint32_t>(Object::Permissions::Dynamic);
+  constexpr auto setpoint_info = Variable::make_info<int16_t, -100, 100>(Object::Permissions::UserConfig);
+  constexpr auto level_info    = Variable::make_info<uint8_t, 0, 200>(Object::Permissions::UserConfig);
+  constexpr auto trim_info     = Variable::make_info<int8_t, -50, 50>(Object::Permissions::UserConfig);
+  constexpr auto label_info    = Variable::make_string_info<16>(Object::Permissions::UserConfig);
+
+  inline const Dictionary& dictionary()
+  {
+    static const auto gains_info =
+      Array::make_info(Object::Permissions::UserConfig, data().gains, { "p", "i", "d" },
+                       Array::detail::set_element<uint16_t>, uint16_t(0), uint16_t(1000));
+    static const auto map_info = Table::make_info(Object::Permissions::UserConfig, data().map,
+                                                  Table::detail::set_row<int16_t>, int16_t(-1000), int16_t(1000));
+
+    static const auto dict = eobject::make_dictionary(
+      Dictionary::Item{ 0x1000, 0, Object("firmware", &firmware_info, &data().firmware) },
+      Dictionary::Item{ 0x2000, 0, Object("motor", &motor_info, &data().motor) },
+      Dictionary::Item{ 0x2001, 0, Object("setpoint", &setpoint_info, &data().setpoint) },
+      Dictionary::Item{ 0x2002, 0, Object("level", &level_info, &data().level) },
+      Dictionary::Item{ 0x2003, 0, Object("trim", &trim_info, &data().trim) },
+      Dictionary::Item{ 0x2004, 0, Object("gains", &gains_info, &data().gains) },
+      Dictionary::Item{ 0x2005, 0, Object("label", &label_info, &data().label) },
+      Dictionary::Item{ 0x2006, 0, Object("map", &map_info, &data().map) },
+      Dictionary::Item{ 0x3000, 0, Object("counter", &counter_info, &data().counter) });
+    return dict;
+  }
+
+}
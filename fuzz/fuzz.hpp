@@ -0,0 +1,80 @@
+#pragma once
+
+/// \file fuzz.hpp
+/// \brief Shared helpers for the fuzz targets.
+/// Each target defines LLVMFuzzerTestOneInput, and is linked either with libFuzzer (or AFL++ in libFuzzer mode),
+/// or with replay.cpp, which runs the target over corpus files so regressions can be checked with any compiler
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "eio.hpp"
+#include "eio_buffer.hpp"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+/// \brief Check a property of the code under test, aborting so the fuzzer records the input as a crash
+#define FUZZ_CHECK(cond)                                                               \
+  do                                                                                   \
+  {                                                                                    \
+    if (!(cond))                                                                       \
+    {                                                                                  \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);         \
+      abort();                                                                         \
+    }                                                                                  \
+  } while (0)
+
+namespace fuzz {
+
+  /// \brief View of fuzzer input as a string
+  inline estd::string_view as_string(const uint8_t* data, size_t size)
+  {
+    return estd::string_view(reinterpret_cast<const char*>(data), static_cast<estd::string_view::size_type>(size));
+  }
+
+  /// \brief Check that view lies within input, as views returned by parsers must
+  inline bool within(estd::string_view view, estd::string_view input)
+  {
+    return view.empty() || (view.data() >= input.data() && view.data() + view.size() <= input.data() + input.size());
+  }
+
+  /// \brief Driver which appends everything written to a string, and reads from a caller-provided view
+  /// \remarks Buffers are small, so the overflow and flush paths are exercised by short inputs
+  struct string_driver final : public eio::IODevice::Driver
+  {
+    typedef eio::iobuffer<string_driver, 16, 32> BufferType;
+
+    string_driver()
+      : buffer_(*this)
+    {}
+
+    std::string       output;
+    estd::string_view input;
+
+    int write(const void* data, uint16_t count) NOEXCEPT override
+    {
+      output.append(static_cast<const char*>(data), count);
+      return count;
+    }
+
+    int read(void* data, uint16_t count) NOEXCEPT override
+    {
+      auto n = estd::min(static_cast<uint32_t>(count), input.size());
+      if (n == 0) return 0;
+      memcpy(data, input.data(), n);
+      input.remove_prefix(n);
+      return n;
+    }
+
+    int sync(int timeout) NOEXCEPT override { return timeout; }
+
+    eio::buffer& getbuf() NOEXCEPT override { return buffer_; }
+
+  private:
+    BufferType buffer_;
+  };
+
+}
@@ -0,0 +1,85 @@
+/// \file fuzz_cbor.cpp
+/// \brief Fuzz target for the CBOR decoder: decodes the input into the dictionary and into each object, then checks
+/// that the decoded values encode to data which decodes back to the same values
+
+#include "fuzz.hpp"
+#include "fixture.hpp"
+
+#include "ecbor.hpp"
+
+using eobject::Dictionary;
+using eobject::Error;
+using eobject::Object;
+using estd::string_view;
+
+namespace {
+
+  /// \brief Range-limited and read-only values are only written through set functions, so they stay valid
+  void check_values()
+  {
+    FUZZ_CHECK(fuzz::data().firmware == 0x00010002);
+    FUZZ_CHECK(fuzz::data().setpoint >= -100 && fuzz::data().setpoint <= 100);
+    FUZZ_CHECK(fuzz::data().level <= 200);
+    FUZZ_CHECK(fuzz::data().trim >= -50 && fuzz::data().trim <= 50);
+    FUZZ_CHECK(fuzz::data().motor.current <= 10000);
+    FUZZ_CHECK(fuzz::data().motor.speed >= -3000 && fuzz::data().motor.speed <= 3000);
+    for (auto gain : fuzz::data().gains) FUZZ_CHECK(gain <= 1000);
+    for (auto& row : fuzz::data().map)
+      for (auto value : row) FUZZ_CHECK(value >= -1000 && value <= 1000);
+  }
+
+  /// \brief Input is consumed on success, within its bounds, and left unchanged on failure
+  void check_consumed(int32_t e, string_view in, string_view input)
+  {
+    if (e == Error::OK) FUZZ_CHECK(fuzz::within(in, input) && in.end() == input.end());
+    else FUZZ_CHECK(in.data() == input.data() && in.size() == input.size());
+  }
+
+  std::string encode(const Object& object, ecbor::Keys keys)
+  {
+    fuzz::string_driver driver;
+    FUZZ_CHECK(ecbor::encode(driver.getbuf(), object, keys) == 0);
+    driver.getbuf().sync(0);
+    return driver.output;
+  }
+
+  /// \brief Encode object, decode the result into initial values, and check that it encodes the same again
+  void check_round_trip(const Object& object, ecbor::Keys keys)
+  {
+    auto saved   = fuzz::data();
+    auto encoded = encode(object, keys);
+
+    fuzz::reset();
+    string_view in(encoded.data(), encoded.size());
+    FUZZ_CHECK(ecbor::decode(in, object) == Error::OK && in.empty());
+    FUZZ_CHECK(encode(object, keys) == encoded);
+    fuzz::data() = saved;
+  }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+  const string_view input = fuzz::as_string(data, size);
+
+  for (auto& item : fuzz::dictionary())
+  {
+    fuzz::reset();
+    string_view in = input;
+    check_consumed(ecbor::decode(in, item.object), in, input);
+    check_values();
+  }
+
+  fuzz::reset();
+  string_view in = input;
+  check_consumed(ecbor::decode(in, fuzz::dictionary()), in, input);
+  check_values();
+
+  for (auto& item : fuzz::dictionary())
+  {
+    // Read-only objects cannot be decoded into
+    if (item.object.info().perm == Object::Permissions::Info) continue;
+    check_round_trip(item.object, ecbor::Keys::Names);
+    check_round_trip(item.object, ecbor::Keys::Indices);
+  }
+  return 0;
+}
@@ -0,0 +1,53 @@
+/// \file fuzz_codec.cpp
+/// \brief Fuzz target for the column decoders: the first bytes of the input select the data type, codec and number of
+/// values, and the rest is decoded as a column. Decoded columns must encode to data which decodes to the same values
+
+#include "fuzz.hpp"
+
+#include <cstring>
+
+#include "ecodec.hpp"
+
+using ecodec::Codec;
+using eobject::DataType;
+using eobject::Error;
+using estd::string_view;
+
+namespace {
+
+  static const size_t max_count = 1024;
+
+  const DataType types[] = { DataType::U8, DataType::U16, DataType::U32, DataType::I8, DataType::I16, DataType::I32 };
+
+  uint32_t values[max_count];
+  uint32_t decoded[max_count];
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+  if (size < 3) return 0;
+  DataType type  = types[data[0] % (sizeof(types) / sizeof(types[0]))];
+  Codec    codec = static_cast<Codec>(data[1] % 4);
+  size_t   count = (data[2] * 8u) % (max_count + 1);
+  const string_view input = fuzz::as_string(data + 3, size - 3);
+
+  // Input is consumed on success, within its bounds, and left unchanged on failure
+  string_view in = input;
+  if (ecodec::decode(in, values, count, type, codec) != Error::OK)
+  {
+    FUZZ_CHECK(in.data() == input.data() && in.size() == input.size());
+    return 0;
+  }
+  FUZZ_CHECK(fuzz::within(in, input) && in.end() == input.end());
+
+  fuzz::string_driver driver;
+  int32_t             written = ecodec::encode(driver.getbuf(), values, count, type, codec);
+  driver.getbuf().sync(0);
+  FUZZ_CHECK(written >= 0 && static_cast<size_t>(written) == driver.output.size());
+  FUZZ_CHECK(driver.output.size() <= ecodec::max_encoded_size(count, type, codec));
+
+  string_view encoded(driver.output.data(), static_cast<string_view::size_type>(driver.output.size()));
+  FUZZ_CHECK(ecodec::decode(encoded, decoded, count, type, codec) == Error::OK && encoded.empty());
+  FUZZ_CHECK(memcmp(values, decoded, count * eobject::type_size(type)) == 0);
+  return 0;
+}
@@ -0,0 +1,36 @@
+/// \file fuzz_console.cpp
+/// \brief Fuzz target for the full Console::poll line path, reading commands from an in-memory device
+
+#include "fuzz.hpp"
+#include "fixture.hpp"
+
+#include "console.hpp"
+#include "eio_memory.hpp"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+  fuzz::reset();
+
+  eio::memory_driver<64, 128> driver;
+  driver.feed(fuzz::as_string(data, size));
+  eio::IODevice device(&driver);
+
+  console::Console console(eformat::stream(device), fuzz::dictionary());
+
+  // Each poll reads more input or handles a line, so the console must drain the input within this many polls.
+  // Running out means the console has stopped reading, e.g. on a line too long for its buffer
+  for (size_t i = 0; i < size + 2; ++i)
+  {
+    console.poll();
+  }
+  FUZZ_CHECK(driver.pending().empty());
+
+  // Read-only and range-limited values are never changed by commands
+  FUZZ_CHECK(fuzz::data().firmware == 0x00010002);
+  FUZZ_CHECK(fuzz::data().setpoint >= -100 && fuzz::data().setpoint <= 100);
+  FUZZ_CHECK(fuzz::data().motor.speed >= -3000 && fuzz::data().motor.speed <= 3000);
+  for (auto gain : fuzz::data().gains) FUZZ_CHECK(gain <= 1000);
+  for (auto& row : fuzz::data().map)
+    for (auto value : row) FUZZ_CHECK(value >= -1000 && value <= 1000);
+  return 0;
+}
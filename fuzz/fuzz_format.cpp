@@ -0,0 +1,141 @@
+/// \file fuzz_format.cpp
+/// \brief Fuzz target for vformat_to: formats a value with options taken from the input and compares the result with
+/// snprintf, then formats a fixed set of arguments with the rest of the input as the format string
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "fuzz.hpp"
+
+#include "eformat.hpp"
+
+using estd::string_view;
+
+namespace {
+
+  /// \brief Option bits taken from the input header
+  enum : uint8_t
+  {
+    AlignMask  = 0x03, ///< 0: left, 1: right, 2: center, 3: not specified
+    BaseShift  = 2,
+    BaseMask   = 0x03, ///< 0: decimal, 1: hex, 2: binary, 3: not specified
+    SignedFlag = 0x10,
+  };
+
+  const size_t header_size = 6;
+
+  /// \brief Build the format specification for the options in the input header
+  std::string make_spec(uint8_t flags, uint8_t width)
+  {
+    static const char align_chars[] = { '<', '>', '^' };
+    static const char base_chars[]  = { 'd', 'x', 'b' };
+
+    std::string spec = "{";
+    if ((flags & AlignMask) != 3) spec += align_chars[flags & AlignMask];
+    if (((flags >> BaseShift) & BaseMask) != 3) spec += base_chars[(flags >> BaseShift) & BaseMask];
+    if (width > 0) spec += std::to_string(width);
+    return spec + "}";
+  }
+
+  /// \brief Reference padding of a formatted value
+  std::string pad(const std::string& value, uint8_t flags, uint8_t width)
+  {
+    if (width <= value.size()) return value;
+    size_t total = width - value.size();
+    size_t left  = 0;
+    switch (flags & AlignMask)
+    {
+      case 1: left = total; break;
+      case 2: left = total / 2; break;
+      default: break;
+    }
+    return std::string(left, ' ') + value + std::string(total - left, ' ');
+  }
+
+  /// \brief Reference integer formatting with snprintf
+  std::string reference_integer(uint32_t bits, uint8_t flags)
+  {
+    char temp[40];
+    switch ((flags >> BaseShift) & BaseMask)
+    {
+      case 1: snprintf(temp, sizeof(temp), "0x%X", static_cast<unsigned>(bits)); break;
+      case 2:
+      {
+        // No binary conversion in printf, so build it by hand
+        std::string binary = "0b";
+        int         width  = 32;
+        while (width > 1 && (bits >> (width - 1)) == 0) --width;
+        for (int bit = width - 1; bit >= 0; --bit) binary += ((bits >> bit) & 1U) ? '1' : '0';
+        return binary;
+      }
+      default:
+        if (flags & SignedFlag) snprintf(temp, sizeof(temp), "% d", static_cast<int>(static_cast<int32_t>(bits)));
+        else snprintf(temp, sizeof(temp), "%u", static_cast<unsigned>(bits));
+        break;
+    }
+    return temp;
+  }
+
+  template<class... Ts>
+  std::string format(string_view fmt, bool& status, Ts... args)
+  {
+    fuzz::string_driver driver;
+    auto&               buf = driver.getbuf();
+    status                  = eformat::format_to(buf, fmt, args...);
+    buf.sync(0);
+    return driver.output;
+  }
+
+  void check_options(const uint8_t* data, string_view text)
+  {
+    uint32_t bits;
+    memcpy(&bits, data, sizeof(bits));
+    uint8_t flags = data[4];
+    uint8_t width = data[5] & 0x7F;
+
+    std::string spec = make_spec(flags, width);
+    string_view fmt(spec.data(), spec.size());
+    bool        status = false;
+
+    std::string output = (flags & SignedFlag) ? format(fmt, status, static_cast<int32_t>(bits))
+                                              : format(fmt, status, bits);
+    FUZZ_CHECK(status);
+    FUZZ_CHECK(output == pad(reference_integer(bits, flags), flags, width));
+
+    // Strings, characters and booleans ignore the base, but are padded the same way
+    output = format(fmt, status, text);
+    FUZZ_CHECK(status && output == pad(std::string(text.data(), text.size()), flags, width));
+
+    char c  = static_cast<char>(bits);
+    output  = format(fmt, status, c);
+    FUZZ_CHECK(status && output == pad(std::string(1, c), flags, width));
+
+    bool b  = (bits & 1U) != 0;
+    output  = format(fmt, status, b);
+    FUZZ_CHECK(status && output == pad(b ? "true" : "false", flags, width));
+  }
+
+  void check_format_string(string_view fmt)
+  {
+    bool        status = false;
+    std::string output = format(fmt, status, uint8_t(200), int16_t(-1234), uint32_t(4000000000u), int32_t(-5),
+                                string_view("text"), true, 'c');
+
+    // Text without arguments is copied unchanged
+    if (memchr(fmt.data(), '{', fmt.size()) == nullptr)
+    {
+      FUZZ_CHECK(status && output == std::string(fmt.data(), fmt.size()));
+    }
+  }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+  if (size < header_size) return 0;
+
+  string_view rest = fuzz::as_string(data + header_size, size - header_size);
+  check_options(data, rest);
+  check_format_string(rest);
+  return 0;
+}
@@ -0,0 +1,109 @@
+/// \file fuzz_json.cpp
+/// \brief Fuzz target for the incremental JSON reader: parses the input whole and in chunks, and checks that both
+/// give the same result, then checks that the values written as JSON read back to the same values
+
+#include <cstring>
+
+#include "fuzz.hpp"
+#include "fixture.hpp"
+
+#include "ejson.hpp"
+
+using eformat::ParseStatus;
+using eobject::Error;
+using estd::string_view;
+
+namespace {
+
+  struct Result
+  {
+    ParseStatus status;
+    int32_t     error;
+    uint16_t    count;
+    size_t      consumed;
+    fuzz::Data  data;
+
+    bool operator==(const Result& other) const
+    {
+      return status == other.status && error == other.error && count == other.count && consumed == other.consumed
+             && memcmp(&data, &other.data, sizeof(data)) == 0;
+    }
+  };
+
+  Result parse_whole(string_view input)
+  {
+    fuzz::reset();
+    ejson::reader reader(fuzz::dictionary());
+    string_view   in     = input;
+    auto          status = reader.parse(in);
+    FUZZ_CHECK(fuzz::within(in, input) && in.end() == input.end());
+    return Result{ status, reader.error(), reader.count(), input.size() - in.size(), fuzz::data() };
+  }
+
+  /// \brief Parse input as it would arrive in chunks, keeping unconsumed input for the next call
+  Result parse_chunked(string_view input, size_t chunk)
+  {
+    fuzz::reset();
+    ejson::reader reader(fuzz::dictionary());
+    const char*   pos      = input.begin();
+    size_t        received = 0;
+    auto          status   = ParseStatus::Incomplete;
+    while(status == ParseStatus::Incomplete && received < input.size())
+    {
+      received = estd::min(static_cast<uint32_t>(received + chunk), input.size());
+      string_view in(pos, input.begin() + received);
+      status = reader.parse(in);
+      pos    = in.begin();
+    }
+    return Result{ status, reader.error(), reader.count(), static_cast<size_t>(pos - input.begin()), fuzz::data() };
+  }
+
+  /// \brief Range-limited and read-only values are only written through set functions, so they stay valid
+  void check_values()
+  {
+    FUZZ_CHECK(fuzz::data().firmware == 0x00010002);
+    FUZZ_CHECK(fuzz::data().setpoint >= -100 && fuzz::data().setpoint <= 100);
+    FUZZ_CHECK(fuzz::data().level <= 200);
+    FUZZ_CHECK(fuzz::data().trim >= -50 && fuzz::data().trim <= 50);
+    FUZZ_CHECK(fuzz::data().motor.speed >= -3000 && fuzz::data().motor.speed <= 3000);
+    for (auto gain : fuzz::data().gains) FUZZ_CHECK(gain <= 1000);
+    for (auto& row : fuzz::data().map)
+      for (auto value : row) FUZZ_CHECK(value >= -1000 && value <= 1000);
+  }
+
+  std::string write_dictionary()
+  {
+    fuzz::string_driver driver;
+    eio::IODevice       device(&driver);
+    eformat::stream     so(device);
+    ejson::write(so, fuzz::dictionary());
+    so.sync();
+    return driver.output;
+  }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+  if (size < 1) return 0;
+
+  // First byte selects the chunk size, so token boundaries fall at every position of the document
+  size_t            chunk = 1 + data[0] % 16;
+  const string_view input = fuzz::as_string(data + 1, size - 1);
+
+  Result whole = parse_whole(input);
+  check_values();
+  FUZZ_CHECK(parse_chunked(input, chunk) == whole);
+
+  // Values read from the input are written as JSON which reads back to the same values. The firmware is read-only,
+  // so setting it fails, and that is the only error
+  fuzz::data()     = whole.data;
+  std::string json = write_dictionary();
+
+  fuzz::reset();
+  ejson::reader reader(fuzz::dictionary());
+  string_view   in(json.data(), json.size());
+  FUZZ_CHECK(reader.parse(in) == ParseStatus::OK && in.empty());
+  FUZZ_CHECK(reader.error() == Error::ReadOnly);
+  FUZZ_CHECK(write_dictionary() == json);
+  return 0;
+}
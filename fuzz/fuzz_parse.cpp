@@ -0,0 +1,243 @@
+/// \file fuzz_parse.cpp
+/// \brief Fuzz target for every eformat::parse overload and match, checked against strtoul/strtol
+
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#include "fuzz.hpp"
+
+#include "eformat.hpp"
+
+using eformat::ParseStatus;
+using estd::string_view;
+
+namespace {
+
+  /// \brief Expected result of parsing the start of an input
+  struct Expected
+  {
+    ParseStatus status;
+    long long   value;
+    size_t      consumed;
+  };
+
+  bool isdigit(char c) { return c >= '0' && c <= '9'; }
+
+  /// \brief Reference for unsigned parsing: the leading run of digits, converted by strtoul
+  Expected reference_unsigned(string_view in, unsigned long max)
+  {
+    size_t n = 0;
+    while (n < in.size() && isdigit(in[n])) ++n;
+    if (n == 0) return Expected{ ParseStatus::NotMatched, 0, 0 };
+
+    std::string digits(in.data(), n);
+    errno               = 0;
+    unsigned long value = strtoul(digits.c_str(), nullptr, 10);
+    if (errno == ERANGE || value > max) return Expected{ ParseStatus::Overflow, 0, 0 };
+    return Expected{ ParseStatus::OK, static_cast<long long>(value), n };
+  }
+
+  /// \brief Reference for signed parsing: an optional sign and the following digits, converted by strtol
+  Expected reference_signed(string_view in, long min, long max)
+  {
+    size_t n = 0;
+    if (n < in.size() && (in[n] == '-' || in[n] == '+')) ++n;
+    size_t first_digit = n;
+    while (n < in.size() && isdigit(in[n])) ++n;
+    if (n == first_digit) return Expected{ ParseStatus::NotMatched, 0, 0 };
+
+    std::string digits(in.data(), n);
+    errno      = 0;
+    long value = strtol(digits.c_str(), nullptr, 10);
+    if (errno == ERANGE || value < min || value > max) return Expected{ ParseStatus::Overflow, 0, 0 };
+    return Expected{ ParseStatus::OK, value, n };
+  }
+
+  /// \brief Parse input as T, and compare status, value and consumed input with the reference
+  template<class T>
+  void check_integer(string_view input, const Expected& expected)
+  {
+    string_view in    = input;
+    T           value = T(0x5A);
+    auto        status = eformat::parse(in, value);
+
+    FUZZ_CHECK(status == expected.status);
+    if (status == ParseStatus::OK)
+    {
+      FUZZ_CHECK(static_cast<long long>(value) == expected.value);
+      FUZZ_CHECK(in.data() == input.data() + expected.consumed && in.size() == input.size() - expected.consumed);
+    }
+    else
+    {
+      // Input is only consumed on success
+      FUZZ_CHECK(in.data() == input.data() && in.size() == input.size());
+    }
+  }
+
+  template<class T>
+  void check_unsigned(string_view input)
+  {
+    check_integer<T>(input, reference_unsigned(input, std::numeric_limits<T>::max()));
+  }
+
+  template<class T>
+  void check_signed(string_view input)
+  {
+    check_integer<T>(input, reference_signed(input, std::numeric_limits<T>::min(), std::numeric_limits<T>::max()));
+  }
+
+  bool starts_with(string_view input, const char* prefix)
+  {
+    size_t n = strlen(prefix);
+    return input.size() >= n && memcmp(input.data(), prefix, n) == 0;
+  }
+
+  void check_bool(string_view input)
+  {
+    string_view in    = input;
+    bool        value = false;
+    auto        status = eformat::parse(in, value);
+
+    if (starts_with(input, "true"))
+    {
+      FUZZ_CHECK(status == ParseStatus::OK && value == true && in.size() == input.size() - 4);
+    }
+    else if (starts_with(input, "false"))
+    {
+      FUZZ_CHECK(status == ParseStatus::OK && value == false && in.size() == input.size() - 5);
+    }
+    else
+    {
+      FUZZ_CHECK(status == ParseStatus::NotMatched && in.size() == input.size());
+    }
+  }
+
+  /// \brief Parse input as a fixed-point number, and check that formatting the value parses back to it
+  void check_fixed(string_view input, uint8_t decimals)
+  {
+    string_view in     = input;
+    int32_t     value  = 0x5A;
+    auto        status = eformat::parse_fixed(in, value, decimals);
+    if (status != ParseStatus::OK)
+    {
+      FUZZ_CHECK(in.data() == input.data() && in.size() == input.size());
+      return;
+    }
+    FUZZ_CHECK(in.data() > input.data() && in.data() <= input.data() + input.size());
+
+    // Positive values are formatted with a space in place of the sign, which parsing does not skip
+    char        text[16];
+    int         n = eformat::format_fixed(text, sizeof(text), value, decimals);
+    string_view formatted(text[0] == ' ' ? text + 1 : text, text[0] == ' ' ? n - 1 : n);
+    int32_t     parsed = 0;
+    FUZZ_CHECK(eformat::parse_fixed(formatted, parsed, decimals) == ParseStatus::OK);
+    FUZZ_CHECK(parsed == value && formatted.empty());
+  }
+
+  int hex_value(char c)
+  {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+  }
+
+  /// \brief Parse input as hex bytes into storage of capacity bytes, checked against decoding one digit at a time,
+  ///        and check that formatting the bytes gives the digits back
+  template<size_t capacity>
+  void check_hex_bytes(string_view input)
+  {
+    size_t digits = 0;
+    while (digits < input.size() && hex_value(input[digits]) >= 0) ++digits;
+
+    uint8_t             storage[capacity];
+    estd::span<uint8_t> value(storage, static_cast<uint32_t>(capacity));
+    string_view         in     = input;
+    auto                status = eformat::parse(in, value);
+
+    if (digits == 0 || (digits % 2 != 0 && digits / 2 <= capacity))
+    {
+      FUZZ_CHECK(status == ParseStatus::NotMatched);
+    }
+    else if (digits / 2 > capacity)
+    {
+      FUZZ_CHECK(status == ParseStatus::Overflow);
+    }
+    else
+    {
+      FUZZ_CHECK(status == ParseStatus::OK && value.size() == digits / 2 && in.data() == input.data() + digits);
+      for (size_t i = 0; i < value.size(); ++i)
+        FUZZ_CHECK(value[i] == (hex_value(input[2 * i]) << 4 | hex_value(input[2 * i + 1])));
+
+      char text[2 * capacity];
+      int  n = eformat::format_hex(text, sizeof(text), estd::span<const uint8_t>(value.begin(), value.size()));
+      FUZZ_CHECK(static_cast<size_t>(n) == digits);
+      for (size_t i = 0; i < digits; ++i) FUZZ_CHECK(hex_value(text[i]) == hex_value(input[i]));
+      return;
+    }
+    FUZZ_CHECK(in.data() == input.data() && in.size() == input.size());
+  }
+
+  /// \brief Parse a token into a small span, stopping at a delimiter chosen by predicate
+  template<class Parse, class IsDelimiter>
+  void check_token(string_view input, Parse parse, IsDelimiter isdelim)
+  {
+    char                   storage[16];
+    estd::span<char>       token(storage, sizeof(storage));
+    string_view            in     = input;
+    auto                   status = parse(in, token);
+
+    size_t end = 0;
+    while (end < input.size() && !isdelim(input[end])) ++end;
+
+    if (end > sizeof(storage))
+    {
+      FUZZ_CHECK(status == ParseStatus::Overflow);
+    }
+    else if (end == input.size())
+    {
+      FUZZ_CHECK(status == ParseStatus::Incomplete);
+    }
+    else
+    {
+      FUZZ_CHECK(status == ParseStatus::OK);
+      FUZZ_CHECK(token.size() == end && memcmp(token.data(), input.data(), end) == 0);
+      FUZZ_CHECK(in.data() == input.data() + end);
+    }
+  }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+  string_view input = fuzz::as_string(data, size);
+
+  check_unsigned<uint8_t>(input);
+  check_unsigned<uint16_t>(input);
+  check_unsigned<uint32_t>(input);
+  check_signed<int8_t>(input);
+  check_signed<int16_t>(input);
+  check_signed<int32_t>(input);
+  check_bool(input);
+  check_fixed(input, 0);
+  check_fixed(input, 2);
+  check_fixed(input, 9);
+  check_hex_bytes<4>(input);
+  check_hex_bytes<64>(input);
+
+  check_token(input,
+              [](string_view& in, estd::span<char>& token) { return eformat::parse(in, token); },
+              [](char c) { return estd::isspace(c); });
+
+  // Use the first byte as the delimiter for the rest of the input
+  if (size > 0)
+  {
+    char delimiter = input[0];
+    check_token(string_view(input.data() + 1, input.size() - 1),
+                [delimiter](string_view& in, estd::span<char>& token) { return eformat::parse(in, token, delimiter); },
+                [delimiter](char c) { return c == delimiter; });
+  }
+  return 0;
+}
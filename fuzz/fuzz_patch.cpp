@@ -0,0 +1,63 @@
+/// \file fuzz_patch.cpp
+/// \brief Fuzz target for patches: applies the input to the dictionary, then checks that a patch from the initial
+/// values to an image of the result brings the initial values to the same result
+
+#include "fuzz.hpp"
+#include "fixture.hpp"
+
+#include "epatch.hpp"
+
+using eobject::Error;
+using estd::string_view;
+
+namespace {
+
+  /// \brief Range-limited and read-only values are only written through set functions, so they stay valid
+  void check_values()
+  {
+    FUZZ_CHECK(fuzz::data().firmware == 0x00010002);
+    FUZZ_CHECK(fuzz::data().setpoint >= -100 && fuzz::data().setpoint <= 100);
+    FUZZ_CHECK(fuzz::data().level <= 200);
+    FUZZ_CHECK(fuzz::data().trim >= -50 && fuzz::data().trim <= 50);
+    FUZZ_CHECK(fuzz::data().motor.current <= 10000);
+    FUZZ_CHECK(fuzz::data().motor.speed >= -3000 && fuzz::data().motor.speed <= 3000);
+    for (auto gain : fuzz::data().gains) FUZZ_CHECK(gain <= 1000);
+    for (auto& row : fuzz::data().map)
+      for (auto value : row) FUZZ_CHECK(value >= -1000 && value <= 1000);
+  }
+
+  std::string image()
+  {
+    fuzz::string_driver driver;
+    int32_t             written = epatch::image(driver.getbuf(), fuzz::dictionary());
+    driver.getbuf().sync(0);
+    FUZZ_CHECK(written >= 0 && static_cast<size_t>(written) == driver.output.size());
+    return driver.output;
+  }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+  const string_view input = fuzz::as_string(data, size);
+
+  // Entries are consumed as they are applied, so the input stops at the entry which failed
+  fuzz::reset();
+  string_view in = input;
+  int32_t     e  = epatch::apply(in, fuzz::dictionary());
+  FUZZ_CHECK(fuzz::within(in, input) && in.end() == input.end());
+  FUZZ_CHECK(e != Error::OK || in.empty());
+  check_values();
+
+  // A patch from the initial values to an image of the result brings them to the same result
+  const std::string   result = image();
+  fuzz::string_driver patch;
+  fuzz::reset();
+  int32_t written = epatch::diff(patch.getbuf(), fuzz::dictionary(), string_view(result.data(), result.size()));
+  patch.getbuf().sync(0);
+  FUZZ_CHECK(written >= 0 && static_cast<size_t>(written) == patch.output.size());
+
+  string_view p(patch.output.data(), patch.output.size());
+  FUZZ_CHECK(epatch::apply(p, fuzz::dictionary()) == Error::OK && p.empty());
+  FUZZ_CHECK(image() == result);
+  return 0;
+}
@@ -0,0 +1,101 @@
+/// \file fuzz_query.cpp
+/// \brief Fuzz target for Dictionary::Query construction from arbitrary lines, and the dictionary lookup it drives,
+/// which a name index and a compact dictionary must resolve the same way
+
+#include "fuzz.hpp"
+#include "fixture.hpp"
+
+using eobject::Dictionary;
+using eobject::Error;
+using estd::string_view;
+
+namespace {
+
+  /// \brief Fixture dictionary as compact tables, with data located by offset in fuzz::Data
+  struct Compact
+  {
+    uint16_t                     addresses[16];
+    const eobject::Object::Info* infos[16];
+    uint16_t                     offsets[16];
+    char                         pool[256];
+    uint16_t                     names[17];
+    eobject::CompactDictionary   dictionary;
+
+    Compact()
+      : dictionary(0, addresses, infos, offsets, &fuzz::data(), names, pool)
+    {
+      uint16_t end = 0;
+      for (auto& item : fuzz::dictionary())
+      {
+        uint16_t i   = dictionary.count++;
+        addresses[i] = item.address;
+        infos[i]     = &item.object.info();
+        offsets[i]   = static_cast<uint16_t>(static_cast<const uint8_t*>(item.object.data()) -
+                                           reinterpret_cast<const uint8_t*>(&fuzz::data()));
+        names[i]     = end;
+        for (char c : item.object.name()) pool[end++] = c;
+      }
+      names[dictionary.count] = end;
+    }
+  };
+
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+  fuzz::reset();
+
+  string_view input = fuzz::as_string(data, size);
+  string_view line  = input;
+
+  Dictionary::Query query{ line };
+
+  // Query names are views into the line, and the line only shrinks
+  FUZZ_CHECK(fuzz::within(query.object_name, input));
+  FUZZ_CHECK(fuzz::within(query.subobject_name, input));
+  FUZZ_CHECK(fuzz::within(line, input));
+
+  static const eobject::TNameIndex<16, 32, 16> names(fuzz::dictionary());
+  Dictionary::Query indexed = query;
+
+  static const Compact compact;
+
+  string_view                       compact_line = input;
+  eobject::CompactDictionary::Query compacted{ compact_line };
+
+  int32_t e = fuzz::dictionary().query(query);
+  FUZZ_CHECK(names.query(indexed) == e);
+  FUZZ_CHECK(indexed.item == query.item);
+  if (e == Error::OK) FUZZ_CHECK(indexed.subIdx == query.subIdx && indexed.info == query.info);
+
+  FUZZ_CHECK(compact.dictionary.query(compacted) == e);
+  if (e == Error::OK)
+  {
+    FUZZ_CHECK(compacted.item->address == query.item->address && compacted.subIdx == query.subIdx);
+    FUZZ_CHECK(compacted.item->object.name() == query.item->object.name());
+    FUZZ_CHECK(compacted.item->object.data() == query.item->object.data() && compacted.info == query.info);
+  }
+
+  if (e == Error::OK)
+  {
+    FUZZ_CHECK(query.item != nullptr && query.info != nullptr);
+    FUZZ_CHECK(query.item->object.name() == query.object_name);
+
+    uint8_t buffer[64];
+    if (query.subIdx >= 0)
+    {
+      FUZZ_CHECK(query.subIdx >= 1 && query.subIdx <= query.item->object.info().nelem);
+      FUZZ_CHECK(query.item->object.get(query.subIdx, buffer, sizeof(buffer)) > 0);
+    }
+    else
+    {
+      FUZZ_CHECK(query.subobject_name.empty());
+    }
+  }
+  else
+  {
+    FUZZ_CHECK(e == Error::ObjectNotFound || e == Error::FieldNotFound);
+    FUZZ_CHECK(e == Error::FieldNotFound || query.item == nullptr);
+  }
+  return 0;
+}
@@ -0,0 +1,77 @@
+/// \file fuzz_remote.cpp
+/// \brief Fuzz target for both ends of remote dictionaries. If the first byte is even, the rest is a stream of
+/// requests to a server of the fixture dictionary, whose responses must be well formed frames. If it is odd, the rest
+/// is a stream of responses to a proxy which fetches metadata and reads and writes values, whose results must fit the
+/// values asked for
+
+#include "fuzz.hpp"
+#include "fixture.hpp"
+
+#include "eremote_host.hpp"
+
+using eobject::Error;
+using eremote::HeaderSize;
+using eremote::MaxFrame;
+
+namespace {
+
+  void serve(const uint8_t* data, size_t size)
+  {
+    fuzz::string_driver driver;
+    driver.input = fuzz::as_string(data, size);
+
+    eremote::Server server(eio::IODevice(&driver), fuzz::dictionary());
+    int             answered = server.poll();
+    FUZZ_CHECK(answered >= 0 && driver.input.empty());
+
+    // Each request is answered by a frame with its tag and operation
+    size_t offset = 0;
+    for (int i = 0; i < answered; ++i)
+    {
+      FUZZ_CHECK(driver.output.size() - offset >= HeaderSize);
+      const uint16_t length = eremote::detail::get16(reinterpret_cast<const uint8_t*>(&driver.output[offset]));
+      FUZZ_CHECK(length >= HeaderSize + 4 && length <= MaxFrame && driver.output.size() - offset >= length);
+      offset += length;
+    }
+    FUZZ_CHECK(offset == driver.output.size());
+  }
+
+  void proxy(const uint8_t* data, size_t size)
+  {
+    fuzz::string_driver driver;
+    driver.input = fuzz::as_string(data, size);
+
+    eremote::RemoteDictionary remote(eio::IODevice(&driver), 4, std::chrono::milliseconds(0));
+    int32_t e = remote.load();
+    for (auto& item : remote)
+    {
+      FUZZ_CHECK(e == Error::OK);
+      FUZZ_CHECK(item.fields.size() <= item.nelem);
+    }
+
+    uint8_t  small[2];
+    uint8_t  large[64];
+    uint16_t value      = 10;
+    int32_t  results[3] = { INT32_MAX, INT32_MAX, INT32_MAX };
+    remote.queue_read(0x2001, 0, small, sizeof(small), &results[0]);
+    remote.queue_read(0x2005, 0, large, sizeof(large), &results[1]);
+    remote.queue_write(0x2002, 0, &value, sizeof(value), &results[2]);
+    e = remote.flush();
+    FUZZ_CHECK(e == Error::OK || e == eremote::NoResponse);
+
+    // Every operation gets a result, whether or not the device answered it
+    FUZZ_CHECK(results[0] <= static_cast<int32_t>(sizeof(small)) && results[1] <= static_cast<int32_t>(sizeof(large)));
+    FUZZ_CHECK(results[2] != INT32_MAX);
+  }
+
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+  fuzz::reset();
+  if (size == 0) return 0;
+
+  if (data[0] % 2 == 0) serve(data + 1, size - 1);
+  else proxy(data + 1, size - 1);
+  return 0;
+}
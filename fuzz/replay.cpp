@@ -0,0 +1,94 @@
+/// \file replay.cpp
+/// \brief Standalone main for fuzz targets, used when libFuzzer is not available.
+/// Runs the target once for each file argument, or each file in a directory argument, so checked-in corpora can be
+/// replayed as a regression check. With no arguments a single input is read from stdin, which also allows
+/// AFL++ to drive the target in its file or stdin modes.
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "fuzz.hpp"
+
+namespace {
+
+  bool read_stream(FILE* f, std::vector<uint8_t>& data)
+  {
+    uint8_t chunk[4096];
+    size_t  n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) data.insert(data.end(), chunk, chunk + n);
+    return ferror(f) == 0;
+  }
+
+  int run_file(const std::string& path)
+  {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (f == nullptr)
+    {
+      fprintf(stderr, "Unable to open %s\n", path.c_str());
+      return 1;
+    }
+    std::vector<uint8_t> data;
+    bool                 ok = read_stream(f, data);
+    fclose(f);
+    if (!ok)
+    {
+      fprintf(stderr, "Unable to read %s\n", path.c_str());
+      return 1;
+    }
+    LLVMFuzzerTestOneInput(data.data(), data.size());
+    return 0;
+  }
+
+  /// \brief Run a file, or every regular file in a directory
+  int run_path(const std::string& path, int& count)
+  {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0)
+    {
+      fprintf(stderr, "Unable to open %s\n", path.c_str());
+      return 1;
+    }
+    if (!S_ISDIR(st.st_mode))
+    {
+      ++count;
+      return run_file(path);
+    }
+
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr) return 1;
+    int errors = 0;
+    while (dirent* entry = readdir(dir))
+    {
+      if (entry->d_name[0] == '.') continue;
+      errors += run_path(path + "/" + entry->d_name, count);
+    }
+    closedir(dir);
+    return errors;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 2)
+  {
+    std::vector<uint8_t> data;
+    if (!read_stream(stdin, data)) return 1;
+    LLVMFuzzerTestOneInput(data.data(), data.size());
+    return 0;
+  }
+
+  int count  = 0;
+  int errors = 0;
+  for (int i = 1; i < argc; ++i)
+  {
+    // Ignore libFuzzer style options, so the same command lines work for both builds
+    if (argv[i][0] == '-') continue;
+    errors += run_path(argv[i], count);
+  }
+  printf("Replayed %d inputs\n", count);
+  return errors > 0 ? 1 : 0;
+}
@@ -0,0 +1,106 @@
+/// \file estd_console.cpp
+/// \brief Host console driver: runs the estd console on stdin/stdout over a small demonstration dictionary, which is
+/// generated from console_objects.json. The console and a heartbeat counter run as tasks, so the process sleeps
+/// until input arrives or the counter is due. Writes are traced, into memory or into a file given as --trace=<file>,
+/// which keeps the trace after exit for tools/etrace_dump.py
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "console.hpp"
+#include "console_objects.hpp"
+#include "eio_posix.hpp"
+#include "esched_posix.hpp"
+#include "etrace.hpp"
+
+namespace {
+
+  /// \brief Task which runs console commands as input arrives, and stops the scheduler when input closes
+  struct ConsoleTask final : public esched::Task
+  {
+    ConsoleTask(console::Console& console, eio::posix_driver& driver, const esched::Event& input) NOEXCEPT
+      : console_(console), driver_(driver), input_(input)
+    {}
+
+    esched::Wait step(esched::Scheduler& scheduler) NOEXCEPT
+    {
+      // Each poll runs at most one line, so poll until the input buffer stops changing, which leaves only a partial
+      // line. Yield after a bounded number of lines, so other tasks are not held up by a long paste
+      auto& buf = driver_.getbuf();
+      for(int i = 0; i < 16; ++i)
+      {
+        auto before = buf.get();
+        if(console_.poll() == 0) break;
+        auto after = buf.get();
+        if(after.begin() == before.begin() && after.size() == before.size()) break;
+        if(i == 15) return esched::Wait::yield();
+      }
+
+      if(driver_.eof())
+      {
+        scheduler.stop();
+        return esched::Wait::done();
+      }
+      return esched::Wait::on(input_);
+    }
+
+  private:
+    console::Console&    console_;
+    eio::posix_driver&   driver_;
+    const esched::Event& input_;
+  };
+
+  void heartbeat(void*) { ++console_objects::counter; }
+
+  esched::posix_platform platform;
+
+  uint32_t trace_clock() { return platform.now(); }
+
+  constexpr uint32_t trace_capacity = 256;
+
+  /// \brief Map trace storage to a file, so the trace is kept when the console exits
+  /// \returns Storage, or nullptr if the file could not be mapped
+  void* map_trace(const char* path)
+  {
+    size_t size = etrace::Recorder::storage_size(trace_capacity);
+    int    fd   = open(path, O_RDWR | O_CREAT, 0644);
+    if(fd < 0) return nullptr;
+    void* storage = ftruncate(fd, size) == 0 ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    return storage == MAP_FAILED ? nullptr : storage;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  eio::posix_driver driver(STDIN_FILENO, STDOUT_FILENO);
+  eio::IODevice     device(&driver);
+
+  console::Console console(eformat::stream(device), console_objects::dictionary);
+  console.visible(&console_objects::visible_objects);
+  console.names(&console_objects::names);
+
+  alignas(4) static uint8_t trace_memory[etrace::Recorder::storage_size(trace_capacity)];
+  void*                     trace_storage = trace_memory;
+  if(argc > 1 && strncmp(argv[1], "--trace=", 8) == 0) trace_storage = map_trace(argv[1] + 8);
+  if(trace_storage == nullptr) return 1;
+
+  etrace::Recorder recorder(trace_storage, etrace::Recorder::storage_size(trace_capacity), console_objects::dictionary,
+                            trace_clock);
+  recorder.start();
+  console.trace(&recorder);
+
+  esched::Event input;
+  platform.watch(STDIN_FILENO, input);
+
+  esched::Scheduler    scheduler(platform);
+  ConsoleTask          console_task(console, driver, input);
+  esched::PeriodicTask heartbeat_task(heartbeat, nullptr, 100);
+  scheduler.add(console_task);
+  scheduler.add(heartbeat_task);
+
+  scheduler.run();
+  return 0;
+}
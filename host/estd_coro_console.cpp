@@ -0,0 +1,64 @@
+/// \file estd_coro_console.cpp
+/// \brief Host console driver written with coroutines: the same console and heartbeat as estd_console.cpp, but each
+/// is a coroutine which reads, writes and sleeps as if it were blocking, while the scheduler sleeps until input
+/// arrives or the counter is due
+
+#include <unistd.h>
+
+#include "console.hpp"
+#include "console_objects.hpp"
+#include "ecoro.hpp"
+#include "eio_posix.hpp"
+#include "esched_posix.hpp"
+
+namespace {
+
+  /// \brief Run console commands line by line, and stop the scheduler when input closes
+  ecoro::Coroutine run_console(esched::Scheduler& scheduler, console::Console& console, eio::posix_driver& driver,
+                               const esched::Event& input) NOEXCEPT
+  {
+    // Input may have closed while lines are still buffered, so run until a line is empty because it closed
+    auto& buf = driver.getbuf();
+    for(;;)
+    {
+      auto line = co_await ecoro::read_line(buf, input);
+      if(false == line.empty()) console.execute(line);
+      else if(buf.closed()) break;
+    }
+    co_await ecoro::flush(buf);
+    scheduler.stop();
+  }
+
+  /// \brief Count time since start in 100 ms steps
+  ecoro::Coroutine heartbeat() NOEXCEPT
+  {
+    for(;;)
+    {
+      co_await ecoro::sleep(100);
+      ++console_objects::counter;
+    }
+  }
+}
+
+int main()
+{
+  eio::posix_driver driver(STDIN_FILENO, STDOUT_FILENO);
+  eio::IODevice     device(&driver);
+
+  console::Console console(eformat::stream(device), console_objects::dictionary);
+  console.visible(&console_objects::visible_objects);
+
+  esched::posix_platform platform;
+  esched::Event          input;
+  platform.watch(STDIN_FILENO, input);
+
+  esched::Scheduler scheduler(platform);
+  auto              console_task   = run_console(scheduler, console, driver, input);
+  auto              heartbeat_task = heartbeat();
+  if(false == console_task.valid() || false == heartbeat_task.valid()) return 1;
+  scheduler.add(console_task);
+  scheduler.add(heartbeat_task);
+
+  scheduler.run();
+  return 0;
+}
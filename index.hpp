@@ -6,7 +6,14 @@
 #include "estring.hpp"
 #include "array.hpp"
 
-namespace index
+/// \brief Define as 1 to keep the former name of namespace eindex, index, for code written before the rename. Off by
+///        default, as a namespace named index clashes with the function index() from <strings.h>, so it can only be
+///        used with C libraries which do not declare it, e.g. on targets built without POSIX extensions
+#ifndef ESTD_INDEX_ALIAS
+#define ESTD_INDEX_ALIAS 0
+#endif
+
+namespace eindex
 {
   using estd::string_view;
   
@@ -139,4 +146,11 @@ namespace index
     //static_assert(estd::conjunction<std::is_same<T, Ts>...>::value, "Arguments are not the same type");
     return value_index<T, Count>{estd::array<named_value<T>, Count>{t, ts...}};
   }
-}
\ No newline at end of file
+}
+
+#if ESTD_INDEX_ALIAS
+namespace [[deprecated("namespace index was renamed to eindex")]] index
+{
+  using namespace eindex;
+}
+#endif
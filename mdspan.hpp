@@ -0,0 +1,137 @@
+#pragma once
+
+/// \file mdspan.hpp Implements mdspan class similar to std::mdspan, with a strided layout set at runtime
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "estring.hpp"
+
+namespace estd {
+
+/// \brief Similar to std::mdspan with layout_stride, a view of a multidimensional array stored in a contiguous data
+///        structure. Strides are counted in elements, so rows, columns and planes of one array are all views of it
+template<class T, size_t Rank>
+struct mdspan
+{
+    static_assert(Rank > 0, "mdspan must have at least one dimension");
+
+    typedef T value_type;
+
+    typedef value_type* pointer;
+    typedef value_type& reference;
+
+    typedef std::uint32_t size_type;
+
+    constexpr mdspan() NOEXCEPT
+      : data_(nullptr), extents_{}, strides_{}
+      {}
+
+    /// \brief Create a view of data in row-major order, where the last index varies fastest, as for T[E0][E1]...
+    constexpr mdspan(pointer data, const size_type (&extents)[Rank]) NOEXCEPT
+      : data_(data), extents_{}, strides_{}
+    {
+      size_type stride = 1;
+      for(size_t r = Rank; r-- > 0;)
+      {
+        extents_[r] = extents[r];
+        strides_[r] = stride;
+        stride *= extents[r];
+      }
+    }
+
+    /// \brief Create a view with the distance in elements between consecutive indices of each dimension
+    constexpr mdspan(pointer data, const size_type (&extents)[Rank], const size_type (&strides)[Rank]) NOEXCEPT
+      : data_(data), extents_{}, strides_{}
+    {
+      for(size_t r = 0; r < Rank; ++r)
+      {
+        extents_[r] = extents[r];
+        strides_[r] = strides[r];
+      }
+    }
+
+    /// \brief Create a view of a built-in multidimensional array, e.g. int16_t[8][16] as a view of rank 2
+    template<class Array, class = std::enable_if_t<std::rank<Array>::value == Rank>>
+    mdspan(Array& array) NOEXCEPT
+      : mdspan(reinterpret_cast<pointer>(&array), extents_of<Array, std::make_index_sequence<Rank>>::value)
+      {}
+
+    /// \brief Get number of dimensions
+    static constexpr size_t rank() NOEXCEPT { return Rank; }
+    /// \brief Get number of indices of dimension r
+    constexpr size_type extent(size_t r) const NOEXCEPT { return extents_[r]; }
+    /// \brief Get distance in elements between consecutive indices of dimension r
+    constexpr size_type stride(size_t r) const NOEXCEPT { return strides_[r]; }
+    /// \brief Get pointer to the element at index 0 of every dimension
+    constexpr pointer data() const NOEXCEPT { return data_; }
+
+    /// \brief Get number of elements in view
+    constexpr size_type size() const NOEXCEPT
+    {
+      size_type count = 1;
+      for(size_t r = 0; r < Rank; ++r) count *= extents_[r];
+      return count;
+    }
+
+    /// \brief Return true if view has no elements
+    constexpr bool empty() const NOEXCEPT { return size() == 0; }
+
+    /// \brief Get element by one index for each dimension
+    template<class... Indices>
+    constexpr reference operator()(Indices... indices) const NOEXCEPT
+    {
+      static_assert(sizeof...(Indices) == Rank, "An index is needed for each dimension");
+      const size_type index[Rank] = { static_cast<size_type>(indices)... };
+      size_type       offset      = 0;
+      for(size_t r = 0; r < Rank; ++r)
+      {
+        CHECK(index[r] < extents_[r]);
+        offset += index[r] * strides_[r];
+      }
+      return data_[offset];
+    }
+
+    /// \brief Get view of the elements with index of dimension fixed, e.g. slice(0, i) is row i of a matrix and
+    ///        slice(1, j) is column j
+    template<size_t R = Rank, class = std::enable_if_t<(R > 1)>>
+    constexpr mdspan<T, Rank - 1> slice(size_t dimension, size_type index) const NOEXCEPT
+    {
+      CHECK(dimension < Rank && index < extents_[dimension]);
+      size_type extents[Rank - 1];
+      size_type strides[Rank - 1];
+      for(size_t r = 0, s = 0; r < Rank; ++r)
+      {
+        if(r == dimension) continue;
+        extents[s] = extents_[r];
+        strides[s] = strides_[r];
+        ++s;
+      }
+      return mdspan<T, Rank - 1>(data_ + index * strides_[dimension], extents, strides);
+    }
+
+    /// \brief Get view of the elements with the first index fixed, e.g. a row of a matrix or a plane of a cube
+    template<size_t R = Rank, class = std::enable_if_t<(R > 1)>>
+    constexpr mdspan<T, Rank - 1> row(size_type index) const NOEXCEPT { return slice(0, index); }
+
+    /// \brief Get view of the elements with the last index fixed, e.g. a column of a matrix
+    template<size_t R = Rank, class = std::enable_if_t<(R > 1)>>
+    constexpr mdspan<T, Rank - 1> column(size_type index) const NOEXCEPT { return slice(Rank - 1, index); }
+
+private:
+    template<class Array, class Sequence>
+    struct extents_of;
+
+    template<class Array, size_t... Rs>
+    struct extents_of<Array, std::index_sequence<Rs...>>
+    {
+      static constexpr size_type value[Rank] = { static_cast<size_type>(std::extent<Array, Rs>::value)... };
+    };
+
+    pointer   data_;
+    size_type extents_[Rank];
+    size_type strides_[Rank];
+};
+
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+/// \file fixture.hpp
+/// \brief Dictionaries of the objects of test_objects.json over storage of their own, so tests can compare devices
+
+#include <cstdint>
+
+#include "test_objects.hpp"
+
+namespace test {
+
+  /// \brief Dictionary with the same type as test_objects::dictionary
+  typedef eobject::TDictionary<10> Dictionary;
+
+  /// \brief Make dictionary of the same objects as test_objects::dictionary, over other storage
+  inline Dictionary dictionary_of(test_objects::Storage& storage)
+  {
+    eobject::CompactDictionary compact = test_objects::compact_dictionary;
+    compact.storage                    = &storage;
+
+    estd::array<eobject::Dictionary::Item, 10> items;
+    for (uint16_t i = 0; i < compact.size(); ++i) items[i] = compact[i];
+    return Dictionary(items);
+  }
+
+}
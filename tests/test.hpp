@@ -0,0 +1,117 @@
+#pragma once
+
+/// \file test.hpp
+/// \brief Shared helpers for the unit tests.
+/// Each test is an executable run by ctest, whose main calls the cases of its module and returns test::finish().
+/// Failed checks are reported with their file and line and counted, so one run shows every failure of a module
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "eio.hpp"
+#include "eio_buffer.hpp"
+#include "esched.hpp"
+
+namespace test {
+
+  /// \brief Number of checks failed so far
+  inline int& failures()
+  {
+    static int count = 0;
+    return count;
+  }
+
+  /// \brief Report a failed check
+  inline void fail(const char* file, int line, const char* what)
+  {
+    fprintf(stderr, "%s:%d: check failed: %s\n", file, line, what);
+    ++failures();
+  }
+
+  /// \brief Report the result of the test, as the exit status of main
+  inline int finish()
+  {
+    if (failures() != 0) fprintf(stderr, "%d check(s) failed\n", failures());
+    return failures() == 0 ? 0 : 1;
+  }
+
+  /// \brief Scheduler platform whose clock only moves when told to, or when the scheduler sleeps
+  struct ManualPlatform final : esched::Platform
+  {
+    esched::tick_type time   = 0;
+    int32_t           slept  = 0; ///< Timeout of the last sleep
+    int               sleeps = 0;
+
+    esched::tick_type now() NOEXCEPT override { return time; }
+
+    void idle(const esched::Scheduler&, int32_t timeout_ms) NOEXCEPT override
+    {
+      slept = timeout_ms;
+      ++sleeps;
+      if (timeout_ms > 0) time += static_cast<esched::tick_type>(timeout_ms);
+    }
+  };
+
+  /// \brief Driver which appends everything written to a string, and reads from a caller-provided view
+  /// \remarks Buffers are small, so the overflow and flush paths are exercised by short inputs. Once closed, reads of
+  ///          an empty input return EOF rather than 0
+  struct string_driver final : public eio::IODevice::Driver
+  {
+    typedef eio::iobuffer<string_driver, 16, 32> BufferType;
+
+    string_driver()
+      : buffer_(*this)
+    {}
+
+    std::string       output;
+    estd::string_view input;
+    bool              closed = false;
+
+    int write(const void* data, uint16_t count) NOEXCEPT override
+    {
+      output.append(static_cast<const char*>(data), count);
+      return count;
+    }
+
+    int read(void* data, uint16_t count) NOEXCEPT override
+    {
+      auto n = estd::min(static_cast<uint32_t>(count), input.size());
+      if (n == 0) return closed ? EOF : 0;
+      memcpy(data, input.data(), n);
+      input.remove_prefix(n);
+      return n;
+    }
+
+    int sync(int timeout) NOEXCEPT override { return timeout; }
+
+    eio::buffer& getbuf() NOEXCEPT override { return buffer_; }
+
+  private:
+    BufferType buffer_;
+  };
+
+}
+
+/// \brief Check a condition, reporting it if false
+#define TEST_CHECK(cond)                                \
+  do                                                    \
+  {                                                     \
+    if (!(cond)) test::fail(__FILE__, __LINE__, #cond); \
+  } while (0)
+
+/// \brief Check two values are equal, reporting both if not
+#define TEST_EQUAL(a, b)                                                                               \
+  do                                                                                                   \
+  {                                                                                                    \
+    const auto test_a_ = (a);                                                                          \
+    const auto test_b_ = (b);                                                                          \
+    if (!(test_a_ == test_b_))                                                                         \
+    {                                                                                                  \
+      test::fail(__FILE__, __LINE__, #a " == " #b);                                                    \
+      fprintf(stderr, "  values: %lld and %lld\n", static_cast<long long>(test_a_),                  \
+              static_cast<long long>(test_b_));                                                        \
+    }                                                                                                  \
+  } while (0)
@@ -0,0 +1,118 @@
+/// \file test_crc.cpp
+/// \brief Tests of CRC-32C and CRC-16/CCITT-FALSE: check values, agreement of the table, hardware and bitwise methods
+/// over lengths and alignments, chaining, and first use from many threads
+
+#include "test.hpp"
+
+#include <thread>
+#include <vector>
+
+#include "crc.hpp"
+
+using estd::crc16_ccitt;
+using estd::crc32c;
+
+namespace {
+
+  static_assert(crc32c("") == 0, "empty CRC-32C");
+  static_assert(crc16_ccitt("") == 0xFFFF, "empty CRC-16");
+
+  uint32_t crc32c_bitwise(const uint8_t* data, size_t size)
+  {
+    uint32_t crc = ~0u;
+    for (size_t i = 0; i < size; ++i) crc = estd::detail::crc32c_byte(crc ^ data[i]);
+    return ~crc;
+  }
+
+  uint16_t crc16_bitwise(const uint8_t* data, size_t size)
+  {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < size; ++i) crc = estd::detail::crc16_byte(static_cast<uint16_t>(crc ^ data[i] << 8));
+    return crc;
+  }
+
+  std::vector<uint8_t> pattern(size_t size)
+  {
+    std::vector<uint8_t> data(size);
+    uint32_t             x = 0x12345678;
+    for (auto& b : data)
+    {
+      x = x * 1103515245 + 12345;
+      b = static_cast<uint8_t>(x >> 16);
+    }
+    return data;
+  }
+
+  void check_values()
+  {
+    const uint8_t digits[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+    TEST_EQUAL(crc32c(estd::span<const uint8_t>(digits, sizeof(digits))), 0xE3069283u);
+    TEST_EQUAL(crc16_ccitt(estd::span<const uint8_t>(digits, sizeof(digits))), 0x29B1);
+
+    // Runtime string views take the fast path, which must agree with the constant
+    estd::string_view s(reinterpret_cast<const char*>(digits), sizeof(digits));
+    TEST_EQUAL(crc32c(s), 0xE3069283u);
+    TEST_EQUAL(crc16_ccitt(s), 0x29B1);
+
+    // 32 zero bytes, from the iSCSI test vectors of RFC 3720
+    const uint8_t zeros[32] = {};
+    TEST_EQUAL(crc32c(estd::span<const uint8_t>(zeros, sizeof(zeros))), 0x8A9136AAu);
+  }
+
+  void check_methods()
+  {
+    const auto data = pattern(300);
+    for (size_t offset = 0; offset < 8; ++offset)
+    {
+      for (size_t size = 0; offset + size <= data.size(); size += size < 40 ? 1 : 37)
+      {
+        const uint8_t* p        = data.data() + offset;
+        const uint32_t expected = crc32c_bitwise(p, size);
+        TEST_EQUAL(crc32c(estd::span<const uint8_t>(p, size)), expected);
+        TEST_EQUAL(~estd::detail::crc32c_update_table(~0u, p, size), expected);
+        TEST_EQUAL(crc16_ccitt(estd::span<const uint8_t>(p, size)), crc16_bitwise(p, size));
+      }
+    }
+  }
+
+  void check_chaining()
+  {
+    const auto data = pattern(100);
+    const auto all  = estd::span<const uint8_t>(data.data(), data.size());
+    for (uint32_t split = 0; split <= data.size(); split += 7)
+    {
+      const auto a = estd::span<const uint8_t>(data.data(), split);
+      const auto b = estd::span<const uint8_t>(data.data() + split, data.size() - split);
+      TEST_EQUAL(crc32c(b, crc32c(a)), crc32c(all));
+      TEST_EQUAL(crc16_ccitt(b, crc16_ccitt(a)), crc16_ccitt(all));
+    }
+  }
+
+  void check_threads()
+  {
+    // The first calls choose the method of this processor, so threads racing to make them must all get the same
+    const auto           data     = pattern(1000);
+    const uint32_t       expected = crc32c_bitwise(data.data(), data.size());
+    std::vector<uint32_t> results(8);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+      threads.emplace_back([&, i] {
+        for (int n = 0; n < 100; ++n)
+          results[i] = crc32c(estd::span<const uint8_t>(data.data(), static_cast<uint32_t>(data.size())));
+      });
+    }
+    for (auto& t : threads) t.join();
+    for (auto r : results) TEST_EQUAL(r, expected);
+  }
+
+}
+
+int main()
+{
+  check_values();
+  check_methods();
+  check_chaining();
+  check_threads();
+  return test::finish();
+}
@@ -0,0 +1,84 @@
+/// \file test_eatom.cpp
+/// \brief Tests of interned names: tables built while compiling, names which compare equal without case sharing an
+/// atom, full tables, and the largest table, whose slot count just fits a uint16_t
+
+#include "test.hpp"
+
+#include <cctype>
+#include <string>
+#include <vector>
+
+#include "eatom.hpp"
+
+using eatom::atom;
+using eatom::NoAtom;
+using estd::string_view;
+
+namespace {
+
+  constexpr eatom::TAtoms<4> constant({ "speed", "current", "Speed", "limit" });
+
+  static_assert(constant.size() == 3, "Names which compare equal share an atom");
+  static_assert(constant.find("SPEED") == 0 && constant.find("limit") == 2, "Names are found while compiling");
+  static_assert(constant.find("voltage") == NoAtom, "Names which were not interned have no atom");
+  static_assert(eatom::hash("Motor") == eatom::hash("mOTOR"), "Hashes ignore case");
+  static_assert(eatom::TAtoms<1>::slot_count == 2 && eatom::TAtoms<5>::slot_count == 16, "Slots are a power of two");
+
+  void check_intern()
+  {
+    TEST_CHECK(constant[1] == "current");
+    TEST_CHECK(constant[0] == "speed");
+    TEST_CHECK(constant[NoAtom].empty());
+
+    eatom::TAtoms<3> atoms;
+    TEST_EQUAL(atoms.size(), 0u);
+    TEST_EQUAL(atoms.find("a"), NoAtom);
+    TEST_EQUAL(atoms.intern("alpha"), 0);
+    TEST_EQUAL(atoms.intern("beta"), 1);
+    TEST_EQUAL(atoms.intern("ALPHA"), 0);
+    TEST_EQUAL(atoms.intern("gamma"), 2);
+
+    // Full tables still find the names they hold
+    TEST_EQUAL(atoms.intern("delta"), NoAtom);
+    TEST_EQUAL(atoms.intern("Gamma"), 2);
+    TEST_EQUAL(atoms.size(), 3u);
+    TEST_CHECK(atoms[2] == "gamma");
+
+    atoms.clear();
+    TEST_EQUAL(atoms.find("alpha"), NoAtom);
+    TEST_EQUAL(atoms.intern("delta"), 0);
+  }
+
+  eatom::TAtoms<16384> largest;
+
+  void check_largest()
+  {
+    static_assert(eatom::TAtoms<16384>::slot_count == 32768, "Slots of the largest table");
+
+    // Names are kept by reference, so their storage is made before interning them
+    std::vector<std::string> names(16385);
+    for (size_t i = 0; i < names.size(); ++i) names[i] = "name_" + std::to_string(i);
+
+    for (size_t i = 0; i < 16384; ++i)
+      TEST_EQUAL(largest.intern(string_view(names[i].data(), names[i].size())), static_cast<atom>(i));
+    TEST_EQUAL(largest.intern(string_view(names[16384].data(), names[16384].size())), NoAtom);
+    TEST_EQUAL(largest.size(), 16384u);
+
+    // Every name is found by probing past the others which share its slot
+    for (size_t i = 0; i < 16384; i += 97)
+    {
+      std::string upper = names[i];
+      for (char& c : upper) c = static_cast<char>(toupper(c));
+      TEST_EQUAL(largest.find(string_view(upper.data(), upper.size())), static_cast<atom>(i));
+    }
+    TEST_EQUAL(largest.find("name_16384"), NoAtom);
+  }
+
+}
+
+int main()
+{
+  check_intern();
+  check_largest();
+  return test::finish();
+}
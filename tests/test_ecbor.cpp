@@ -0,0 +1,148 @@
+/// \file test_ecbor.cpp
+/// \brief Tests of CBOR serialization: the shortest forms of heads, round trips of objects and dictionaries keyed by
+/// names and by addresses, and input which is truncated or does not match the objects
+
+#include "test.hpp"
+
+#include <cstring>
+#include <string>
+
+#include "ecbor.hpp"
+#include "test_objects.hpp"
+
+using ecbor::Keys;
+using ecbor::Major;
+using eformat::ParseStatus;
+using eobject::Error;
+using estd::string_view;
+
+namespace {
+
+  template<typename Encode>
+  std::string encoded(Encode encode)
+  {
+    test::string_driver driver;
+    TEST_EQUAL(encode(driver.getbuf()), 0);
+    driver.getbuf().sync(0);
+    return driver.output;
+  }
+
+  std::string bytes(std::initializer_list<uint8_t> values) { return std::string(values.begin(), values.end()); }
+
+  void check_heads()
+  {
+    TEST_CHECK(encoded([](eio::buffer& out) { return ecbor::encode_uint(out, 23); }) == bytes({ 0x17 }));
+    TEST_CHECK(encoded([](eio::buffer& out) { return ecbor::encode_uint(out, 24); }) == bytes({ 0x18, 24 }));
+    TEST_CHECK(encoded([](eio::buffer& out) { return ecbor::encode_uint(out, 500); }) == bytes({ 0x19, 0x01, 0xF4 }));
+    TEST_CHECK(encoded([](eio::buffer& out) { return ecbor::encode_uint(out, 70000); }) ==
+               bytes({ 0x1A, 0x00, 0x01, 0x11, 0x70 }));
+    TEST_CHECK(encoded([](eio::buffer& out) { return ecbor::encode_int(out, -1); }) == bytes({ 0x20 }));
+    TEST_CHECK(encoded([](eio::buffer& out) { return ecbor::encode_int(out, -500); }) == bytes({ 0x39, 0x01, 0xF3 }));
+    TEST_CHECK(encoded([](eio::buffer& out) { return ecbor::encode_text(out, "ab"); }) == bytes({ 0x62, 'a', 'b' }));
+    TEST_CHECK(encoded([](eio::buffer& out) { return ecbor::encode_simple(out, ecbor::Null); }) == bytes({ 0xF6 }));
+
+    // Heads are decoded back to their argument, and only consumed when complete
+    const std::string in = bytes({ 0x39, 0x01, 0xF3, 0x1A, 0x00, 0x01 });
+    string_view       view(in.data(), in.size());
+    ecbor::Head       head;
+    TEST_EQUAL(ecbor::decode_head(view, head), ParseStatus::OK);
+    TEST_CHECK(head.major == Major::Negative);
+    TEST_EQUAL(head.value, 499u);
+    TEST_EQUAL(ecbor::decode_head(view, head), ParseStatus::Incomplete);
+    TEST_EQUAL(view.size(), 3u);
+
+    // Arguments of 8 bytes are accepted while their value fits in 32 bits
+    const std::string indefinite = bytes({ 0x5F });
+    const std::string narrow     = bytes({ 0x1B, 0, 0, 0, 0, 0, 0, 0, 1 });
+    const std::string wide       = bytes({ 0x1B, 0, 0, 0, 1, 0, 0, 0, 0 });
+    view                         = string_view(indefinite.data(), indefinite.size());
+    TEST_EQUAL(ecbor::decode_head(view, head), ParseStatus::NotMatched);
+    view = string_view(narrow.data(), narrow.size());
+    TEST_EQUAL(ecbor::decode_head(view, head), ParseStatus::OK);
+    TEST_EQUAL(head.value, 1u);
+    view = string_view(wide.data(), wide.size());
+    TEST_EQUAL(ecbor::decode_head(view, head), ParseStatus::Overflow);
+  }
+
+  /// \brief Encode the persisted objects with keys of either kind, and decode them over changed values
+  void check_round_trip(Keys keys)
+  {
+    const auto saved = test_objects::storage;
+    test_objects::motor.speed = -1200;
+    test_objects::setpoint    = 60;
+    test_objects::gains[0]    = 321;
+    test_objects::map[2][1]   = -7;
+    strcpy(test_objects::label, "round trip");
+    const auto        expected = test_objects::storage;
+    const std::string snapshot =
+      encoded([keys](eio::buffer& out) { return ecbor::encode(out, test_objects::persisted_objects, keys); });
+
+    test_objects::storage = saved;
+    string_view in(snapshot.data(), snapshot.size());
+    TEST_EQUAL(ecbor::decode(in, test_objects::dictionary), Error::OK);
+    TEST_CHECK(in.empty());
+    TEST_EQUAL(test_objects::motor.speed, -1200);
+    TEST_EQUAL(test_objects::setpoint, 60);
+    TEST_EQUAL(test_objects::gains[0], 321);
+    TEST_EQUAL(test_objects::map[2][1], -7);
+    TEST_CHECK(strcmp(test_objects::label, "round trip") == 0);
+    TEST_CHECK(memcmp(&test_objects::storage, &expected, sizeof(expected)) == 0);
+    test_objects::storage = saved;
+  }
+
+  void check_keys()
+  {
+    // Keys by address are smaller than keys by name
+    const std::string names =
+      encoded([](eio::buffer& out) { return ecbor::encode(out, test_objects::persisted_objects, Keys::Names); });
+    const std::string indices =
+      encoded([](eio::buffer& out) { return ecbor::encode(out, test_objects::persisted_objects, Keys::Indices); });
+    TEST_CHECK(indices.size() < names.size());
+
+    // A single object is encoded as its value alone, without a key
+    const auto*       setpoint = test_objects::dictionary.get(0x2001);
+    const std::string value    = encoded([setpoint](eio::buffer& out) { return ecbor::encode(out, *setpoint); });
+    TEST_CHECK(value == bytes({ 0x18, 25 }));
+  }
+
+  void check_errors()
+  {
+    const auto saved    = test_objects::storage;
+    const auto setpoint = *test_objects::dictionary.get(0x2001);
+
+    // Values outside the range of the object fail in its set function, and leave the input in place
+    const std::string high = bytes({ 0x18, 200 });
+    string_view       in(high.data(), high.size());
+    TEST_CHECK(ecbor::decode(in, setpoint) < 0);
+    TEST_EQUAL(test_objects::setpoint, 25);
+
+    // Text does not match a number
+    const std::string text = bytes({ 0x61, '1' });
+    in                     = string_view(text.data(), text.size());
+    TEST_EQUAL(ecbor::decode(in, setpoint), Error::DataTypeError);
+
+    // Truncated input
+    const std::string cut = bytes({ 0x19, 0x01 });
+    in                    = string_view(cut.data(), cut.size());
+    TEST_EQUAL(ecbor::decode(in, setpoint), Error::ParamTooShort);
+    TEST_EQUAL(in.size(), 2u);
+
+    // Unknown names stop decoding a dictionary, and objects before them keep their new values
+    const std::string map = bytes({ 0xA2, 0x68, 's', 'e', 't', 'p', 'o', 'i', 'n', 't', 0x0A, 0x63, 'x', 'y', 'z', 0 });
+    in                    = string_view(map.data(), map.size());
+    TEST_CHECK(ecbor::decode(in, test_objects::dictionary) < 0);
+    TEST_EQUAL(test_objects::setpoint, 10);
+    test_objects::storage = saved;
+  }
+
+}
+
+int main()
+{
+  check_heads();
+  check_round_trip(Keys::Names);
+  check_round_trip(Keys::Indices);
+  check_keys();
+  check_errors();
+  return test::finish();
+}
@@ -0,0 +1,164 @@
+/// \file test_ecodec.cpp
+/// \brief Tests of column compression: round trips of every codec over each integer type, columns written in pieces,
+/// the sizes which make each codec worth choosing, and input which is truncated or of the wrong type
+
+#include "test.hpp"
+
+#include <cstring>
+#include <string>
+
+#include "ecodec.hpp"
+
+using ecodec::Codec;
+using eobject::DataType;
+using eobject::Error;
+using estd::string_view;
+
+namespace {
+
+  const Codec codecs[] = { Codec::Raw, Codec::Delta, Codec::DeltaOfDelta, Codec::Rle };
+
+  template<class T>
+  std::string encode(const T* values, size_t count, Codec codec)
+  {
+    test::string_driver driver;
+    int32_t written = ecodec::encode(driver.getbuf(), estd::span<const T>(values, count), codec);
+    driver.getbuf().sync(0);
+    TEST_CHECK(written >= 0 && static_cast<size_t>(written) == driver.output.size());
+    TEST_CHECK(driver.output.size() <= ecodec::max_encoded_size(count, eobject::Type_<T>::id, codec));
+    return driver.output;
+  }
+
+  template<class T>
+  void check_round_trip(const T* values, size_t count)
+  {
+    for (Codec codec : codecs)
+    {
+      std::string encoded = encode(values, count, codec);
+      encoded += "tail";
+
+      T           decoded[300];
+      string_view in(encoded.data(), encoded.size());
+      TEST_EQUAL(ecodec::decode(in, estd::span<T>(decoded, count), codec), Error::OK);
+      TEST_CHECK(in == "tail");
+      TEST_CHECK(memcmp(decoded, values, count * sizeof(T)) == 0);
+    }
+  }
+
+  void check_zigzag()
+  {
+    static_assert(ecodec::zigzag(0) == 0 && ecodec::zigzag(-1) == 1 && ecodec::zigzag(1) == 2, "small numbers");
+    static_assert(ecodec::zigzag(INT32_MIN) == UINT32_MAX && ecodec::zigzag(INT32_MAX) == UINT32_MAX - 1, "limits");
+    for (int32_t value : { 0, 1, -1, 1000, -1000, INT32_MAX, INT32_MIN })
+      TEST_EQUAL(ecodec::unzigzag(ecodec::zigzag(value)), value);
+    TEST_CHECK(ecodec::to_string(Codec::DeltaOfDelta) == "delta-of-delta");
+  }
+
+  void check_types()
+  {
+    // Columns longer than a block, with steps, ramps, runs and the extremes of each type
+    int16_t  i16[300];
+    uint32_t u32[300];
+    int8_t   i8[300];
+    uint16_t u16[300];
+    int32_t  i32[300];
+    uint8_t  u8[300];
+    for (int i = 0; i < 300; ++i)
+    {
+      i16[i] = static_cast<int16_t>(i < 100 ? i * 3 : i < 200 ? -i : (i % 7) * 1000);
+      u32[i] = i % 50 == 0 ? UINT32_MAX : 1000000u + static_cast<uint32_t>(i / 10);
+      i8[i]  = static_cast<int8_t>(i % 2 == 0 ? INT8_MIN : INT8_MAX);
+      u16[i] = static_cast<uint16_t>(i * 217);
+      i32[i] = i % 3 == 0 ? INT32_MIN : i * i;
+      u8[i]  = static_cast<uint8_t>(i / 40);
+    }
+    for (size_t count : { size_t(0), size_t(1), size_t(2), ecodec::BlockSize, ecodec::BlockSize + 1, size_t(300) })
+    {
+      check_round_trip(i16, count);
+      check_round_trip(u32, count);
+      check_round_trip(i8, count);
+      check_round_trip(u16, count);
+      check_round_trip(i32, count);
+      check_round_trip(u8, count);
+    }
+  }
+
+  void check_sizes()
+  {
+    int32_t  ramp[256], steady[256], noise[256];
+    uint32_t random = 1;
+    for (int i = 0; i < 256; ++i)
+    {
+      random ^= random << 13;
+      random ^= random >> 17;
+      random ^= random << 5;
+      ramp[i]   = 5000 + 37 * i;
+      steady[i] = i < 100 ? 12 : 13;
+      noise[i]  = static_cast<int32_t>(random);
+    }
+    const size_t raw = sizeof(ramp);
+    TEST_EQUAL(encode(ramp, 256, Codec::Raw).size(), raw);
+
+    // Ramps have constant differences, so their differences of differences are zero
+    TEST_CHECK(encode(ramp, 256, Codec::Delta).size() < raw / 2);
+    TEST_CHECK(encode(ramp, 256, Codec::DeltaOfDelta).size() < encode(ramp, 256, Codec::Delta).size());
+
+    // Values held for long runs take a few bytes
+    TEST_CHECK(encode(steady, 256, Codec::Rle).size() < 10);
+
+    // Noise does not compress, but stays within the bound for the codec
+    for (Codec codec : codecs) TEST_CHECK(encode(noise, 256, codec).size() >= raw);
+  }
+
+  void check_pieces()
+  {
+    uint16_t values[400];
+    for (int i = 0; i < 400; ++i) values[i] = static_cast<uint16_t>(i / 3 + (i % 5 == 0 ? 100 : 0));
+
+    // Writing a column in pieces which do not line up with blocks or runs gives the same output as writing it whole
+    for (Codec codec : codecs)
+    {
+      test::string_driver driver;
+      ecodec::Encoder     encoder(driver.getbuf(), DataType::U16, codec);
+      for (size_t start = 0, size = 1; start < 400; start += size, size = size * 3 % 97 + 1)
+      {
+        if (size > 400 - start) size = 400 - start;
+        TEST_EQUAL(encoder.write(values + start, size), Error::OK);
+      }
+      int32_t written = encoder.finish();
+      driver.getbuf().sync(0);
+      TEST_EQUAL(written, static_cast<int32_t>(driver.output.size()));
+      TEST_CHECK(driver.output == encode(values, 400, codec));
+    }
+  }
+
+  void check_errors()
+  {
+    test::string_driver driver;
+    const char          text[] = "text";
+    TEST_EQUAL(ecodec::encode(driver.getbuf(), text, 4, DataType::String, Codec::Delta), Error::DataTypeError);
+
+    // Truncated columns leave the input unchanged
+    int16_t values[200];
+    for (int i = 0; i < 200; ++i) values[i] = static_cast<int16_t>(i * i);
+    for (Codec codec : codecs)
+    {
+      const std::string encoded = encode(values, 200, codec);
+      string_view       in(encoded.data(), encoded.size() - 1);
+      int16_t           decoded[200];
+      TEST_CHECK(ecodec::decode(in, decoded, 200, DataType::I16, codec) < 0);
+      TEST_EQUAL(in.size(), encoded.size() - 1);
+    }
+  }
+
+}
+
+int main()
+{
+  check_zigzag();
+  check_types();
+  check_sizes();
+  check_pieces();
+  check_errors();
+  return test::finish();
+}
@@ -0,0 +1,161 @@
+/// \file test_ecoro.cpp
+/// \brief Tests of coroutines run by the scheduler: sleeping, waiting for events with and without timeouts, reading
+/// lines as input arrives and after it closes, flushing output, and allocation from the frame pool
+
+#include "test.hpp"
+
+#include <string>
+#include <vector>
+
+#include "ecoro.hpp"
+
+using esched::Event;
+using esched::Scheduler;
+using esched::tick_type;
+using test::ManualPlatform;
+
+namespace {
+
+  ecoro::Coroutine timed(const Scheduler& scheduler, const Event& event, std::vector<tick_type>& times,
+                         std::vector<bool>& results) NOEXCEPT
+  {
+    co_await ecoro::sleep(10);
+    times.push_back(scheduler.now());
+    results.push_back(co_await ecoro::wait(event, 20));
+    times.push_back(scheduler.now());
+    results.push_back(co_await ecoro::wait(event, 20));
+    times.push_back(scheduler.now());
+    co_await ecoro::wait(event);
+    times.push_back(scheduler.now());
+  }
+
+  void check_time()
+  {
+    ManualPlatform         platform;
+    Scheduler              scheduler(platform);
+    Event                  event;
+    std::vector<tick_type> times;
+    std::vector<bool>      results;
+    auto                   task = timed(scheduler, event, times, results);
+    TEST_CHECK(task.valid() && !task.done());
+    scheduler.add(task);
+
+    // The coroutine runs when added, and sleeps until its time
+    TEST_EQUAL(scheduler.run_once(), 10);
+    TEST_CHECK(times.empty());
+    platform.time = 10;
+    TEST_EQUAL(scheduler.run_once(), 20);
+    TEST_EQUAL(times.size(), 1u);
+
+    // Waits time out without the event, and return as soon as it is signalled
+    platform.time = 30;
+    TEST_EQUAL(scheduler.run_once(), 20);
+    TEST_EQUAL(results.size(), 1u);
+    TEST_CHECK(!results[0]);
+    platform.time = 35;
+    event.signal();
+    TEST_EQUAL(scheduler.run_once(), -1);
+    TEST_EQUAL(results.size(), 2u);
+    TEST_CHECK(results[1]);
+
+    platform.time = 1000;
+    TEST_EQUAL(scheduler.run_once(), -1);
+    TEST_EQUAL(times.size(), 3u);
+    event.signal();
+    scheduler.run_once();
+    TEST_CHECK(task.done());
+    TEST_EQUAL(times.size(), 4u);
+    TEST_EQUAL(times[0], 10u);
+    TEST_EQUAL(times[1], 30u);
+    TEST_EQUAL(times[2], 35u);
+    TEST_EQUAL(times[3], 1000u);
+  }
+
+  ecoro::Coroutine lines(eio::buffer& buf, const Event& input, std::vector<std::string>& read) NOEXCEPT
+  {
+    for (;;)
+    {
+      auto line = co_await ecoro::read_line(buf, input);
+      if (false == line.empty()) read.emplace_back(line.data(), line.size());
+      else if (buf.closed()) break;
+    }
+    buf.sputn("done\n", 5);
+    co_await ecoro::flush(buf);
+  }
+
+  void check_lines()
+  {
+    ManualPlatform           platform;
+    Scheduler                scheduler(platform);
+    Event                    input;
+    test::string_driver      driver;
+    std::vector<std::string> read;
+    auto                     task = lines(driver.getbuf(), input, read);
+    scheduler.add(task);
+
+    // Lines are returned once complete, however the input arrives
+    const std::string first = "hel";
+    driver.input            = estd::string_view(first.data(), first.size());
+    TEST_EQUAL(scheduler.run_once(), -1);
+    TEST_CHECK(read.empty());
+    const std::string second = "lo\nwor";
+    driver.input             = estd::string_view(second.data(), second.size());
+    input.signal();
+    TEST_EQUAL(scheduler.run_once(), -1);
+    TEST_EQUAL(read.size(), 1u);
+    TEST_CHECK(read.size() == 1 && read[0] == "hello");
+
+    // Once input closes, the rest of it is the last line, even without an end of line
+    driver.closed = true;
+    input.signal();
+    scheduler.run_once();
+    scheduler.run_once();
+    TEST_CHECK(task.done());
+    TEST_EQUAL(read.size(), 2u);
+    TEST_CHECK(read.size() == 2 && read[1] == "wor");
+    TEST_CHECK(driver.output == "done\n");
+  }
+
+  ecoro::Coroutine idle() NOEXCEPT { co_await ecoro::sleep(1); }
+
+  void check_pool()
+  {
+    const int available = ecoro::FramePool::available();
+    TEST_EQUAL(available, ECORO_FRAME_COUNT);
+    {
+      auto task = idle();
+      TEST_CHECK(task.valid());
+      TEST_EQUAL(ecoro::FramePool::available(), available - 1);
+    }
+    TEST_EQUAL(ecoro::FramePool::available(), available);
+
+    // Coroutines made once the pool is exhausted are not valid, and finish without running
+    std::vector<ecoro::Coroutine> tasks;
+    tasks.reserve(ECORO_FRAME_COUNT);
+    for (int i = 0; i < ECORO_FRAME_COUNT; ++i) tasks.push_back(idle());
+    for (const auto& task : tasks) TEST_CHECK(task.valid());
+    TEST_EQUAL(ecoro::FramePool::available(), 0);
+
+    auto           extra = idle();
+    ManualPlatform platform;
+    Scheduler      scheduler(platform);
+    TEST_CHECK(!extra.valid() && extra.done());
+    scheduler.add(extra);
+    TEST_EQUAL(scheduler.run_once(), -1);
+
+    // Frames are moved with their coroutines, and freed once
+    ecoro::Coroutine moved(std::move(tasks.back()));
+    TEST_CHECK(moved.valid() && !tasks.back().valid());
+    tasks.clear();
+    TEST_EQUAL(ecoro::FramePool::available(), available - 1);
+  }
+
+}
+
+int main()
+{
+  check_time();
+  check_lines();
+  check_pool();
+  return test::finish();
+}
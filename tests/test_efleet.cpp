@@ -0,0 +1,134 @@
+/// \file test_efleet.cpp
+/// \brief Tests of bulk operations over many dictionaries: the pool runs every index exactly once however work is
+/// stolen, and validating, comparing and encoding devices gives the same results for any number of threads.
+/// Run under ThreadSanitizer (the tsan preset) to check the pool and the merging of results for races
+
+#include "test.hpp"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "efleet.hpp"
+#include "fixture.hpp"
+
+using eobject::Error;
+
+namespace {
+
+  /// \brief Devices whose storage is owned alongside their dictionaries
+  struct Fleet
+  {
+    std::vector<test_objects::Storage>              storage;
+    std::vector<std::unique_ptr<test::Dictionary>> dictionaries;
+    std::vector<const eobject::Dictionary*>         devices;
+
+    explicit Fleet(size_t count)
+      : storage(count, test_objects::storage)
+    {
+      for (auto& s : storage)
+      {
+        dictionaries.emplace_back(new test::Dictionary(test::dictionary_of(s)));
+        devices.push_back(dictionaries.back().get());
+      }
+    }
+
+    estd::span<const eobject::Dictionary* const> span() const
+    {
+      return estd::span<const eobject::Dictionary* const>(devices.data(), static_cast<uint32_t>(devices.size()));
+    }
+  };
+
+  void check_pool()
+  {
+    for (unsigned threads : { 1u, 2u, 4u, 7u })
+    {
+      efleet::Pool pool(threads);
+      TEST_EQUAL(pool.size(), threads);
+
+      // Every index runs once, on a worker of the pool, for loops larger and smaller than the pool
+      for (size_t count : { size_t(0), size_t(1), size_t(3), size_t(10000) })
+      {
+        std::vector<std::atomic<int>> hits(count);
+        std::atomic<bool>             bad_worker(false);
+        auto                          body = [&](size_t index, unsigned worker) {
+          hits[index].fetch_add(1, std::memory_order_relaxed);
+          if (worker >= threads) bad_worker = true;
+        };
+        pool.run(count, body);
+        for (auto& h : hits) TEST_EQUAL(h.load(), 1);
+        TEST_CHECK(!bad_worker);
+      }
+    }
+
+    // Work taking longer at some indices is stolen by idle threads, and the loop still covers every index
+    efleet::Pool               pool(4);
+    std::atomic<unsigned long> sum(0), mixed(0);
+    auto                       body = [&](size_t index, unsigned) {
+      unsigned long x = index;
+      for (int i = 0; i < (index < 64 ? 20000 : 10); ++i) x = x * 6364136223846793005ul + 1442695040888963407ul;
+      mixed.fetch_xor(x, std::memory_order_relaxed);
+      sum.fetch_add(index, std::memory_order_relaxed);
+    };
+    pool.run(1000, body);
+    TEST_EQUAL(sum.load(), 1000ul * 999 / 2);
+  }
+
+  void check_validate()
+  {
+    Fleet fleet(64);
+    fleet.storage[7].setpoint      = 200;
+    fleet.storage[13].motor.speed  = -4000;
+    fleet.storage[13].gains[2]     = 1001;
+    fleet.storage[63].map[0][1]    = -2000;
+    fleet.storage[63].offset       = 0;
+
+    const std::vector<efleet::Issue> expected = {
+      { 7, 0x2001, 0, Error::ValueTooHigh }, { 13, 0x2000, 2, Error::ValueTooLow },
+      { 13, 0x2004, 3, Error::ValueTooHigh }, { 63, 0x2002, 0, Error::ValueTooLow },
+      { 63, 0x2006, 1, Error::ValueTooLow },
+    };
+    for (unsigned threads : { 1u, 3u, 8u })
+    {
+      efleet::Pool pool(threads);
+      TEST_CHECK(efleet::validate(pool, fleet.span()) == expected);
+    }
+  }
+
+  void check_diff()
+  {
+    Fleet devices(40), others(40);
+    others.storage[0].counter     = 1;
+    others.storage[21].gains[0]   = 5;
+    others.storage[21].gains[2]   = 6;
+    others.storage[39].label[0]   = 'E';
+    others.storage[39].motor.limit = 1;
+
+    const std::vector<efleet::Difference> expected = {
+      { 0, 0x3000, 0 }, { 21, 0x2004, 1 }, { 21, 0x2004, 3 }, { 39, 0x2000, 3 }, { 39, 0x2005, 0 },
+    };
+    std::vector<std::string> first;
+    for (unsigned threads : { 1u, 2u, 5u })
+    {
+      efleet::Pool pool(threads);
+      TEST_CHECK(efleet::diff(pool, devices.span(), others.span()) == expected);
+
+      // Encodings are the same whatever thread made them
+      auto snapshots = efleet::snapshot(pool, others.span());
+      TEST_EQUAL(snapshots.size(), 40u);
+      if (first.empty()) first = snapshots;
+      TEST_CHECK(snapshots == first);
+    }
+    TEST_CHECK(!first.empty() && !first[0].empty());
+    TEST_CHECK(first[1] == first[2] && first[0] != first[1] && first[21] != first[1]);
+  }
+
+}
+
+int main()
+{
+  check_pool();
+  check_validate();
+  check_diff();
+  return test::finish();
+}
@@ -0,0 +1,241 @@
+/// \file test_eformat.cpp
+/// \brief Tests of formatting and parsing: fixed-point numbers, formatted into fields and parsed back without floating
+/// point, and bytes as hex digits and hexdumps. Values of 16 bytes or more are encoded and decoded with SSSE3 where the
+/// processor has it, and shorter ones with tables, so lengths on both sides of 16 are checked against a reference
+
+#include "test.hpp"
+
+#include <cctype>
+#include <cstring>
+#include <string>
+
+#include "eformat.hpp"
+
+using eformat::Align;
+using eformat::Options;
+using eformat::ParseStatus;
+using estd::string_view;
+
+namespace {
+
+  /// \brief Encode bytes as hex one digit at a time, as a reference
+  std::string reference_hex(const uint8_t* data, size_t size)
+  {
+    const char  digits[] = "0123456789ABCDEF";
+    std::string out;
+    for (size_t i = 0; i < size; ++i)
+    {
+      out += digits[data[i] >> 4];
+      out += digits[data[i] & 0xF];
+    }
+    return out;
+  }
+
+  ParseStatus parse_hex(const std::string& text, uint8_t* out, size_t& size, size_t& rest)
+  {
+    string_view         in(text.data(), text.size());
+    estd::span<uint8_t> value(out, size);
+    auto                status = eformat::parse(in, value);
+    size                       = value.size();
+    rest                       = in.size();
+    return status;
+  }
+
+  template<class T>
+  std::string fixed(T value, uint8_t decimals, Options options = Options{})
+  {
+    char out[32];
+    int  n = eformat::format_fixed(out, sizeof(out), value, decimals, options);
+    TEST_CHECK(n >= 0);
+
+    // Buffers give the same text as arrays
+    test::string_driver driver;
+    TEST_EQUAL(eformat::format_fixed(driver.getbuf(), value, decimals, options), 0);
+    driver.getbuf().sync(0);
+    TEST_CHECK(driver.output == std::string(out, n));
+    return std::string(out, n);
+  }
+
+  template<class T>
+  ParseStatus parse_fixed(const char* text, T& value, uint8_t decimals, size_t rest = 0)
+  {
+    string_view in(text, strlen(text));
+    auto        status = eformat::parse_fixed(in, value, decimals);
+    TEST_EQUAL(in.size(), status == ParseStatus::OK ? rest : strlen(text));
+    return status;
+  }
+
+  void check_format_fixed()
+  {
+    TEST_CHECK(fixed(1234u, 2) == "12.34");
+    TEST_CHECK(fixed(5u, 3) == "0.005");
+    TEST_CHECK(fixed(1200u, 2) == "12.00");
+    TEST_CHECK(fixed(42u, 0) == "42");
+    TEST_CHECK(fixed(UINT32_MAX, 9) == "4.294967295");
+    TEST_CHECK(fixed(UINT32_MAX, 12) == "4.294967295");
+
+    // Signed values have a sign or a space, so columns of them line up
+    TEST_CHECK(fixed(-1234, 2) == "-12.34");
+    TEST_CHECK(fixed(1234, 2) == " 12.34");
+    TEST_CHECK(fixed(-5, 1) == "-0.5");
+    TEST_CHECK(fixed(INT32_MIN, 3) == "-2147483.648");
+
+    Options right{};
+    right.align = Align::Right;
+    right.width = 8;
+    TEST_CHECK(fixed(1234u, 2, right) == "   12.34");
+    Options left{};
+    left.width = 8;
+    TEST_CHECK(fixed(-1234, 2, left) == "-12.34  ");
+
+    // Text is truncated to arrays which are too small
+    char out[4];
+    TEST_EQUAL(eformat::format_fixed(out, sizeof(out), 1234u, 2), 4);
+    TEST_CHECK(memcmp(out, "12.3", 4) == 0);
+  }
+
+  void check_parse_fixed()
+  {
+    uint32_t u = 0;
+    TEST_EQUAL(parse_fixed("12.34 A", u, 2, 2), ParseStatus::OK);
+    TEST_EQUAL(u, 1234u);
+    TEST_EQUAL(parse_fixed("12.3,", u, 2, 1), ParseStatus::OK);
+    TEST_EQUAL(u, 1230u);
+    TEST_EQUAL(parse_fixed("12 ", u, 2, 1), ParseStatus::OK);
+    TEST_EQUAL(u, 1200u);
+    TEST_EQUAL(parse_fixed("4.294967295 ", u, 9, 1), ParseStatus::OK);
+    TEST_EQUAL(u, UINT32_MAX);
+
+    // Digits which cannot be stored, and decimal points without digits, are not numbers
+    TEST_EQUAL(parse_fixed("12.345 ", u, 2), ParseStatus::NotMatched);
+    TEST_EQUAL(parse_fixed("12. ", u, 2), ParseStatus::NotMatched);
+    TEST_EQUAL(parse_fixed("1 ", u, 10), ParseStatus::NotMatched);
+    TEST_EQUAL(parse_fixed("42949673 ", u, 2), ParseStatus::Overflow);
+    TEST_EQUAL(parse_fixed("4.294967296 ", u, 9), ParseStatus::Overflow);
+
+    int32_t i = 0;
+    TEST_EQUAL(parse_fixed("-12.34 ", i, 2, 1), ParseStatus::OK);
+    TEST_EQUAL(i, -1234);
+    TEST_EQUAL(parse_fixed("+0.5 ", i, 3, 1), ParseStatus::OK);
+    TEST_EQUAL(i, 500);
+    TEST_EQUAL(parse_fixed("-2147483.648 ", i, 3, 1), ParseStatus::OK);
+    TEST_EQUAL(i, INT32_MIN);
+    TEST_EQUAL(parse_fixed("2147483.648 ", i, 3), ParseStatus::Overflow);
+    TEST_EQUAL(parse_fixed("- 1 ", i, 0), ParseStatus::NotMatched);
+
+    // Formatted values parse back to themselves
+    for (int32_t value : { 0, 1, -1, 99, -100, 123456, -7654321, INT32_MAX, INT32_MIN })
+    {
+      for (uint8_t decimals = 0; decimals <= 9; ++decimals)
+      {
+        std::string text = fixed(value, decimals) + " ";
+        TEST_EQUAL(parse_fixed(text.c_str() + (text[0] == ' '), i, decimals, 1), ParseStatus::OK);
+        TEST_EQUAL(i, value);
+      }
+    }
+  }
+
+  void check_hex()
+  {
+    uint8_t data[80];
+    for (size_t i = 0; i < sizeof(data); ++i) data[i] = static_cast<uint8_t>(i * 53 + 7);
+    data[0] = 0x00;
+    data[1] = 0xFF;
+
+    for (size_t size = 0; size <= sizeof(data); ++size)
+    {
+      const std::string expected = reference_hex(data, size);
+      char              out[2 * sizeof(data)];
+      TEST_EQUAL(eformat::format_hex(out, sizeof(out), estd::span<const uint8_t>(data, size)), 2 * size);
+      TEST_CHECK(std::string(out, 2 * size) == expected);
+
+      test::string_driver driver;
+      TEST_EQUAL(eformat::format(driver.getbuf(), estd::span<const uint8_t>(data, size), Options{}), 0);
+      driver.getbuf().sync(0);
+      TEST_CHECK(driver.output == expected);
+
+      // Digits decode in either case, and decoding stops before the first character which is not a digit
+      std::string lower = expected;
+      for (char& c : lower) c = static_cast<char>(tolower(c));
+      for (const std::string& text : { expected + " rest", lower + " rest" })
+      {
+        uint8_t decoded[sizeof(data)];
+        size_t  n = sizeof(decoded), rest = 0;
+        TEST_EQUAL(parse_hex(text, decoded, n, rest), size > 0 ? ParseStatus::OK : ParseStatus::NotMatched);
+        if (size == 0) continue;
+        TEST_EQUAL(n, size);
+        TEST_EQUAL(rest, 5u);
+        TEST_CHECK(memcmp(decoded, data, size) == 0);
+      }
+    }
+
+    // Text only just outside the ranges of digits ends them, at every position of blocks and of the tail
+    const std::string digits = reference_hex(data, 40);
+    for (char stop : { '/', ':', '@', 'G', '`', 'g', '\0', '\xB0' })
+    {
+      for (size_t at = 2; at < digits.size(); at += 2)
+      {
+        std::string text = digits;
+        text[at]         = stop;
+        uint8_t decoded[40];
+        size_t  n = sizeof(decoded), rest = 0;
+        TEST_EQUAL(parse_hex(text, decoded, n, rest), ParseStatus::OK);
+        TEST_EQUAL(n, at / 2);
+        TEST_EQUAL(rest, text.size() - at);
+        TEST_CHECK(memcmp(decoded, data, n) == 0);
+
+        // A digit left after the last whole pair is half a byte
+        text[at + 1] = stop;
+        text[at]     = 'a';
+        n            = sizeof(decoded);
+        TEST_EQUAL(parse_hex(text, decoded, n, rest), ParseStatus::NotMatched);
+        TEST_EQUAL(rest, text.size());
+      }
+    }
+
+    // More digits than fit are an overflow, but as many as fit are not
+    uint8_t decoded[32];
+    size_t  n = 16, rest = 0;
+    TEST_EQUAL(parse_hex(reference_hex(data, 17), decoded, n, rest), ParseStatus::Overflow);
+    n = 16;
+    TEST_EQUAL(parse_hex(reference_hex(data, 16), decoded, n, rest), ParseStatus::OK);
+    TEST_EQUAL(n, 16u);
+    TEST_EQUAL(rest, 0u);
+  }
+
+  void check_hexdump()
+  {
+    const char text[] = "Hexdump of 20 bytes\x01";
+    const auto bytes  = estd::span<const uint8_t>(reinterpret_cast<const uint8_t*>(text), 20);
+
+    test::string_driver driver;
+    TEST_EQUAL(eformat::format_hexdump(driver.getbuf(), bytes, 0x1000), 0);
+    driver.getbuf().sync(0);
+    TEST_CHECK(driver.output ==
+               "00001000  48 65 78 64 75 6D 70 20  6F 66 20 32 30 20 62 79  |Hexdump of 20 by|\n"
+               "00001010  74 65 73 01                                       |tes.|\n");
+
+    // Streams write the same lines
+    test::string_driver streamed;
+    eio::IODevice       device(&streamed);
+    eformat::stream     so(device);
+    so << eformat::hexdump(bytes, 0x1000);
+    so.sync();
+    TEST_CHECK(streamed.output == driver.output);
+
+    driver.output.clear();
+    TEST_EQUAL(eformat::format_hexdump(driver.getbuf(), bytes.first(0)), 0);
+    driver.getbuf().sync(0);
+    TEST_CHECK(driver.output.empty());
+  }
+
+}
+
+int main()
+{
+  check_format_fixed();
+  check_parse_fixed();
+  check_hex();
+  check_hexdump();
+  return test::finish();
+}
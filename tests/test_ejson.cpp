@@ -0,0 +1,139 @@
+/// \file test_ejson.cpp
+/// \brief Tests of JSON export and import: escaping of strings, round trips of the dictionary, input which arrives in
+/// pieces, queries of fields, and errors which are kept while parsing goes on
+
+#include "test.hpp"
+
+#include <cstring>
+#include <string>
+
+#include "ejson.hpp"
+#include "test_objects.hpp"
+
+using eformat::ParseStatus;
+using eobject::Error;
+using estd::string_view;
+
+namespace {
+
+  template<typename Write>
+  std::string written(Write write)
+  {
+    test::string_driver driver;
+    eio::IODevice       device(&driver);
+    eformat::stream     so(device);
+    write(so);
+    so.sync();
+    return driver.output;
+  }
+
+  ParseStatus parse(ejson::reader& reader, const char* document)
+  {
+    string_view in(document, strlen(document));
+    return reader.parse(in);
+  }
+
+  void check_strings()
+  {
+    auto text = written([](eformat::stream& so) { ejson::write_string(so, "a\"b\\c\nd\x01"); });
+    TEST_CHECK(text == "\"a\\\"b\\\\c\\nd\\u0001\"");
+
+    const auto* motor         = test_objects::dictionary.get(0x2000);
+    test_objects::motor.speed = -20;
+    text                      = written([motor](eformat::stream& so) { ejson::write(so, *motor); });
+    TEST_CHECK(text == "{\"current\":0,\"speed\":-20,\"limit\":2000}");
+    test_objects::motor.speed = 0;
+  }
+
+  void check_round_trip()
+  {
+    const auto saved          = test_objects::storage;
+    test_objects::motor.speed = -1500;
+    test_objects::gains[2]    = 42;
+    strcpy(test_objects::label, "say \"hi\"");
+    const auto        expected = test_objects::storage;
+    const std::string document =
+      written([](eformat::stream& so) { ejson::write(so, test_objects::dictionary); });
+
+    // Read the document back one character at a time, as if it arrived slowly
+    test_objects::storage = saved;
+    ejson::reader reader(test_objects::dictionary);
+    std::string   pending;
+    ParseStatus   status = ParseStatus::Incomplete;
+    for (char c : document)
+    {
+      pending += c;
+      string_view in(pending.data(), pending.size());
+      status = reader.parse(in);
+      pending.erase(0, pending.size() - in.size());
+    }
+    // The read-only firmware version and the table are written, but not read back
+    TEST_EQUAL(status, ParseStatus::OK);
+    TEST_EQUAL(reader.error(), Error::ReadOnly);
+    TEST_CHECK(reader.count() > 0);
+    TEST_EQUAL(test_objects::motor.speed, -1500);
+    TEST_EQUAL(test_objects::gains[2], 42);
+    TEST_CHECK(strcmp(test_objects::label, "say \"hi\"") == 0);
+    TEST_CHECK(memcmp(&test_objects::storage, &expected, sizeof(expected)) == 0);
+    test_objects::storage = saved;
+  }
+
+  void check_queries()
+  {
+    const auto    saved = test_objects::storage;
+    ejson::reader reader(test_objects::dictionary);
+
+    // Fields are selected by query, by name within an object, or by position within an array, and nulls are skipped
+    TEST_EQUAL(parse(reader, "{\"motor.speed\": -10, \"gains\": {\"i\": 5}, \"setpoint\": null}"), ParseStatus::OK);
+    TEST_EQUAL(test_objects::motor.speed, -10);
+    TEST_EQUAL(test_objects::gains[1], 5);
+    TEST_EQUAL(test_objects::setpoint, 25);
+    TEST_EQUAL(reader.count(), 2u);
+
+    reader.reset();
+    TEST_EQUAL(parse(reader, "{\"gains\": [1, null, 3]}"), ParseStatus::OK);
+    TEST_EQUAL(test_objects::gains[0], 1);
+    TEST_EQUAL(test_objects::gains[1], 5);
+    TEST_EQUAL(test_objects::gains[2], 3);
+    test_objects::storage = saved;
+  }
+
+  void check_errors()
+  {
+    const auto    saved = test_objects::storage;
+    ejson::reader reader(test_objects::dictionary);
+
+    // Errors are kept while the rest of the document is still read
+    TEST_EQUAL(parse(reader, "{\"nothing\": [1, {\"a\": 2}], \"setpoint\": 500, \"offset\": 20}"), ParseStatus::OK);
+    TEST_CHECK(reader.error() < 0);
+    TEST_EQUAL(test_objects::setpoint, 25);
+    TEST_EQUAL(test_objects::offset, 20);
+
+    // Tables are not read
+    reader.reset();
+    TEST_EQUAL(parse(reader, "{\"map\": [[1, 2, 3, 4]]}"), ParseStatus::OK);
+    TEST_EQUAL(reader.error(), Error::DataTypeError);
+
+    reader.reset();
+    TEST_EQUAL(parse(reader, "{\"setpoint\" 5}"), ParseStatus::NotMatched);
+    reader.reset();
+    TEST_EQUAL(parse(reader, "{\"setpoint\": 5"), ParseStatus::Incomplete);
+
+    // Nesting deeper than the reader tracks
+    std::string deep = "{\"label\": ";
+    for (uint8_t i = 0; i <= ejson::reader::max_depth; ++i) deep += '[';
+    reader.reset();
+    TEST_EQUAL(parse(reader, deep.c_str()), ParseStatus::Overflow);
+    test_objects::storage = saved;
+  }
+
+}
+
+int main()
+{
+  check_strings();
+  check_round_trip();
+  check_queries();
+  check_errors();
+  return test::finish();
+}
@@ -0,0 +1,185 @@
+/// \file test_eobject.cpp
+/// \brief Tests of object dictionaries generated from test_objects.json: lookups by address and by name through the
+/// name index, agreement of the compact dictionary, views of objects by permissions, and restoring defaults
+
+#include "test.hpp"
+
+#include <cstring>
+
+#include "test_objects.hpp"
+
+using eobject::Dictionary;
+using eobject::Error;
+using eobject::Object;
+using eobject::View;
+
+namespace {
+
+  int traced = 0;
+
+  void count_trace(const Object&, uint16_t, uint8_t, uint32_t, uint32_t) { ++traced; }
+
+  /// \brief Change every value from its default, through set where it has a range
+  void change_values()
+  {
+    test_objects::firmware = 7;
+    test_objects::serial   = 99;
+    memcpy(test_objects::secret, "secret!", 8);
+    test_objects::motor          = { 500, -20, 3000 };
+    test_objects::gains[1]       = 999;
+    test_objects::map[2][3]      = -1;
+    test_objects::counter        = 42;
+    const int16_t setpoint       = -5;
+    const int8_t  offset         = 33;
+    const char    label[]        = "changed";
+    TEST_EQUAL(test_objects::dictionary.write(0x2001, 0, &setpoint, sizeof(setpoint)), Error::OK);
+    TEST_EQUAL(test_objects::dictionary.write(0x2002, 0, &offset, sizeof(offset)), Error::OK);
+    TEST_CHECK(test_objects::dictionary.write(0x2005, 0, label, sizeof(label) - 1) >= 0);
+    TEST_EQUAL(test_objects::setpoint, -5);
+    TEST_EQUAL(test_objects::offset, 33);
+  }
+
+  void check_lookup()
+  {
+    const auto& dictionary = test_objects::dictionary;
+    TEST_EQUAL(dictionary.count, 10u);
+    for (const auto* item = dictionary.begin(); item + 1 < dictionary.end(); ++item)
+      TEST_CHECK(item->address < item[1].address);
+
+    TEST_CHECK(dictionary.get(0x2004) == &dictionary.begin()[6].object);
+    TEST_CHECK(dictionary.get(0x2003) == nullptr);
+
+    // Names are found through the generated index, and must agree with the names of the objects
+    for (const auto& item : dictionary)
+    {
+      TEST_CHECK(dictionary.find(item.object.name()) == &item);
+      auto compact = test_objects::compact_dictionary.find(item.object.name());
+      TEST_CHECK(compact != nullptr && compact->address == item.address);
+    }
+    TEST_CHECK(dictionary.find("motors") == nullptr);
+    TEST_CHECK(dictionary.find("") == nullptr);
+    TEST_CHECK(test_objects::compact_dictionary.find("current") == nullptr);
+
+    struct Case
+    {
+      const char* text;
+      int32_t     result;
+      uint16_t    address;
+      int16_t     subIdx;
+    };
+    const Case cases[] = {
+      { "motor.limit", Error::OK, 0x2000, 3 }, { "gains/i", Error::OK, 0x2004, 2 },
+      { "map:2", Error::OK, 0x2006, 3 },       { "setpoint", Error::OK, 0x2001, -1 },
+      { "motor.p", Error::FieldNotFound, 0, 0 }, { "map.3", Error::FieldNotFound, 0, 0 },
+      { "current", Error::ObjectNotFound, 0, 0 },
+    };
+    for (const auto& c : cases)
+    {
+      estd::string_view text(c.text, static_cast<uint32_t>(strlen(c.text)));
+      estd::string_view compact_text = text;
+      Dictionary::Query q(text);
+      const int32_t     result = dictionary.query(q);
+      TEST_EQUAL(result, c.result);
+      if (result == Error::OK)
+      {
+        TEST_EQUAL(q.item->address, c.address);
+        TEST_EQUAL(q.subIdx, c.subIdx);
+      }
+
+      eobject::CompactDictionary::Query cq(compact_text);
+      TEST_EQUAL(test_objects::compact_dictionary.query(cq), c.result);
+      if (result == Error::OK) TEST_EQUAL(cq.subIdx, c.subIdx);
+    }
+  }
+
+  void check_views()
+  {
+    TEST_EQUAL(test_objects::visible_objects.size(), 9u);
+    TEST_EQUAL(test_objects::persisted_objects.size(), 8u);
+    TEST_EQUAL(test_objects::live_objects.size(), 1u);
+    TEST_EQUAL(test_objects::live_objects.begin()->address, 0x3000);
+
+    // Views list the objects in their mask in address order, and no others
+    const View* views[] = { &test_objects::visible_objects, &test_objects::persisted_objects,
+                            &test_objects::live_objects };
+    for (const View* view : views)
+    {
+      auto     it      = view->begin();
+      uint16_t counted = 0;
+      for (const auto& item : test_objects::dictionary)
+      {
+        if (!view->contains(item.object)) continue;
+        ++counted;
+        TEST_CHECK(it != view->end() && &*it == &item);
+        if (it != view->end()) ++it;
+      }
+      TEST_EQUAL(counted, view->size());
+      TEST_CHECK(it == view->end());
+    }
+    TEST_CHECK(!test_objects::visible_objects.contains(test_objects::dictionary.get(0x1002)[0]));
+    TEST_CHECK(test_objects::persisted_objects.contains(test_objects::dictionary.get(0x1002)[0]));
+    TEST_CHECK(!test_objects::persisted_objects.contains(test_objects::dictionary.get(0x1000)[0]));
+
+    // Views built at runtime keep the first objects which fit
+    eobject::TView<3> first(static_cast<const Dictionary&>(test_objects::dictionary), View::Persisted);
+    TEST_EQUAL(first.size(), 3u);
+    auto it = first.begin();
+    TEST_EQUAL(it->address, 0x1001);
+    ++it;
+    TEST_EQUAL(it->address, 0x1002);
+    ++it;
+    TEST_EQUAL(it->address, 0x2000);
+  }
+
+  void check_reset()
+  {
+    // Defaults are copied without calling set or trace functions
+    Object::trace_function = count_trace;
+    traced                 = 0;
+
+    change_values();
+    TEST_EQUAL(traced, 3);
+    TEST_EQUAL(test_objects::live_objects.reset(), 1);
+    TEST_EQUAL(test_objects::counter, 0u);
+    TEST_EQUAL(test_objects::setpoint, -5);
+
+    // A factory reset restores configuration, and leaves the firmware version alone
+    TEST_EQUAL(test_objects::persisted_objects.reset(), 8);
+    TEST_EQUAL(test_objects::serial, 1234u);
+    TEST_EQUAL(test_objects::secret[0], 0);
+    TEST_EQUAL(test_objects::motor.current, 0u);
+    TEST_EQUAL(test_objects::motor.speed, 0);
+    TEST_EQUAL(test_objects::motor.limit, 2000);
+    TEST_EQUAL(test_objects::setpoint, 25);
+    TEST_EQUAL(test_objects::offset, 10);
+    TEST_EQUAL(test_objects::gains[1], 10);
+    TEST_CHECK(strcmp(test_objects::label, "estd") == 0);
+    TEST_EQUAL(test_objects::map[2][3], 50);
+    TEST_EQUAL(test_objects::firmware, 7u);
+    TEST_EQUAL(traced, 3);
+
+    // Resetting the dictionary by mask does the same as the views, and the compact dictionary as the dictionary
+    change_values();
+    TEST_EQUAL(test_objects::dictionary.reset(View::Persisted | View::Live), 9);
+    TEST_EQUAL(test_objects::setpoint, 25);
+    TEST_EQUAL(test_objects::counter, 0u);
+    TEST_EQUAL(test_objects::firmware, 7u);
+    change_values();
+    TEST_EQUAL(test_objects::compact_dictionary.reset(View::Visible), 9);
+    TEST_EQUAL(test_objects::firmware, 0x00010002u);
+    TEST_EQUAL(test_objects::serial, 1234u);
+    TEST_CHECK(memcmp(test_objects::secret, "secret!", 8) == 0);
+    TEST_EQUAL(test_objects::gains[1], 10);
+
+    Object::trace_function = nullptr;
+  }
+
+}
+
+int main()
+{
+  check_lookup();
+  check_views();
+  check_reset();
+  return test::finish();
+}
@@ -0,0 +1,173 @@
+/// \file test_epatch.cpp
+/// \brief Tests of patches between dictionaries: round trips of diff and apply, agreement of diffs with images and
+/// with live dictionaries, and entries which fail to apply or are corrupt
+
+#include "test.hpp"
+
+#include <cstring>
+#include <string>
+
+#include "epatch.hpp"
+#include "fixture.hpp"
+
+using eobject::Dictionary;
+using eobject::Error;
+using estd::string_view;
+using test::dictionary_of;
+
+namespace {
+
+  std::string image(const Dictionary& dictionary)
+  {
+    test::string_driver driver;
+    int32_t             written = epatch::image(driver.getbuf(), dictionary);
+    driver.getbuf().sync(0);
+    TEST_CHECK(written >= 0 && static_cast<size_t>(written) == driver.output.size());
+    return driver.output;
+  }
+
+  std::string diff(const Dictionary& dictionary, const Dictionary& reference)
+  {
+    test::string_driver driver;
+    int32_t             written = epatch::diff(driver.getbuf(), dictionary, reference);
+    driver.getbuf().sync(0);
+    TEST_CHECK(written >= 0 && static_cast<size_t>(written) == driver.output.size());
+    return driver.output;
+  }
+
+  std::string diff(const Dictionary& dictionary, const std::string& reference)
+  {
+    test::string_driver driver;
+    int32_t written = epatch::diff(driver.getbuf(), dictionary, string_view(reference.data(), reference.size()));
+    driver.getbuf().sync(0);
+    TEST_CHECK(written >= 0 && static_cast<size_t>(written) == driver.output.size());
+    return driver.output;
+  }
+
+  int32_t apply(const std::string& patch, const Dictionary& dictionary, string_view& rest)
+  {
+    rest = string_view(patch.data(), patch.size());
+    return epatch::apply(rest, dictionary);
+  }
+
+  void check_round_trip()
+  {
+    const Dictionary&     dictionary = test_objects::dictionary;
+    test_objects::Storage copy       = test_objects::storage;
+    const auto            reference  = dictionary_of(copy);
+
+    // Equal dictionaries need no patch
+    TEST_CHECK(diff(dictionary, reference).empty());
+    TEST_CHECK(image(dictionary) == image(reference));
+
+    copy.motor.speed = -100;
+    copy.setpoint    = 50;
+    copy.gains[2]    = 7;
+    copy.map[1][0]   = -30;
+    strcpy(copy.label, "patched");
+    const std::string patch = diff(dictionary, reference);
+    TEST_CHECK(!patch.empty());
+
+    // Only the values which differ are written
+    TEST_CHECK(patch.size() < image(reference).size() / 2);
+    TEST_CHECK(diff(dictionary, image(reference)) == patch);
+
+    string_view rest;
+    TEST_EQUAL(apply(patch, dictionary, rest), Error::OK);
+    TEST_CHECK(rest.empty());
+    TEST_EQUAL(test_objects::motor.speed, -100);
+    TEST_EQUAL(test_objects::gains[2], 7);
+    TEST_CHECK(image(dictionary) == image(reference));
+    TEST_CHECK(diff(dictionary, reference).empty());
+    TEST_CHECK(diff(dictionary, image(reference)).empty());
+
+    test_objects::dictionary.reset(eobject::View::Persisted);
+  }
+
+  void check_errors()
+  {
+    const Dictionary&     dictionary = test_objects::dictionary;
+    test_objects::Storage copy       = test_objects::storage;
+    const auto            reference  = dictionary_of(copy);
+
+    // A value out of range stops the patch at its entry, keeping the values set before it
+    copy.motor.limit = 1000;
+    copy.setpoint    = 500;
+    copy.gains[0]    = 1;
+    const std::string patch = diff(dictionary, reference);
+    string_view       rest;
+    TEST_EQUAL(apply(patch, dictionary, rest), Error::ValueTooHigh);
+    TEST_CHECK(!rest.empty() && rest.end() == patch.data() + patch.size());
+    TEST_EQUAL(test_objects::motor.limit, 1000);
+    TEST_EQUAL(test_objects::setpoint, 25);
+    TEST_EQUAL(test_objects::gains[0], 100);
+
+    // Truncated entries are left in the input, after the entries before them are applied
+    test_objects::dictionary.reset(eobject::View::Persisted);
+    copy.setpoint         = 50;
+    std::string truncated = diff(dictionary, reference);
+    truncated.pop_back();
+    TEST_EQUAL(apply(truncated, dictionary, rest), Error::ParamTooShort);
+    TEST_CHECK(!rest.empty() && rest.end() == truncated.data() + truncated.size());
+    TEST_EQUAL(test_objects::motor.limit, 1000);
+    TEST_EQUAL(test_objects::setpoint, 50);
+    TEST_EQUAL(test_objects::gains[0], 100);
+
+    // Addresses past the last cannot wrap around to reach objects at lower addresses
+    test_objects::dictionary.reset(eobject::View::Persisted | eobject::View::Live);
+    const char wrapping[] = { '\x19', '\x30', '\x00', '\x00', '\x44', '\x01', '\x00', '\x00', '\x00', // 0x3000 = 1
+                              '\x19', '\xF0', '\x01', '\x00', '\x42', '\x05', '\x00' };             // 0x2001 = 5
+    rest = string_view(wrapping, sizeof(wrapping));
+    TEST_EQUAL(epatch::apply(rest, dictionary), Error::DataTypeError);
+    TEST_EQUAL(rest.size(), 7u);
+    TEST_EQUAL(test_objects::counter, 1u);
+    TEST_EQUAL(test_objects::setpoint, 25);
+
+    // Objects missing from the dictionary are reported
+    const char missing[] = { '\x19', '\x20', '\x03', '\x00', '\x41', '\x01' };
+    rest                 = string_view(missing, sizeof(missing));
+    TEST_EQUAL(epatch::apply(rest, dictionary), Error::ObjectNotFound);
+    TEST_EQUAL(rest.size(), sizeof(missing));
+
+    test_objects::dictionary.reset(eobject::View::Persisted | eobject::View::Live);
+  }
+
+  void check_compare()
+  {
+    test_objects::Storage copy      = test_objects::storage;
+    const auto            reference = dictionary_of(copy);
+    copy.motor.current              = 1;
+    copy.map[2][1]                  = 2;
+    copy.counter                    = 3;
+
+    struct Visit
+    {
+      uint16_t address;
+      uint8_t  subIdx;
+    };
+    Visit  visits[8];
+    size_t count = 0;
+    epatch::compare(test_objects::dictionary, reference,
+                    [&](const Dictionary::Item& item, const eobject::Object* other, uint8_t subIdx) {
+                      TEST_CHECK(other != nullptr);
+                      if (count < 8) visits[count] = { item.address, subIdx };
+                      ++count;
+                    });
+    TEST_EQUAL(count, 3u);
+    TEST_EQUAL(visits[0].address, 0x2000);
+    TEST_EQUAL(visits[0].subIdx, 1);
+    TEST_EQUAL(visits[1].address, 0x2006);
+    TEST_EQUAL(visits[1].subIdx, 3);
+    TEST_EQUAL(visits[2].address, 0x3000);
+    TEST_EQUAL(visits[2].subIdx, 0);
+  }
+
+}
+
+int main()
+{
+  check_round_trip();
+  check_errors();
+  check_compare();
+  return test::finish();
+}
@@ -0,0 +1,230 @@
+/// \file test_eremote.cpp
+/// \brief Tests of remote dictionaries over in-process links: metadata and queries of the served dictionary, reads
+/// and writes one at a time and queued together, and responses which arrive after their request was given up on
+
+#include "test.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "eremote_host.hpp"
+#include "test_objects.hpp"
+
+using eobject::DataType;
+using eobject::Error;
+using eobject::Object;
+using eremote::Loopback;
+using eremote::NoResponse;
+using eremote::RemoteDictionary;
+
+namespace {
+
+  void check_metadata()
+  {
+    Loopback         link(test_objects::dictionary);
+    RemoteDictionary remote(link.device());
+    TEST_EQUAL(remote.load(), Error::OK);
+    TEST_EQUAL(remote.end() - remote.begin(), test_objects::dictionary.count);
+    for (const auto& item : test_objects::dictionary)
+    {
+      const auto* remote_item = remote.get(item.address);
+      TEST_CHECK(remote_item != nullptr && remote_item->name == std::string(item.object.name().data(),
+                                                                            item.object.name().size()));
+    }
+    TEST_CHECK(remote.get(0x2003) == nullptr);
+
+    const auto* motor = remote.find("MOTOR");
+    TEST_CHECK(motor != nullptr && motor->address == 0x2000);
+    TEST_CHECK(motor->otype == Object::ClassId::Record);
+    TEST_EQUAL(motor->fields.size(), 3u);
+    TEST_CHECK(motor->fields[1].name == "speed" && motor->fields[1].type == DataType::I16);
+
+    // Queries name fields, elements and rows of tables
+    estd::string_view            text("motor.limit");
+    RemoteDictionary::Query      query(text);
+    TEST_EQUAL(remote.query(query), Error::OK);
+    TEST_EQUAL(query.subIdx, 3);
+    TEST_EQUAL(query.size, 2u);
+    estd::string_view       row_text("map.2");
+    RemoteDictionary::Query row(row_text);
+    TEST_EQUAL(remote.query(row), Error::OK);
+    TEST_EQUAL(row.subIdx, 3);
+    TEST_EQUAL(row.size, 8u);
+    estd::string_view       missing_text("gains.x");
+    RemoteDictionary::Query missing(missing_text);
+    TEST_EQUAL(remote.query(missing), Error::FieldNotFound);
+
+    // Metadata is fetched once
+    const auto frames = remote.stats().frames;
+    TEST_CHECK(remote.find("label") != nullptr);
+    TEST_EQUAL(remote.stats().frames, frames);
+  }
+
+  void check_read_write()
+  {
+    const auto       saved = test_objects::storage;
+    Loopback         link(test_objects::dictionary);
+    RemoteDictionary remote(link.device());
+
+    const int16_t setpoint = 42;
+    TEST_EQUAL(remote.write(0x2001, 0, &setpoint, sizeof(setpoint)), Error::OK);
+    TEST_EQUAL(test_objects::setpoint, 42);
+    const int16_t high = 500;
+    TEST_CHECK(remote.write(0x2001, 0, &high, sizeof(high)) < 0);
+    TEST_EQUAL(test_objects::setpoint, 42);
+
+    // Subindex 0 of arrays is their number of elements
+    uint8_t  count = 0;
+    uint16_t gain  = 0;
+    TEST_EQUAL(remote.read(0x2004, 0, &count, sizeof(count)), 1);
+    TEST_EQUAL(count, 3);
+    TEST_EQUAL(remote.read(0x2004, 3, &gain, sizeof(gain)), static_cast<int32_t>(sizeof(gain)));
+    TEST_EQUAL(gain, 1);
+    int16_t value = 0;
+    TEST_EQUAL(remote.read(0x2003, 0, &value, sizeof(value)), Error::ObjectNotFound);
+
+    // Operations queued together are done in order, with consecutive reads sharing requests
+    test_objects::counter = 7;
+    int16_t  speeds[40];
+    int32_t  results[42];
+    uint32_t counter    = 0;
+    int16_t  speed      = -300;
+    const auto operations = remote.stats().operations;
+    remote.queue_write(0x2000, 2, &speed, sizeof(speed), &results[0]);
+    for (int i = 0; i < 40; ++i) remote.queue_read(0x2000, 2, &speeds[i], sizeof(speeds[i]), &results[i + 1]);
+    remote.queue_read(0x3000, 0, &counter, sizeof(counter), &results[41]);
+    const auto frames = remote.stats().frames;
+    TEST_EQUAL(remote.flush(), Error::OK);
+    TEST_EQUAL(results[0], Error::OK);
+    for (int i = 0; i < 40; ++i)
+    {
+      TEST_EQUAL(results[i + 1], 2);
+      TEST_EQUAL(speeds[i], -300);
+    }
+    TEST_EQUAL(results[41], 4);
+    TEST_EQUAL(counter, 7u);
+    TEST_EQUAL(remote.stats().operations - operations, 42u);
+    TEST_EQUAL(remote.stats().frames - frames, 2u);
+    test_objects::storage = saved;
+  }
+
+  /// \brief Link to a server of the test objects which only answers while it is up, so requests can be left without a
+  ///        response until after they are given up on
+  struct Link
+  {
+    struct End final : public eio::IODevice::Driver
+    {
+      typedef eio::iobuffer<End, 64, 64> BufferType;
+
+      End(Link& link, std::string& in, std::string& out)
+        : link_(link)
+        , in_(in)
+        , out_(out)
+        , buffer_(*this)
+      {}
+
+      int write(const void* data, uint16_t count) NOEXCEPT
+      {
+        out_.append(static_cast<const char*>(data), count);
+        return count;
+      }
+
+      int read(void* data, uint16_t count) NOEXCEPT
+      {
+        const size_t n = std::min<size_t>(count, in_.size());
+        memcpy(data, in_.data(), n);
+        in_.erase(0, n);
+        return static_cast<int>(n);
+      }
+
+      int sync(int timeout) NOEXCEPT
+      {
+        // The server runs whenever the client waits, and the client gives up at once while the link is down
+        if (this != &link_.host) return timeout;
+        if (!link_.up) return EOF;
+        return link_.server.poll() < 0 ? EOF : timeout;
+      }
+
+      eio::buffer& getbuf() NOEXCEPT { return buffer_; }
+
+    private:
+      Link&        link_;
+      std::string& in_;
+      std::string& out_;
+      BufferType   buffer_;
+    };
+
+    std::string     to_device;
+    std::string     to_host;
+    End             host{ *this, to_host, to_device };
+    End             device{ *this, to_device, to_host };
+    eremote::Server server{ eio::IODevice(&device), test_objects::dictionary };
+    bool            up = false;
+  };
+
+  /// \brief Give up on requests while the link is down, and check their late responses are neither taken as responses
+  ///        to the requests after them nor written to their values, while their tags are reused once they arrive
+  void check_late_responses()
+  {
+    const auto       saved = test_objects::storage;
+    Link             link;
+    RemoteDictionary remote(eio::IODevice(&link.host), 16, std::chrono::milliseconds(20));
+
+    int16_t rows[8][4];
+    int32_t results[8];
+    memset(rows, 0x55, sizeof(rows));
+    for (uint8_t i = 0; i < 8; ++i) remote.queue_read(0x2006, i % 3 + 1, rows[i], sizeof(rows[i]), &results[i]);
+    TEST_EQUAL(remote.flush(), NoResponse);
+    for (int32_t result : results) TEST_EQUAL(result, NoResponse);
+
+    // Every other tag is given up on, leaving one to send with
+    test_objects::counter = 99;
+    uint32_t counter      = 0;
+    for (int i = 0; i < 254; ++i) TEST_EQUAL(remote.read(0x3000, 0, &counter, sizeof(counter)), NoResponse);
+    TEST_EQUAL(counter, 0u);
+
+    // The server answers every request in order once the link is up, so the response to the last comes after 255
+    // late responses
+    link.up                = true;
+    test_objects::setpoint = 12;
+    int16_t setpoint       = 0;
+    TEST_EQUAL(remote.read(0x2001, 0, &setpoint, sizeof(setpoint)), static_cast<int32_t>(sizeof(setpoint)));
+    TEST_EQUAL(setpoint, 12);
+    TEST_EQUAL(counter, 0u);
+    for (const auto& row : rows)
+    {
+      int16_t untouched[4];
+      memset(untouched, 0x55, sizeof(untouched));
+      TEST_CHECK(memcmp(row, untouched, sizeof(row)) == 0);
+    }
+
+    // Tags are free again once their late responses arrive
+    for (int i = 0; i < 300; ++i)
+    {
+      test_objects::counter = static_cast<uint32_t>(i);
+      TEST_EQUAL(remote.read(0x3000, 0, &counter, sizeof(counter)), static_cast<int32_t>(sizeof(counter)));
+      TEST_EQUAL(counter, static_cast<uint32_t>(i));
+    }
+
+    // With every tag given up on, responses are dropped until the link is quiet before requests are sent again, so
+    // the response to a read of setpoint is not taken from the late responses to reads of counter
+    link.up = false;
+    for (int i = 0; i < 256; ++i) TEST_EQUAL(remote.read(0x3000, 0, &counter, sizeof(counter)), NoResponse);
+    link.up                = true;
+    test_objects::setpoint = -7;
+    TEST_EQUAL(remote.read(0x2001, 0, &setpoint, sizeof(setpoint)), static_cast<int32_t>(sizeof(setpoint)));
+    TEST_EQUAL(setpoint, -7);
+    TEST_EQUAL(counter, 299u);
+    test_objects::storage = saved;
+  }
+
+}
+
+int main()
+{
+  check_metadata();
+  check_read_write();
+  check_late_responses();
+  return test::finish();
+}
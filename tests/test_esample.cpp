@@ -0,0 +1,204 @@
+/// \file test_esample.cpp
+/// \brief Tests of the sampler: signals which can and cannot be sampled, captures started by each trigger condition
+/// with their pre-trigger window, continuous sampling around the ring, and exports read in pieces and encoded
+
+#include "test.hpp"
+
+#include <cstring>
+#include <string>
+
+#include "esample.hpp"
+#include "test_objects.hpp"
+
+using eobject::DataType;
+using eobject::Error;
+using esample::Condition;
+using esample::Header;
+using esample::Sampler;
+using esample::SignalInfo;
+using State = esample::Sampler::State;
+
+namespace {
+
+  /// \brief Storage for 10 samples of setpoint, counter and offset, which take 7 bytes together
+  uint8_t storage[70];
+
+  void add_signals(Sampler& sampler)
+  {
+    TEST_EQUAL(sampler.add(0x2001, 0), 0);
+    TEST_EQUAL(sampler.add(0x3000, 0), 1);
+    TEST_EQUAL(sampler.add(0x2002, 0), 2);
+  }
+
+  /// \brief Set the signals from a step number, and take a sample
+  void tick(Sampler& sampler, int16_t step)
+  {
+    test_objects::setpoint = step;
+    test_objects::counter  = 1000u * static_cast<uint32_t>(step);
+    test_objects::offset   = static_cast<int8_t>(-step);
+    sampler.tick();
+  }
+
+  void check_signals()
+  {
+    Sampler sampler(storage, sizeof(storage), test_objects::dictionary);
+    TEST_EQUAL(sampler.start(0, 1, 100), Error::FieldNotFound);
+    TEST_EQUAL(sampler.add(0x2003, 0), Error::ObjectNotFound);
+    TEST_EQUAL(sampler.add(0x2005, 0), Error::DataTypeError);
+    TEST_EQUAL(sampler.add(0x2004, 9), Error::FieldNotFound);
+
+    // Fields of records and elements of arrays are sampled as well as variables
+    TEST_EQUAL(sampler.add(0x2000, 2), 0);
+    TEST_EQUAL(sampler.add(0x2004, 3), 1);
+    TEST_EQUAL(sampler.signal(0).size, 2);
+    TEST_CHECK(sampler.signal(0).data == &test_objects::motor.speed);
+    TEST_CHECK(sampler.signal(1).data == &test_objects::gains[2]);
+    TEST_EQUAL(sampler.trigger(2, Condition::Rising), Error::FieldNotFound);
+
+    // Storage holds 17 samples of 4 bytes
+    TEST_EQUAL(sampler.start(10, 8, 100), Error::ParamTooLong);
+    TEST_EQUAL(sampler.start(10, 7, 100), Error::OK);
+    TEST_EQUAL(sampler.depth(), 17u);
+    TEST_EQUAL(sampler.add(0x2001, 0), Error::UnableToSet);
+    sampler.clear();
+    TEST_EQUAL(sampler.signals(), 0);
+    TEST_CHECK(sampler.state() == State::Stopped);
+  }
+
+  void check_trigger()
+  {
+    const auto saved = test_objects::storage;
+    Sampler    sampler(storage, sizeof(storage), test_objects::dictionary);
+    add_signals(sampler);
+
+    // The capture waits for its pre-trigger window, and for a rising edge rather than a level
+    TEST_EQUAL(sampler.trigger(0, Condition::Rising, 5), Error::OK);
+    TEST_EQUAL(sampler.start(2, 3, 250), Error::OK);
+    TEST_EQUAL(sampler.depth(), 10u);
+    tick(sampler, 9);
+    tick(sampler, 9);
+    tick(sampler, 1);
+    tick(sampler, 2);
+    TEST_CHECK(sampler.state() == State::Armed);
+    tick(sampler, 5);
+    TEST_CHECK(sampler.state() == State::Triggered);
+    tick(sampler, 6);
+    tick(sampler, 7);
+    TEST_CHECK(sampler.state() == State::Done);
+    tick(sampler, 8);
+
+    // Only the pre-trigger window is kept from before the trigger
+    const int16_t expected[] = { 1, 2, 5, 6, 7 };
+    TEST_EQUAL(sampler.samples(), 5u);
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+      TEST_EQUAL(sampler.value(0, i), expected[i]);
+      TEST_EQUAL(sampler.value(1, i), 1000 * expected[i]);
+      TEST_EQUAL(sampler.value(2, i), -expected[i]);
+    }
+
+    // Levels are compared with the sample taken, for each condition. Captures which never trigger take 0 ticks
+    const struct
+    {
+      Condition condition;
+      int16_t   steps[3];
+      uint32_t  ticks;
+    } cases[] = {
+      { Condition::Always, { 0, 0, 0 }, 1 }, { Condition::Above, { 3, 4, 5 }, 2 },
+      { Condition::Below, { 4, 3, 2 }, 3 },  { Condition::Falling, { 3, 4, 0 }, 3 },
+      { Condition::Falling, { 0, 0, 0 }, 0 },
+    };
+    for (const auto& c : cases)
+    {
+      TEST_EQUAL(sampler.trigger(0, c.condition, 3), Error::OK);
+      TEST_EQUAL(sampler.start(0, 1, 250), Error::OK);
+      uint32_t ticks = 0;
+      for (int16_t step : c.steps)
+      {
+        if (sampler.state() == State::Done) break;
+        tick(sampler, step);
+        ++ticks;
+      }
+      TEST_EQUAL(sampler.state() == State::Done ? ticks : 0u, c.ticks);
+    }
+    test_objects::storage = saved;
+  }
+
+  void check_export()
+  {
+    const auto saved = test_objects::storage;
+    Sampler    sampler(storage, sizeof(storage), test_objects::dictionary);
+    add_signals(sampler);
+
+    // Sampling continuously wraps around the ring, keeping the latest samples until stopped
+    TEST_EQUAL(sampler.trigger(0, Condition::Never), Error::OK);
+    TEST_EQUAL(sampler.start(0, 1, 500), Error::OK);
+    for (int16_t step = 1; step <= 23; ++step) tick(sampler, step);
+    TEST_CHECK(sampler.state() == State::Armed);
+    sampler.stop();
+    tick(sampler, 100);
+    TEST_EQUAL(sampler.samples(), 10u);
+    TEST_EQUAL(sampler.value(0, 0), 14);
+    TEST_EQUAL(sampler.value(0, 9), 23);
+
+    // The export is the same whether it is read whole or in pieces across the ends of the ring
+    const size_t size = sizeof(Header) + 3 * sizeof(SignalInfo) + 10 * 7;
+    TEST_EQUAL(sampler.export_size(), size);
+    std::string whole(size, '\0');
+    TEST_EQUAL(sampler.read(0, &whole[0], size + 10), size);
+    TEST_EQUAL(sampler.read(size, &whole[0], 1), 0u);
+    std::string pieces;
+    char        piece[3];
+    for (size_t offset = 0, n; (n = sampler.read(offset, piece, sizeof(piece))) > 0; offset += n)
+      pieces.append(piece, n);
+    TEST_CHECK(pieces == whole);
+
+    Header header;
+    memcpy(&header, whole.data(), sizeof(header));
+    TEST_EQUAL(header.magic, Header::Magic);
+    TEST_EQUAL(header.version, Header::Version);
+    TEST_EQUAL(header.signals, 3);
+    TEST_EQUAL(header.samples, 10u);
+    TEST_EQUAL(header.trigger, Header::NoTrigger);
+    TEST_EQUAL(header.period_us, 500u);
+    SignalInfo info;
+    memcpy(&info, whole.data() + sizeof(Header) + sizeof(SignalInfo), sizeof(info));
+    TEST_EQUAL(info.address, 0x3000);
+    TEST_EQUAL(info.type, static_cast<uint8_t>(DataType::U32));
+
+    const char* columns = whole.data() + sizeof(Header) + 3 * sizeof(SignalInfo);
+    uint32_t    counter;
+    memcpy(&counter, columns + 10 * sizeof(int16_t) + 9 * sizeof(uint32_t), sizeof(counter));
+    TEST_EQUAL(counter, 23000u);
+
+    // Encoded exports decode to the same columns
+    test::string_driver driver;
+    int32_t             written = sampler.write(driver.getbuf(), ecodec::Codec::Delta);
+    driver.getbuf().sync(0);
+    TEST_CHECK(written > 0 && static_cast<size_t>(written) == driver.output.size());
+    estd::string_view in(driver.output.data(), driver.output.size());
+    in.remove_prefix(sizeof(Header) + 3 * sizeof(SignalInfo));
+    TEST_EQUAL(in[0], static_cast<char>(ecodec::Codec::Delta));
+    in.remove_prefix(1);
+    int16_t  setpoints[10];
+    uint32_t counters[10];
+    int8_t   offsets[10];
+    TEST_EQUAL(ecodec::decode(in, setpoints, 10, DataType::I16, ecodec::Codec::Delta), Error::OK);
+    TEST_EQUAL(ecodec::decode(in, counters, 10, DataType::U32, ecodec::Codec::Delta), Error::OK);
+    TEST_EQUAL(ecodec::decode(in, offsets, 10, DataType::I8, ecodec::Codec::Delta), Error::OK);
+    TEST_CHECK(in.empty());
+    TEST_CHECK(memcmp(setpoints, columns, sizeof(setpoints)) == 0);
+    TEST_CHECK(memcmp(counters, columns + sizeof(setpoints), sizeof(counters)) == 0);
+    TEST_CHECK(memcmp(offsets, columns + sizeof(setpoints) + sizeof(counters), sizeof(offsets)) == 0);
+    test_objects::storage = saved;
+  }
+
+}
+
+int main()
+{
+  check_signals();
+  check_trigger();
+  check_export();
+  return test::finish();
+}
@@ -0,0 +1,282 @@
+/// \file test_esched.cpp
+/// \brief Tests of the cooperative scheduler on a platform with a manual clock: deadlines, events and timeouts,
+/// periodic tasks, times which wrap around, and adding and removing tasks while they run
+
+#include "test.hpp"
+
+#include "esched.hpp"
+#include "test_objects.hpp"
+
+using esched::Event;
+using esched::Scheduler;
+using esched::Task;
+using esched::tick_type;
+using esched::Wait;
+using test::ManualPlatform;
+
+namespace {
+
+  /// \brief Task which records when it ran, and waits for what it is given next
+  /// \remarks Waits for events see the signals since they were made, so they are made at the end of each step
+  struct Recorder final : Task
+  {
+    Wait         next    = Wait::yield();
+    const Event* event   = nullptr; ///< Event to wait for instead of next, or nullptr
+    tick_type    timeout = 0;       ///< Timeout of the wait for event, or 0 for none
+    int          steps   = 0;
+    tick_type    last    = 0;
+    bool         woken   = false;
+
+    Wait step(Scheduler& scheduler) NOEXCEPT override
+    {
+      ++steps;
+      last  = scheduler.now();
+      woken = signalled();
+      if (event != nullptr) return timeout != 0 ? Wait::on(*event, timeout) : Wait::on(*event);
+      return next;
+    }
+  };
+
+  void check_deadlines()
+  {
+    ManualPlatform platform;
+    Scheduler      scheduler(platform);
+    Recorder       task;
+    task.next = Wait::sleep(10);
+    scheduler.add(task);
+
+    TEST_EQUAL(scheduler.run_once(), 10);
+    TEST_EQUAL(task.steps, 1);
+    platform.time = 4;
+    TEST_CHECK(!scheduler.pending());
+    TEST_EQUAL(scheduler.run_once(), 6);
+    TEST_EQUAL(task.steps, 1);
+    platform.time = 12;
+    TEST_EQUAL(scheduler.run_once(), 10);
+    TEST_EQUAL(task.steps, 2);
+    TEST_EQUAL(task.last, 12u);
+
+    // Absolute deadlines do not move with the time the step ended
+    task.next = Wait::until(30);
+    platform.time = 22;
+    TEST_EQUAL(scheduler.run_once(), 8);
+    platform.time = 29;
+    TEST_EQUAL(scheduler.run_once(), 1);
+
+    // Tasks which yield stay ready
+    task.next = Wait::yield();
+    platform.time = 30;
+    TEST_EQUAL(scheduler.run_once(), 0);
+    TEST_CHECK(scheduler.pending());
+  }
+
+  void check_wrap_around()
+  {
+    ManualPlatform platform;
+    platform.time = 0xFFFFFFF0u;
+    Scheduler scheduler(platform);
+    Recorder  task;
+    task.next = Wait::sleep(32);
+    scheduler.add(task);
+
+    TEST_EQUAL(scheduler.run_once(), 32);
+    platform.time += 31;
+    TEST_EQUAL(scheduler.run_once(), 1);
+    TEST_EQUAL(task.steps, 1);
+    platform.time += 1;
+    scheduler.run_once();
+    TEST_EQUAL(task.steps, 2);
+    TEST_EQUAL(task.last, 16u);
+  }
+
+  void check_events()
+  {
+    ManualPlatform platform;
+    Scheduler      scheduler(platform);
+    Event          event;
+    Recorder       waiting, timed;
+    waiting.event = &event;
+    timed.event   = &event;
+    timed.timeout = 50;
+    scheduler.add(waiting);
+    scheduler.add(timed);
+
+    TEST_EQUAL(scheduler.run_once(), 50);
+    platform.time = 10;
+    TEST_EQUAL(scheduler.run_once(), 40);
+    TEST_EQUAL(waiting.steps, 1);
+
+    // Every task waiting is woken by a signal, however many signals arrived
+    event.signal();
+    event.signal();
+    TEST_CHECK(scheduler.pending());
+    TEST_EQUAL(scheduler.run_once(), 50);
+    TEST_EQUAL(waiting.steps, 2);
+    TEST_EQUAL(timed.steps, 2);
+    TEST_CHECK(waiting.woken && timed.woken);
+    TEST_EQUAL(scheduler.run_once(), 50);
+    TEST_EQUAL(waiting.steps, 2);
+
+    // A timeout runs the task without the event
+    platform.time = 60;
+    TEST_EQUAL(scheduler.run_once(), 50);
+    TEST_EQUAL(timed.steps, 3);
+    TEST_CHECK(!timed.woken);
+
+    // Tasks waiting on events only leave nothing to time
+    scheduler.remove(timed);
+    TEST_EQUAL(scheduler.run_once(), -1);
+    TEST_EQUAL(timed.steps, 3);
+  }
+
+  esched::Event changed;
+
+  void check_set_and_signal()
+  {
+    const auto& object = *test_objects::dictionary.get(0x2001);
+    const auto  setf   = esched::set_and_signal<eobject::Variable::detail::set_value<int16_t>, changed>;
+    int16_t     value  = 40;
+    TEST_EQUAL(setf(object, 0, &value, sizeof(value)), eobject::Error::OK);
+    TEST_EQUAL(changed.count(), 1u);
+    TEST_EQUAL(test_objects::setpoint, 40);
+
+    // Values which are not set signal nothing
+    value = 1000;
+    TEST_EQUAL(setf(object, 0, &value, sizeof(value)), eobject::Error::ValueTooHigh);
+    TEST_EQUAL(changed.count(), 1u);
+    test_objects::dictionary.reset(eobject::View::Persisted);
+  }
+
+  void check_periodic()
+  {
+    ManualPlatform          platform;
+    Scheduler               scheduler(platform);
+    tick_type               calls[8];
+    int                     count = 0;
+    struct Context
+    {
+      ManualPlatform& platform;
+      tick_type*      calls;
+      int&            count;
+    } context{ platform, calls, count };
+    esched::PeriodicTask task(
+      [](void* c) {
+        auto& context = *static_cast<Context*>(c);
+        if (context.count < 8) context.calls[context.count] = context.platform.time;
+        ++context.count;
+      },
+      &context, 10);
+    scheduler.add(task);
+
+    TEST_EQUAL(scheduler.run_once(), 10);
+    platform.time = 13;
+    TEST_EQUAL(scheduler.run_once(), 7);
+    TEST_EQUAL(count, 2);
+
+    // Calls are made at multiples of the period from the first, however late each ran
+    platform.time = 20;
+    TEST_EQUAL(scheduler.run_once(), 10);
+    TEST_EQUAL(count, 3);
+
+    // Calls which fall more than a period behind are skipped rather than made back to back
+    platform.time = 55;
+    TEST_EQUAL(scheduler.run_once(), 10);
+    TEST_EQUAL(count, 4);
+    TEST_EQUAL(scheduler.run_once(), 10);
+    TEST_EQUAL(count, 4);
+    TEST_EQUAL(calls[0], 0u);
+    TEST_EQUAL(calls[1], 13u);
+    TEST_EQUAL(calls[2], 20u);
+    TEST_EQUAL(calls[3], 55u);
+  }
+
+  /// \brief Task which adds another, removes itself after some steps, and stops the scheduler when both are done
+  struct Spawner final : Task
+  {
+    Recorder child;
+    int      steps = 0;
+
+    Wait step(Scheduler& scheduler) NOEXCEPT override
+    {
+      ++steps;
+      if (steps == 1)
+      {
+        child.next = Wait::sleep(5);
+        scheduler.add(child);
+      }
+      if (steps == 3)
+      {
+        scheduler.remove(child);
+        scheduler.stop();
+        return Wait::done();
+      }
+      return Wait::sleep(20);
+    }
+  };
+
+  void check_run()
+  {
+    ManualPlatform platform;
+    Scheduler      scheduler(platform);
+    Spawner        spawner;
+    scheduler.add(spawner);
+    scheduler.run();
+
+    // The scheduler sleeps until the next deadline whenever nothing is ready
+    TEST_EQUAL(spawner.steps, 3);
+    TEST_EQUAL(platform.time, 40u);
+    TEST_EQUAL(spawner.child.steps, 9);
+    TEST_EQUAL(platform.slept, 5);
+
+    // Finished and removed tasks are not run again, and may be added again
+    TEST_EQUAL(scheduler.run_once(), -1);
+    TEST_EQUAL(spawner.child.steps, 9);
+    scheduler.add(spawner.child);
+    TEST_EQUAL(scheduler.run_once(), 5);
+    TEST_EQUAL(spawner.child.steps, 10);
+  }
+
+  void check_unlink()
+  {
+    ManualPlatform platform;
+    Scheduler      scheduler(platform);
+    Recorder       kept;
+    kept.next = Wait::sleep(10);
+    scheduler.add(kept);
+
+    // Tasks removed outside of a pass are unlinked at once, so they may be destroyed straight away
+    {
+      Recorder removed;
+      scheduler.add(removed);
+      scheduler.remove(removed);
+    }
+    TEST_EQUAL(scheduler.run_once(), 10);
+    TEST_EQUAL(kept.steps, 1);
+
+    // Tasks which finish are unlinked when their pass ends
+    {
+      Recorder finished;
+      finished.next = Wait::done();
+      scheduler.add(finished);
+      TEST_EQUAL(scheduler.run_once(), 10);
+      TEST_EQUAL(finished.steps, 1);
+    }
+    platform.time = 10;
+    TEST_EQUAL(scheduler.run_once(), 10);
+    TEST_EQUAL(kept.steps, 2);
+    TEST_CHECK(!scheduler.pending());
+  }
+
+}
+
+int main()
+{
+  check_deadlines();
+  check_wrap_around();
+  check_events();
+  check_set_and_signal();
+  check_periodic();
+  check_run();
+  check_unlink();
+  return test::finish();
+}
@@ -0,0 +1,151 @@
+/// \file test_etable.cpp
+/// \brief Tests of interpolated lookup in tables: locating values on axes, blending in fixed point, lookups in two
+/// and three dimensions, and the views of multidimensional data they read through
+
+#include "test.hpp"
+
+#include "etable.hpp"
+#include "test_objects.hpp"
+
+using estd::mdspan;
+using etable::position;
+using etable::Position;
+
+namespace {
+
+  void check_locate()
+  {
+    const int16_t axis[] = { 0, 100, 200, 400 };
+    TEST_EQUAL(etable::locate(axis, 4, int16_t(300)), position(2, 0x8000));
+    TEST_EQUAL(etable::locate(axis, 4, int16_t(100)), position(1));
+    TEST_EQUAL(etable::locate(axis, 4, int16_t(25)), position(0, 0x4000));
+
+    // Values outside the axis are clamped to its ends
+    TEST_EQUAL(etable::locate(axis, 4, int16_t(-5)), position(0));
+    TEST_EQUAL(etable::locate(axis, 4, int16_t(400)), position(3));
+    TEST_EQUAL(etable::locate(axis, 4, int16_t(500)), position(3));
+    TEST_EQUAL(etable::locate(axis, 1, int16_t(50)), position(0));
+
+    // Uniform axes give the same positions as searched ones
+    const int32_t uniform[] = { -50, 0, 50, 100, 150 };
+    for (int32_t value = -80; value <= 180; value += 7)
+      TEST_EQUAL(etable::locate_uniform(-50, 50, 5, value), etable::locate(uniform, 5, value));
+    TEST_EQUAL(etable::locate_uniform(0, 0, 5, 10), position(0));
+
+    static_assert(etable::index(position(3, 7)) == 3 && etable::fraction(position(3, 7)) == 7, "Q16.16 positions");
+    static_assert(etable::locate_uniform(0, 100, 4, 250) == position(2, 0x8000), "constexpr uniform axes");
+  }
+
+  void check_lerp()
+  {
+    TEST_EQUAL(etable::lerp(int16_t(-100), int16_t(100), 0x4000), -50);
+    TEST_EQUAL(etable::lerp(int16_t(-100), int16_t(100), 0), -100);
+    TEST_EQUAL(etable::lerp(uint8_t(200), uint8_t(100), 0x8000), 150);
+    TEST_EQUAL(etable::lerp(int32_t(-2000000000), int32_t(2000000000), 0xFFFF), 1999938964);
+  }
+
+  void check_mdspan()
+  {
+    int16_t values[3][4] = { { 0, 1, 2, 3 }, { 10, 11, 12, 13 }, { 20, 21, 22, 23 } };
+
+    mdspan<int16_t, 2> matrix(values);
+    TEST_EQUAL(matrix.extent(0), 3u);
+    TEST_EQUAL(matrix.extent(1), 4u);
+    TEST_EQUAL(matrix.stride(0), 4u);
+    TEST_EQUAL(matrix.stride(1), 1u);
+    TEST_EQUAL(matrix.size(), 12u);
+    TEST_EQUAL(matrix(2, 1), 21);
+    matrix(1, 3) = 99;
+    TEST_EQUAL(values[1][3], 99);
+    values[1][3] = 13;
+
+    auto row = matrix.row(2);
+    TEST_EQUAL(row.extent(0), 4u);
+    TEST_EQUAL(row(3), 23);
+    auto column = matrix.column(1);
+    TEST_EQUAL(column.extent(0), 3u);
+    TEST_EQUAL(column.stride(0), 4u);
+    TEST_EQUAL(column(2), 21);
+    TEST_EQUAL(matrix.slice(0, 1)(2), 12);
+    TEST_EQUAL(matrix.slice(1, 3)(0), 3);
+
+    // Strides give a transposed view of the same data
+    const uint32_t             extents[] = { 4, 3 };
+    const uint32_t             strides[] = { 1, 4 };
+    mdspan<const int16_t, 2>   transposed(&values[0][0], extents, strides);
+    for (uint32_t i = 0; i < 3; ++i)
+      for (uint32_t j = 0; j < 4; ++j) TEST_EQUAL(transposed(j, i), values[i][j]);
+
+    mdspan<int16_t, 2> none;
+    TEST_CHECK(none.empty() && none.data() == nullptr);
+  }
+
+  void check_interpolate()
+  {
+    const auto& object = *test_objects::dictionary.get(0x2006);
+    const auto  map    = eobject::Table::view<int16_t, 2>(object);
+    TEST_CHECK(map.data() == &test_objects::map[0][0]);
+    TEST_EQUAL(map.extent(0), 3u);
+    TEST_EQUAL(map.extent(1), 4u);
+
+    // Views of the wrong type, rank or class of object are empty
+    TEST_CHECK((eobject::Table::view<int16_t, 3>(object).empty()));
+    TEST_CHECK((eobject::Table::view<int32_t, 2>(object).empty()));
+    TEST_CHECK((eobject::Table::view<int16_t, 2>(*test_objects::dictionary.get(0x2001)).empty()));
+
+    TEST_EQUAL(etable::interpolate(map, position(1, 0x8000), position(2, 0x8000)), 40);
+    TEST_EQUAL(etable::interpolate(map, position(0, 0x4000), position(1)), 12);
+    for (uint16_t i = 0; i < 3; ++i)
+      for (uint16_t j = 0; j < 4; ++j) TEST_EQUAL(etable::interpolate(map, position(i), position(j)), map(i, j));
+
+    // Clamped positions at the last breakpoints read no further than the table
+    TEST_EQUAL(etable::interpolate(map, position(2), position(3)), 50);
+    TEST_EQUAL(etable::interpolate(map, position(2), position(2, 0x8000)), 45);
+
+    // Strided views interpolate the same values with the axes swapped
+    const uint32_t           extents[] = { 4, 3 };
+    const uint32_t           strides[] = { 1, 4 };
+    mdspan<const int16_t, 2> transposed(map.data(), extents, strides);
+    for (Position x = 0; x <= position(2); x += 0x5555)
+      for (Position y = 0; y <= position(3); y += 0x7777)
+        TEST_EQUAL(etable::interpolate(transposed, y, x), etable::interpolate(map, x, y));
+
+    const int32_t            cube_values[2][2][2] = { { { 0, 100 }, { 200, 300 } }, { { 400, 500 }, { 600, 700 } } };
+    mdspan<const int32_t, 3> cube(cube_values);
+    const Position           half = position(0, 0x8000);
+    TEST_EQUAL(etable::interpolate(cube, half, half, half), 350);
+    TEST_EQUAL(etable::interpolate(cube, position(1), position(0), half), 450);
+    TEST_EQUAL(etable::interpolate(cube, position(1), position(1), position(1)), 700);
+  }
+
+  void check_columns()
+  {
+    const auto& object = *test_objects::dictionary.get(0x2006);
+    int16_t     column[3];
+    TEST_EQUAL(eobject::Table::get_column(object, 2, column, sizeof(column)), static_cast<int32_t>(sizeof(column)));
+    TEST_EQUAL(column[0], 20);
+    TEST_EQUAL(column[1], 30);
+    TEST_EQUAL(column[2], 40);
+    TEST_EQUAL(eobject::Table::get_column(object, 4, column, sizeof(column)), eobject::Error::FieldNotFound);
+
+    // Rows are set whole and range checked, so an error leaves the rows after it unchanged
+    const int16_t values[3] = { 1, 2000, 3 };
+    TEST_EQUAL(eobject::Table::set_column(object, 0, values, sizeof(values)), eobject::Error::ValueTooHigh);
+    TEST_EQUAL(test_objects::map[0][0], 1);
+    TEST_EQUAL(test_objects::map[1][0], 10);
+    TEST_EQUAL(test_objects::map[2][0], 20);
+    test_objects::dictionary.reset(eobject::View::Persisted);
+    TEST_EQUAL(test_objects::map[0][0], 0);
+  }
+
+}
+
+int main()
+{
+  check_locate();
+  check_lerp();
+  check_mdspan();
+  check_interpolate();
+  check_columns();
+  return test::finish();
+}
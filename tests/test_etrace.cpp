@@ -0,0 +1,154 @@
+/// \file test_etrace.cpp
+/// \brief Tests of the trace recorder: entries of writes through the dictionary and through copies of its objects,
+/// overwriting the oldest entries once the ring is full, exports in the storage layout, reads across the wrap around
+/// of sequence numbers, and traces continued from storage
+
+#include "test.hpp"
+
+#include <cstring>
+
+#include "etrace.hpp"
+#include "test_objects.hpp"
+
+using eobject::Error;
+using etrace::Entry;
+using etrace::Header;
+using etrace::Source;
+
+namespace {
+
+  uint32_t now = 0;
+
+  uint32_t clock() { return now; }
+
+  void write_setpoint(int16_t value)
+  {
+    TEST_EQUAL(test_objects::dictionary.write(0x2001, 0, &value, sizeof(value)), Error::OK);
+  }
+
+  void check_entries()
+  {
+    const auto           saved = test_objects::storage;
+    etrace::TRecorder<8> recorder(test_objects::dictionary, clock);
+    TEST_EQUAL(recorder.capacity(), 8u);
+    TEST_EQUAL(recorder.end(), 0u);
+
+    // Writes are only recorded while the recorder is started
+    write_setpoint(1);
+    recorder.start();
+    TEST_CHECK(recorder.recording());
+    now = 100;
+    write_setpoint(2);
+    {
+      etrace::SourceScope scope(Source::Console);
+      now                  = 200;
+      auto           gains = *test_objects::dictionary.get(0x2004);
+      const uint16_t gain  = 50;
+      TEST_EQUAL(gains.set(2, &gain, sizeof(gain)), Error::OK);
+    }
+    recorder.stop();
+    write_setpoint(3);
+    TEST_EQUAL(recorder.begin(), 0u);
+    TEST_EQUAL(recorder.end(), 2u);
+
+    Entry entry;
+    TEST_CHECK(recorder.read(0, entry));
+    TEST_EQUAL(entry.sequence, 1u);
+    TEST_EQUAL(entry.time, 100u);
+    TEST_EQUAL(entry.address, 0x2001);
+    TEST_EQUAL(entry.old_value, 1u);
+    TEST_EQUAL(entry.new_value, 2u);
+    TEST_EQUAL(entry.source, static_cast<uint8_t>(Source::Application));
+
+    // Copies of items are found by their metadata and data. Subindex 2 is the second gain
+    TEST_CHECK(recorder.read(1, entry));
+    TEST_EQUAL(entry.time, 200u);
+    TEST_EQUAL(entry.address, 0x2004);
+    TEST_EQUAL(entry.subIdx, 2);
+    TEST_EQUAL(entry.old_value, 10u);
+    TEST_EQUAL(entry.new_value, 50u);
+    TEST_EQUAL(entry.source, static_cast<uint8_t>(Source::Console));
+    TEST_CHECK(!recorder.read(2, entry));
+    TEST_CHECK(etrace::to_string(Source::Console) == "console");
+    test_objects::storage = saved;
+  }
+
+  void check_ring()
+  {
+    const auto saved = test_objects::storage;
+    alignas(4) uint8_t storage[etrace::Recorder::storage_size(4)];
+    etrace::Recorder recorder(storage, sizeof(storage), test_objects::dictionary, nullptr);
+    recorder.start();
+    for (int16_t value = 1; value <= 10; ++value) write_setpoint(value);
+    recorder.stop();
+
+    // Only the last writes are held, and older ones read as overwritten
+    TEST_EQUAL(recorder.begin(), 6u);
+    TEST_EQUAL(recorder.end(), 10u);
+    Entry entry;
+    TEST_CHECK(!recorder.read(5, entry));
+    for (uint32_t sequence = recorder.begin(); sequence != recorder.end(); ++sequence)
+    {
+      TEST_CHECK(recorder.read(sequence, entry));
+      TEST_EQUAL(entry.new_value, sequence + 1);
+      TEST_EQUAL(entry.time, 0u);
+    }
+
+    // Exports hold the header and the ring as they are laid out in storage
+    uint8_t exported[sizeof(storage)];
+    TEST_EQUAL(recorder.export_to(exported, sizeof(exported) - 1), 0u);
+    TEST_EQUAL(recorder.export_to(exported, sizeof(exported)), sizeof(exported));
+    TEST_CHECK(memcmp(exported, storage, sizeof(storage)) == 0);
+
+    recorder.clear();
+    TEST_EQUAL(recorder.end(), 0u);
+    TEST_CHECK(!recorder.read(9, entry));
+    test_objects::storage = saved;
+  }
+
+  void check_wrap_around()
+  {
+    const auto saved = test_objects::storage;
+    alignas(4) uint8_t storage[etrace::Recorder::storage_size(4) + sizeof(Entry) - 1];
+    memset(storage, 0, sizeof(storage));
+
+    // Storage for a little less than 5 entries holds a ring of 4
+    etrace::Recorder recorder(storage, sizeof(storage), test_objects::dictionary, nullptr);
+    TEST_EQUAL(recorder.capacity(), 4u);
+    auto& header = *reinterpret_cast<Header*>(storage);
+    TEST_EQUAL(header.magic, Header::Magic);
+    header.head.store(0xFFFFFFFE);
+
+    recorder.start();
+    for (int16_t value = 1; value <= 5; ++value) write_setpoint(value);
+    recorder.stop();
+    TEST_EQUAL(recorder.end(), 3u);
+
+    // Sequence numbers are compared by their difference, so the entries before the wrap around are still read
+    Entry entry;
+    TEST_CHECK(!recorder.read(0xFFFFFFFE, entry));
+    const uint32_t held[] = { 0xFFFFFFFF, 0, 1, 2 };
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+      TEST_CHECK(recorder.read(held[i], entry));
+      TEST_EQUAL(entry.new_value, i + 2);
+    }
+    TEST_CHECK(!recorder.read(3, entry));
+
+    // A recorder over the same storage continues the trace
+    etrace::Recorder continued(storage, sizeof(storage), test_objects::dictionary, nullptr);
+    TEST_EQUAL(continued.end(), 3u);
+    TEST_CHECK(continued.read(1, entry));
+    TEST_EQUAL(entry.new_value, 4u);
+    test_objects::storage = saved;
+  }
+
+}
+
+int main()
+{
+  check_entries();
+  check_ring();
+  check_wrap_around();
+  return test::finish();
+}
@@ -0,0 +1,634 @@
+#!/usr/bin/env python3
+"""Generate object dictionary sources from a JSON schema.
+
+Usage: eobject_gen.py <schema.json> <output-stem>
+
+Writes <output-stem>.hpp, declaring the data types of every object, a Storage block holding the data of all objects
+and a reference to each object's data in it, and <output-stem>.cpp, defining the storage with its defaults, the
+object metadata, the dictionary with a table of each object's defaults for Dictionary::reset, views of its visible,
+persisted and live objects, and an index of every object and subobject name by atom (see eatom.hpp), with each
+distinct name interned once. The same objects are also written as an eobject::CompactDictionary of parallel tables,
+which locates data by its offset in the storage and names in one string pool, for targets short of flash. With
+unused sections removed at link time, only the dictionary the application uses is kept. Metadata is written as flat
+constexpr tables with offsets, sizes and ranges already computed, so compiling it needs none of the template
+recursion of Record::fields(). Record fields with the same type, range, unit and set function share one entry of a
+table of descriptors. Set functions check values against the ranges in the tables, so only one is instantiated for
+each type.
+
+Schema:
+
+    {
+      "namespace": "app",
+      "objects": [
+        { "name": "firmware", "address": "0x1000", "type": "u32", "perm": "Info", "readonly": true, "default": 1 },
+        { "name": "setpoint", "address": "0x2001", "type": "i16", "min": -100, "max": 100 },
+        { "name": "label", "address": "0x2005", "type": "string", "length": 16, "default": "estd" },
+        { "name": "gains", "address": "0x2004", "type": "u16", "elements": ["p", "i", "d"], "max": 1000 },
+        { "name": "map", "address": "0x2006", "type": "i16", "table": [4, 6], "min": -1000, "max": 1000 },
+        { "name": "motor", "address": "0x2000", "record": "Motor", "fields": [
+          { "name": "current", "type": "u32", "perm": "Status", "max": 10000, "decimals": 2, "unit": "A" },
+          { "name": "speed", "type": "i16", "min": -3000, "max": 3000 }
+        ] }
+      ]
+    }
+
+Objects are variables, arrays (with "elements", a count or a list of element names), tables (with "table", the
+extents of 2 or 3 dimensions, whose last dimension is a row of at most 256 bytes, with at most 255 rows) or records
+(with "fields"). Defaults of arrays and tables are one value for every element, or a list of all of them in row-major
+order.
+Permissions default to UserConfig, ranges default to empty (unchecked), and values default to zero, or to the minimum
+if zero is out of range. Records may not contain padding, as for Record::fields().
+Integer values with "decimals" or "unit" hold scaled counts, e.g. 1234 for 12.34 A with 2 decimals, which the console
+reads and writes in the unit. Ranges and defaults are given in counts. Objects in the same unit share one Object::Unit.
+"""
+
+import json
+import os
+import re
+import sys
+
+TYPES = {
+    "u8": ("uint8_t", 1, 0, 0xFF),
+    "u16": ("uint16_t", 2, 0, 0xFFFF),
+    "u32": ("uint32_t", 4, 0, 0xFFFFFFFF),
+    "i8": ("int8_t", 1, -0x80, 0x7F),
+    "i16": ("int16_t", 2, -0x8000, 0x7FFF),
+    "i32": ("int32_t", 4, -0x80000000, 0x7FFFFFFF),
+}
+
+STRING_TYPES = {"string": "String", "binstring": "BinString"}
+
+PERMISSIONS = ("FactoryHidden", "FactoryConfig", "Hidden", "UserConfig", "Info", "Status", "Dynamic")
+
+# Views of the dictionary written for each schema, with the permissions of the objects in each, as eobject::View
+VIEWS = (
+    ("visible_objects", "Visible", "Objects listed to users",
+     ("FactoryConfig", "UserConfig", "Info", "Status", "Dynamic")),
+    ("persisted_objects", "Persisted", "Configuration objects, which are kept across restarts",
+     ("FactoryHidden", "FactoryConfig", "Hidden", "UserConfig")),
+    ("live_objects", "Live", "Objects whose values change while running", ("Status", "Dynamic")),
+)
+
+IDENTIFIER = re.compile(r"^[A-Za-z_][A-Za-z0-9_]*$")
+
+# Names declared in the generated header besides the objects, which objects and records may not use
+RESERVED = ("storage", "dictionary", "compact_dictionary", "names", "Storage") + tuple(v[0] for v in VIEWS)
+
+
+class SchemaError(Exception):
+    pass
+
+
+def check_name(name, what):
+    if not isinstance(name, str) or not IDENTIFIER.match(name):
+        raise SchemaError("%s name %r is not a valid identifier" % (what, name))
+    return name
+
+
+def parse_int(value, what):
+    if isinstance(value, str):
+        try:
+            return int(value, 0)
+        except ValueError:
+            pass
+    elif isinstance(value, int) and not isinstance(value, bool):
+        return value
+    raise SchemaError("%s %r is not an integer" % (what, value))
+
+
+def literal(type_name, value):
+    """C++ literal for a value of an integer type, avoiding literals which are out of range before negation"""
+    if type_name == "i32" and value == -0x80000000:
+        return "INT32_MIN"
+    if TYPES[type_name][2] == 0:
+        return "%du" % value
+    return "%d" % value
+
+
+class Value:
+    """Integer variable, array element or record field"""
+
+    def __init__(self, spec, where):
+        self.type = spec.get("type")
+        if self.type not in TYPES:
+            raise SchemaError("%s: type %r is not one of %s" % (where, self.type, ", ".join(TYPES)))
+        self.ctype, self.size, lo, hi = TYPES[self.type]
+        self.min = parse_int(spec.get("min", lo if "max" in spec else 0), where + " min")
+        self.max = parse_int(spec.get("max", hi if "min" in spec else 0), where + " max")
+        for bound in (self.min, self.max):
+            if bound < lo or bound > hi:
+                raise SchemaError("%s: range %d..%d does not fit %s" % (where, self.min, self.max, self.type))
+        if self.min > self.max:
+            raise SchemaError("%s: min %d is greater than max %d" % (where, self.min, self.max))
+        self.readonly = bool(spec.get("readonly", False))
+        self.unit = None
+        if "decimals" in spec or "unit" in spec:
+            decimals = parse_int(spec.get("decimals", 0), where + " decimals")
+            if not 0 <= decimals <= 9:
+                raise SchemaError("%s: decimals must be 0 to 9" % where)
+            symbol = spec.get("unit", "")
+            if not isinstance(symbol, str):
+                raise SchemaError("%s: unit %r is not a string" % (where, symbol))
+            self.unit = (decimals, symbol)
+
+    def check_default(self, value, where):
+        value = parse_int(value, where + " default")
+        lo, hi = TYPES[self.type][2:]
+        if self.min != self.max:
+            lo, hi = self.min, self.max
+        if value < lo or value > hi:
+            raise SchemaError("%s: default %d is outside %d..%d" % (where, value, lo, hi))
+        return literal(self.type, value)
+
+    def fallback(self):
+        """Default value when none is given: zero, or the minimum if zero is out of range"""
+        return self.min if self.min != self.max and self.min > 0 else 0
+
+    def range_args(self):
+        return "%s(%s), %s(%s)" % (self.ctype, literal(self.type, self.min), self.ctype, literal(self.type, self.max))
+
+
+class Object:
+    def __init__(self, spec):
+        self.name = check_name(spec.get("name"), "Object")
+        where = "object '%s'" % self.name
+        self.address = parse_int(spec.get("address"), where + " address")
+        if self.address < 0 or self.address > 0xFFFF:
+            raise SchemaError("%s: address 0x%X is not 16 bits" % (where, self.address))
+        self.perm = spec.get("perm", "UserConfig")
+        if self.perm not in PERMISSIONS:
+            raise SchemaError("%s: permission %r is not one of %s" % (where, self.perm, ", ".join(PERMISSIONS)))
+
+        if "fields" in spec:
+            self.kind = "record"
+            self.record = check_name(spec.get("record", self.name[0].upper() + self.name[1:]), where + " record")
+            self.readonly = bool(spec.get("readonly", False))
+            self.fields = []
+            offset = 0
+            for field in spec["fields"]:
+                name = check_name(field.get("name"), where + " field")
+                value = Value(field, "%s field '%s'" % (where, name))
+                value.name = name
+                value.perm = field.get("perm", self.perm)
+                if value.perm not in PERMISSIONS:
+                    raise SchemaError("%s field '%s': permission %r is not valid" % (where, name, value.perm))
+                if offset % value.size != 0:
+                    raise SchemaError("%s field '%s' would be padded to offset %d. Reorder fields so the record has "
+                                      "no gaps" % (where, name, offset + value.size - offset % value.size))
+                value.offset = offset
+                value.default = value.check_default(field.get("default", value.fallback()),
+                                                    "%s field '%s'" % (where, name))
+                offset += value.size
+                self.fields.append(value)
+            if not 0 < len(self.fields) < 256:
+                raise SchemaError("%s: record must have 1 to 255 fields" % where)
+            if len(set(f.name for f in self.fields)) != len(self.fields):
+                raise SchemaError("%s: field names are not unique" % where)
+            self.size = offset
+        elif spec.get("type") in STRING_TYPES:
+            self.kind = "string"
+            self.string_type = STRING_TYPES[spec["type"]]
+            self.length = parse_int(spec.get("length"), where + " length")
+            if not 0 < self.length < 0x10000:
+                raise SchemaError("%s: string length must be 1 to 65535" % where)
+            self.readonly = bool(spec.get("readonly", False))
+            self.default = spec.get("default", "")
+            if not isinstance(self.default, str) or len(self.default.encode()) >= self.length:
+                raise SchemaError("%s: default must be a string shorter than the length" % where)
+        else:
+            self.value = Value(spec, where)
+            self.readonly = self.value.readonly
+            if "table" in spec:
+                self.kind = "table"
+                extents = spec["table"]
+                if not isinstance(extents, list) or not 2 <= len(extents) <= 3:
+                    raise SchemaError("%s: table must have 2 or 3 extents" % where)
+                self.extents = [parse_int(e, where + " table extent") for e in extents]
+                if any(e < 1 for e in self.extents):
+                    raise SchemaError("%s: table extents must be at least 1" % where)
+                rows = 1
+                for e in self.extents[:-1]:
+                    rows *= e
+                if rows > 255:
+                    raise SchemaError("%s: table must have at most 255 rows" % where)
+                if self.extents[-1] * self.value.size > 256:
+                    raise SchemaError("%s: table rows must be at most 256 bytes" % where)
+                count = rows * self.extents[-1]
+                defaults = spec.get("default", self.value.fallback())
+                if not isinstance(defaults, list):
+                    defaults = [defaults] * count
+                if len(defaults) != count:
+                    raise SchemaError("%s: expected %d defaults" % (where, count))
+                self.defaults = [self.value.check_default(d, where) for d in defaults]
+            elif "elements" in spec:
+                self.kind = "array"
+                elements = spec["elements"]
+                if isinstance(elements, list):
+                    self.names = [str(e) for e in elements]
+                    self.count = len(elements)
+                else:
+                    self.names = None
+                    self.count = parse_int(elements, where + " elements")
+                if not 0 < self.count < 256:
+                    raise SchemaError("%s: array must have 1 to 255 elements" % where)
+                defaults = spec.get("default", self.value.fallback())
+                if not isinstance(defaults, list):
+                    defaults = [defaults] * self.count
+                if len(defaults) != self.count:
+                    raise SchemaError("%s: expected %d defaults" % (where, self.count))
+                self.defaults = [self.value.check_default(d, where) for d in defaults]
+            else:
+                self.kind = "variable"
+                self.default = self.value.check_default(spec.get("default", self.value.fallback()), where)
+
+
+def load(path):
+    with open(path) as f:
+        schema = json.load(f)
+    namespace = schema.get("namespace", "objects")
+    for part in namespace.split("::"):
+        check_name(part, "Namespace")
+    objects = [Object(spec) for spec in schema.get("objects", [])]
+    if not objects:
+        raise SchemaError("schema has no objects")
+    for o in objects:
+        if o.name in RESERVED or (o.kind == "record" and o.record in RESERVED):
+            raise SchemaError("object '%s': name is reserved for the generated dictionary" % o.name)
+    for attr, what in (("name", "name"), ("address", "address")):
+        seen = {}
+        for o in objects:
+            key = getattr(o, attr)
+            if key in seen:
+                raise SchemaError("objects '%s' and '%s' have the same %s" % (seen[key].name, o.name, what))
+            seen[key] = o
+    if sum(len(o.name) for o in objects) > 0xFFFF:
+        raise SchemaError("object names take more bytes than 16-bit offsets reach")
+    records = {}
+    for o in objects:
+        if o.kind == "record":
+            if o.record in records:
+                raise SchemaError("record type %s is defined by objects '%s' and '%s'"
+                                  % (o.record, records[o.record].name, o.name))
+            records[o.record] = o
+    return namespace, sorted(objects, key=lambda o: o.address)
+
+
+def cstring(text):
+    out = '"'
+    for b in text.encode():
+        c = chr(b)
+        if c in '"\\':
+            out += "\\" + c
+        elif 0x20 <= b < 0x7F:
+            out += c
+        else:
+            out += '\\%03o' % b
+    return out + '"'
+
+
+def write_header(out, namespace, objects, source, stem):
+    out.append("#pragma once")
+    out.append("")
+    out.append("/// \\file %s.hpp" % stem)
+    out.append("/// Object dictionary generated from %s by eobject_gen.py. Do not edit" % source)
+    out.append("")
+    out.append('#include "eobject.hpp"')
+    out.append("")
+    out.append("namespace %s {" % namespace)
+    for o in objects:
+        if o.kind == "record":
+            out.append("")
+            out.append("  struct %s" % o.record)
+            out.append("  {")
+            width = max(len(f.ctype) for f in o.fields)
+            for f in o.fields:
+                out.append("    %-*s %s;" % (width, f.ctype, f.name))
+            out.append("  };")
+    out.append("")
+    out.append("  /// \\brief Data of all objects, in address order")
+    out.append("  struct Storage")
+    out.append("  {")
+    width = max(len(declared_type(o)) for o in objects)
+    for o in objects:
+        out.append("    %-*s %s%s;" % (width, declared_type(o), o.name, extent(o)))
+    out.append("  };")
+    out.append("")
+    out.append("  extern Storage storage;")
+    out.append("")
+    for o in objects:
+        out.append("  static constexpr auto& %s = storage.%s;" % (o.name, o.name))
+    out.append("")
+    out.append("  /// \\brief Dictionary of all objects, sorted by address, which finds objects by name through names")
+    out.append("  extern const eobject::TDictionary<%d> dictionary;" % len(objects))
+    out.append("")
+    out.append("  /// \\brief Dictionary of all objects as parallel tables, which take half the flash of dictionary")
+    out.append("  extern const eobject::CompactDictionary compact_dictionary;")
+    out.append("")
+    out.append("  /// \\brief Index of object and subobject names by atom, for queries by name")
+    out.append("  extern const eobject::NameIndex names;")
+    for name, _, brief, perms in VIEWS:
+        out.append("")
+        out.append("  /// \\brief %s" % brief)
+        out.append("  extern const eobject::TView<%d> %s;" % (view_size(objects, perms), name))
+    out.append("}")
+
+
+def view_size(objects, perms):
+    return sum(1 for o in objects if o.perm in perms)
+
+
+def declared_type(o):
+    if o.kind == "record":
+        return o.record
+    if o.kind == "string":
+        return "char"
+    return o.value.ctype
+
+
+def extent(o):
+    if o.kind == "string":
+        return "[%d]" % o.length
+    if o.kind == "array":
+        return "[%d]" % o.count
+    if o.kind == "table":
+        return "".join("[%d]" % e for e in o.extents)
+    return ""
+
+
+def nested(values, extents):
+    """Brace initializer of values in row-major order for an array of extents"""
+    if len(extents) == 1:
+        return "{ %s }" % ", ".join(values)
+    step = len(values) // extents[0]
+    return "{ %s }" % ", ".join(nested(values[i:i + step], extents[1:]) for i in range(0, len(values), step))
+
+
+def initializer(o):
+    if o.kind == "record":
+        return "{ %s }" % ", ".join(f.default for f in o.fields)
+    if o.kind == "string":
+        return cstring(o.default)
+    if o.kind == "array":
+        return "{ %s }" % ", ".join(o.defaults)
+    if o.kind == "table":
+        return nested(o.defaults, o.extents)
+    return o.default
+
+
+def wrapped(out, head, values, indent, close=" };"):
+    """Append initializer list of values, wrapped to lines of at most 120 characters"""
+    line = indent + head + "{"
+    for i, v in enumerate(values):
+        text = " %s%s" % (v, "," if i + 1 < len(values) else "")
+        if len(line) + len(text) > 118:
+            out.append(line)
+            line = indent + " "
+        line += text
+    out.append(line + close)
+
+
+def name_tables(objects):
+    """Distinct names without case, in order of first use, with the atom of each object and of each subobject"""
+    atoms, spellings = {}, []
+
+    def intern(name):
+        if name.lower() not in atoms:
+            atoms[name.lower()] = len(spellings)
+            spellings.append(name)
+        return atoms[name.lower()]
+
+    items, first, fields = {}, [], []
+    for i, o in enumerate(objects):
+        first.append(len(fields))
+        items.setdefault(intern(o.name), i)
+        if o.kind == "record":
+            fields.extend(intern(f.name) for f in o.fields)
+        elif o.kind == "array":
+            fields.extend(intern(n) if n else None for n in (o.names or [""] * o.count))
+    first.append(len(fields))
+    return spellings, [items.get(a) for a in range(len(spellings))], first, fields
+
+
+def units_of(objects):
+    """Distinct units of all values, in order of first use"""
+    units = []
+    for o in objects:
+        values = o.fields if o.kind == "record" else [o.value] if o.kind != "string" else []
+        for v in values:
+            if v.unit is not None and v.unit not in units:
+                units.append(v.unit)
+    return units
+
+
+def descriptor_key(field):
+    return (field.type, field.readonly, field.min, field.max, field.unit)
+
+
+def descriptor_table(objects):
+    """Distinct descriptors of record fields, in order of first use, with the position in the table of the first
+    descriptor of each record. Each record reaches its descriptors by one byte, so a record whose descriptors would
+    span more than 256 entries gets copies of them at the end of the table"""
+    table, index, bases = [], {}, {}
+    for o in objects:
+        if o.kind != "record":
+            continue
+        keys = [descriptor_key(f) for f in o.fields]
+        new = len(set(k for k in keys if k not in index))
+        old = [index[k] for k in keys if k in index]
+        base = min(old) if old else len(table)
+        if len(table) + new - base > 256:
+            base = len(table)
+            for k in keys:
+                index.pop(k, None)
+        for k, f in zip(keys, o.fields):
+            if k not in index:
+                index[k] = len(table)
+                table.append(f)
+        bases[o.name] = (base, [index[k] - base for k in keys])
+    return table, bases
+
+
+def with_unit(info, value, units):
+    if value.unit is None:
+        return info
+    return "eobject::with_unit(%s, &units[%d])" % (info, units.index(value.unit))
+
+
+def write_source(out, namespace, objects, source, stem):
+    out.append("/// \\file %s.cpp" % stem)
+    out.append("/// Object dictionary generated from %s by eobject_gen.py. Do not edit" % source)
+    out.append("")
+    out.append("#include <cstddef>")
+    out.append("#include <cstdint>")
+    out.append("")
+    out.append('#include "%s.hpp"' % stem)
+    out.append("")
+    out.append("using eobject::Array;")
+    out.append("using eobject::DataType;")
+    out.append("using eobject::Dictionary;")
+    out.append("using eobject::Object;")
+    out.append("using eobject::Record;")
+    out.append("using eobject::Table;")
+    out.append("using eobject::Variable;")
+    out.append("")
+    out.append("namespace %s {" % namespace)
+
+    for o in objects:
+        if o.kind == "record":
+            out.append("")
+            out.append('  static_assert(sizeof(%s) == %d, "Record %s has padding");' % (o.record, o.size, o.record))
+            for f in o.fields:
+                out.append('  static_assert(offsetof(%s, %s) == %d, "Field offset differs from schema");'
+                           % (o.record, f.name, f.offset))
+
+    out.append('  static_assert(sizeof(Storage) <= 0x10000, "Storage is too large for 16-bit offsets");')
+
+    out.append("")
+    out.append("  namespace {")
+    units = units_of(objects)
+    if units:
+        out.append("")
+        out.append("    constexpr Object::Unit units[] = {")
+        for i, (decimals, symbol) in enumerate(units):
+            out.append("      { %d, %s }%s" % (decimals, cstring(symbol), "," if i + 1 < len(units) else ""))
+        out.append("    };")
+    out.append("")
+    descriptors, bases = descriptor_table(objects)
+    if descriptors:
+        out.append("")
+        out.append("    constexpr Record::Descriptor descriptors[] = {")
+        for i, f in enumerate(descriptors):
+            setf = ("Object::detail::set_readonly" if f.readonly else "Record::detail::set_field<%s>" % f.ctype)
+            descriptor = "Record::descriptor(%s, %s)" % (setf, f.range_args())
+            out.append("      %s%s" % (with_unit(descriptor, f, units), "," if i + 1 < len(descriptors) else ""))
+        out.append("    };")
+    out.append("")
+    out.append("    constexpr Storage defaults = {")
+    for i, o in enumerate(objects):
+        out.append("      %s%s" % (initializer(o), "," if i + 1 < len(objects) else ""))
+    out.append("    };")
+    for o in objects:
+        perm = "Object::Permissions::" + o.perm
+        out.append("")
+        if o.kind == "record":
+            out.append("    constexpr auto %s_info = Record::TInfo<%d>(" % (o.name, len(o.fields)))
+            setf = "Object::detail::set_readonly" if o.readonly else "Record::detail::set_data"
+            base, indices = bases[o.name]
+            out.append("      %s, 0, %d, %s, descriptors + %d," % (perm, o.size, setf, base))
+            for i, (f, d) in enumerate(zip(o.fields, indices)):
+                out.append('      Record::FieldInfo(Object::Permissions::%s, "%s", %d, %d)%s'
+                           % (f.perm, f.name, f.offset, d,
+                              "," if i + 1 < len(o.fields) else ");"))
+            continue
+        if o.kind == "string":
+            setf = ("Object::detail::set_readonly" if o.readonly
+                    else "Object::detail::set_%s_variable<%d>" % (o.string_type.lower(), o.length))
+            info = "Variable::Info(%s, DataType::%s, %s, %d)" % (perm, o.string_type, setf, o.length)
+        elif o.kind == "array":
+            v = o.value
+            setf = ("Object::detail::set_readonly" if o.readonly
+                    else "Array::detail::set_element<%s>" % v.ctype)
+            names = ""
+            if o.names is not None:
+                names = "{ %s }, " % ", ".join(cstring(n) for n in o.names)
+            info = "Array::TInfo<%d>(%s, %s, %s%s, %s)" % (o.count, perm, o.name, names, setf, v.range_args())
+            info = with_unit(info, v, units)
+        elif o.kind == "table":
+            v = o.value
+            setf = ("Object::detail::set_readonly" if o.readonly
+                    else "Table::detail::set_row<%s>" % v.ctype)
+            info = with_unit("Table::Info(%s, %s, %s, %s)" % (perm, o.name, setf, v.range_args()), v, units)
+        else:
+            v = o.value
+            setf = ("Object::detail::set_readonly" if o.readonly
+                    else "Variable::detail::set_value<%s>" % v.ctype)
+            info = with_unit("Variable::Info(%s, 0, %s, %s)" % (perm, setf, v.range_args()), v, units)
+        out.append("    constexpr auto %s_info = %s;" % (o.name, info))
+    out.append("")
+    wrapped(out, "constexpr const void* item_defaults[] = ", ["&defaults.%s" % o.name for o in objects], "    ")
+    out.append("  }")
+    out.append("")
+    out.append("  Storage storage = defaults;")
+
+    out.append("")
+    out.append("  constexpr eobject::TDictionary<%d> dictionary(estd::array<Dictionary::Item, %d>{"
+               % (len(objects), len(objects)))
+    for i, o in enumerate(objects):
+        out.append('    Dictionary::Item{ 0x%04X, 0, Object("%s", &%s_info, &%s) }%s'
+                   % (o.address, o.name, o.name, o.name, "," if i + 1 < len(objects) else ""))
+    out.append("  }, &names, item_defaults);")
+
+    pool, offsets = "", [0]
+    for o in objects:
+        pool += o.name
+        offsets.append(len(pool))
+    out.append("")
+    out.append("  namespace {")
+    wrapped(out, "constexpr uint16_t compact_addresses[] = ", ["0x%04X" % o.address for o in objects], "    ")
+    wrapped(out, "constexpr const Object::Info* compact_infos[] = ", ["&%s_info" % o.name for o in objects], "    ")
+    wrapped(out, "constexpr uint16_t compact_offsets[] = ", ["offsetof(Storage, %s)" % o.name for o in objects],
+            "    ")
+    out.append("    constexpr char compact_pool[] =")
+    line = "     "
+    for o in objects:
+        if len(line) + len(o.name) + 3 > 118:
+            out.append(line)
+            line = "     "
+        line += " " + cstring(o.name)
+    out.append(line + ";")
+    wrapped(out, "constexpr uint16_t compact_names[] = ", offsets, "    ")
+    out.append("  }")
+    out.append("")
+    out.append("  constexpr eobject::CompactDictionary compact_dictionary(%d, compact_addresses, compact_infos, "
+               "compact_offsets, &storage," % len(objects))
+    out.append("                                                          compact_names, compact_pool, nullptr, &defaults);")
+
+    spellings, items, first, fields = name_tables(objects)
+    out.append("")
+    out.append("  namespace {")
+    wrapped(out, "constexpr eatom::TAtoms<%d> atoms(" % len(spellings), [cstring(n) for n in spellings], "    ",
+            " });")
+    out.append("    constexpr uint16_t NoItem = eobject::NameIndex::NoItem;")
+    wrapped(out, "constexpr uint16_t name_items[] = ", ["NoItem" if i is None else i for i in items], "    ")
+    wrapped(out, "constexpr uint16_t name_first[] = ", first, "    ")
+    wrapped(out, "constexpr eatom::atom name_fields[] = ",
+            ["eatom::NoAtom" if f is None else f for f in (fields or [None])], "    ")
+    out.append("    static_assert(atoms.size() == %d && sizeof(name_items) / sizeof(name_items[0]) == atoms.size(),"
+               % len(spellings))
+    out.append('                  "Every name has an atom and an item");')
+    out.append("    static_assert(sizeof(name_first) / sizeof(name_first[0]) == dictionary.count + 1 &&")
+    out.append("                    name_first[dictionary.count] <= sizeof(name_fields) / sizeof(name_fields[0]),")
+    out.append('                  "Every object has a range of subobject names");')
+    out.append("  }")
+    out.append("")
+    out.append("  constexpr eobject::NameIndex names(dictionary, atoms, name_items, name_first, name_fields);")
+
+    out.append("")
+    for name, mask, _, perms in VIEWS:
+        out.append("  constexpr eobject::TView<%d> %s(dictionary, eobject::View::%s);"
+                   % (view_size(objects, perms), name, mask))
+    out.append("}")
+
+
+def main(argv):
+    if len(argv) != 3:
+        print(__doc__, file=sys.stderr)
+        return 2
+    source, stem = argv[1], argv[2]
+    try:
+        namespace, objects = load(source)
+    except (OSError, ValueError, SchemaError) as e:
+        print("%s: error: %s" % (source, e), file=sys.stderr)
+        return 1
+
+    header, body = [], []
+    write_header(header, namespace, objects, os.path.basename(source), os.path.basename(stem))
+    write_source(body, namespace, objects, os.path.basename(source), os.path.basename(stem))
+    for path, lines in ((stem + ".hpp", header), (stem + ".cpp", body)):
+        with open(path, "w") as f:
+            f.write("\n".join(lines) + "\n")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+"""Convert a capture read out of esample::Sampler to CSV.
+
+Usage: esample_dump.py <capture file> [--schema=<schema.json>]
+
+Prints one row per sample, with the time from the trigger in microseconds and a column per signal. With the JSON schema
+the dictionary was generated from (see eobject_gen.py), columns are named after objects and fields; otherwise they
+are named by address and subindex. Captures are read as little-endian, either as read out raw (version 1) or as written
+with encoded columns (version 2, see ecodec.hpp).
+"""
+
+import struct
+import sys
+
+from etrace_dump import load_schema
+
+MAGIC = 0x504D5345
+NO_TRIGGER = 0xFFFFFFFF
+HEADER = struct.Struct("<IHHIII")
+SIGNAL = struct.Struct("<HBB")
+
+# Formats of the DataType values which can be sampled
+FORMATS = {1: "B", 2: "H", 3: "I", 4: "b", 5: "h", 6: "i"}
+
+# Codecs of encoded columns, and number of values bit-packed at the same width
+RAW, DELTA, DELTA_OF_DELTA, RLE = range(4)
+BLOCK_SIZE = 128
+
+
+def unzigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def narrow(value, data_type):
+    """Truncate a 32 bit value to the width of the data type, as the device stores it"""
+    bits = 8 * struct.calcsize(FORMATS[data_type])
+    value &= (1 << bits) - 1
+    if FORMATS[data_type].islower() and value >= 1 << (bits - 1):
+        value -= 1 << bits
+    return value
+
+
+def read_varint(data, offset):
+    value, shift = 0, 0
+    while shift < 35:
+        if offset >= len(data):
+            raise ValueError("capture is truncated")
+        byte = data[offset]
+        offset += 1
+        value |= (byte & 0x7F) << shift
+        if not byte & 0x80:
+            return value, offset
+        shift += 7
+    raise ValueError("capture has a bad run")
+
+
+def decode_column(data, offset, samples, data_type, codec):
+    """Decode a column, returning the values and the offset after it"""
+    if codec == RAW:
+        fmt = "<%d%s" % (samples, FORMATS[data_type])
+        size = struct.calcsize(fmt)
+        if len(data) < offset + size:
+            raise ValueError("capture is truncated")
+        return list(struct.unpack_from(fmt, data, offset)), offset + size
+
+    values, previous, previous_delta = [], 0, 0
+    if codec in (DELTA, DELTA_OF_DELTA):
+        for start in range(0, samples, BLOCK_SIZE):
+            n = min(BLOCK_SIZE, samples - start)
+            if offset >= len(data) or data[offset] > 32:
+                raise ValueError("capture is truncated or has a bad block")
+            width = data[offset]
+            size = (n * width + 7) // 8
+            if len(data) < offset + 1 + size:
+                raise ValueError("capture is truncated")
+            bits = int.from_bytes(data[offset + 1:offset + 1 + size], "little")
+            offset += 1 + size
+            for i in range(n):
+                delta = unzigzag((bits >> (i * width)) & ((1 << width) - 1))
+                if codec == DELTA_OF_DELTA:
+                    delta += previous_delta
+                    previous_delta = delta
+                previous += delta
+                values.append(narrow(previous, data_type))
+        return values, offset
+    if codec == RLE:
+        while len(values) < samples:
+            run, offset = read_varint(data, offset)
+            delta, offset = read_varint(data, offset)
+            if run == 0 or run > samples - len(values):
+                raise ValueError("capture has a bad run")
+            previous += unzigzag(delta)
+            values.extend([narrow(previous, data_type)] * run)
+        return values, offset
+    raise ValueError("capture has unsupported codec %d" % codec)
+
+
+def read_capture(data):
+    if len(data) < HEADER.size:
+        raise ValueError("capture is too short")
+    magic, version, signals, samples, trigger, period_us = HEADER.unpack_from(data)
+    if magic != MAGIC or version not in (1, 2):
+        raise ValueError("not a capture, or a capture of an unsupported version")
+
+    offset = HEADER.size
+    columns = []
+    for _ in range(signals):
+        address, subidx, data_type = SIGNAL.unpack_from(data, offset)
+        offset += SIGNAL.size
+        if data_type not in FORMATS:
+            raise ValueError("signal 0x%04X:%d has unsupported type %d" % (address, subidx, data_type))
+        columns.append([address, subidx, data_type, None])
+    codec = RAW
+    if version == 2:
+        if offset >= len(data):
+            raise ValueError("capture is truncated")
+        codec = data[offset]
+        offset += 1
+    for column in columns:
+        column[3], offset = decode_column(data, offset, samples, column[2], codec)
+    return samples, None if trigger == NO_TRIGGER else trigger, period_us, columns
+
+
+def column_name(address, subidx, objects):
+    if address not in objects:
+        return "0x%04X:%d" % (address, subidx)
+    name, fields = objects[address]
+    field = fields.get(subidx, (str(subidx), None))[0]
+    return name if field is None else name + "." + field
+
+
+def main(argv):
+    path, schema_path = None, None
+    for arg in argv[1:]:
+        key, _, value = arg.partition("=")
+        if key == "--schema":
+            schema_path = value
+        elif not arg.startswith("--") and path is None:
+            path = arg
+        else:
+            print(__doc__, file=sys.stderr)
+            return 2
+    if path is None:
+        print(__doc__, file=sys.stderr)
+        return 2
+
+    objects = load_schema(schema_path) if schema_path else {}
+    with open(path, "rb") as f:
+        try:
+            samples, trigger, period_us, columns = read_capture(f.read())
+        except ValueError as e:
+            print("%s: %s" % (path, e), file=sys.stderr)
+            return 1
+
+    origin = trigger if trigger is not None else 0
+    print(",".join(["time_us"] + [column_name(c[0], c[1], objects) for c in columns]))
+    for i in range(samples):
+        print(",".join([str((i - origin) * period_us)] + [str(c[3][i]) for c in columns]))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+"""Print a trace of object writes recorded by etrace::Recorder.
+
+Usage: etrace_dump.py <trace file> [--schema=<schema.json>] [--format=text|csv]
+
+The trace file holds the header and ring of entries of the recorder, as kept in a memory mapped file or written by
+Recorder::export_to. Entries are printed oldest first. With the JSON schema the dictionary was generated from (see
+eobject_gen.py), objects and fields are printed by name and values as their types; otherwise addresses, subindexes and
+raw values are printed. Traces are read as little-endian, which is the byte order of the targets and hosts supported.
+"""
+
+import json
+import struct
+import sys
+
+MAGIC = 0x43525445
+HEADER = struct.Struct("<IHHII")
+ENTRY = struct.Struct("<IIHBBII")
+SOURCES = ["application", "console", "import", "remote"]
+NO_ADDRESS = 0xFFFF
+
+SIGNED = {"i8": 8, "i16": 16, "i32": 32}
+UNSIGNED = {"u8": 8, "u16": 16, "u32": 32}
+
+
+def parse_int(value):
+    return int(value, 0) if isinstance(value, str) else int(value)
+
+
+def load_schema(path):
+    """Map addresses to object names and the name and type of each subindex"""
+    with open(path) as f:
+        schema = json.load(f)
+    objects = {}
+    for spec in schema["objects"]:
+        fields = {}
+        if "fields" in spec:
+            for i, field in enumerate(spec["fields"]):
+                fields[i + 1] = (field["name"], field["type"])
+        elif "elements" in spec:
+            elements = spec["elements"]
+            names = elements if isinstance(elements, list) else [str(i) for i in range(parse_int(elements))]
+            for i, name in enumerate(names):
+                fields[i + 1] = (str(name), spec["type"])
+        else:
+            fields[0] = (None, spec["type"])
+        objects[parse_int(spec["address"])] = (spec["name"], fields)
+    return objects
+
+
+def format_value(value, type_name):
+    """Format the first 4 bytes of a value, as stored in native (little-endian) order"""
+    if type_name in UNSIGNED:
+        return str(value & ((1 << UNSIGNED[type_name]) - 1))
+    if type_name in SIGNED:
+        bits = SIGNED[type_name]
+        value &= (1 << bits) - 1
+        return str(value - (1 << bits) if value >> (bits - 1) else value)
+    if type_name == "string":
+        text = struct.pack("<I", value).split(b"\0")[0].decode("utf-8", "replace")
+        return json.dumps(text)
+    return "0x%08X" % value
+
+
+def read_trace(data):
+    if len(data) < HEADER.size:
+        raise ValueError("trace is too short")
+    magic, version, entry_size, capacity, head = HEADER.unpack_from(data)
+    if magic != MAGIC or version != 1 or entry_size != ENTRY.size:
+        raise ValueError("not a trace, or a trace of an unsupported version")
+    if len(data) < HEADER.size + capacity * ENTRY.size:
+        raise ValueError("trace is truncated")
+
+    entries = []
+    for i in range(capacity):
+        entry = ENTRY.unpack_from(data, HEADER.size + i * ENTRY.size)
+        # Empty entries, and entries being written when the trace was taken, have no sequence number
+        if entry[0] != 0:
+            entries.append(entry)
+    # Order by distance back from the head, so sequence numbers which have wrapped around are ordered correctly
+    entries.sort(key=lambda e: (head - e[0]) & 0xFFFFFFFF, reverse=True)
+    return entries
+
+
+def describe(entry, objects):
+    sequence, time, address, subidx, source, old, new = entry
+    name, type_name = None, None
+    if address != NO_ADDRESS and address in objects:
+        object_name, fields = objects[address]
+        field_name, type_name = fields.get(subidx, (str(subidx), None))
+        name = object_name if field_name is None else object_name + "." + field_name
+    elif address != NO_ADDRESS:
+        name = "0x%04X:%d" % (address, subidx)
+    else:
+        name = "unknown:%d" % subidx
+    source_name = SOURCES[source] if source < len(SOURCES) else str(source)
+    return sequence - 1, time, name, format_value(old, type_name), format_value(new, type_name), source_name
+
+
+def main(argv):
+    path, schema_path, output_format = None, None, "text"
+    for arg in argv[1:]:
+        key, _, value = arg.partition("=")
+        if key == "--schema":
+            schema_path = value
+        elif key == "--format" and value in ("text", "csv"):
+            output_format = value
+        elif not arg.startswith("--") and path is None:
+            path = arg
+        else:
+            print(__doc__, file=sys.stderr)
+            return 2
+    if path is None:
+        print(__doc__, file=sys.stderr)
+        return 2
+
+    objects = load_schema(schema_path) if schema_path else {}
+    with open(path, "rb") as f:
+        try:
+            entries = read_trace(f.read())
+        except ValueError as e:
+            print("%s: %s" % (path, e), file=sys.stderr)
+            return 1
+
+    if output_format == "csv":
+        print("sequence,time,object,old,new,source")
+    for entry in entries:
+        row = describe(entry, objects)
+        if output_format == "csv":
+            print(",".join(str(v) for v in row))
+        else:
+            print("%8d %10d %-24s %12s -> %-12s %s" % row)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))